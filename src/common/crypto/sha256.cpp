@@ -0,0 +1,596 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cstring>
+#include <initializer_list>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SHA256_X86
+#include <cpuid.h>
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define SHA256_ARMV8
+#include <arm_neon.h>
+#include <sys/auxv.h>
+#endif
+
+#include "sha256.hpp"
+
+namespace aos {
+namespace sha256 {
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+namespace {
+
+alignas(16) constexpr uint32_t cK[64] = {0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+    0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7,
+    0xc19bf174, 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967, 0x27b70a85,
+    0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070, 0x19a4c116, 0x1e376c08, 0x2748774c,
+    0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+constexpr uint32_t cInitState[8]
+    = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+
+// Number of messages hashed at once by multi-buffer implementation.
+constexpr size_t cNumLanes = 8;
+
+inline uint32_t Rotr(uint32_t value, int count)
+{
+    return (value >> count) | (value << (32 - count));
+}
+
+inline uint32_t LoadBE32(const uint8_t* data)
+{
+    return static_cast<uint32_t>(data[0]) << 24 | static_cast<uint32_t>(data[1]) << 16
+        | static_cast<uint32_t>(data[2]) << 8 | data[3];
+}
+
+inline void StoreBE32(uint8_t* data, uint32_t value)
+{
+    data[0] = static_cast<uint8_t>(value >> 24);
+    data[1] = static_cast<uint8_t>(value >> 16);
+    data[2] = static_cast<uint8_t>(value >> 8);
+    data[3] = static_cast<uint8_t>(value);
+}
+
+// Writes message tail followed by padding and message bit length, returns number of written blocks.
+size_t Pad(const uint8_t* tail, size_t tailSize, uint64_t messageSize, uint8_t* blocks)
+{
+    auto numBlocks = tailSize + 1 + sizeof(uint64_t) > cBlockSize ? 2 : 1;
+    auto size      = numBlocks * cBlockSize;
+
+    if (tailSize > 0) {
+        memcpy(blocks, tail, tailSize);
+    }
+
+    blocks[tailSize] = 0x80;
+    memset(blocks + tailSize + 1, 0, size - tailSize - 1);
+
+    auto bits = messageSize * 8;
+
+    StoreBE32(blocks + size - 8, static_cast<uint32_t>(bits >> 32));
+    StoreBE32(blocks + size - 4, static_cast<uint32_t>(bits));
+
+    return numBlocks;
+}
+
+void CompressScalar(uint32_t state[8], const uint8_t* data, size_t numBlocks)
+{
+    for (; numBlocks > 0; numBlocks--, data += cBlockSize) {
+        uint32_t w[64];
+
+        for (int i = 0; i < 16; i++) {
+            w[i] = LoadBE32(data + i * 4);
+        }
+
+        for (int i = 16; i < 64; i++) {
+            auto s0 = Rotr(w[i - 15], 7) ^ Rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            auto s1 = Rotr(w[i - 2], 17) ^ Rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        auto a = state[0], b = state[1], c = state[2], d = state[3];
+        auto e = state[4], f = state[5], g = state[6], h = state[7];
+
+        for (int i = 0; i < 64; i++) {
+            auto t1 = h + (Rotr(e, 6) ^ Rotr(e, 11) ^ Rotr(e, 25)) + ((e & f) ^ (~e & g)) + cK[i] + w[i];
+            auto t2 = (Rotr(a, 2) ^ Rotr(a, 13) ^ Rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+    }
+}
+
+#ifdef SHA256_X86
+
+/***********************************************************************************************************************
+ * SHA-NI
+ **********************************************************************************************************************/
+
+// CPUID is expensive under virtualization, so it is queried once.
+bool IsSHANISupported()
+{
+    static const bool sSupported = [] {
+        unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+
+        // SHA extensions are reported in CPUID leaf 7 EBX bit 29.
+        if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+            return false;
+        }
+
+        return (ebx & (1u << 29)) && __builtin_cpu_supports("sse4.1") && __builtin_cpu_supports("ssse3");
+    }();
+
+    return sSupported;
+}
+
+__attribute__((target("sha,sse4.1,ssse3"))) void CompressSHANI(uint32_t state[8], const uint8_t* data, size_t numBlocks)
+{
+    const auto cByteSwap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    // Instructions operate on ABEF and CDGH state halves.
+    auto tmp    = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[0])), 0xb1);
+    auto state1 = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[4])), 0x1b);
+    auto state0 = _mm_alignr_epi8(tmp, state1, 8);
+
+    state1 = _mm_blend_epi16(state1, tmp, 0xf0);
+
+    for (; numBlocks > 0; numBlocks--, data += cBlockSize) {
+        auto    save0 = state0;
+        auto    save1 = state1;
+        __m128i msgs[4];
+
+        // Each step does 4 rounds, message schedule keeps the last 16 words.
+        for (int i = 0; i < 16; i++) {
+            auto& msg = msgs[i % 4];
+
+            if (i < 4) {
+                msg = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * 16)), cByteSwap);
+            } else {
+                msg = _mm_add_epi32(_mm_sha256msg1_epu32(msg, msgs[(i + 1) % 4]),
+                    _mm_alignr_epi8(msgs[(i + 3) % 4], msgs[(i + 2) % 4], 4));
+                msg = _mm_sha256msg2_epu32(msg, msgs[(i + 3) % 4]);
+            }
+
+            auto words = _mm_add_epi32(msg, _mm_load_si128(reinterpret_cast<const __m128i*>(&cK[i * 4])));
+
+            state1 = _mm_sha256rnds2_epu32(state1, state0, words);
+            state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(words, 0x0e));
+        }
+
+        state0 = _mm_add_epi32(state0, save0);
+        state1 = _mm_add_epi32(state1, save1);
+    }
+
+    tmp    = _mm_shuffle_epi32(state0, 0x1b);
+    state1 = _mm_shuffle_epi32(state1, 0xb1);
+    state0 = _mm_blend_epi16(tmp, state1, 0xf0);
+    state1 = _mm_alignr_epi8(state1, tmp, 8);
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[0]), state0);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[4]), state1);
+}
+
+/***********************************************************************************************************************
+ * AVX2 multi-buffer
+ **********************************************************************************************************************/
+
+template <int cCount>
+__attribute__((target("avx2"))) inline __m256i Rotr8(__m256i value)
+{
+    return _mm256_or_si256(_mm256_srli_epi32(value, cCount), _mm256_slli_epi32(value, 32 - cCount));
+}
+
+// Loads 8 words of each lane, so that the result word i holds word i of all lanes.
+__attribute__((target("avx2"))) inline void LoadTransposed(const uint8_t* const blocks[cNumLanes], size_t offset,
+    __m256i words[8])
+{
+    const auto cByteSwap = _mm256_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3, 12, 13, 14, 15, 8, 9,
+        10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+
+    __m256i rows[8], pairs[8], quads[8];
+
+    for (int i = 0; i < 8; i++) {
+        rows[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(blocks[i] + offset));
+    }
+
+    for (int i = 0; i < 8; i += 2) {
+        pairs[i]     = _mm256_unpacklo_epi32(rows[i], rows[i + 1]);
+        pairs[i + 1] = _mm256_unpackhi_epi32(rows[i], rows[i + 1]);
+    }
+
+    for (int i = 0; i < 8; i += 4) {
+        quads[i]     = _mm256_unpacklo_epi64(pairs[i], pairs[i + 2]);
+        quads[i + 1] = _mm256_unpackhi_epi64(pairs[i], pairs[i + 2]);
+        quads[i + 2] = _mm256_unpacklo_epi64(pairs[i + 1], pairs[i + 3]);
+        quads[i + 3] = _mm256_unpackhi_epi64(pairs[i + 1], pairs[i + 3]);
+    }
+
+    for (int i = 0; i < 4; i++) {
+        words[i]     = _mm256_shuffle_epi8(_mm256_permute2x128_si256(quads[i], quads[i + 4], 0x20), cByteSwap);
+        words[i + 4] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(quads[i], quads[i + 4], 0x31), cByteSwap);
+    }
+}
+
+// Compresses one block of each lane. State of inactive lanes is not changed.
+__attribute__((target("avx2"))) void CompressAVX2(
+    __m256i state[8], const uint8_t* const blocks[cNumLanes], const __m256i* activeLanes)
+{
+    __m256i w[16];
+
+    LoadTransposed(blocks, 0, w);
+    LoadTransposed(blocks, 32, w + 8);
+
+    auto a = state[0], b = state[1], c = state[2], d = state[3];
+    auto e = state[4], f = state[5], g = state[6], h = state[7];
+
+    for (int i = 0; i < 64; i++) {
+        auto& word = w[i % 16];
+
+        if (i >= 16) {
+            auto w15 = w[(i + 1) % 16];
+            auto w2  = w[(i + 14) % 16];
+            auto s0  = _mm256_xor_si256(_mm256_xor_si256(Rotr8<7>(w15), Rotr8<18>(w15)), _mm256_srli_epi32(w15, 3));
+            auto s1  = _mm256_xor_si256(_mm256_xor_si256(Rotr8<17>(w2), Rotr8<19>(w2)), _mm256_srli_epi32(w2, 10));
+
+            word = _mm256_add_epi32(_mm256_add_epi32(word, s0), _mm256_add_epi32(w[(i + 9) % 16], s1));
+        }
+
+        auto sum1 = _mm256_xor_si256(_mm256_xor_si256(Rotr8<6>(e), Rotr8<11>(e)), Rotr8<25>(e));
+        auto ch   = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+        auto t1   = _mm256_add_epi32(_mm256_add_epi32(h, sum1),
+              _mm256_add_epi32(_mm256_add_epi32(ch, _mm256_set1_epi32(static_cast<int>(cK[i]))), word));
+        auto sum0 = _mm256_xor_si256(_mm256_xor_si256(Rotr8<2>(a), Rotr8<13>(a)), Rotr8<22>(a));
+        auto maj  = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(c, _mm256_or_si256(a, b)));
+        auto t2   = _mm256_add_epi32(sum0, maj);
+
+        h = g;
+        g = f;
+        f = e;
+        e = _mm256_add_epi32(d, t1);
+        d = c;
+        c = b;
+        b = a;
+        a = _mm256_add_epi32(t1, t2);
+    }
+
+    const __m256i result[8] = {a, b, c, d, e, f, g, h};
+
+    for (int i = 0; i < 8; i++) {
+        state[i] = _mm256_blendv_epi8(state[i], _mm256_add_epi32(state[i], result[i]), *activeLanes);
+    }
+}
+
+__attribute__((target("avx2"))) void CalculateLanesAVX2(const Message* messages, size_t count, Digest* digests)
+{
+    static const uint8_t cIdleBlock[cBlockSize] = {};
+
+    uint8_t        tails[cNumLanes][2 * cBlockSize];
+    const uint8_t* data[cNumLanes];
+    size_t         numFullBlocks[cNumLanes] = {}, numBlocks[cNumLanes] = {}, maxBlocks = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        auto size     = messages[i].mSize;
+        auto tailSize = size % cBlockSize;
+
+        data[i]          = static_cast<const uint8_t*>(messages[i].mData);
+        numFullBlocks[i] = size / cBlockSize;
+        numBlocks[i]     = numFullBlocks[i] + Pad(data[i] + size - tailSize, tailSize, size, tails[i]);
+        maxBlocks        = std::max(maxBlocks, numBlocks[i]);
+    }
+
+    __m256i state[8];
+
+    for (int i = 0; i < 8; i++) {
+        state[i] = _mm256_set1_epi32(static_cast<int>(cInitState[i]));
+    }
+
+    // Lanes of shorter messages are masked out when their blocks are over.
+    for (size_t block = 0; block < maxBlocks; block++) {
+        const uint8_t* blocks[cNumLanes];
+        alignas(32) int32_t active[cNumLanes];
+
+        for (size_t i = 0; i < cNumLanes; i++) {
+            if (block < numFullBlocks[i]) {
+                blocks[i] = data[i] + block * cBlockSize;
+            } else if (block < numBlocks[i]) {
+                blocks[i] = tails[i] + (block - numFullBlocks[i]) * cBlockSize;
+            } else {
+                blocks[i] = cIdleBlock;
+            }
+
+            active[i] = block < numBlocks[i] ? -1 : 0;
+        }
+
+        auto activeLanes = _mm256_load_si256(reinterpret_cast<const __m256i*>(active));
+
+        CompressAVX2(state, blocks, &activeLanes);
+    }
+
+    alignas(32) uint32_t words[8][cNumLanes];
+
+    for (int i = 0; i < 8; i++) {
+        _mm256_store_si256(reinterpret_cast<__m256i*>(words[i]), state[i]);
+    }
+
+    for (size_t lane = 0; lane < count; lane++) {
+        for (int i = 0; i < 8; i++) {
+            StoreBE32(digests[lane].data() + i * 4, words[i][lane]);
+        }
+    }
+}
+
+#endif
+
+#ifdef SHA256_ARMV8
+
+/***********************************************************************************************************************
+ * ARMv8
+ **********************************************************************************************************************/
+
+__attribute__((target("+crypto"))) void CompressARMv8(uint32_t state[8], const uint8_t* data, size_t numBlocks)
+{
+    auto state0 = vld1q_u32(&state[0]);
+    auto state1 = vld1q_u32(&state[4]);
+
+    for (; numBlocks > 0; numBlocks--, data += cBlockSize) {
+        auto       save0 = state0;
+        auto       save1 = state1;
+        uint32x4_t msgs[4];
+
+        for (int i = 0; i < 4; i++) {
+            msgs[i] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + i * 16)));
+        }
+
+        // Each step does 4 rounds, message schedule keeps the next 16 words.
+        for (int i = 0; i < 16; i++) {
+            auto& msg   = msgs[i % 4];
+            auto  words = vaddq_u32(msg, vld1q_u32(&cK[i * 4]));
+            auto  prev  = state0;
+
+            if (i < 12) {
+                msg = vsha256su1q_u32(vsha256su0q_u32(msg, msgs[(i + 1) % 4]), msgs[(i + 2) % 4], msgs[(i + 3) % 4]);
+            }
+
+            state0 = vsha256hq_u32(state0, state1, words);
+            state1 = vsha256h2q_u32(state1, prev, words);
+        }
+
+        state0 = vaddq_u32(state0, save0);
+        state1 = vaddq_u32(state1, save1);
+    }
+
+    vst1q_u32(&state[0], state0);
+    vst1q_u32(&state[4], state1);
+}
+
+#endif
+
+void Compress(Impl impl, uint32_t state[8], const uint8_t* data, size_t numBlocks)
+{
+    switch (impl) {
+#ifdef SHA256_X86
+    case Impl::eSHANI:
+        CompressSHANI(state, data, numBlocks);
+
+        break;
+#endif
+
+#ifdef SHA256_ARMV8
+    case Impl::eARMv8:
+        CompressARMv8(state, data, numBlocks);
+
+        break;
+#endif
+
+    default:
+        CompressScalar(state, data, numBlocks);
+    }
+}
+
+Impl ResolveImpl(Impl impl, bool multi)
+{
+    if (impl == Impl::eAuto) {
+        return GetAutoImpl(multi);
+    }
+
+    return IsSupported(impl) ? impl : Impl::eScalar;
+}
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Public
+ **********************************************************************************************************************/
+
+bool IsSupported(Impl impl)
+{
+    switch (impl) {
+    case Impl::eAuto:
+    case Impl::eScalar:
+        return true;
+
+#ifdef SHA256_X86
+    case Impl::eSHANI:
+        return IsSHANISupported();
+
+    case Impl::eAVX2:
+        return __builtin_cpu_supports("avx2");
+#endif
+
+#ifdef SHA256_ARMV8
+    case Impl::eARMv8:
+        return getauxval(AT_HWCAP) & HWCAP_SHA2;
+#endif
+
+    default:
+        return false;
+    }
+}
+
+Impl GetAutoImpl(bool multi)
+{
+    static const Impl sImpl = [] {
+        for (auto impl : {Impl::eSHANI, Impl::eARMv8}) {
+            if (IsSupported(impl)) {
+                return impl;
+            }
+        }
+
+        return Impl::eScalar;
+    }();
+
+    static const Impl sMultiImpl = [] {
+        if (sImpl == Impl::eScalar && IsSupported(Impl::eAVX2)) {
+            return Impl::eAVX2;
+        }
+
+        return sImpl;
+    }();
+
+    return multi ? sMultiImpl : sImpl;
+}
+
+Hasher::Hasher(Impl impl)
+    : mImpl(ResolveImpl(impl, false))
+{
+    Reset();
+}
+
+void Hasher::Reset()
+{
+    memcpy(mState, cInitState, sizeof(mState));
+
+    mBufferSize = 0;
+    mSize       = 0;
+}
+
+void Hasher::Update(const void* data, size_t size)
+{
+    auto bytes = static_cast<const uint8_t*>(data);
+
+    mSize += size;
+
+    if (mBufferSize > 0) {
+        auto count = std::min(cBlockSize - mBufferSize, size);
+
+        memcpy(mBuffer + mBufferSize, bytes, count);
+
+        mBufferSize += count;
+        bytes += count;
+        size -= count;
+
+        if (mBufferSize < cBlockSize) {
+            return;
+        }
+
+        Compress(mImpl, mState, mBuffer, 1);
+
+        mBufferSize = 0;
+    }
+
+    // Full blocks are hashed straight from the input.
+    auto numBlocks = size / cBlockSize;
+
+    if (numBlocks > 0) {
+        Compress(mImpl, mState, bytes, numBlocks);
+
+        bytes += numBlocks * cBlockSize;
+        size -= numBlocks * cBlockSize;
+    }
+
+    if (size > 0) {
+        memcpy(mBuffer, bytes, size);
+    }
+
+    mBufferSize = size;
+}
+
+Digest Hasher::Finish()
+{
+    uint8_t blocks[2 * cBlockSize];
+    Digest  digest;
+
+    Compress(mImpl, mState, blocks, Pad(mBuffer, mBufferSize, mSize, blocks));
+
+    for (int i = 0; i < 8; i++) {
+        StoreBE32(digest.data() + i * 4, mState[i]);
+    }
+
+    return digest;
+}
+
+Digest Calculate(const void* data, size_t size, Impl impl)
+{
+    Hasher hasher(impl);
+
+    hasher.Update(data, size);
+
+    return hasher.Finish();
+}
+
+void CalculateMulti(const std::vector<Message>& messages, std::vector<Digest>& digests, Impl impl)
+{
+    auto resolved = ResolveImpl(impl, true);
+    auto pos      = size_t(0);
+
+    digests.resize(messages.size());
+
+#ifdef SHA256_X86
+    // Remaining single message is hashed faster by scalar code.
+    if (resolved == Impl::eAVX2) {
+        while (messages.size() - pos > 1) {
+            auto count = std::min(cNumLanes, messages.size() - pos);
+
+            CalculateLanesAVX2(&messages[pos], count, &digests[pos]);
+
+            pos += count;
+        }
+    }
+#endif
+
+    for (; pos < messages.size(); pos++) {
+        digests[pos] = Calculate(messages[pos].mData, messages[pos].mSize, resolved);
+    }
+}
+
+} // namespace sha256
+} // namespace aos
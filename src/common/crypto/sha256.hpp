@@ -0,0 +1,151 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SHA256_HPP_
+#define SHA256_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace aos {
+namespace sha256 {
+
+/**
+ * Digest size.
+ */
+constexpr size_t cDigestSize = 32;
+
+/**
+ * Block size.
+ */
+constexpr size_t cBlockSize = 64;
+
+/**
+ * Digest.
+ */
+using Digest = std::array<uint8_t, cDigestSize>;
+
+/**
+ * Hash implementation.
+ */
+enum class Impl {
+    eAuto,
+    eScalar,
+    eSHANI,
+    eARMv8,
+    eAVX2,
+};
+
+/**
+ * Message to hash with CalculateMulti().
+ */
+struct Message {
+    /**
+     * Message data.
+     */
+    const void* mData;
+
+    /**
+     * Message size.
+     */
+    size_t mSize;
+};
+
+/**
+ * Returns true if implementation is supported by the CPU.
+ *
+ * @param impl implementation.
+ * @return bool.
+ */
+bool IsSupported(Impl impl);
+
+/**
+ * Returns implementation selected for eAuto: SHA extensions if supported by the CPU, AVX2 multi-buffer for several
+ * messages, scalar otherwise.
+ *
+ * @param multi true to select implementation for several messages.
+ * @return Impl.
+ */
+Impl GetAutoImpl(bool multi = false);
+
+/**
+ * Incremental hasher for large data. AVX2 implementation hashes several messages at once only: single message is
+ * hashed with scalar code.
+ */
+class Hasher {
+public:
+    /**
+     * Creates hasher.
+     *
+     * @param impl implementation, unsupported implementation falls back to scalar one.
+     */
+    explicit Hasher(Impl impl = Impl::eAuto);
+
+    /**
+     * Starts new message.
+     */
+    void Reset();
+
+    /**
+     * Hashes data.
+     *
+     * @param data data.
+     * @param size data size.
+     */
+    void Update(const void* data, size_t size);
+
+    /**
+     * Finishes message. The hasher must be reset before the next message.
+     *
+     * @return Digest.
+     */
+    Digest Finish();
+
+private:
+    Impl     mImpl;
+    uint32_t mState[8];
+    uint8_t  mBuffer[cBlockSize];
+    size_t   mBufferSize = 0;
+    uint64_t mSize       = 0;
+};
+
+/**
+ * Calculates digest of data.
+ *
+ * @param data data.
+ * @param size data size.
+ * @param impl implementation, unsupported implementation falls back to scalar one.
+ * @return Digest.
+ */
+Digest Calculate(const void* data, size_t size, Impl impl = Impl::eAuto);
+
+/**
+ * Calculates digests of several messages. AVX2 implementation hashes 8 messages at once, which pays off for messages
+ * of similar size such as certificate chains.
+ *
+ * @param messages messages.
+ * @param[out] digests digests in the order of messages.
+ * @param impl implementation, unsupported implementation falls back to scalar one.
+ */
+void CalculateMulti(const std::vector<Message>& messages, std::vector<Digest>& digests, Impl impl = Impl::eAuto);
+
+} // namespace sha256
+} // namespace aos
+
+#endif
@@ -0,0 +1,112 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <random>
+
+#include <benchmark/benchmark.h>
+
+#include "sha256.hpp"
+
+using namespace aos;
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+namespace {
+
+constexpr size_t cCertSize = 1024;
+
+std::vector<uint8_t> GenerateData(size_t size)
+{
+    std::mt19937                            rng(size);
+    std::uniform_int_distribution<uint16_t> byte(0, 255);
+    std::vector<uint8_t>                    data(size);
+
+    for (auto& value : data) {
+        value = static_cast<uint8_t>(byte(rng));
+    }
+
+    return data;
+}
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Benchmarks
+ **********************************************************************************************************************/
+
+static void Calculate(benchmark::State& state, sha256::Impl impl)
+{
+    if (!sha256::IsSupported(impl)) {
+        state.SkipWithError("not supported");
+
+        return;
+    }
+
+    auto data = GenerateData(state.range(0));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(sha256::Calculate(data.data(), data.size(), impl));
+    }
+
+    state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+// Chain of state.range(0) certificate sized messages.
+static void CalculateMulti(benchmark::State& state, sha256::Impl impl)
+{
+    if (!sha256::IsSupported(impl)) {
+        state.SkipWithError("not supported");
+
+        return;
+    }
+
+    std::vector<std::vector<uint8_t>> certs;
+    std::vector<sha256::Message>      messages;
+    std::vector<sha256::Digest>       digests;
+
+    for (int64_t i = 0; i < state.range(0); i++) {
+        certs.push_back(GenerateData(cCertSize + i * 16));
+    }
+
+    for (const auto& cert : certs) {
+        messages.push_back({cert.data(), cert.size()});
+    }
+
+    for (auto _ : state) {
+        sha256::CalculateMulti(messages, digests, impl);
+
+        benchmark::DoNotOptimize(digests.data());
+    }
+
+    size_t size = 0;
+
+    for (const auto& message : messages) {
+        size += message.mSize;
+    }
+
+    state.SetBytesProcessed(state.iterations() * size);
+}
+
+BENCHMARK_CAPTURE(Calculate, Scalar, sha256::Impl::eScalar)->Arg(1 << 10)->Arg(1 << 20);
+BENCHMARK_CAPTURE(Calculate, SHANI, sha256::Impl::eSHANI)->Arg(1 << 10)->Arg(1 << 20);
+BENCHMARK_CAPTURE(Calculate, ARMv8, sha256::Impl::eARMv8)->Arg(1 << 10)->Arg(1 << 20);
+BENCHMARK_CAPTURE(CalculateMulti, Scalar, sha256::Impl::eScalar)->Arg(4)->Arg(8)->Arg(64);
+BENCHMARK_CAPTURE(CalculateMulti, SHANI, sha256::Impl::eSHANI)->Arg(4)->Arg(8)->Arg(64);
+BENCHMARK_CAPTURE(CalculateMulti, ARMv8, sha256::Impl::eARMv8)->Arg(4)->Arg(8)->Arg(64);
+BENCHMARK_CAPTURE(CalculateMulti, AVX2, sha256::Impl::eAVX2)->Arg(4)->Arg(8)->Arg(64);
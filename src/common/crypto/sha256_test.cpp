@@ -0,0 +1,178 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "sha256.hpp"
+
+using namespace aos;
+
+/***********************************************************************************************************************
+ * Utils
+ **********************************************************************************************************************/
+
+static std::vector<sha256::Impl> GetImpls()
+{
+    std::vector<sha256::Impl> impls;
+
+    for (auto impl : {sha256::Impl::eScalar, sha256::Impl::eSHANI, sha256::Impl::eARMv8, sha256::Impl::eAVX2}) {
+        if (sha256::IsSupported(impl)) {
+            impls.push_back(impl);
+        }
+    }
+
+    return impls;
+}
+
+static std::string ToHex(const sha256::Digest& digest)
+{
+    static const char cHex[] = "0123456789abcdef";
+
+    std::string result;
+
+    for (auto value : digest) {
+        result += cHex[value >> 4];
+        result += cHex[value & 0xf];
+    }
+
+    return result;
+}
+
+static std::vector<uint8_t> GenerateData(std::mt19937& rng, size_t size)
+{
+    std::uniform_int_distribution<uint16_t> byte(0, 255);
+    std::vector<uint8_t>                    data(size);
+
+    for (auto& value : data) {
+        value = static_cast<uint8_t>(byte(rng));
+    }
+
+    return data;
+}
+
+/***********************************************************************************************************************
+ * Tests
+ **********************************************************************************************************************/
+
+TEST(sha256, Vectors)
+{
+    // FIPS 180-4 examples.
+    const std::pair<std::string, std::string> vectors[] = {
+        {"", "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"},
+        {"abc", "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"},
+        {"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+            "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"},
+        {std::string(1000000, 'a'), "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0"},
+    };
+
+    for (auto impl : GetImpls()) {
+        for (const auto& vector : vectors) {
+            EXPECT_EQ(ToHex(sha256::Calculate(vector.first.data(), vector.first.size(), impl)), vector.second);
+        }
+    }
+}
+
+TEST(sha256, Implementations)
+{
+    std::mt19937 rng(1);
+
+    // Cover all padding cases: tail fits in the last block or takes an extra one.
+    for (size_t size = 0; size <= 300; size++) {
+        auto data     = GenerateData(rng, size);
+        auto expected = sha256::Calculate(data.data(), data.size(), sha256::Impl::eScalar);
+
+        for (auto impl : GetImpls()) {
+            ASSERT_EQ(sha256::Calculate(data.data(), data.size(), impl), expected) << "size: " << size;
+        }
+    }
+}
+
+TEST(sha256, Hasher)
+{
+    std::mt19937                          rng(2);
+    std::uniform_int_distribution<size_t> chunkSize(0, 150);
+    auto                                  data     = GenerateData(rng, 4096);
+    auto                                  expected = sha256::Calculate(data.data(), data.size(), sha256::Impl::eScalar);
+
+    for (auto impl : GetImpls()) {
+        sha256::Hasher hasher(impl);
+
+        // Hasher is reusable after reset.
+        for (int i = 0; i < 3; i++) {
+            hasher.Reset();
+
+            for (size_t pos = 0; pos < data.size();) {
+                auto size = std::min(chunkSize(rng), data.size() - pos);
+
+                hasher.Update(data.data() + pos, size);
+                pos += size;
+            }
+
+            EXPECT_EQ(hasher.Finish(), expected);
+        }
+    }
+}
+
+TEST(sha256, CalculateMulti)
+{
+    std::mt19937                          rng(3);
+    std::uniform_int_distribution<size_t> messageSize(0, 2000);
+
+    // Partially filled lane groups and messages of different number of blocks.
+    for (size_t count : {0, 1, 2, 7, 8, 9, 17, 30}) {
+        std::vector<std::vector<uint8_t>> data;
+        std::vector<sha256::Message>      messages;
+
+        for (size_t i = 0; i < count; i++) {
+            data.push_back(GenerateData(rng, messageSize(rng)));
+        }
+
+        for (const auto& item : data) {
+            messages.push_back({item.data(), item.size()});
+        }
+
+        for (auto impl : GetImpls()) {
+            std::vector<sha256::Digest> digests;
+
+            sha256::CalculateMulti(messages, digests, impl);
+
+            ASSERT_EQ(digests.size(), count);
+
+            for (size_t i = 0; i < count; i++) {
+                EXPECT_EQ(digests[i], sha256::Calculate(data[i].data(), data[i].size(), sha256::Impl::eScalar))
+                    << "count: " << count << ", message: " << i;
+            }
+        }
+    }
+}
+
+TEST(sha256, Unsupported)
+{
+    auto expected = sha256::Calculate("abc", 3, sha256::Impl::eScalar);
+
+    // Unsupported implementation falls back to scalar one.
+    for (auto impl : {sha256::Impl::eSHANI, sha256::Impl::eARMv8, sha256::Impl::eAVX2}) {
+        EXPECT_EQ(sha256::Calculate("abc", 3, impl), expected);
+    }
+
+    EXPECT_TRUE(sha256::IsSupported(sha256::GetAutoImpl()));
+    EXPECT_TRUE(sha256::IsSupported(sha256::GetAutoImpl(true)));
+}
@@ -0,0 +1,552 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstring>
+#include <initializer_list>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define BASE64_X86
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define BASE64_NEON
+#include <arm_neon.h>
+#endif
+
+#include "base64.hpp"
+
+namespace aos {
+namespace base64 {
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+namespace {
+
+constexpr uint8_t cInvalid = 0xff;
+
+const char cEncodeTable[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+struct DecodeTable {
+    uint8_t mValues[256];
+};
+
+constexpr DecodeTable MakeDecodeTable()
+{
+    DecodeTable table {};
+
+    for (auto& value : table.mValues) {
+        value = cInvalid;
+    }
+
+    for (uint8_t i = 0; i < 26; i++) {
+        table.mValues['A' + i] = i;
+        table.mValues['a' + i] = 26 + i;
+    }
+
+    for (uint8_t i = 0; i < 10; i++) {
+        table.mValues['0' + i] = 52 + i;
+    }
+
+    table.mValues['+'] = 62;
+    table.mValues['/'] = 63;
+
+    return table;
+}
+
+constexpr DecodeTable cDecodeTable = MakeDecodeTable();
+
+/***********************************************************************************************************************
+ * Scalar
+ **********************************************************************************************************************/
+
+size_t EncodeScalar(const uint8_t* src, size_t size, char* dst)
+{
+    auto out = dst;
+
+    for (; size >= 3; size -= 3, src += 3) {
+        uint32_t value = (src[0] << 16) | (src[1] << 8) | src[2];
+
+        *out++ = cEncodeTable[(value >> 18) & 0x3f];
+        *out++ = cEncodeTable[(value >> 12) & 0x3f];
+        *out++ = cEncodeTable[(value >> 6) & 0x3f];
+        *out++ = cEncodeTable[value & 0x3f];
+    }
+
+    if (size > 0) {
+        uint32_t value = (src[0] << 16) | (size > 1 ? src[1] << 8 : 0);
+
+        *out++ = cEncodeTable[(value >> 18) & 0x3f];
+        *out++ = cEncodeTable[(value >> 12) & 0x3f];
+        *out++ = size > 1 ? cEncodeTable[(value >> 6) & 0x3f] : '=';
+        *out++ = '=';
+    }
+
+    return out - dst;
+}
+
+Error DecodeScalar(const char* src, size_t size, uint8_t* dst, size_t& decodedSize)
+{
+    auto input = reinterpret_cast<const uint8_t*>(src);
+    auto out   = dst;
+
+    for (size_t i = 0; i < size; i += 4) {
+        auto isLast = i + 4 == size;
+        auto a      = cDecodeTable.mValues[input[i]];
+        auto b      = cDecodeTable.mValues[input[i + 1]];
+        auto c      = cDecodeTable.mValues[input[i + 2]];
+        auto d      = cDecodeTable.mValues[input[i + 3]];
+
+        if (a == cInvalid || b == cInvalid) {
+            return Error::eInvalidArgument;
+        }
+
+        *out++ = static_cast<uint8_t>((a << 2) | (b >> 4));
+
+        if (c == cInvalid || d == cInvalid) {
+            // Padding is allowed only at the end: "xx==" or "xxx=".
+            if (!isLast || input[i + 3] != '=' || (c == cInvalid && input[i + 2] != '=')) {
+                return Error::eInvalidArgument;
+            }
+
+            if (c != cInvalid) {
+                *out++ = static_cast<uint8_t>((b << 4) | (c >> 2));
+            }
+
+            break;
+        }
+
+        *out++ = static_cast<uint8_t>((b << 4) | (c >> 2));
+        *out++ = static_cast<uint8_t>((c << 6) | d);
+    }
+
+    decodedSize = out - dst;
+
+    return Error::eNone;
+}
+
+#ifdef BASE64_X86
+
+/***********************************************************************************************************************
+ * SSSE3
+ **********************************************************************************************************************/
+
+// Unpacks 12 bytes into 16 6-bit indices, one per byte.
+__attribute__((target("ssse3"))) inline __m128i UnpackSSSE3(__m128i input)
+{
+    input = _mm_shuffle_epi8(input, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+
+    auto t0 = _mm_and_si128(input, _mm_set1_epi32(0x0fc0fc00));
+    auto t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+    auto t2 = _mm_and_si128(input, _mm_set1_epi32(0x003f03f0));
+    auto t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+
+    return _mm_or_si128(t1, t3);
+}
+
+// Translates 6-bit indices to ASCII: selects per range offset with a single shuffle.
+__attribute__((target("ssse3"))) inline __m128i TranslateSSSE3(__m128i indices)
+{
+    const auto cShiftLUT = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+
+    auto result = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+    auto less   = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+
+    result = _mm_or_si128(result, _mm_and_si128(less, _mm_set1_epi8(13)));
+
+    return _mm_add_epi8(_mm_shuffle_epi8(cShiftLUT, result), indices);
+}
+
+// Converts ASCII to 6-bit values. Returns false if any byte is not a base64 alphabet character. Validation and
+// translation are done with lookups by high and low nibbles.
+__attribute__((target("ssse3"))) inline bool LookupSSSE3(__m128i input, __m128i& values)
+{
+    const auto cLowLUT  = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1a, 0x1b,
+        0x1b, 0x1b, 0x1a);
+    const auto cHighLUT = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10,
+        0x10, 0x10, 0x10);
+    const auto cRollLUT = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+
+    auto high = _mm_and_si128(_mm_srli_epi32(input, 4), _mm_set1_epi8(0x0f));
+    auto low  = _mm_and_si128(input, _mm_set1_epi8(0x0f));
+
+    auto invalid = _mm_and_si128(_mm_shuffle_epi8(cLowLUT, low), _mm_shuffle_epi8(cHighLUT, high));
+
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(invalid, _mm_setzero_si128())) != 0xffff) {
+        return false;
+    }
+
+    // '/' shares high nibble with '+', it is told apart by the equality mask added to the roll index.
+    auto roll = _mm_shuffle_epi8(cRollLUT, _mm_add_epi8(_mm_cmpeq_epi8(input, _mm_set1_epi8('/')), high));
+
+    values = _mm_add_epi8(input, roll);
+
+    return true;
+}
+
+// Packs 16 6-bit values into 12 bytes placed at the beginning of the result.
+__attribute__((target("ssse3"))) inline __m128i PackSSSE3(__m128i values)
+{
+    auto merged = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+    auto packed = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+
+    return _mm_shuffle_epi8(packed, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+}
+
+__attribute__((target("ssse3"))) size_t EncodeBlocksSSSE3(const uint8_t* src, size_t size, char* dst)
+{
+    size_t pos = 0;
+
+    // Each block loads 16 bytes and consumes 12 of them.
+    for (; pos + 16 <= size; pos += 12, dst += 16) {
+        auto input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + pos));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), TranslateSSSE3(UnpackSSSE3(input)));
+    }
+
+    return pos;
+}
+
+__attribute__((target("ssse3"))) size_t DecodeBlocksSSSE3(const char* src, size_t size, uint8_t* dst)
+{
+    size_t pos = 0;
+
+    for (; pos + 16 <= size; pos += 16, dst += 12) {
+        __m128i values;
+
+        if (!LookupSSSE3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + pos)), values)) {
+            break;
+        }
+
+        auto     packed = PackSSSE3(values);
+        uint32_t tail   = _mm_cvtsi128_si32(_mm_srli_si128(packed, 8));
+
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst), packed);
+        memcpy(dst + 8, &tail, sizeof(tail));
+    }
+
+    return pos;
+}
+
+/***********************************************************************************************************************
+ * AVX2
+ **********************************************************************************************************************/
+
+__attribute__((target("avx2"))) size_t EncodeBlocksAVX2(const uint8_t* src, size_t size, char* dst)
+{
+    const auto cShuffle = _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10, 5, 4, 6, 5, 8, 7, 9, 8,
+        11, 10, 12, 11, 14, 13, 15, 14);
+    const auto cShiftLUT
+        = _mm256_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+            '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0, 'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+            '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+
+    size_t pos = 0;
+
+    // Low lane gets bytes 0..11 from the first load, high lane gets bytes 12..23 from the second load at offset 8, so
+    // exactly 24 bytes are read.
+    for (; pos + 24 <= size; pos += 24, dst += 32) {
+        auto input = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + pos))),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + pos + 8)), 1);
+
+        input = _mm256_shuffle_epi8(input, cShuffle);
+
+        auto t0 = _mm256_and_si256(input, _mm256_set1_epi32(0x0fc0fc00));
+        auto t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+        auto t2 = _mm256_and_si256(input, _mm256_set1_epi32(0x003f03f0));
+        auto t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+
+        auto indices = _mm256_or_si256(t1, t3);
+        auto result  = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+        auto less    = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+
+        result = _mm256_or_si256(result, _mm256_and_si256(less, _mm256_set1_epi8(13)));
+        result = _mm256_add_epi8(_mm256_shuffle_epi8(cShiftLUT, result), indices);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), result);
+    }
+
+    return pos;
+}
+
+__attribute__((target("avx2"))) size_t DecodeBlocksAVX2(const char* src, size_t size, uint8_t* dst)
+{
+    const auto cPackShuffle = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1, 2, 1, 0, 6, 5,
+        4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    const auto cPermute     = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+    const auto cLowLUT = _mm256_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1a, 0x1b,
+        0x1b, 0x1b, 0x1a, 0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b,
+        0x1a);
+    const auto cHighLUT = _mm256_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10,
+        0x10, 0x10, 0x10, 0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+        0x10);
+    const auto cRollLUT = _mm256_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0, 0, 16, 19, 4, -65,
+        -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+
+    size_t pos = 0;
+
+    for (; pos + 32 <= size; pos += 32, dst += 24) {
+        auto input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + pos));
+
+        auto high = _mm256_and_si256(_mm256_srli_epi32(input, 4), _mm256_set1_epi8(0x0f));
+        auto low  = _mm256_and_si256(input, _mm256_set1_epi8(0x0f));
+
+        auto invalid = _mm256_and_si256(_mm256_shuffle_epi8(cLowLUT, low), _mm256_shuffle_epi8(cHighLUT, high));
+
+        if (!_mm256_testz_si256(invalid, invalid)) {
+            break;
+        }
+
+        auto slash  = _mm256_cmpeq_epi8(input, _mm256_set1_epi8('/'));
+        auto values = _mm256_add_epi8(input, _mm256_shuffle_epi8(cRollLUT, _mm256_add_epi8(slash, high)));
+        auto merged = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+        auto packed = _mm256_madd_epi16(merged, _mm256_set1_epi32(0x00011000));
+
+        // 12 bytes at the beginning of each lane, then move them together.
+        packed = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(packed, cPackShuffle), cPermute);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm256_castsi256_si128(packed));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + 16), _mm256_extracti128_si256(packed, 1));
+    }
+
+    return pos;
+}
+
+#endif
+
+#ifdef BASE64_NEON
+
+/***********************************************************************************************************************
+ * NEON
+ **********************************************************************************************************************/
+
+size_t EncodeBlocksNEON(const uint8_t* src, size_t size, char* dst)
+{
+    const uint8x16x4_t cTable = vld1q_u8_x4(reinterpret_cast<const uint8_t*>(cEncodeTable));
+
+    size_t pos = 0;
+
+    for (; pos + 48 <= size; pos += 48, dst += 64) {
+        auto         input = vld3q_u8(src + pos);
+        uint8x16x4_t indices;
+
+        indices.val[0] = vshrq_n_u8(input.val[0], 2);
+        indices.val[1] = vandq_u8(vorrq_u8(vshlq_n_u8(input.val[0], 4), vshrq_n_u8(input.val[1], 4)), vdupq_n_u8(0x3f));
+        indices.val[2] = vandq_u8(vorrq_u8(vshlq_n_u8(input.val[1], 2), vshrq_n_u8(input.val[2], 6)), vdupq_n_u8(0x3f));
+        indices.val[3] = vandq_u8(input.val[2], vdupq_n_u8(0x3f));
+
+        uint8x16x4_t output;
+
+        for (int i = 0; i < 4; i++) {
+            output.val[i] = vqtbl4q_u8(cTable, indices.val[i]);
+        }
+
+        vst4q_u8(reinterpret_cast<uint8_t*>(dst), output);
+    }
+
+    return pos;
+}
+
+inline uint8x16_t InRangeNEON(uint8x16_t input, uint8_t low, uint8_t high)
+{
+    return vandq_u8(vcgeq_u8(input, vdupq_n_u8(low)), vcleq_u8(input, vdupq_n_u8(high)));
+}
+
+inline bool LookupNEON(uint8x16_t input, uint8x16_t& values)
+{
+    auto upper = InRangeNEON(input, 'A', 'Z');
+    auto lower = InRangeNEON(input, 'a', 'z');
+    auto digit = InRangeNEON(input, '0', '9');
+    auto plus  = vceqq_u8(input, vdupq_n_u8('+'));
+    auto slash = vceqq_u8(input, vdupq_n_u8('/'));
+
+    auto valid = vorrq_u8(vorrq_u8(upper, lower), vorrq_u8(vorrq_u8(digit, plus), slash));
+
+    if (vminvq_u8(valid) == 0) {
+        return false;
+    }
+
+    auto letters = vorrq_u8(vandq_u8(upper, vdupq_n_u8(static_cast<uint8_t>(-65))),
+        vandq_u8(lower, vdupq_n_u8(static_cast<uint8_t>(-71))));
+    auto symbols = vorrq_u8(vandq_u8(plus, vdupq_n_u8(19)), vandq_u8(slash, vdupq_n_u8(16)));
+    auto shift   = vorrq_u8(letters, vorrq_u8(vandq_u8(digit, vdupq_n_u8(4)), symbols));
+
+    values = vaddq_u8(input, shift);
+
+    return true;
+}
+
+size_t DecodeBlocksNEON(const char* src, size_t size, uint8_t* dst)
+{
+    size_t pos = 0;
+
+    for (; pos + 64 <= size; pos += 64, dst += 48) {
+        auto         input = vld4q_u8(reinterpret_cast<const uint8_t*>(src + pos));
+        uint8x16x4_t values;
+        uint8x16x3_t output;
+
+        if (!LookupNEON(input.val[0], values.val[0]) || !LookupNEON(input.val[1], values.val[1])
+            || !LookupNEON(input.val[2], values.val[2]) || !LookupNEON(input.val[3], values.val[3])) {
+            break;
+        }
+
+        output.val[0] = vorrq_u8(vshlq_n_u8(values.val[0], 2), vshrq_n_u8(values.val[1], 4));
+        output.val[1] = vorrq_u8(vshlq_n_u8(values.val[1], 4), vshrq_n_u8(values.val[2], 2));
+        output.val[2] = vorrq_u8(vshlq_n_u8(values.val[2], 6), values.val[3]);
+
+        vst3q_u8(dst, output);
+    }
+
+    return pos;
+}
+
+#endif
+
+Impl ResolveImpl(Impl impl)
+{
+    if (impl == Impl::eAuto) {
+        return GetAutoImpl();
+    }
+
+    return IsSupported(impl) ? impl : Impl::eScalar;
+}
+
+size_t EncodeBlocks(const uint8_t* src, size_t size, char* dst, Impl impl)
+{
+    switch (impl) {
+#ifdef BASE64_X86
+    case Impl::eAVX2: {
+        auto pos = EncodeBlocksAVX2(src, size, dst);
+
+        return pos + EncodeBlocksSSSE3(src + pos, size - pos, dst + pos / 3 * 4);
+    }
+
+    case Impl::eSSSE3:
+        return EncodeBlocksSSSE3(src, size, dst);
+#endif
+
+#ifdef BASE64_NEON
+    case Impl::eNEON:
+        return EncodeBlocksNEON(src, size, dst);
+#endif
+
+    default:
+        return 0;
+    }
+}
+
+size_t DecodeBlocks(const char* src, size_t size, uint8_t* dst, Impl impl)
+{
+    switch (impl) {
+#ifdef BASE64_X86
+    case Impl::eAVX2:
+        return DecodeBlocksAVX2(src, size, dst);
+
+    case Impl::eSSSE3:
+        return DecodeBlocksSSSE3(src, size, dst);
+#endif
+
+#ifdef BASE64_NEON
+    case Impl::eNEON:
+        return DecodeBlocksNEON(src, size, dst);
+#endif
+
+    default:
+        return 0;
+    }
+}
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Public
+ **********************************************************************************************************************/
+
+bool IsSupported(Impl impl)
+{
+    switch (impl) {
+    case Impl::eAuto:
+    case Impl::eScalar:
+        return true;
+
+#ifdef BASE64_X86
+    case Impl::eSSSE3:
+        return __builtin_cpu_supports("ssse3");
+
+    case Impl::eAVX2:
+        return __builtin_cpu_supports("avx2");
+#endif
+
+#ifdef BASE64_NEON
+    // NEON is mandatory on AArch64.
+    case Impl::eNEON:
+        return true;
+#endif
+
+    default:
+        return false;
+    }
+}
+
+Impl GetAutoImpl()
+{
+    static const Impl sImpl = [] {
+        for (auto impl : {Impl::eAVX2, Impl::eSSSE3, Impl::eNEON}) {
+            if (IsSupported(impl)) {
+                return impl;
+            }
+        }
+
+        return Impl::eScalar;
+    }();
+
+    return sImpl;
+}
+
+size_t Encode(const uint8_t* src, size_t size, char* dst, Impl impl)
+{
+    auto pos     = EncodeBlocks(src, size, dst, ResolveImpl(impl));
+    auto written = pos / 3 * 4;
+
+    return written + EncodeScalar(src + pos, size - pos, dst + written);
+}
+
+Error Decode(const char* src, size_t size, uint8_t* dst, size_t& decodedSize, Impl impl)
+{
+    if (size % 4 != 0) {
+        return Error::eInvalidArgument;
+    }
+
+    // Vector code stops at the first block with padding or invalid characters, the rest is validated by scalar code.
+    auto   pos     = DecodeBlocks(src, size, dst, ResolveImpl(impl));
+    auto   written = pos / 4 * 3;
+    size_t tail    = 0;
+
+    auto err = DecodeScalar(src + pos, size - pos, dst + written, tail);
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    decodedSize = written + tail;
+
+    return Error::eNone;
+}
+
+} // namespace base64
+} // namespace aos
@@ -0,0 +1,103 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef BASE64_HPP_
+#define BASE64_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "error/error.hpp"
+
+namespace aos {
+namespace base64 {
+
+/**
+ * Codec implementation.
+ */
+enum class Impl {
+    eAuto,
+    eScalar,
+    eSSSE3,
+    eAVX2,
+    eNEON,
+};
+
+/**
+ * Returns true if implementation is supported by the CPU.
+ *
+ * @param impl implementation.
+ * @return bool.
+ */
+bool IsSupported(Impl impl);
+
+/**
+ * Returns implementation selected for eAuto: the fastest one supported by the CPU.
+ *
+ * @return Impl.
+ */
+Impl GetAutoImpl();
+
+/**
+ * Returns encoded size.
+ *
+ * @param size data size.
+ * @return size_t.
+ */
+constexpr size_t GetEncodedSize(size_t size)
+{
+    return (size + 2) / 3 * 4;
+}
+
+/**
+ * Returns max decoded size.
+ *
+ * @param size encoded size.
+ * @return size_t.
+ */
+constexpr size_t GetMaxDecodedSize(size_t size)
+{
+    return size / 4 * 3;
+}
+
+/**
+ * Encodes data with padding.
+ *
+ * @param src data.
+ * @param size data size.
+ * @param[out] dst encoded data, GetEncodedSize(size) bytes.
+ * @param impl implementation, must be supported.
+ * @return size_t encoded size.
+ */
+size_t Encode(const uint8_t* src, size_t size, char* dst, Impl impl = Impl::eAuto);
+
+/**
+ * Decodes padded data. Whitespaces are not allowed.
+ *
+ * @param src encoded data.
+ * @param size encoded data size, multiple of 4.
+ * @param[out] dst decoded data, GetMaxDecodedSize(size) bytes.
+ * @param[out] decodedSize decoded data size.
+ * @param impl implementation, must be supported.
+ * @return Error.
+ */
+Error Decode(const char* src, size_t size, uint8_t* dst, size_t& decodedSize, Impl impl = Impl::eAuto);
+
+} // namespace base64
+} // namespace aos
+
+#endif
@@ -0,0 +1,151 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <random>
+
+#include <benchmark/benchmark.h>
+
+#include "base64.hpp"
+#include "pem.hpp"
+
+using namespace aos;
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+namespace {
+
+constexpr size_t cCertSize = 1024;
+
+std::vector<uint8_t> GenerateData(size_t size)
+{
+    std::mt19937                            rng(size);
+    std::uniform_int_distribution<uint16_t> byte(0, 255);
+    std::vector<uint8_t>                    data(size);
+
+    for (auto& value : data) {
+        value = static_cast<uint8_t>(byte(rng));
+    }
+
+    return data;
+}
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Benchmarks
+ **********************************************************************************************************************/
+
+static void Encode(benchmark::State& state, base64::Impl impl)
+{
+    if (!base64::IsSupported(impl)) {
+        state.SkipWithError("not supported");
+
+        return;
+    }
+
+    auto        data = GenerateData(state.range(0));
+    std::string encoded(base64::GetEncodedSize(data.size()), '\0');
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(base64::Encode(data.data(), data.size(), &encoded[0], impl));
+    }
+
+    state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+static void Decode(benchmark::State& state, base64::Impl impl)
+{
+    if (!base64::IsSupported(impl)) {
+        state.SkipWithError("not supported");
+
+        return;
+    }
+
+    auto        data = GenerateData(state.range(0));
+    std::string encoded(base64::GetEncodedSize(data.size()), '\0');
+
+    base64::Encode(data.data(), data.size(), &encoded[0], base64::Impl::eScalar);
+
+    for (auto _ : state) {
+        size_t size = 0;
+
+        if (base64::Decode(encoded.data(), encoded.size(), data.data(), size, impl) != Error::eNone) {
+            state.SkipWithError("decode failed");
+        }
+
+        benchmark::DoNotOptimize(size);
+    }
+
+    state.SetBytesProcessed(state.iterations() * encoded.size());
+}
+
+// Trust bundle of state.range(0) certificate sized blocks.
+static void DecodeBundle(benchmark::State& state)
+{
+    std::string bundle;
+
+    for (int64_t i = 0; i < state.range(0); i++) {
+        pem::Encode(pem::cCertificate, GenerateData(cCertSize + i), bundle);
+    }
+
+    for (auto _ : state) {
+        pem::Reader          reader(bundle);
+        std::string          label;
+        std::vector<uint8_t> der;
+
+        while (reader.Next(label, der) == Error::eNone) {
+            benchmark::DoNotOptimize(der.data());
+        }
+    }
+
+    state.SetBytesProcessed(state.iterations() * bundle.size());
+}
+
+static void EncodeBundle(benchmark::State& state)
+{
+    std::vector<std::vector<uint8_t>> certs;
+
+    for (int64_t i = 0; i < state.range(0); i++) {
+        certs.push_back(GenerateData(cCertSize + i));
+    }
+
+    for (auto _ : state) {
+        std::string bundle;
+
+        for (const auto& cert : certs) {
+            pem::Encode(pem::cCertificate, cert, bundle);
+        }
+
+        benchmark::DoNotOptimize(bundle.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * certs.size() * cCertSize);
+}
+
+BENCHMARK_CAPTURE(Encode, Scalar, base64::Impl::eScalar)->Arg(1 << 10)->Arg(1 << 20);
+BENCHMARK_CAPTURE(Encode, SSSE3, base64::Impl::eSSSE3)->Arg(1 << 10)->Arg(1 << 20);
+BENCHMARK_CAPTURE(Encode, AVX2, base64::Impl::eAVX2)->Arg(1 << 10)->Arg(1 << 20);
+BENCHMARK_CAPTURE(Encode, NEON, base64::Impl::eNEON)->Arg(1 << 10)->Arg(1 << 20);
+BENCHMARK_CAPTURE(Decode, Scalar, base64::Impl::eScalar)->Arg(1 << 10)->Arg(1 << 20);
+BENCHMARK_CAPTURE(Decode, SSSE3, base64::Impl::eSSSE3)->Arg(1 << 10)->Arg(1 << 20);
+BENCHMARK_CAPTURE(Decode, AVX2, base64::Impl::eAVX2)->Arg(1 << 10)->Arg(1 << 20);
+BENCHMARK_CAPTURE(Decode, NEON, base64::Impl::eNEON)->Arg(1 << 10)->Arg(1 << 20);
+BENCHMARK(DecodeBundle)->Arg(1)->Arg(200);
+BENCHMARK(EncodeBundle)->Arg(1)->Arg(200);
@@ -0,0 +1,156 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "base64.hpp"
+
+using namespace aos;
+
+/***********************************************************************************************************************
+ * Utils
+ **********************************************************************************************************************/
+
+static std::vector<base64::Impl> GetImpls()
+{
+    std::vector<base64::Impl> impls;
+
+    for (auto impl : {base64::Impl::eScalar, base64::Impl::eSSSE3, base64::Impl::eAVX2, base64::Impl::eNEON}) {
+        if (base64::IsSupported(impl)) {
+            impls.push_back(impl);
+        }
+    }
+
+    return impls;
+}
+
+static std::string Encode(const std::vector<uint8_t>& data, base64::Impl impl)
+{
+    std::string result(base64::GetEncodedSize(data.size()), '\0');
+
+    result.resize(base64::Encode(data.data(), data.size(), &result[0], impl));
+
+    return result;
+}
+
+static Error Decode(const std::string& str, std::vector<uint8_t>& data, base64::Impl impl)
+{
+    size_t size = 0;
+
+    data.resize(base64::GetMaxDecodedSize(str.size()));
+
+    auto err = base64::Decode(str.data(), str.size(), data.data(), size, impl);
+
+    data.resize(size);
+
+    return err;
+}
+
+/***********************************************************************************************************************
+ * Tests
+ **********************************************************************************************************************/
+
+TEST(base64, Vectors)
+{
+    // RFC 4648 test vectors.
+    const std::pair<std::string, std::string> vectors[] = {
+        {"", ""},
+        {"f", "Zg=="},
+        {"fo", "Zm8="},
+        {"foo", "Zm9v"},
+        {"foob", "Zm9vYg=="},
+        {"fooba", "Zm9vYmE="},
+        {"foobar", "Zm9vYmFy"},
+    };
+
+    for (auto impl : GetImpls()) {
+        for (const auto& vector : vectors) {
+            std::vector<uint8_t> decoded;
+
+            EXPECT_EQ(Encode(std::vector<uint8_t>(vector.first.begin(), vector.first.end()), impl), vector.second);
+            EXPECT_EQ(Decode(vector.second, decoded, impl), Error::eNone);
+            EXPECT_EQ(std::string(decoded.begin(), decoded.end()), vector.first);
+        }
+    }
+}
+
+TEST(base64, RoundTrip)
+{
+    std::mt19937                            rng(1);
+    std::uniform_int_distribution<uint16_t> byte(0, 255);
+
+    // Cover all SIMD block boundaries, every byte value included.
+    for (size_t size = 0; size <= 300; size++) {
+        std::vector<uint8_t> data(size);
+
+        for (auto& value : data) {
+            value = static_cast<uint8_t>(byte(rng));
+        }
+
+        auto expected = Encode(data, base64::Impl::eScalar);
+
+        for (auto impl : GetImpls()) {
+            std::vector<uint8_t> decoded;
+
+            ASSERT_EQ(Encode(data, impl), expected) << "size: " << size;
+            ASSERT_EQ(Decode(expected, decoded, impl), Error::eNone) << "size: " << size;
+            ASSERT_EQ(decoded, data) << "size: " << size;
+        }
+    }
+}
+
+TEST(base64, InvalidCharacters)
+{
+    std::vector<uint8_t> data(96, 0x5a);
+    auto                 encoded = Encode(data, base64::Impl::eScalar);
+
+    for (auto impl : GetImpls()) {
+        // Invalid characters at every position, including inside vector blocks.
+        for (size_t pos = 0; pos < encoded.size(); pos++) {
+            for (auto invalid : {'-', '_', ' ', '\n', '=', '\x80', '\0', '@', '[', '`', '{', ':'}) {
+                auto                 str = encoded;
+                std::vector<uint8_t> decoded;
+
+                // Valid padding.
+                if (invalid == '=' && pos == encoded.size() - 1) {
+                    continue;
+                }
+
+                str[pos] = invalid;
+
+                EXPECT_EQ(Decode(str, decoded, impl), Error::eInvalidArgument) << "pos: " << pos;
+            }
+        }
+    }
+}
+
+TEST(base64, InvalidPadding)
+{
+    for (auto impl : GetImpls()) {
+        for (const auto& str :
+            {"Zg=", "Zg", "Z===", "====", "Zg==Zm9v", "Zm=v", "Zg=a", "Zm9vYg==Zm9vYmFyZm9vYmFyZm9vYmFyZm9vYmFy"}) {
+            std::vector<uint8_t> decoded;
+
+            EXPECT_EQ(Decode(str, decoded, impl), Error::eInvalidArgument) << str;
+        }
+    }
+}
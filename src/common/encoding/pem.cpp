@@ -0,0 +1,260 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cstring>
+
+#include "base64.hpp"
+#include "pem.hpp"
+
+namespace aos {
+namespace pem {
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+namespace {
+
+constexpr char   cBegin[]   = "-----BEGIN ";
+constexpr char   cEnd[]     = "-----END ";
+constexpr char   cDashes[]  = "-----";
+constexpr size_t cLineSize  = 64;
+constexpr size_t cLineBlock = cLineSize / 4 * 3;
+constexpr size_t cNotFound  = static_cast<size_t>(-1);
+
+size_t Find(const char* data, size_t size, size_t pos, const char* str)
+{
+    auto found = static_cast<const char*>(memmem(data + pos, size - pos, str, strlen(str)));
+
+    return found ? found - data : cNotFound;
+}
+
+bool IsSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+// Decodes base64 lines into preallocated buffer. Lines don't have to be a multiple of 4 characters long: incomplete
+// quantum is carried over to the next line.
+class BodyDecoder {
+public:
+    explicit BodyDecoder(uint8_t* dst)
+        : mDst(dst)
+    {
+    }
+
+    Error DecodeLine(const char* src, size_t size)
+    {
+        if (mCarrySize > 0) {
+            auto count = std::min(sizeof(mCarry) - mCarrySize, size);
+
+            memcpy(mCarry + mCarrySize, src, count);
+
+            mCarrySize += count;
+            src += count;
+            size -= count;
+
+            if (mCarrySize < sizeof(mCarry)) {
+                return Error::eNone;
+            }
+
+            auto err = Decode(mCarry, sizeof(mCarry));
+            if (err != Error::eNone) {
+                return err;
+            }
+
+            mCarrySize = 0;
+        }
+
+        auto full = size / 4 * 4;
+
+        if (full > 0) {
+            auto err = Decode(src, full);
+            if (err != Error::eNone) {
+                return err;
+            }
+        }
+
+        mCarrySize = size - full;
+        memcpy(mCarry, src + full, mCarrySize);
+
+        return Error::eNone;
+    }
+
+    bool IsEmpty() const { return mWritten == 0 && mCarrySize == 0; }
+
+    Error Finish(size_t& decodedSize) const
+    {
+        if (mCarrySize != 0) {
+            return Error::eInvalidArgument;
+        }
+
+        decodedSize = mWritten;
+
+        return Error::eNone;
+    }
+
+private:
+    Error Decode(const char* src, size_t size)
+    {
+        // Nothing may follow padding.
+        if (mPadded) {
+            return Error::eInvalidArgument;
+        }
+
+        size_t decodedSize = 0;
+
+        auto err = base64::Decode(src, size, mDst + mWritten, decodedSize);
+        if (err != Error::eNone) {
+            return err;
+        }
+
+        mPadded = decodedSize < base64::GetMaxDecodedSize(size);
+        mWritten += decodedSize;
+
+        return Error::eNone;
+    }
+
+    uint8_t* mDst;
+    size_t   mWritten = 0;
+    char     mCarry[4];
+    size_t   mCarrySize = 0;
+    bool     mPadded    = false;
+};
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Public
+ **********************************************************************************************************************/
+
+Error Reader::Next(std::string& label, std::vector<uint8_t>& der)
+{
+    auto begin = Find(mData, mSize, mPos, cBegin);
+    if (begin == cNotFound) {
+        mPos = mSize;
+
+        return Error::eNotFound;
+    }
+
+    auto labelStart = begin + strlen(cBegin);
+    auto labelEnd   = Find(mData, mSize, labelStart, cDashes);
+    auto bodyStart  = labelEnd + strlen(cDashes);
+
+    if (labelEnd == cNotFound || std::find(mData + labelStart, mData + labelEnd, '\n') != mData + labelEnd) {
+        return Error::eInvalidArgument;
+    }
+
+    auto bodyEnd = Find(mData, mSize, bodyStart, cEnd);
+    if (bodyEnd == cNotFound) {
+        return Error::eInvalidArgument;
+    }
+
+    label.assign(mData + labelStart, labelEnd - labelStart);
+
+    // Body is decoded in place: allocate once for the largest possible content.
+    der.resize(base64::GetMaxDecodedSize(bodyEnd - bodyStart));
+
+    BodyDecoder decoder(der.data());
+    auto        pos = bodyStart;
+
+    while (pos < bodyEnd) {
+        auto newLine = static_cast<const char*>(memchr(mData + pos, '\n', bodyEnd - pos));
+        auto lineEnd = newLine ? static_cast<size_t>(newLine - mData) : bodyEnd;
+        auto end     = lineEnd;
+
+        while (end > pos && IsSpace(mData[end - 1])) {
+            end--;
+        }
+
+        // Skip encapsulated headers of legacy encrypted PEM, they precede base64 data.
+        if (decoder.IsEmpty() && memchr(mData + pos, ':', end - pos)) {
+            pos = lineEnd + 1;
+
+            continue;
+        }
+
+        auto err = decoder.DecodeLine(mData + pos, end - pos);
+        if (err != Error::eNone) {
+            return err;
+        }
+
+        pos = lineEnd + 1;
+    }
+
+    size_t decodedSize = 0;
+
+    auto err = decoder.Finish(decodedSize);
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    der.resize(decodedSize);
+
+    auto endLabel = bodyEnd + strlen(cEnd);
+
+    if (mSize - endLabel < label.size() + strlen(cDashes)
+        || label.compare(0, label.size(), mData + endLabel, label.size()) != 0
+        || strncmp(mData + endLabel + label.size(), cDashes, strlen(cDashes)) != 0) {
+        return Error::eInvalidArgument;
+    }
+
+    mPos = endLabel + label.size() + strlen(cDashes);
+
+    return Error::eNone;
+}
+
+Error Decode(const std::string& pem, const std::string& label, std::vector<uint8_t>& der)
+{
+    Reader      reader(pem);
+    std::string readLabel;
+
+    auto err = reader.Next(readLabel, der);
+    if (err != Error::eNone) {
+        return err == Error::eNotFound ? Error::eInvalidArgument : err;
+    }
+
+    if (readLabel != label) {
+        return Error::eInvalidArgument;
+    }
+
+    return Error::eNone;
+}
+
+void Encode(const std::string& label, const uint8_t* der, size_t size, std::string& pem)
+{
+    auto numLines = (size + cLineBlock - 1) / cLineBlock;
+    auto encoded  = base64::GetEncodedSize(size) + numLines;
+
+    pem.append(cBegin).append(label).append(cDashes).append("\n");
+
+    // Encode straight into the output string.
+    pem.resize(pem.size() + encoded);
+
+    auto out = &pem[pem.size() - encoded];
+
+    for (size_t offset = 0; offset < size; offset += cLineBlock) {
+        out += base64::Encode(der + offset, std::min(cLineBlock, size - offset), out);
+        *out++ = '\n';
+    }
+
+    pem.append(cEnd).append(label).append(cDashes).append("\n");
+}
+
+} // namespace pem
+} // namespace aos
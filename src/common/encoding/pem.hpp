@@ -0,0 +1,124 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PEM_HPP_
+#define PEM_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "error/error.hpp"
+
+namespace aos {
+namespace pem {
+
+/**
+ * Certificate label.
+ */
+constexpr auto cCertificate = "CERTIFICATE";
+
+/**
+ * Certificate request label.
+ */
+constexpr auto cCertificateRequest = "CERTIFICATE REQUEST";
+
+/**
+ * CRL label.
+ */
+constexpr auto cCRL = "X509 CRL";
+
+/**
+ * Reads PEM blocks one by one. Text outside of blocks is ignored. Base64 body is decoded straight into the output
+ * buffer without intermediate copies.
+ */
+class Reader {
+public:
+    /**
+     * Creates reader. Data must outlive the reader.
+     *
+     * @param data PEM data.
+     * @param size PEM data size.
+     */
+    Reader(const char* data, size_t size)
+        : mData(data)
+        , mSize(size)
+    {
+    }
+
+    /**
+     * Creates reader. String must outlive the reader.
+     *
+     * @param pem PEM data.
+     */
+    explicit Reader(const std::string& pem)
+        : Reader(pem.data(), pem.size())
+    {
+    }
+
+    /**
+     * Reads next block.
+     *
+     * @param[out] label block label.
+     * @param[out] der decoded block content.
+     * @return Error eNotFound if there are no more blocks.
+     */
+    Error Next(std::string& label, std::vector<uint8_t>& der);
+
+private:
+    const char* mData;
+    size_t      mSize;
+    size_t      mPos = 0;
+};
+
+/**
+ * Decodes the first PEM block and checks its label.
+ *
+ * @param pem PEM data.
+ * @param label expected label.
+ * @param[out] der decoded block content.
+ * @return Error.
+ */
+Error Decode(const std::string& pem, const std::string& label, std::vector<uint8_t>& der);
+
+/**
+ * Appends PEM block with 64 characters lines.
+ *
+ * @param label block label.
+ * @param der block content.
+ * @param size block content size.
+ * @param[out] pem PEM data.
+ */
+void Encode(const std::string& label, const uint8_t* der, size_t size, std::string& pem);
+
+/**
+ * Appends PEM block with 64 characters lines.
+ *
+ * @param label block label.
+ * @param der block content.
+ * @param[out] pem PEM data.
+ */
+inline void Encode(const std::string& label, const std::vector<uint8_t>& der, std::string& pem)
+{
+    Encode(label, der.data(), der.size(), pem);
+}
+
+} // namespace pem
+} // namespace aos
+
+#endif
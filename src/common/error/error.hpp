@@ -25,6 +25,12 @@ namespace aos {
  */
 enum class Error {
     eNone,
+    eFailed,
+    eInvalidArgument,
+    eNotFound,
+    eAlreadyExist,
+    eNoMemory,
+    eWrongState,
 };
 
 } // namespace aos
@@ -0,0 +1,255 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cerrno>
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include "filewatcher.hpp"
+
+namespace aos {
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+namespace {
+
+constexpr uint32_t cWatchMask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE | IN_ONLYDIR;
+
+// Continuous changes are reported after this number of debounce intervals.
+constexpr int cMaxDelayFactor = 10;
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Public
+ **********************************************************************************************************************/
+
+constexpr std::chrono::milliseconds FileWatcher::cDefaultDebounce;
+
+FileWatcher::FileWatcher(std::chrono::milliseconds debounce)
+    : mDebounce(debounce)
+{
+}
+
+FileWatcher::~FileWatcher()
+{
+    Stop();
+}
+
+Error FileWatcher::Start(Callback callback)
+{
+    if (!callback) {
+        return Error::eInvalidArgument;
+    }
+
+    if (mThread.joinable()) {
+        return Error::eWrongState;
+    }
+
+    mFd     = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    mStopFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    if (mFd < 0 || mStopFd < 0) {
+        Stop();
+
+        return Error::eFailed;
+    }
+
+    mCallback = std::move(callback);
+    mThread   = std::thread(&FileWatcher::Run, this);
+
+    return Error::eNone;
+}
+
+void FileWatcher::Stop()
+{
+    if (mThread.joinable()) {
+        uint64_t value = 1;
+
+        while (write(mStopFd, &value, sizeof(value)) < 0 && errno == EINTR) { }
+
+        mThread.join();
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    for (auto fd : {mFd, mStopFd}) {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+    mFd     = -1;
+    mStopFd = -1;
+
+    mWatches.clear();
+    mPending.clear();
+    mRescan.clear();
+}
+
+Error FileWatcher::AddWatch(const std::string& dir)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    if (mFd < 0) {
+        return Error::eWrongState;
+    }
+
+    auto wd = inotify_add_watch(mFd, dir.c_str(), cWatchMask);
+    if (wd < 0) {
+        return errno == ENOENT || errno == ENOTDIR ? Error::eNotFound : Error::eFailed;
+    }
+
+    mWatches[wd] = dir;
+
+    return Error::eNone;
+}
+
+Error FileWatcher::RemoveWatch(const std::string& dir)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    auto it = std::find_if(mWatches.begin(), mWatches.end(),
+        [&dir](const std::pair<const int, std::string>& watch) { return watch.second == dir; });
+    if (it == mWatches.end()) {
+        return Error::eNotFound;
+    }
+
+    inotify_rm_watch(mFd, it->first);
+    mWatches.erase(it);
+
+    return Error::eNone;
+}
+
+/***********************************************************************************************************************
+ * Private
+ **********************************************************************************************************************/
+
+void FileWatcher::Run()
+{
+    while (true) {
+        auto timeout = -1;
+
+        if (!mPending.empty() || !mRescan.empty()) {
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(GetDeadline() - Clock::now()).count();
+
+            timeout = static_cast<int>(std::max<int64_t>(left, 0));
+        }
+
+        pollfd fds[] = {{mFd, POLLIN, 0}, {mStopFd, POLLIN, 0}};
+
+        if (poll(fds, 2, timeout) < 0 && errno != EINTR) {
+            return;
+        }
+
+        if (fds[1].revents & POLLIN) {
+            return;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            ReadEvents();
+        }
+
+        if ((!mPending.empty() || !mRescan.empty()) && Clock::now() >= GetDeadline()) {
+            Report();
+        }
+    }
+}
+
+void FileWatcher::ReadEvents()
+{
+    alignas(inotify_event) char buffer[4096];
+
+    while (true) {
+        auto size = read(mFd, buffer, sizeof(buffer));
+        if (size <= 0) {
+            return;
+        }
+
+        auto now = Clock::now();
+
+        if (mPending.empty() && mRescan.empty()) {
+            mFirstEvent = now;
+        }
+
+        mLastEvent = now;
+
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        for (ssize_t pos = 0; pos < size;) {
+            auto event = reinterpret_cast<const inotify_event*>(buffer + pos);
+
+            pos += sizeof(inotify_event) + event->len;
+
+            // Queue overflow drops events of all directories.
+            if (event->mask & IN_Q_OVERFLOW) {
+                for (const auto& watch : mWatches) {
+                    mRescan.insert(watch.second);
+                }
+
+                continue;
+            }
+
+            auto it = mWatches.find(event->wd);
+            if (it == mWatches.end()) {
+                continue;
+            }
+
+            // Watch of a removed directory is released by the kernel.
+            if (event->mask & IN_IGNORED) {
+                mWatches.erase(it);
+
+                continue;
+            }
+
+            if (event->len > 0) {
+                mPending[it->second].insert(event->name);
+            }
+        }
+    }
+}
+
+void FileWatcher::Report()
+{
+    auto pending = std::move(mPending);
+    auto rescan  = std::move(mRescan);
+
+    mPending.clear();
+    mRescan.clear();
+
+    for (const auto& dir : rescan) {
+        pending.erase(dir);
+        mCallback(dir, {});
+    }
+
+    for (const auto& it : pending) {
+        mCallback(it.first, std::vector<std::string>(it.second.begin(), it.second.end()));
+    }
+}
+
+FileWatcher::Clock::time_point FileWatcher::GetDeadline() const
+{
+    return std::min(mLastEvent + mDebounce, mFirstEvent + mDebounce * cMaxDelayFactor);
+}
+
+} // namespace aos
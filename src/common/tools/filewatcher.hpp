@@ -0,0 +1,120 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FILEWATCHER_HPP_
+#define FILEWATCHER_HPP_
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "error/error.hpp"
+
+namespace aos {
+
+/**
+ * Watches files of directories with inotify. Changes are debounced: they are accumulated until directories stay
+ * unchanged for the debounce interval, then reported once per directory with names of changed files. A burst of
+ * writes to a file, or a tool replacing many files at once, results in a single callback. Subdirectories are not
+ * watched, their creation and removal are reported as changed names.
+ */
+class FileWatcher {
+public:
+    /**
+     * Change callback. Empty names mean that events were lost and any file of the directory may have changed.
+     */
+    using Callback = std::function<void(const std::string& dir, const std::vector<std::string>& names)>;
+
+    /**
+     * Default debounce interval.
+     */
+    static constexpr std::chrono::milliseconds cDefaultDebounce {200};
+
+    /**
+     * Creates file watcher.
+     *
+     * @param debounce quiet interval before changes are reported. Continuous changes are reported at least every 10
+     * intervals.
+     */
+    explicit FileWatcher(std::chrono::milliseconds debounce = cDefaultDebounce);
+
+    /**
+     * Destroys file watcher.
+     */
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    /**
+     * Starts watcher thread. Callback is called from the thread and may add or remove watches.
+     *
+     * @param callback change callback.
+     * @return Error.
+     */
+    Error Start(Callback callback);
+
+    /**
+     * Stops watcher thread. Pending changes are dropped. Must not be called from the callback.
+     */
+    void Stop();
+
+    /**
+     * Adds directory watch.
+     *
+     * @param dir directory path.
+     * @return Error.
+     */
+    Error AddWatch(const std::string& dir);
+
+    /**
+     * Removes directory watch.
+     *
+     * @param dir directory path.
+     * @return Error.
+     */
+    Error RemoveWatch(const std::string& dir);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void              Run();
+    void              ReadEvents();
+    void              Report();
+    Clock::time_point GetDeadline() const;
+
+    std::chrono::milliseconds                    mDebounce;
+    Callback                                     mCallback;
+    int                                          mFd     = -1;
+    int                                          mStopFd = -1;
+    std::thread                                  mThread;
+    std::mutex                                   mMutex;
+    std::map<int, std::string>                   mWatches;
+    std::map<std::string, std::set<std::string>> mPending;
+    std::set<std::string>                        mRescan;
+    Clock::time_point                            mFirstEvent;
+    Clock::time_point                            mLastEvent;
+};
+
+} // namespace aos
+
+#endif
@@ -0,0 +1,191 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ftw.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include "filewatcher.hpp"
+
+using namespace aos;
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+namespace {
+
+constexpr auto cDebounce = std::chrono::milliseconds(50);
+constexpr auto cTimeout  = std::chrono::seconds(5);
+
+struct Change {
+    std::string              mDir;
+    std::vector<std::string> mNames;
+};
+
+class Recorder {
+public:
+    FileWatcher::Callback GetCallback()
+    {
+        return [this](const std::string& dir, const std::vector<std::string>& names) {
+            std::lock_guard<std::mutex> lock(mMutex);
+
+            mChanges.push_back({dir, names});
+            mCondVar.notify_all();
+        };
+    }
+
+    bool WaitChanges(size_t count)
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+
+        return mCondVar.wait_for(lock, cTimeout, [this, count] { return mChanges.size() >= count; });
+    }
+
+    std::vector<Change> GetChanges()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        return mChanges;
+    }
+
+private:
+    std::mutex              mMutex;
+    std::condition_variable mCondVar;
+    std::vector<Change>     mChanges;
+};
+
+class TempDir {
+public:
+    TempDir()
+    {
+        char path[] = "/tmp/aos_test_XXXXXX";
+
+        mPath = mkdtemp(path);
+    }
+
+    ~TempDir()
+    {
+        nftw(
+            mPath.c_str(), [](const char* path, const struct stat*, int, struct FTW*) { return remove(path); }, 16,
+            FTW_DEPTH | FTW_PHYS);
+    }
+
+    const std::string& GetPath() const { return mPath; }
+
+private:
+    std::string mPath;
+};
+
+void WriteFile(const std::string& path, const std::string& content)
+{
+    std::ofstream(path) << content;
+}
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Tests
+ **********************************************************************************************************************/
+
+TEST(filewatcher, Debounce)
+{
+    TempDir     dir;
+    Recorder    recorder;
+    FileWatcher watcher(cDebounce);
+
+    EXPECT_EQ(watcher.AddWatch(dir.GetPath()), Error::eWrongState);
+    ASSERT_EQ(watcher.Start(recorder.GetCallback()), Error::eNone);
+    EXPECT_EQ(watcher.AddWatch(dir.GetPath() + "/missing"), Error::eNotFound);
+    ASSERT_EQ(watcher.AddWatch(dir.GetPath()), Error::eNone);
+
+    // Burst of changes is reported once.
+    for (int i = 0; i < 10; i++) {
+        WriteFile(dir.GetPath() + "/a.pem", std::to_string(i));
+    }
+
+    WriteFile(dir.GetPath() + "/b.pem", "b");
+    ASSERT_EQ(rename((dir.GetPath() + "/b.pem").c_str(), (dir.GetPath() + "/c.pem").c_str()), 0);
+    ASSERT_EQ(mkdir((dir.GetPath() + "/sub").c_str(), 0700), 0);
+
+    ASSERT_TRUE(recorder.WaitChanges(1));
+
+    std::this_thread::sleep_for(cDebounce * 4);
+
+    auto changes = recorder.GetChanges();
+
+    ASSERT_EQ(changes.size(), 1u);
+    EXPECT_EQ(changes[0].mDir, dir.GetPath());
+    EXPECT_EQ(changes[0].mNames, std::vector<std::string>({"a.pem", "b.pem", "c.pem", "sub"}));
+
+    // Files of subdirectories are not watched.
+    WriteFile(dir.GetPath() + "/sub/d.pem", "d");
+    ASSERT_EQ(unlink((dir.GetPath() + "/a.pem").c_str()), 0);
+
+    ASSERT_TRUE(recorder.WaitChanges(2));
+
+    changes = recorder.GetChanges();
+
+    EXPECT_EQ(changes[1].mNames, std::vector<std::string>({"a.pem"}));
+}
+
+TEST(filewatcher, Watches)
+{
+    TempDir     first, second;
+    Recorder    recorder;
+    FileWatcher watcher(cDebounce);
+
+    ASSERT_EQ(watcher.Start(recorder.GetCallback()), Error::eNone);
+    ASSERT_EQ(watcher.AddWatch(first.GetPath()), Error::eNone);
+    ASSERT_EQ(watcher.AddWatch(second.GetPath()), Error::eNone);
+
+    // Directories are reported separately.
+    WriteFile(first.GetPath() + "/a.pem", "a");
+    WriteFile(second.GetPath() + "/b.pem", "b");
+
+    ASSERT_TRUE(recorder.WaitChanges(2));
+
+    ASSERT_EQ(watcher.RemoveWatch(first.GetPath()), Error::eNone);
+    EXPECT_EQ(watcher.RemoveWatch(first.GetPath()), Error::eNotFound);
+
+    WriteFile(first.GetPath() + "/c.pem", "c");
+    WriteFile(second.GetPath() + "/d.pem", "d");
+
+    ASSERT_TRUE(recorder.WaitChanges(3));
+
+    std::this_thread::sleep_for(cDebounce * 4);
+
+    auto changes = recorder.GetChanges();
+
+    ASSERT_EQ(changes.size(), 3u);
+    EXPECT_EQ(changes[2].mDir, second.GetPath());
+    EXPECT_EQ(changes[2].mNames, std::vector<std::string>({"d.pem"}));
+
+    watcher.Stop();
+
+    EXPECT_EQ(watcher.AddWatch(first.GetPath()), Error::eWrongState);
+}
@@ -0,0 +1,167 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "rcu.hpp"
+
+namespace aos {
+namespace rcu {
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+namespace {
+
+constexpr size_t cCacheLineSize = 64;
+
+// Reader record owned by one thread. Sequence is odd while the thread is inside a read side critical section.
+// Records are padded instead of aligned, as over-aligned new is not available in C++14: the sequence never shares
+// a cache line with other data.
+struct Reader {
+    char                  mPaddingBefore[cCacheLineSize];
+    std::atomic<uint64_t> mSequence {0};
+    char                  mPaddingAfter[cCacheLineSize];
+    bool                  mUsed = false;
+};
+
+// Records are never freed: a record of an exited thread is reused by a new one.
+class Registry {
+public:
+    Reader* Acquire()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        for (auto reader : mReaders) {
+            if (!reader->mUsed) {
+                reader->mUsed = true;
+
+                return reader;
+            }
+        }
+
+        mReaders.push_back(new Reader());
+        mReaders.back()->mUsed = true;
+
+        return mReaders.back();
+    }
+
+    void Release(Reader* reader)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        reader->mUsed = false;
+    }
+
+    void Synchronize()
+    {
+        std::vector<Reader*> readers;
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+
+            readers = mReaders;
+        }
+
+        for (auto reader : readers) {
+            auto sequence = reader->mSequence.load();
+
+            // Reader that enters after this point sees the published object.
+            while ((sequence & 1) && reader->mSequence.load() == sequence) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+private:
+    std::mutex           mMutex;
+    std::vector<Reader*> mReaders;
+};
+
+// Intentionally leaked: thread local records may be released after static destructors are run.
+Registry& GetRegistry()
+{
+    static auto sRegistry = new Registry();
+
+    return *sRegistry;
+}
+
+class ThreadReader {
+public:
+    ThreadReader()
+        : mReader(GetRegistry().Acquire())
+    {
+    }
+
+    ~ThreadReader() { GetRegistry().Release(mReader); }
+
+    void Enter()
+    {
+        if (mDepth++ == 0) {
+            mReader->mSequence.fetch_add(1);
+        }
+    }
+
+    void Leave()
+    {
+        // Only the owning thread writes the sequence.
+        if (--mDepth == 0) {
+            mReader->mSequence.store(mReader->mSequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+    }
+
+    bool IsReading() const { return mDepth > 0; }
+
+private:
+    Reader* mReader;
+    size_t  mDepth = 0;
+};
+
+thread_local ThreadReader tThreadReader;
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Public
+ **********************************************************************************************************************/
+
+ReadLock::ReadLock()
+{
+    tThreadReader.Enter();
+}
+
+ReadLock::~ReadLock()
+{
+    tThreadReader.Leave();
+}
+
+bool IsReading()
+{
+    return tThreadReader.IsReading();
+}
+
+void Synchronize()
+{
+    GetRegistry().Synchronize();
+}
+
+} // namespace rcu
+} // namespace aos
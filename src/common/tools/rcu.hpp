@@ -0,0 +1,139 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCU_HPP_
+#define RCU_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace aos {
+namespace rcu {
+
+/**
+ * Read side critical section. Data published with Publish() and loaded inside the section is not freed until the
+ * section ends. Sections may be nested. Entering a section writes only to the thread own reader record, so readers
+ * never contend with each other or with writers.
+ */
+class ReadLock {
+public:
+    /**
+     * Enters read side critical section.
+     */
+    ReadLock();
+
+    /**
+     * Leaves read side critical section.
+     */
+    ~ReadLock();
+
+    ReadLock(const ReadLock&) = delete;
+    ReadLock& operator=(const ReadLock&) = delete;
+};
+
+/**
+ * Returns whether the calling thread is inside a read side critical section.
+ *
+ * @return bool.
+ */
+bool IsReading();
+
+/**
+ * Waits until all read side critical sections started before the call are finished. Must not be called inside a read
+ * side critical section: it would wait for the calling thread itself.
+ */
+void Synchronize();
+
+/**
+ * Atomically replaces published object and frees the previous one after a grace period. Concurrent writers must be
+ * serialized by the caller. As Synchronize(), must not be called inside a read side critical section, and the caller
+ * must not hold locks readers may wait for.
+ *
+ * @param pointer published pointer.
+ * @param object new object, may be nullptr.
+ */
+template <typename T>
+void Publish(std::atomic<const T*>& pointer, const T* object)
+{
+    auto previous = pointer.exchange(object);
+
+    if (previous) {
+        Synchronize();
+        delete previous;
+    }
+}
+
+/**
+ * Shared pointer published through RCU. Load() copies the pointer inside a read side critical section, so readers
+ * take no locks and only pay for the reference count increment. Store() serializes writers and frees the previous
+ * holder after a grace period: it has Publish() restrictions and must not be called inside a read side critical
+ * section.
+ */
+template <typename T>
+class SharedPtr {
+public:
+    /**
+     * Creates empty pointer.
+     */
+    SharedPtr() = default;
+
+    /**
+     * Destroys pointer. There must be no concurrent readers or writers.
+     */
+    ~SharedPtr() { delete mHolder.load(); }
+
+    SharedPtr(const SharedPtr&) = delete;
+    SharedPtr& operator=(const SharedPtr&) = delete;
+
+    /**
+     * Returns current value.
+     *
+     * @return std::shared_ptr<T>.
+     */
+    std::shared_ptr<T> Load() const
+    {
+        ReadLock lock;
+
+        auto holder = mHolder.load();
+
+        return holder ? *holder : nullptr;
+    }
+
+    /**
+     * Replaces current value.
+     *
+     * @param value new value, may be nullptr.
+     */
+    void Store(std::shared_ptr<T> value)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        Publish<std::shared_ptr<T>>(mHolder, value ? new std::shared_ptr<T>(std::move(value)) : nullptr);
+    }
+
+private:
+    std::atomic<const std::shared_ptr<T>*> mHolder {nullptr};
+    std::mutex                             mMutex;
+};
+
+} // namespace rcu
+} // namespace aos
+
+#endif
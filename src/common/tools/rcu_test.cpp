@@ -0,0 +1,209 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "rcu.hpp"
+
+using namespace aos;
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+namespace {
+
+struct Object {
+    explicit Object(int value)
+        : mValue(value)
+    {
+        sAlive++;
+    }
+
+    ~Object()
+    {
+        // Poison value to catch use after free.
+        mValue = -1;
+        sAlive--;
+    }
+
+    int mValue;
+
+    static std::atomic<int> sAlive;
+};
+
+std::atomic<int> Object::sAlive {0};
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Tests
+ **********************************************************************************************************************/
+
+TEST(rcu, Publish)
+{
+    std::atomic<const Object*> pointer {nullptr};
+
+    rcu::Publish(pointer, new Object(1));
+    rcu::Publish(pointer, new Object(2));
+
+    EXPECT_EQ(pointer.load()->mValue, 2);
+    EXPECT_EQ(Object::sAlive, 1);
+
+    rcu::Publish<Object>(pointer, nullptr);
+
+    EXPECT_EQ(Object::sAlive, 0);
+}
+
+TEST(rcu, IsReading)
+{
+    EXPECT_FALSE(rcu::IsReading());
+
+    {
+        rcu::ReadLock lock;
+
+        {
+            rcu::ReadLock nested;
+
+            EXPECT_TRUE(rcu::IsReading());
+        }
+
+        EXPECT_TRUE(rcu::IsReading());
+    }
+
+    EXPECT_FALSE(rcu::IsReading());
+}
+
+TEST(rcu, WaitsForReaders)
+{
+    std::atomic<const Object*> pointer {new Object(1)};
+    std::atomic<bool>          entered {false}, published {false};
+
+    std::thread reader([&] {
+        rcu::ReadLock lock;
+        rcu::ReadLock nested;
+
+        auto object = pointer.load();
+
+        entered = true;
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+        // Object is still alive although a new one has been published meanwhile.
+        EXPECT_FALSE(published);
+        EXPECT_EQ(object->mValue, 1);
+    });
+
+    while (!entered) {
+        std::this_thread::yield();
+    }
+
+    rcu::Publish(pointer, new Object(2));
+    published = true;
+
+    reader.join();
+
+    rcu::Publish<Object>(pointer, nullptr);
+}
+
+TEST(rcu, ConcurrentReaders)
+{
+    std::atomic<const Object*> pointer {new Object(0)};
+    std::atomic<bool>          stop {false};
+    std::atomic<int>           failures {0};
+    std::vector<std::thread>   readers;
+
+    for (int i = 0; i < 4; i++) {
+        readers.emplace_back([&] {
+            while (!stop) {
+                rcu::ReadLock lock;
+
+                if (pointer.load()->mValue < 0) {
+                    failures++;
+                }
+            }
+        });
+    }
+
+    for (int i = 1; i < 1000; i++) {
+        rcu::Publish(pointer, new Object(i));
+    }
+
+    stop = true;
+
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    EXPECT_EQ(failures, 0);
+
+    rcu::Publish<Object>(pointer, nullptr);
+}
+
+TEST(rcu, SharedPtr)
+{
+    rcu::SharedPtr<const Object> pointer;
+    std::atomic<bool>            stop {false};
+    std::atomic<int>             failures {0};
+    std::vector<std::thread>     readers;
+
+    EXPECT_EQ(pointer.Load(), nullptr);
+
+    pointer.Store(std::make_shared<const Object>(0));
+
+    for (int i = 0; i < 4; i++) {
+        readers.emplace_back([&] {
+            while (!stop) {
+                auto object = pointer.Load();
+
+                if (!object || object->mValue < 0) {
+                    failures++;
+                }
+            }
+        });
+    }
+
+    auto kept = pointer.Load();
+
+    for (int i = 1; i < 1000; i++) {
+        pointer.Store(std::make_shared<const Object>(i));
+    }
+
+    stop = true;
+
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    EXPECT_EQ(failures, 0);
+
+    // Loaded value outlives its replacement.
+    EXPECT_EQ(kept->mValue, 0);
+    EXPECT_EQ(pointer.Load()->mValue, 999);
+    EXPECT_EQ(Object::sAlive, 2);
+
+    kept.reset();
+    pointer.Store(nullptr);
+
+    EXPECT_EQ(Object::sAlive, 0);
+}
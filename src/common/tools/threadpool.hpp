@@ -0,0 +1,196 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THREADPOOL_HPP_
+#define THREADPOOL_HPP_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "error/error.hpp"
+
+namespace aos {
+
+/**
+ * Fixed size thread pool with bounded job queue.
+ */
+class ThreadPool {
+public:
+    /**
+     * Job to be executed by pool.
+     */
+    using Job = std::function<void()>;
+
+    /**
+     * Job priority.
+     */
+    enum class Priority {
+        eNormal,
+        eIdle,
+    };
+
+    /**
+     * Creates thread pool.
+     *
+     * @param numThreads number of worker threads.
+     * @param maxJobs max number of queued jobs.
+     */
+    ThreadPool(size_t numThreads, size_t maxJobs)
+        : mMaxJobs(maxJobs)
+    {
+        if (numThreads == 0) {
+            numThreads = 1;
+        }
+
+        for (size_t i = 0; i < numThreads; i++) {
+            mThreads.emplace_back(&ThreadPool::Run, this);
+        }
+    }
+
+    /**
+     * Destroys thread pool. Pending jobs are executed before exit.
+     */
+    ~ThreadPool() { Shutdown(); }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * Adds job to the pool. Idle jobs are started only when there are no queued or running normal jobs.
+     *
+     * @param job job to execute.
+     * @param priority job priority.
+     * @return Error.
+     */
+    Error AddJob(Job job, Priority priority = Priority::eNormal)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        if (mShutdown) {
+            return Error::eWrongState;
+        }
+
+        auto& jobs = priority == Priority::eNormal ? mJobs : mIdleJobs;
+
+        if (jobs.size() >= mMaxJobs) {
+            return Error::eNoMemory;
+        }
+
+        jobs.push_back(std::move(job));
+        mCondVar.notify_all();
+
+        return Error::eNone;
+    }
+
+    /**
+     * Waits until all queued and running jobs are finished.
+     */
+    void Wait()
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+
+        mIdleCondVar.wait(lock, [this] { return IsIdle() && mIdleJobs.empty() && mActiveIdleJobs == 0; });
+    }
+
+    /**
+     * Finishes queued jobs and stops worker threads.
+     */
+    void Shutdown()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+
+            if (mShutdown) {
+                return;
+            }
+
+            mShutdown = true;
+            mCondVar.notify_all();
+        }
+
+        for (auto& thread : mThreads) {
+            if (thread.joinable()) {
+                thread.join();
+            }
+        }
+    }
+
+    /**
+     * Returns number of worker threads.
+     *
+     * @return size_t.
+     */
+    size_t GetNumThreads() const { return mThreads.size(); }
+
+private:
+    bool IsIdle() const { return mJobs.empty() && mActiveJobs == 0; }
+
+    void Run()
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+
+        while (true) {
+            mCondVar.wait(lock, [this] { return mShutdown || !mJobs.empty() || (IsIdle() && !mIdleJobs.empty()); });
+
+            auto idle = mJobs.empty();
+
+            if (idle && (mIdleJobs.empty() || !IsIdle())) {
+                return;
+            }
+
+            auto& jobs = idle ? mIdleJobs : mJobs;
+            auto& active = idle ? mActiveIdleJobs : mActiveJobs;
+            auto  job = std::move(jobs.front());
+
+            jobs.pop_front();
+            active++;
+
+            lock.unlock();
+            job();
+            lock.lock();
+
+            active--;
+
+            if (IsIdle()) {
+                mCondVar.notify_all();
+
+                if (mIdleJobs.empty() && mActiveIdleJobs == 0) {
+                    mIdleCondVar.notify_all();
+                }
+            }
+        }
+    }
+
+    size_t                   mMaxJobs;
+    size_t                   mActiveJobs = 0;
+    size_t                   mActiveIdleJobs = 0;
+    bool                     mShutdown = false;
+    std::mutex               mMutex;
+    std::condition_variable  mCondVar;
+    std::condition_variable  mIdleCondVar;
+    std::deque<Job>          mJobs;
+    std::deque<Job>          mIdleJobs;
+    std::vector<std::thread> mThreads;
+};
+
+} // namespace aos
+
+#endif
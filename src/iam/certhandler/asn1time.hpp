@@ -0,0 +1,64 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ASN1TIME_HPP_
+#define ASN1TIME_HPP_
+
+#include <ctime>
+
+#include <openssl/asn1.h>
+
+#include "error/error.hpp"
+#include "x509parser.hpp"
+
+namespace aos {
+namespace iam {
+namespace certhandler {
+
+/**
+ * Converts OpenSSL time of certificates and CRLs with the X.509 parser time parsing, see ParseTime(). Internal header:
+ * it is not installed, so the public parser interface doesn't depend on OpenSSL.
+ *
+ * @param asn1Time OpenSSL time.
+ * @param[out] result time.
+ * @return Error.
+ */
+inline Error ConvertTime(const ASN1_TIME* asn1Time, time_t& result)
+{
+    if (!asn1Time) {
+        return Error::eInvalidArgument;
+    }
+
+    DERView value(ASN1_STRING_get0_data(asn1Time), static_cast<size_t>(ASN1_STRING_length(asn1Time)));
+
+    switch (ASN1_STRING_type(asn1Time)) {
+    case V_ASN1_UTCTIME:
+        return ParseTime(dertag::cUTCTime, value, result);
+
+    case V_ASN1_GENERALIZEDTIME:
+        return ParseTime(dertag::cGeneralizedTime, value, result);
+
+    default:
+        return Error::eInvalidArgument;
+    }
+}
+
+} // namespace certhandler
+} // namespace iam
+} // namespace aos
+
+#endif
@@ -15,21 +15,1255 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <future>
+#include <iterator>
+#include <set>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include "certhandler.hpp"
+#include "encoding/pem.hpp"
+#include "x509parser.hpp"
 
 namespace aos {
 namespace iam {
 namespace certhandler {
 
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+constexpr size_t CertHandler::cDefaultNumWorkers;
+constexpr size_t CertHandler::cMaxPendingJobs;
+constexpr size_t CertHandler::cVerifyCacheSize;
+constexpr size_t CertHandler::cMaxTLSKeys;
+
+namespace {
+
+constexpr const char* cBundleFileExts[] = {".pem", ".crt"};
+
+bool IsBundleFile(const std::string& name)
+{
+    return std::any_of(std::begin(cBundleFileExts), std::end(cBundleFileExts), [&name](const char* ext) {
+        auto size = strlen(ext);
+
+        return name.size() > size && name.compare(name.size() - size, size, ext) == 0;
+    });
+}
+
+void ListDir(const std::string& path, std::set<std::string>& names)
+{
+    auto dir = opendir(path.c_str());
+    if (!dir) {
+        return;
+    }
+
+    while (auto entry = readdir(dir)) {
+        if (entry->d_name[0] != '.') {
+            names.insert(entry->d_name);
+        }
+    }
+
+    closedir(dir);
+}
+
+Error ReadTrustBundle(const std::string& path, CertChain& anchors)
+{
+    std::ifstream file(path);
+
+    if (!file) {
+        return access(path.c_str(), F_OK) != 0 && errno == ENOENT ? Error::eNotFound : Error::eFailed;
+    }
+
+    std::string          content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    pem::Reader          reader(content);
+    std::string          label;
+    std::vector<uint8_t> der;
+    Error                err = Error::eNone;
+
+    while ((err = reader.Next(label, der)) == Error::eNone) {
+        X509View cert;
+
+        if (label != pem::cCertificate) {
+            continue;
+        }
+
+        if (ParseX509(der, cert) != Error::eNone) {
+            return Error::eInvalidArgument;
+        }
+
+        anchors.push_back(std::move(der));
+    }
+
+    return err == Error::eNotFound ? Error::eNone : err;
+}
+
+} // namespace
+
 /***********************************************************************************************************************
  * Public
  **********************************************************************************************************************/
 
-Error CertHandler::CreateKey()
+CertHandler::CertHandler(size_t numWorkers)
+    : mVerifyCache(cVerifyCacheSize)
+    , mWorkers(numWorkers, cMaxPendingJobs)
+{
+}
+
+CertHandler::~CertHandler()
+{
+    // Reloads of changed files use the handler.
+    StopWatch();
+
+    // Renewal callback may use the handler.
+    mRenewalScheduler.Stop();
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        mShutdown = true;
+    }
+
+    // Jobs pending on storage concurrency limit are executed by the running ones, so waiting for the pool to become idle
+    // is enough to complete all requests.
+    mWorkers.Wait();
+    mWorkers.Shutdown();
+
+    for (auto& storage : mStorages) {
+        for (auto& pool : storage.second.mKeyPools) {
+            KeyList keys;
+
+            for (auto& pooledKey : pool.second.mKeys) {
+                keys.push_back(std::move(pooledKey.mKey));
+            }
+
+            DisposeKeys(*storage.first, keys, pool.second.mConfig.mSecureDispose);
+        }
+    }
+}
+
+Error CertHandler::RegisterCertType(const std::string& certType, KeyStorageItf& storage)
+{
+    auto state = std::make_unique<CertTypeState>();
+
+    state->mStorage = &storage;
+    state->mTLSSlot = std::make_shared<TLSCredentialsSlot>();
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        mStorages.emplace(&storage, StorageState());
+    }
+
+    std::lock_guard<std::shared_timed_mutex> lock(mCertTypesMutex);
+
+    if (!mCertTypes.emplace(certType, std::move(state)).second) {
+        return Error::eAlreadyExist;
+    }
+
+    return Error::eNone;
+}
+
+Error CertHandler::ConfigureKeyPool(KeyStorageItf& storage, KeyAlgorithm algorithm, const KeyPoolConfig& config)
+{
+    KeyList keys;
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        auto it = mStorages.find(&storage);
+        if (it == mStorages.end()) {
+            return Error::eNotFound;
+        }
+
+        auto& pool = it->second.mKeyPools[algorithm];
+
+        pool.mConfig       = config;
+        pool.mRefillFailed = false;
+
+        while (pool.mKeys.size() > config.mSize) {
+            keys.push_back(std::move(pool.mKeys.front().mKey));
+            pool.mKeys.pop_front();
+        }
+
+        ScheduleRefill(storage, it->second);
+    }
+
+    DisposeKeys(storage, keys, config.mSecureDispose);
+
+    return Error::eNone;
+}
+
+Error CertHandler::SuspendKeyPools(KeyStorageItf& storage)
+{
+    KeyList keys;
+
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+
+        auto it = mStorages.find(&storage);
+        if (it == mStorages.end()) {
+            return Error::eNotFound;
+        }
+
+        auto& state = it->second;
+
+        state.mPoolsSuspended = true;
+
+        // Refill started before suspension creates its key on the storage and puts it to the pool.
+        mRefillCondVar.wait(lock, [&state] { return state.mRunningRefills == 0; });
+
+        for (auto& pool : state.mKeyPools) {
+            for (auto& pooledKey : pool.second.mKeys) {
+                if (pool.second.mConfig.mSecureDispose) {
+                    keys.push_back(std::move(pooledKey.mKey));
+                }
+            }
+
+            pool.second.mKeys.clear();
+            pool.second.mRefillFailed = false;
+        }
+    }
+
+    DisposeKeys(storage, keys, true);
+
+    return Error::eNone;
+}
+
+Error CertHandler::ResumeKeyPools(KeyStorageItf& storage)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    auto it = mStorages.find(&storage);
+    if (it == mStorages.end()) {
+        return Error::eNotFound;
+    }
+
+    it->second.mPoolsSuspended = false;
+
+    ScheduleRefill(storage, it->second);
+
+    return Error::eNone;
+}
+
+Error CertHandler::CreateKey(const std::string& certType, KeyAlgorithm algorithm, std::shared_ptr<PrivateKeyItf>& key)
+{
+    CertTypeState* state = nullptr;
+
+    auto err = FindCertType(certType, state);
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    if (TakePooledKey(*state->mStorage, algorithm, key)) {
+        return Error::eNone;
+    }
+
+    std::promise<Error> promise;
+    auto                future = promise.get_future();
+
+    err = CreateKeyAsync(certType, algorithm, [&promise, &key](Error err, std::shared_ptr<PrivateKeyItf> createdKey) {
+        key = std::move(createdKey);
+        promise.set_value(err);
+    });
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    return future.get();
+}
+
+Error CertHandler::CreateKeyAsync(const std::string& certType, KeyAlgorithm algorithm, CreateKeyCallback callback)
+{
+    if (!callback) {
+        return Error::eInvalidArgument;
+    }
+
+    CertTypeState* state = nullptr;
+
+    auto err = FindCertType(certType, state);
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    return ScheduleCreateKey(*state->mStorage, algorithm, std::move(callback));
+}
+
+Error CertHandler::CreateCSR(const CSRRequest& request, CSRResult& result)
+{
+    std::vector<CSRResult> results;
+
+    CreateCSRs({request}, results);
+
+    result = std::move(results.front());
+
+    return result.mError;
+}
+
+Error CertHandler::CreateCSRs(const std::vector<CSRRequest>& requests, std::vector<CSRResult>& results)
+{
+    std::vector<CertTypeState*> states(requests.size());
+    CryptoProviderItf*          provider = mCryptoProvider;
+
+    results.assign(requests.size(), CSRResult());
+
+    {
+        std::shared_lock<std::shared_timed_mutex> lock(mCertTypesMutex);
+
+        for (size_t i = 0; i < requests.size(); i++) {
+            results[i].mCertType = requests[i].mCertType;
+
+            auto it = mCertTypes.find(requests[i].mCertType);
+            if (it == mCertTypes.end()) {
+                results[i].mError = Error::eNotFound;
+
+                continue;
+            }
+
+            states[i] = it->second.get();
+        }
+    }
+
+    std::mutex              mutex;
+    std::condition_variable condVar;
+    size_t                  numPending = 0;
+
+    for (size_t i = 0; i < requests.size(); i++) {
+        if (!states[i]) {
+            continue;
+        }
+
+        auto& storage = *states[i]->mStorage;
+        auto& request = requests[i];
+        auto& result  = results[i];
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            numPending++;
+        }
+
+        auto err = ScheduleCreateKey(storage, request.mAlgorithm,
+            [provider, &storage, &request, &result, &mutex, &condVar, &numPending](
+                Error err, std::shared_ptr<PrivateKeyItf> key) {
+                std::vector<uint8_t> der;
+
+                // Sign in the worker as well, so requests of different types are signed in parallel.
+                if (err == Error::eNone) {
+                    err = provider->CreateCSR(*key, request.mParams, der);
+                }
+
+                if (err == Error::eNone) {
+                    pem::Encode(pem::cCertificateRequest, der, result.mCSR);
+                    result.mKey = std::move(key);
+                } else if (key) {
+                    storage.DeleteKey(key);
+                }
+
+                std::lock_guard<std::mutex> lock(mutex);
+
+                result.mError = err;
+
+                if (--numPending == 0) {
+                    condVar.notify_one();
+                }
+            });
+        if (err != Error::eNone) {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            result.mError = err;
+            numPending--;
+        }
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        condVar.wait(lock, [&numPending]() { return numPending == 0; });
+    }
+
+    // Keep created keys to build TLS credentials when issued certificates are applied.
+    for (size_t i = 0; i < requests.size(); i++) {
+        if (results[i].mError == Error::eNone) {
+            AddTLSKey(*states[i], results[i].mKey);
+        }
+    }
+
+    auto failed = std::any_of(
+        results.begin(), results.end(), [](const CSRResult& result) { return result.mError != Error::eNone; });
+
+    return failed ? Error::eFailed : Error::eNone;
+}
+
+Error CertHandler::CreateCSR(const std::string& certType, const std::shared_ptr<PrivateKeyItf>& key,
+    const CSRParams& params, std::string& pemCSR)
+{
+    if (!key) {
+        return Error::eInvalidArgument;
+    }
+
+    CertTypeState* state = nullptr;
+
+    auto err = FindCertType(certType, state);
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    std::vector<uint8_t> der;
+
+    err = mCryptoProvider.load()->CreateCSR(*key, params, der);
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    pemCSR.clear();
+    pem::Encode(pem::cCertificateRequest, der, pemCSR);
+
+    AddTLSKey(*state, key);
+
+    return Error::eNone;
+}
+
+void CertHandler::SetCertStorage(CertStorage& certStorage)
+{
+    mCertStorage = &certStorage;
+}
+
+Error CertHandler::ApplyCert(const std::string& certType, const std::string& pemCert, CertInfo& info)
+{
+    std::vector<CertInfo> infos;
+
+    auto err = ApplyCerts({{certType, pemCert}}, infos);
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    info = std::move(infos.front());
+
+    return Error::eNone;
+}
+
+Error CertHandler::ApplyCerts(const std::vector<ApplyCertRequest>& requests, std::vector<CertInfo>& infos)
+{
+    std::map<std::string, CertTypeState*> states;
+
+    for (const auto& request : requests) {
+        CertTypeState* state = nullptr;
+
+        auto err = FindCertType(request.mCertType, state);
+        if (err != Error::eNone) {
+            return err;
+        }
+
+        states.emplace(request.mCertType, state);
+    }
+
+    auto certStorage = mCertStorage.load();
+    if (!certStorage) {
+        return Error::eWrongState;
+    }
+
+    std::vector<CertChain> chains(requests.size());
+    std::vector<CertItem>  certs;
+
+    for (size_t i = 0; i < requests.size(); i++) {
+        auto err = DecodePEMChain(requests[i].mPEMCert, chains[i]);
+        if (err != Error::eNone) {
+            return err;
+        }
+
+        certs.push_back({requests[i].mCertType, chains[i].front()});
+    }
+
+    {
+        std::vector<std::unique_lock<std::shared_timed_mutex>> locks;
+
+        // Queries of the types see either the previous or the applied certificates together with TLS credentials.
+        // Types are locked in name order, so concurrent applies of overlapping types don't deadlock.
+        for (auto& it : states) {
+            locks.emplace_back(it.second->mMutex);
+        }
+
+        auto err = certStorage->AddCerts(certs, infos);
+        if (err != Error::eNone) {
+            return err;
+        }
+
+        for (size_t i = 0; i < requests.size(); i++) {
+            PublishTLSCredentials(*states.at(requests[i].mCertType), chains[i], infos[i]);
+        }
+    }
+
+    for (const auto& it : states) {
+        ScheduleRenewal(it.first);
+    }
+
+    return Error::eNone;
+}
+
+Error CertHandler::RemoveCerts(const std::string& certType)
+{
+    CertTypeState* state = nullptr;
+
+    auto err = FindCertType(certType, state);
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    auto certStorage = mCertStorage.load();
+    if (!certStorage) {
+        return Error::eWrongState;
+    }
+
+    {
+        std::lock_guard<std::shared_timed_mutex> lock(state->mMutex);
+
+        err = certStorage->RemoveCerts(certType);
+        if (err != Error::eNone) {
+            return err;
+        }
+
+        state->mTLSKeys.clear();
+        state->mTLSSlot->Publish(nullptr);
+    }
+
+    mRenewalScheduler.Cancel(certType);
+
+    return Error::eNone;
+}
+
+Error CertHandler::GetCertificate(const std::string& certType, const std::vector<uint8_t>& issuer,
+    const std::vector<uint8_t>& serial, CertInfo& info)
+{
+    CertTypeState* state = nullptr;
+
+    auto err = FindCertType(certType, state);
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    auto certStorage = mCertStorage.load();
+    if (!certStorage) {
+        return Error::eWrongState;
+    }
+
+    std::shared_lock<std::shared_timed_mutex> lock(state->mMutex);
+
+    if (!serial.empty()) {
+        err = certStorage->FindBySerial(issuer, serial, info);
+        if (err != Error::eNone) {
+            return err;
+        }
+
+        return info.mCertType == certType ? Error::eNone : Error::eNotFound;
+    }
+
+    return GetLatestCert(*certStorage, certType, info);
+}
+
+Error CertHandler::GetTLSCredentialsSlot(const std::string& certType, std::shared_ptr<const TLSCredentialsSlot>& slot)
+{
+    CertTypeState* state = nullptr;
+
+    auto err = FindCertType(certType, state);
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    slot = state->mTLSSlot;
+
+    return Error::eNone;
+}
+
+Error CertHandler::GetTLSCredentials(const std::string& certType, std::shared_ptr<const TLSCredentials>& credentials)
 {
+    std::shared_ptr<const TLSCredentialsSlot> slot;
+
+    auto err = GetTLSCredentialsSlot(certType, slot);
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    credentials = slot->Load();
+    if (!credentials) {
+        return Error::eNotFound;
+    }
+
     return Error::eNone;
 }
 
+void CertHandler::SetCryptoProvider(CryptoProviderItf& provider)
+{
+    mCryptoProvider = &provider;
+}
+
+void CertHandler::SetTrustStore(TrustStore& trustStore)
+{
+    mTrustStore = &trustStore;
+}
+
+Error CertHandler::VerifyCertChain(const CertChain& chain)
+{
+    auto trustStore = mTrustStore.load();
+    if (!trustStore) {
+        return Error::eWrongState;
+    }
+
+    auto             generation = trustStore->GetGeneration();
+    auto             now        = time(nullptr);
+    VerifyCache::Key key;
+
+    auto err = VerifyCache::MakeKey(chain, generation, key);
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    if (mVerifyCache.Lookup(key, generation, now)) {
+        return Error::eNone;
+    }
+
+    auto   start      = std::chrono::steady_clock::now();
+    time_t validUntil = 0;
+
+    err = trustStore->VerifyChain(chain, now, validUntil);
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    mVerifyCache.Add(key, generation, validUntil, std::chrono::steady_clock::now() - start);
+
+    return Error::eNone;
+}
+
+Error CertHandler::VerifySignatures(const std::vector<SignatureItem>& items, std::vector<Error>& results)
+{
+    auto provider = mCryptoProvider.load();
+
+    // Default provider is OpenSSL: verify with public keys parsed once per batch.
+    if (provider == &GetDefaultCryptoProvider()) {
+        return certhandler::VerifySignatures(items, results, &mWorkers);
+    }
+
+    return certhandler::VerifySignatures(items, results, *provider, &mWorkers);
+}
+
+Error CertHandler::ApplyCRL(const std::string& pemCRL)
+{
+    auto trustStore = mTrustStore.load();
+    if (!trustStore) {
+        return Error::eWrongState;
+    }
+
+    pem::Reader          reader(pemCRL);
+    std::string          label;
+    std::vector<uint8_t> der;
+    Error                err   = Error::eNone;
+    size_t               count = 0;
+
+    while ((err = reader.Next(label, der)) == Error::eNone) {
+        if (label != pem::cCRL) {
+            continue;
+        }
+
+        // CRL which is not newer than the current one is skipped: CRL bundles are refetched periodically.
+        err = trustStore->SetCRL(der);
+        if (err != Error::eNone && err != Error::eAlreadyExist) {
+            return err;
+        }
+
+        count++;
+    }
+
+    if (err != Error::eNotFound) {
+        return err;
+    }
+
+    return count > 0 ? Error::eNone : Error::eInvalidArgument;
+}
+
+VerifyCacheMetrics CertHandler::GetVerifyCacheMetrics() const
+{
+    return mVerifyCache.GetMetrics();
+}
+
+Error CertHandler::StartRenewal(const RenewalConfig& config, RenewalScheduler::RenewalCallback callback)
+{
+    if (!mCertStorage.load()) {
+        return Error::eWrongState;
+    }
+
+    auto err = mRenewalScheduler.Start(config, std::move(callback));
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    std::vector<std::string> certTypes;
+
+    {
+        std::shared_lock<std::shared_timed_mutex> lock(mCertTypesMutex);
+
+        for (const auto& it : mCertTypes) {
+            certTypes.push_back(it.first);
+        }
+    }
+
+    for (const auto& certType : certTypes) {
+        ScheduleRenewal(certType);
+    }
+
+    return Error::eNone;
+}
+
+void CertHandler::StopRenewal()
+{
+    mRenewalScheduler.Stop();
+}
+
+Error CertHandler::StartWatch(const WatchConfig& config)
+{
+    auto certStorage = mCertStorage.load();
+    if (!certStorage || (!config.mTrustDir.empty() && !mTrustStore.load())) {
+        return Error::eWrongState;
+    }
+
+    StopWatch();
+
+    std::lock_guard<std::mutex> lock(mWatchMutex);
+
+    mStoragePath = certStorage->GetPath();
+    mTrustDir    = config.mTrustDir;
+    mWatcher     = std::make_unique<FileWatcher>(config.mDebounce);
+
+    mTrustBundles.clear();
+    mTrustAnchorRefs.clear();
+
+    auto err = mWatcher->Start(
+        [this](const std::string& dir, const std::vector<std::string>& names) { OnFilesChanged(dir, names); });
+    if (err == Error::eNone) {
+        err = mWatcher->AddWatch(mStoragePath);
+    }
+
+    if (err == Error::eNone && !mTrustDir.empty()) {
+        err = mWatcher->AddWatch(mTrustDir);
+    }
+
+    if (err != Error::eNone) {
+        mWatcher.reset();
+
+        return err;
+    }
+
+    // Watches are added first, so files changed during the rescan are reloaded again rather than missed.
+    ReloadStorageDir({});
+
+    if (!mTrustDir.empty()) {
+        ReloadTrustBundles({});
+    }
+
+    return Error::eNone;
+}
+
+void CertHandler::StopWatch()
+{
+    std::unique_ptr<FileWatcher> watcher;
+
+    {
+        std::lock_guard<std::mutex> lock(mWatchMutex);
+
+        watcher = std::move(mWatcher);
+    }
+
+    // The watcher thread may wait for the watch mutex.
+    if (watcher) {
+        watcher->Stop();
+    }
+}
+
+/***********************************************************************************************************************
+ * Private
+ **********************************************************************************************************************/
+
+Error CertHandler::DecodePEMChain(const std::string& pemChain, CertChain& chain)
+{
+    pem::Reader          reader(pemChain);
+    std::string          label;
+    std::vector<uint8_t> der;
+    Error                err = Error::eNone;
+
+    while ((err = reader.Next(label, der)) == Error::eNone) {
+        if (label == pem::cCertificate) {
+            chain.push_back(std::move(der));
+        }
+    }
+
+    if (err != Error::eNotFound) {
+        return err;
+    }
+
+    return chain.empty() ? Error::eInvalidArgument : Error::eNone;
+}
+
+Error CertHandler::GetLatestCert(CertStorage& certStorage, const std::string& certType, CertInfo& info)
+{
+    std::vector<CertInfo> certs;
+
+    auto err = certStorage.GetCerts(certType, certs);
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    auto latest = std::max_element(certs.begin(), certs.end(),
+        [](const CertInfo& lhs, const CertInfo& rhs) { return lhs.mNotAfter < rhs.mNotAfter; });
+    if (latest == certs.end()) {
+        return Error::eNotFound;
+    }
+
+    info = *latest;
+
+    return Error::eNone;
+}
+
+void CertHandler::ScheduleRenewal(const std::string& certType)
+{
+    CertInfo info;
+
+    // Renewal follows the latest certificate of the type, applying an older one doesn't postpone it.
+    if (GetCertificate(certType, {}, {}, info) == Error::eNone) {
+        mRenewalScheduler.Schedule(certType, info);
+    }
+}
+
+void CertHandler::AddTLSKey(CertTypeState& state, std::shared_ptr<PrivateKeyItf> key)
+{
+    std::lock_guard<std::shared_timed_mutex> lock(state.mMutex);
+
+    if (state.mTLSKeys.size() == cMaxTLSKeys) {
+        state.mTLSKeys.erase(state.mTLSKeys.begin());
+    }
+
+    state.mTLSKeys.push_back(std::move(key));
+}
+
+void CertHandler::PublishTLSCredentials(CertTypeState& state, const CertChain& chain, const CertInfo& info)
+{
+    X509View leaf;
+
+    if (state.mTLSKeys.empty() || ParseX509(chain.front(), leaf) != Error::eNone) {
+        return;
+    }
+
+    auto credentials = std::make_shared<TLSCredentials>();
+
+    // Hardware backed keys may be slow to export public key, but only operations of the same type wait for it.
+    for (const auto& key : state.mTLSKeys) {
+        std::vector<uint8_t> publicKey;
+
+        if (key->GetPublicKey(publicKey) == Error::eNone
+            && DERView(publicKey.data(), publicKey.size()) == leaf.mPublicKey) {
+            credentials->mKey = key;
+
+            break;
+        }
+    }
+
+    if (!credentials->mKey) {
+        return;
+    }
+
+    for (const auto& der : chain) {
+        auto data = der.data();
+        auto cert = d2i_X509(nullptr, &data, static_cast<long>(der.size()));
+
+        if (!cert) {
+            return;
+        }
+
+        credentials->mChain.emplace_back(cert, X509_free);
+    }
+
+    credentials->mInfo     = info;
+    credentials->mChainDER = chain;
+
+    auto current = state.mTLSSlot->Load();
+
+    // As renewal, TLS credentials follow the latest certificate of the type.
+    if (current && current->mInfo.mNotAfter > info.mNotAfter) {
+        return;
+    }
+
+    credentials->mGeneration = current ? current->mGeneration + 1 : 1;
+
+    state.mTLSSlot->Publish(std::move(credentials));
+}
+
+Error CertHandler::FindCertType(const std::string& certType, CertTypeState*& state)
+{
+    std::shared_lock<std::shared_timed_mutex> lock(mCertTypesMutex);
+
+    auto it = mCertTypes.find(certType);
+    if (it == mCertTypes.end()) {
+        return Error::eNotFound;
+    }
+
+    state = it->second.get();
+
+    return Error::eNone;
+}
+
+Error CertHandler::ScheduleCreateKey(KeyStorageItf& storage, KeyAlgorithm algorithm, CreateKeyCallback callback)
+{
+    std::shared_ptr<PrivateKeyItf> key;
+
+    if (TakePooledKey(storage, algorithm, key)) {
+        auto err = mWorkers.AddJob([callback, key]() { callback(Error::eNone, key); });
+        if (err != Error::eNone) {
+            std::lock_guard<std::mutex> lock(mMutex);
+
+            mStorages[&storage].mKeyPools[algorithm].mKeys.push_front({key, std::chrono::steady_clock::now()});
+        }
+
+        return err;
+    }
+
+    return ScheduleJob(storage, [&storage, algorithm, callback]() {
+        std::shared_ptr<PrivateKeyItf> key;
+
+        auto err = storage.CreateKey(algorithm, key);
+
+        callback(err, err == Error::eNone ? key : nullptr);
+    });
+}
+
+Error CertHandler::ScheduleJob(KeyStorageItf& storage, ThreadPool::Job job)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    auto& state = mStorages[&storage];
+
+    if (state.mRunningJobs < storage.GetMaxConcurrency()) {
+        auto err = mWorkers.AddJob([this, &storage, job]() { RunJobs(storage, job); });
+        if (err != Error::eNone) {
+            return err;
+        }
+
+        state.mRunningJobs++;
+
+        return Error::eNone;
+    }
+
+    if (mNumPendingJobs >= cMaxPendingJobs) {
+        return Error::eNoMemory;
+    }
+
+    state.mPendingJobs.push_back(std::move(job));
+    mNumPendingJobs++;
+
+    return Error::eNone;
+}
+
+void CertHandler::RunJobs(KeyStorageItf& storage, ThreadPool::Job job)
+{
+    // Keep the storage slot and execute jobs queued for the same storage in this worker.
+    while (true) {
+        job();
+
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        auto& state = mStorages[&storage];
+
+        if (state.mPendingJobs.empty()) {
+            state.mRunningJobs--;
+
+            ScheduleRefill(storage, state);
+
+            return;
+        }
+
+        job = std::move(state.mPendingJobs.front());
+
+        state.mPendingJobs.pop_front();
+        mNumPendingJobs--;
+    }
+}
+
+bool CertHandler::TakePooledKey(KeyStorageItf& storage, KeyAlgorithm algorithm, std::shared_ptr<PrivateKeyItf>& key)
+{
+    KeyList expiredKeys;
+    bool    secureDispose = false;
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        auto& state = mStorages[&storage];
+
+        auto it = state.mKeyPools.find(algorithm);
+        if (it == state.mKeyPools.end()) {
+            return false;
+        }
+
+        auto& pool   = it->second;
+        auto  now    = std::chrono::steady_clock::now();
+        auto  maxAge = pool.mConfig.mMaxKeyAge;
+
+        secureDispose = pool.mConfig.mSecureDispose;
+
+        while (!pool.mKeys.empty()) {
+            auto pooledKey = std::move(pool.mKeys.front());
+
+            pool.mKeys.pop_front();
+
+            if (maxAge.count() != 0 && now - pooledKey.mCreated > maxAge) {
+                expiredKeys.push_back(std::move(pooledKey.mKey));
+
+                continue;
+            }
+
+            key = std::move(pooledKey.mKey);
+
+            break;
+        }
+
+        pool.mRefillFailed = false;
+
+        ScheduleRefill(storage, state);
+    }
+
+    DisposeKeys(storage, expiredKeys, secureDispose);
+
+    return key != nullptr;
+}
+
+void CertHandler::ScheduleRefill(KeyStorageItf& storage, StorageState& state)
+{
+    if (mShutdown || state.mPoolsSuspended) {
+        return;
+    }
+
+    for (auto& it : state.mKeyPools) {
+        auto  algorithm = it.first;
+        auto& pool      = it.second;
+
+        if (pool.mRefillScheduled || pool.mRefillFailed || pool.mKeys.size() >= pool.mConfig.mSize) {
+            continue;
+        }
+
+        auto priority = pool.mConfig.mIdleRefill ? ThreadPool::Priority::eIdle : ThreadPool::Priority::eNormal;
+
+        if (mWorkers.AddJob([this, &storage, algorithm]() { RefillPool(storage, algorithm); }, priority)
+            == Error::eNone) {
+            pool.mRefillScheduled = true;
+        }
+    }
+}
+
+void CertHandler::RefillPool(KeyStorageItf& storage, KeyAlgorithm algorithm)
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        auto& state = mStorages[&storage];
+        auto& pool  = state.mKeyPools[algorithm];
+
+        pool.mRefillScheduled = false;
+
+        // If the storage is busy, refill is rescheduled when the running job releases the storage slot.
+        if (mShutdown || state.mPoolsSuspended || pool.mKeys.size() >= pool.mConfig.mSize
+            || state.mRunningJobs >= storage.GetMaxConcurrency()) {
+            return;
+        }
+
+        state.mRunningJobs++;
+        state.mRunningRefills++;
+    }
+
+    RunJobs(storage, [this, &storage, algorithm]() {
+        std::shared_ptr<PrivateKeyItf> key;
+
+        auto err = storage.CreateKey(algorithm, key);
+
+        std::unique_lock<std::mutex> lock(mMutex);
+
+        auto& state = mStorages[&storage];
+        auto& pool  = state.mKeyPools[algorithm];
+
+        state.mRunningRefills--;
+        mRefillCondVar.notify_all();
+
+        if (err != Error::eNone) {
+            // Don't retry in a loop, the next pool access triggers refill again.
+            pool.mRefillFailed = true;
+
+            return;
+        }
+
+        if (!mShutdown && pool.mKeys.size() < pool.mConfig.mSize) {
+            pool.mKeys.push_back({std::move(key), std::chrono::steady_clock::now()});
+
+            return;
+        }
+
+        auto secureDispose = pool.mConfig.mSecureDispose;
+
+        lock.unlock();
+
+        DisposeKeys(storage, {key}, secureDispose);
+    });
+}
+
+void CertHandler::DisposeKeys(KeyStorageItf& storage, const KeyList& keys, bool secure)
+{
+    if (!secure) {
+        return;
+    }
+
+    for (const auto& key : keys) {
+        storage.DeleteKey(key);
+    }
+}
+
+void CertHandler::OnFilesChanged(const std::string& dir, const std::vector<std::string>& names)
+{
+    std::lock_guard<std::mutex> lock(mWatchMutex);
+
+    if (!mWatcher) {
+        return;
+    }
+
+    if (dir == mTrustDir) {
+        ReloadTrustBundles(names);
+    } else if (dir == mStoragePath) {
+        ReloadStorageDir(names);
+    } else if (dir.compare(0, mStoragePath.size() + 1, mStoragePath + "/") == 0) {
+        ReloadCertType(dir.substr(mStoragePath.size() + 1), names);
+    }
+}
+
+void CertHandler::ReloadStorageDir(const std::vector<std::string>& names)
+{
+    std::set<std::string> certTypes(names.begin(), names.end());
+
+    if (names.empty()) {
+        ListDir(mStoragePath, certTypes);
+    }
+
+    // Certificate type directories are watched once they appear, removed ones drop certificates of the type.
+    for (const auto& certType : certTypes) {
+        auto        path = mStoragePath + "/" + certType;
+        struct stat st;
+
+        if (stat(path.c_str(), &st) == 0) {
+            if (!S_ISDIR(st.st_mode) || mWatcher->AddWatch(path) != Error::eNone) {
+                continue;
+            }
+        } else if (errno != ENOENT) {
+            continue;
+        }
+
+        ReloadCertType(certType, {});
+    }
+}
+
+void CertHandler::ReloadCertType(const std::string& certType, const std::vector<std::string>& names)
+{
+    auto           certStorage = mCertStorage.load();
+    CertTypeState* state       = nullptr;
+    bool           changed     = false;
+
+    // Certificates of unregistered types are reloaded as well to keep the storage index in sync with the files.
+    if (FindCertType(certType, state) != Error::eNone) {
+        certStorage->ReloadFiles(certType, names, changed);
+
+        return;
+    }
+
+    {
+        std::lock_guard<std::shared_timed_mutex> lock(state->mMutex);
+
+        if (certStorage->ReloadFiles(certType, names, changed) != Error::eNone || !changed) {
+            return;
+        }
+
+        // As on RemoveCerts(), credentials of a removed certificate are dropped.
+        auto     credentials = state->mTLSSlot->Load();
+        CertInfo info;
+
+        if (credentials && certStorage->FindByFingerprint(credentials->mInfo.mFingerprint, info) != Error::eNone) {
+            state->mTLSSlot->Publish(nullptr);
+        }
+    }
+
+    CertInfo info;
+
+    if (GetCertificate(certType, {}, {}, info) == Error::eNone) {
+        mRenewalScheduler.Schedule(certType, info);
+    } else {
+        mRenewalScheduler.Cancel(certType);
+    }
+}
+
+void CertHandler::ReloadTrustBundles(const std::vector<std::string>& names)
+{
+    std::set<std::string> bundles(names.begin(), names.end());
+
+    if (names.empty()) {
+        ListDir(mTrustDir, bundles);
+
+        for (const auto& it : mTrustBundles) {
+            bundles.insert(it.first);
+        }
+    }
+
+    // Anchors are reference counted, so an anchor moved between bundles or present in several ones stays trusted.
+    CertChain added, removed;
+
+    for (const auto& bundle : bundles) {
+        CertChain anchors;
+
+        if (!IsBundleFile(bundle)) {
+            continue;
+        }
+
+        // A bundle which can't be read or parsed keeps its previous anchors until it is fixed or removed.
+        auto err = ReadTrustBundle(mTrustDir + "/" + bundle, anchors);
+        if (err != Error::eNone && err != Error::eNotFound) {
+            continue;
+        }
+
+        for (const auto& der : anchors) {
+            if (mTrustAnchorRefs[der]++ == 0) {
+                added.push_back(der);
+            }
+        }
+
+        for (const auto& der : mTrustBundles[bundle]) {
+            auto it = mTrustAnchorRefs.find(der);
+
+            if (--it->second == 0) {
+                mTrustAnchorRefs.erase(it);
+                removed.push_back(der);
+            }
+        }
+
+        if (anchors.empty()) {
+            mTrustBundles.erase(bundle);
+        } else {
+            mTrustBundles[bundle] = std::move(anchors);
+        }
+    }
+
+    if (!added.empty() || !removed.empty()) {
+        mTrustStore.load()->UpdateTrustAnchors(added, removed);
+    }
+}
+
 } // namespace certhandler
 } // namespace iam
 } // namespace aos
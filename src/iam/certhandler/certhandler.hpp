@@ -18,7 +18,30 @@
 #ifndef CERTHANDLER_HPP_
 #define CERTHANDLER_HPP_
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+#include "certstorage.hpp"
+#include "cryptoprovider.hpp"
+#include "csr.hpp"
 #include "error/error.hpp"
+#include "keystorage.hpp"
+#include "renewalscheduler.hpp"
+#include "signature.hpp"
+#include "tlscredentials.hpp"
+#include "tools/filewatcher.hpp"
+#include "tools/threadpool.hpp"
+#include "truststore.hpp"
+#include "verifycache.hpp"
 
 namespace aos {
 namespace iam {
@@ -28,17 +51,474 @@ namespace certhandler {
  *  @{
  */
 
+/**
+ * Pre-generated key pool configuration.
+ */
+struct KeyPoolConfig {
+    /**
+     * Number of pre-generated keys, 0 disables the pool.
+     */
+    size_t mSize = 0;
+
+    /**
+     * Refill the pool only when there are no other requests to process.
+     */
+    bool mIdleRefill = true;
+
+    /**
+     * Max age of a pooled key, older keys are disposed instead of being returned. 0 means unlimited.
+     */
+    std::chrono::seconds mMaxKeyAge {0};
+
+    /**
+     * Delete disposed keys from the key storage.
+     */
+    bool mSecureDispose = true;
+};
+
+/**
+ * Certificate signing request of the certificate type.
+ */
+struct CSRRequest {
+    /**
+     * Certificate type.
+     */
+    std::string mCertType;
+
+    /**
+     * Key algorithm.
+     */
+    KeyAlgorithm mAlgorithm = KeyAlgorithm::eECDSAP256;
+
+    /**
+     * Request parameters.
+     */
+    CSRParams mParams;
+};
+
+/**
+ * Result of certificate signing request creation.
+ */
+struct CSRResult {
+    /**
+     * Certificate type.
+     */
+    std::string mCertType;
+
+    /**
+     * Error of the certificate type request.
+     */
+    Error mError = Error::eNone;
+
+    /**
+     * Created key, set on success.
+     */
+    std::shared_ptr<PrivateKeyItf> mKey;
+
+    /**
+     * PEM encoded certificate signing request, set on success.
+     */
+    std::string mCSR;
+};
+
+/**
+ * Certificate to apply.
+ */
+struct ApplyCertRequest {
+    /**
+     * Certificate type.
+     */
+    std::string mCertType;
+
+    /**
+     * PEM encoded certificate, optionally followed by the rest of the chain.
+     */
+    std::string mPEMCert;
+};
+
+/**
+ * Certificate files watch configuration.
+ */
+struct WatchConfig {
+    /**
+     * Directory of PEM CA bundles applied to the trust store, empty to watch the certificate storage only.
+     */
+    std::string mTrustDir;
+
+    /**
+     * Quiet interval before changed files are reloaded.
+     */
+    std::chrono::milliseconds mDebounce {FileWatcher::cDefaultDebounce};
+};
+
 /**
  * Handles keys and certificates.
+ *
+ * Certificate types are locked independently: certificate apply of a type excludes other operations of the same type
+ * only, queries of a type run in parallel. Key generation doesn't lock the type at all.
  */
 class CertHandler {
 public:
     /**
-     * Creates key.
+     * Create key completion callback. Called from worker thread.
+     */
+    using CreateKeyCallback = std::function<void(Error err, std::shared_ptr<PrivateKeyItf> key)>;
+
+    /**
+     * Default number of key generation workers.
+     */
+    static constexpr size_t cDefaultNumWorkers = 2;
+
+    /**
+     * Max number of key generation requests waiting for execution.
+     */
+    static constexpr size_t cMaxPendingJobs = 64;
+
+    /**
+     * Max number of cached chain verification results.
+     */
+    static constexpr size_t cVerifyCacheSize = 1024;
+
+    /**
+     * Max number of keys of created requests kept per certificate type to build TLS credentials on apply.
+     */
+    static constexpr size_t cMaxTLSKeys = 4;
+
+    /**
+     * Creates cert handler.
+     *
+     * @param numWorkers number of key generation workers.
+     */
+    explicit CertHandler(size_t numWorkers = cDefaultNumWorkers);
+
+    /**
+     * Destroys cert handler. Waits for pending key generation requests.
+     */
+    ~CertHandler();
+
+    /**
+     * Registers certificate type.
+     *
+     * @param certType certificate type.
+     * @param storage key storage backend used for the certificate type.
+     * @return Error.
+     */
+    Error RegisterCertType(const std::string& certType, KeyStorageItf& storage);
+
+    /**
+     * Configures pre-generated key pool of the storage for the key algorithm. The pool is shared by all certificate
+     * types which use the storage and is refilled in background.
+     *
+     * @param storage registered key storage.
+     * @param algorithm key algorithm.
+     * @param config pool configuration.
+     * @return Error.
+     */
+    Error ConfigureKeyPool(KeyStorageItf& storage, KeyAlgorithm algorithm, const KeyPoolConfig& config);
+
+    /**
+     * Suspends key pools of the storage before its keys are invalidated, e.g. the storage is cleared: waits for
+     * running refills and disposes pooled keys. Suspended pools are not refilled and don't return keys.
+     *
+     * @param storage registered key storage.
+     * @return Error.
+     */
+    Error SuspendKeyPools(KeyStorageItf& storage);
+
+    /**
+     * Resumes suspended key pools of the storage and schedules refill.
      *
-     * @return Error
+     * @param storage registered key storage.
+     * @return Error.
      */
-    Error CreateKey();
+    Error ResumeKeyPools(KeyStorageItf& storage);
+
+    /**
+     * Creates key. Returns pre-generated key immediately if the key pool is not empty.
+     *
+     * Must not be called from create key callback as it waits for key generation worker.
+     *
+     * @param certType certificate type.
+     * @param algorithm key algorithm.
+     * @param[out] key created key.
+     * @return Error.
+     */
+    Error CreateKey(const std::string& certType, KeyAlgorithm algorithm, std::shared_ptr<PrivateKeyItf>& key);
+
+    /**
+     * Creates key asynchronously. Key is taken from the key pool or generated on the worker pool, not more than storage
+     * max concurrency requests are executed in parallel for the same key storage.
+     *
+     * @param certType certificate type.
+     * @param algorithm key algorithm.
+     * @param callback completion callback, not called if error is returned.
+     * @return Error.
+     */
+    Error CreateKeyAsync(const std::string& certType, KeyAlgorithm algorithm, CreateKeyCallback callback);
+
+    /**
+     * Creates key and certificate signing request.
+     *
+     * Must not be called from create key callback as it waits for key generation worker.
+     *
+     * @param request request.
+     * @param[out] result created key and request.
+     * @return Error.
+     */
+    Error CreateCSR(const CSRRequest& request, CSRResult& result);
+
+    /**
+     * Creates keys and certificate signing requests for several certificate types in parallel. Storages of all types
+     * are resolved at once, key generation and signing of each type run on the worker pool within the storage
+     * concurrency limit. If a key is created but the request fails, the key is deleted.
+     *
+     * Must not be called from create key callback as it waits for key generation workers.
+     *
+     * @param requests requests.
+     * @param[out] results results in the order of requests.
+     * @return Error eFailed if any request failed, see per type errors in results.
+     */
+    Error CreateCSRs(const std::vector<CSRRequest>& requests, std::vector<CSRResult>& results);
+
+    /**
+     * Creates certificate signing request for the existing key of the certificate type. The key is kept to build TLS
+     * credentials as by CreateCSR().
+     *
+     * @param certType registered certificate type.
+     * @param key key created by the type storage.
+     * @param params request parameters.
+     * @param[out] pemCSR PEM encoded request.
+     * @return Error.
+     */
+    Error CreateCSR(const std::string& certType, const std::shared_ptr<PrivateKeyItf>& key, const CSRParams& params,
+        std::string& pemCSR);
+
+    /**
+     * Sets certificate storage used to apply and get certificates.
+     *
+     * @param certStorage initialized certificate storage.
+     */
+    void SetCertStorage(CertStorage& certStorage);
+
+    /**
+     * Applies PEM certificate to the certificate type. If the certificate key was created by CreateCSR() or
+     * CreateCSRs() and the certificate is the latest one of the type, TLS credentials of the type are replaced.
+     *
+     * @param certType registered certificate type.
+     * @param pemCert PEM encoded certificate, optionally followed by the rest of the chain.
+     * @param[out] info applied certificate info.
+     * @return Error.
+     */
+    Error ApplyCert(const std::string& certType, const std::string& pemCert, CertInfo& info);
+
+    /**
+     * Applies certificates of one or several certificate types atomically: either all certificates are stored or none,
+     * also across power loss. TLS credentials are replaced as by ApplyCert().
+     *
+     * @param requests certificates to apply.
+     * @param[out] infos applied certificates info in the order of requests.
+     * @return Error.
+     */
+    Error ApplyCerts(const std::vector<ApplyCertRequest>& requests, std::vector<CertInfo>& infos);
+
+    /**
+     * Removes all certificates of the certificate type with one storage journal record. Published TLS credentials and
+     * kept keys of the type are dropped, renewal of the type is canceled. Keys are not deleted from the storage.
+     *
+     * @param certType registered certificate type.
+     * @return Error.
+     */
+    Error RemoveCerts(const std::string& certType);
+
+    /**
+     * Returns certificate by issuer and serial number. If serial is empty, returns certificate of the type with the
+     * latest validity end.
+     *
+     * @param certType certificate type.
+     * @param issuer DER encoded issuer name.
+     * @param serial serial number.
+     * @param[out] info certificate info.
+     * @return Error.
+     */
+    Error GetCertificate(const std::string& certType, const std::vector<uint8_t>& issuer,
+        const std::vector<uint8_t>& serial, CertInfo& info);
+
+    /**
+     * Returns TLS credentials slot of the certificate type. The slot stays valid after the handler is destroyed.
+     *
+     * @param certType registered certificate type.
+     * @param[out] slot TLS credentials slot.
+     * @return Error.
+     */
+    Error GetTLSCredentialsSlot(const std::string& certType, std::shared_ptr<const TLSCredentialsSlot>& slot);
+
+    /**
+     * Returns current TLS credentials of the certificate type.
+     *
+     * @param certType registered certificate type.
+     * @param[out] credentials TLS credentials.
+     * @return Error eNotFound if no credentials are published.
+     */
+    Error GetTLSCredentials(const std::string& certType, std::shared_ptr<const TLSCredentials>& credentials);
+
+    /**
+     * Sets crypto provider used to encode certificate signing requests and verify signatures, OpenSSL provider is used
+     * by default. The provider must support keys of all registered storages.
+     *
+     * @param provider crypto provider.
+     */
+    void SetCryptoProvider(CryptoProviderItf& provider);
+
+    /**
+     * Sets trust store used to verify certificate chains.
+     *
+     * @param trustStore trust store.
+     */
+    void SetTrustStore(TrustStore& trustStore);
+
+    /**
+     * Verifies certificate chain against the trust store. Successful results are cached until a chain certificate
+     * expires, CRL next update time is reached or the trust store is changed.
+     *
+     * @param chain certificate chain.
+     * @return Error eNone if chain is trusted.
+     */
+    Error VerifyCertChain(const CertChain& chain);
+
+    /**
+     * Verifies signatures of multiple items, for example signed manifests of a desired state, on the worker pool.
+     * Signatures are verified by the crypto provider set with SetCryptoProvider().
+     *
+     * Must not be called from create key callback as it waits for workers.
+     *
+     * @param items signed items.
+     * @param[out] results verification results in the order of items.
+     * @return Error eFailed if any signature is not valid.
+     */
+    Error VerifySignatures(const std::vector<SignatureItem>& items, std::vector<Error>& results);
+
+    /**
+     * Applies PEM CRLs to the trust store. A CRL replaces the previous CRL of the same issuer, CRLs which are not newer
+     * than the current ones are skipped.
+     *
+     * @param pemCRL PEM encoded CRLs.
+     * @return Error.
+     */
+    Error ApplyCRL(const std::string& pemCRL);
+
+    /**
+     * Returns chain verification cache metrics.
+     *
+     * @return VerifyCacheMetrics.
+     */
+    VerifyCacheMetrics GetVerifyCacheMetrics() const;
+
+    /**
+     * Starts certificate renewal scheduling. The latest certificate of each registered type is scheduled from the
+     * certificate storage, applied certificates replace scheduled ones. Renewal callback is called at the configured
+     * lead time before expiration and must not call StopRenewal().
+     *
+     * @param config renewal configuration.
+     * @param callback renewal callback.
+     * @return Error.
+     */
+    Error StartRenewal(const RenewalConfig& config, RenewalScheduler::RenewalCallback callback);
+
+    /**
+     * Stops certificate renewal scheduling.
+     */
+    void StopRenewal();
+
+    /**
+     * Starts watching certificate files. Certificate files added or removed in the certificate storage by external
+     * tools are reloaded into its index, bundles of the trust directory are applied to the trust store. Only changed
+     * files are reparsed. Files changed before the start are loaded by an initial rescan, which doesn't read files of
+     * already indexed certificates.
+     *
+     * @param config watch configuration.
+     * @return Error.
+     */
+    Error StartWatch(const WatchConfig& config);
+
+    /**
+     * Stops watching certificate files.
+     */
+    void StopWatch();
+
+private:
+    using KeyList    = std::vector<std::shared_ptr<PrivateKeyItf>>;
+    using TLSSlotPtr = std::shared_ptr<TLSCredentialsSlot>;
+
+    struct PooledKey {
+        std::shared_ptr<PrivateKeyItf>        mKey;
+        std::chrono::steady_clock::time_point mCreated;
+    };
+
+    struct KeyPool {
+        KeyPoolConfig         mConfig;
+        std::deque<PooledKey> mKeys;
+        bool                  mRefillScheduled = false;
+        bool                  mRefillFailed = false;
+    };
+
+    struct StorageState {
+        size_t                          mRunningJobs = 0;
+        std::deque<ThreadPool::Job>     mPendingJobs;
+        std::map<KeyAlgorithm, KeyPool> mKeyPools;
+        size_t                          mRunningRefills = 0;
+        bool                            mPoolsSuspended = false;
+    };
+
+    struct CertTypeState {
+        KeyStorageItf*          mStorage = nullptr;
+        TLSSlotPtr              mTLSSlot;
+        KeyList                 mTLSKeys;
+        std::shared_timed_mutex mMutex;
+    };
+
+    using CertTypeStatePtr = std::unique_ptr<CertTypeState>;
+
+    static Error DecodePEMChain(const std::string& pemChain, CertChain& chain);
+
+    Error        FindCertType(const std::string& certType, CertTypeState*& state);
+    Error        GetLatestCert(CertStorage& certStorage, const std::string& certType, CertInfo& info);
+    void         ScheduleRenewal(const std::string& certType);
+    void         PublishTLSCredentials(CertTypeState& state, const CertChain& chain, const CertInfo& info);
+    void         AddTLSKey(CertTypeState& state, std::shared_ptr<PrivateKeyItf> key);
+    Error        ScheduleCreateKey(KeyStorageItf& storage, KeyAlgorithm algorithm, CreateKeyCallback callback);
+    Error        ScheduleJob(KeyStorageItf& storage, ThreadPool::Job job);
+    void         RunJobs(KeyStorageItf& storage, ThreadPool::Job job);
+    bool         TakePooledKey(KeyStorageItf& storage, KeyAlgorithm algorithm, std::shared_ptr<PrivateKeyItf>& key);
+    void         ScheduleRefill(KeyStorageItf& storage, StorageState& state);
+    void         RefillPool(KeyStorageItf& storage, KeyAlgorithm algorithm);
+    void         DisposeKeys(KeyStorageItf& storage, const KeyList& keys, bool secure);
+    void         OnFilesChanged(const std::string& dir, const std::vector<std::string>& names);
+    void         ReloadStorageDir(const std::vector<std::string>& names);
+    void         ReloadCertType(const std::string& certType, const std::vector<std::string>& names);
+    void         ReloadTrustBundles(const std::vector<std::string>& names);
+
+    // Registered types are never removed, so a found type state stays valid without holding the types mutex.
+    std::shared_timed_mutex                 mCertTypesMutex;
+    std::map<std::string, CertTypeStatePtr> mCertTypes;
+    std::mutex                              mMutex;
+    std::map<KeyStorageItf*, StorageState>  mStorages;
+    std::condition_variable                 mRefillCondVar;
+    size_t                                  mNumPendingJobs = 0;
+    bool                                    mShutdown = false;
+    std::atomic<CertStorage*>               mCertStorage {nullptr};
+    std::atomic<TrustStore*>                mTrustStore {nullptr};
+    std::atomic<CryptoProviderItf*>         mCryptoProvider {&GetDefaultCryptoProvider()};
+    VerifyCache                             mVerifyCache;
+    RenewalScheduler                        mRenewalScheduler;
+    ThreadPool                              mWorkers;
+
+    // Watch state is used by the watcher thread and by the initial rescan, both hold the watch mutex.
+    std::mutex                             mWatchMutex;
+    std::unique_ptr<FileWatcher>           mWatcher;
+    std::string                            mStoragePath;
+    std::string                            mTrustDir;
+    std::map<std::string, CertChain>       mTrustBundles;
+    std::map<std::vector<uint8_t>, size_t> mTrustAnchorRefs;
 };
 
 /** @}*/
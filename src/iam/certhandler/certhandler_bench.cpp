@@ -0,0 +1,287 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include <benchmark/benchmark.h>
+
+#include "certhandler.hpp"
+#include "swkeystorage.hpp"
+#include "testcerts.hpp"
+
+using namespace aos;
+using namespace aos::iam::certhandler;
+using namespace aos::iam::certhandler::test;
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+namespace {
+
+enum class Background {
+    eIdle,
+    eCreateKey,
+    eApplyCert,
+};
+
+// Runs operations on the "offline" certificate type in background while "online" type is queried.
+class BackgroundLoad {
+public:
+    BackgroundLoad(CertHandler& handler, Background background)
+    {
+        if (background == Background::eIdle) {
+            return;
+        }
+
+        mThread = std::thread([this, &handler, background]() {
+            auto key    = GenerateTestKey();
+            long serial = 1;
+
+            while (!mStop) {
+                if (background == Background::eCreateKey) {
+                    std::shared_ptr<PrivateKeyItf> createdKey;
+
+                    handler.CreateKey("offline", KeyAlgorithm::eRSA2048, createdKey);
+                } else {
+                    TestCertParams params;
+                    CertInfo       info;
+
+                    params.mSerial = serial++;
+
+                    handler.ApplyCert("offline", ConvertToPEM(CreateTestCert(params, key.get())), info);
+                }
+            }
+        });
+    }
+
+    ~BackgroundLoad()
+    {
+        mStop = true;
+
+        if (mThread.joinable()) {
+            mThread.join();
+        }
+    }
+
+private:
+    std::atomic_bool mStop {false};
+    std::thread      mThread;
+};
+
+// Handler with a certificate type per benchmark thread, so threads contend only on shared state. The key storage runs
+// as many operations in parallel as there are benchmark threads, otherwise key operations are serialized by the
+// storage concurrency limit.
+class LoadHandler {
+public:
+    static constexpr int cNumCertTypes = 16;
+
+    LoadHandler()
+    {
+        mCertStorage.Init(mDir.GetPath());
+        mHandler.SetCertStorage(mCertStorage);
+
+        for (int i = 0; i < cNumCertTypes; i++) {
+            CertInfo info;
+
+            mHandler.RegisterCertType(GetCertType(i), mStorage);
+            mHandler.RegisterCertType(GetApplyCertType(i), mStorage);
+            mHandler.ApplyCert(GetCertType(i), CreateCert(), info);
+        }
+    }
+
+    CertHandler& GetHandler() { return mHandler; }
+
+    static std::string GetCertType(int index) { return "type" + std::to_string(index % cNumCertTypes); }
+
+    // Applied certificates are accumulated by separate types to keep lookups independent of the benchmark order.
+    static std::string GetApplyCertType(int index) { return "apply" + std::to_string(index % cNumCertTypes); }
+
+    std::string CreateCert()
+    {
+        TestCertParams params;
+
+        params.mSerial = mSerial++;
+
+        return ConvertToPEM(CreateTestCert(params, mKey.get()));
+    }
+
+private:
+    TempDir           mDir;
+    CertStorage       mCertStorage;
+    SWKeyStorage      mStorage {cNumCertTypes};
+    CertHandler       mHandler;
+    TestKeyPtr        mKey = GenerateTestKey();
+    std::atomic<long> mSerial {1};
+};
+
+LoadHandler& GetLoadHandler()
+{
+    static LoadHandler sHandler;
+
+    return sHandler;
+}
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Benchmarks
+ **********************************************************************************************************************/
+
+// Latency of certificate and TLS credentials queries of one type while another type generates keys or applies
+// certificates.
+static void Query(benchmark::State& state, Background background)
+{
+    TempDir      dir;
+    CertStorage  certStorage;
+    SWKeyStorage storage;
+    CertHandler  handler;
+    CertInfo     info;
+
+    if (certStorage.Init(dir.GetPath()) != Error::eNone || handler.RegisterCertType("online", storage) != Error::eNone
+        || handler.RegisterCertType("offline", storage) != Error::eNone) {
+        state.SkipWithError("init failed");
+
+        return;
+    }
+
+    handler.SetCertStorage(certStorage);
+
+    auto key = GenerateTestKey();
+
+    if (handler.ApplyCert("online", ConvertToPEM(CreateTestCert({}, key.get())), info) != Error::eNone) {
+        state.SkipWithError("apply failed");
+
+        return;
+    }
+
+    BackgroundLoad load(handler, background);
+    double         maxLatency = 0;
+
+    for (auto _ : state) {
+        std::shared_ptr<const TLSCredentials> credentials;
+
+        auto start = std::chrono::steady_clock::now();
+
+        if (handler.GetCertificate("online", {}, {}, info) != Error::eNone) {
+            state.SkipWithError("query failed");
+
+            break;
+        }
+
+        handler.GetTLSCredentials("online", credentials);
+
+        maxLatency = std::max(maxLatency,
+            std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    state.counters["max_us"] = maxLatency;
+}
+
+BENCHMARK_CAPTURE(Query, Idle, Background::eIdle)->UseRealTime();
+BENCHMARK_CAPTURE(Query, CreateKey, Background::eCreateKey)->UseRealTime();
+BENCHMARK_CAPTURE(Query, ApplyCert, Background::eApplyCert)->UseRealTime();
+
+static void CreateKey(benchmark::State& state, KeyAlgorithm algorithm)
+{
+    auto& handler  = GetLoadHandler().GetHandler();
+    auto  certType = LoadHandler::GetCertType(state.thread_index());
+
+    for (auto _ : state) {
+        std::shared_ptr<PrivateKeyItf> key;
+
+        if (handler.CreateKey(certType, algorithm, key) != Error::eNone) {
+            state.SkipWithError("create key failed");
+
+            break;
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void CreateCSR(benchmark::State& state)
+{
+    auto&      handler = GetLoadHandler().GetHandler();
+    CSRRequest request {LoadHandler::GetCertType(state.thread_index()), KeyAlgorithm::eECDSAP256, {"bench", {}}};
+
+    for (auto _ : state) {
+        CSRResult result;
+
+        if (handler.CreateCSR(request, result) != Error::eNone) {
+            state.SkipWithError("create CSR failed");
+
+            break;
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void ApplyCert(benchmark::State& state)
+{
+    auto& loadHandler = GetLoadHandler();
+    auto  certType    = LoadHandler::GetApplyCertType(state.thread_index());
+
+    for (auto _ : state) {
+        CertInfo info;
+
+        // Certificate signing is not a part of the measured operation.
+        state.PauseTiming();
+        auto cert = loadHandler.CreateCert();
+        state.ResumeTiming();
+
+        if (loadHandler.GetHandler().ApplyCert(certType, cert, info) != Error::eNone) {
+            state.SkipWithError("apply failed");
+
+            break;
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void GetCertificate(benchmark::State& state)
+{
+    auto& handler  = GetLoadHandler().GetHandler();
+    auto  certType = LoadHandler::GetCertType(state.thread_index());
+
+    for (auto _ : state) {
+        CertInfo info;
+
+        if (handler.GetCertificate(certType, {}, {}, info) != Error::eNone) {
+            state.SkipWithError("lookup failed");
+
+            break;
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Throughput of handler operations under single-threaded and multi-threaded load. Permission checks are measured by
+// permhandler_bench.cpp.
+BENCHMARK_CAPTURE(CreateKey, ECDSAP256, KeyAlgorithm::eECDSAP256)->Threads(1)->Threads(4)->UseRealTime();
+BENCHMARK_CAPTURE(CreateKey, RSA2048, KeyAlgorithm::eRSA2048)->Threads(1)->Threads(4)->UseRealTime();
+BENCHMARK(CreateCSR)->Threads(1)->Threads(4)->UseRealTime();
+BENCHMARK(ApplyCert)->Threads(1)->Threads(4)->UseRealTime();
+BENCHMARK(GetCertificate)->ThreadRange(1, 16)->UseRealTime();
@@ -15,16 +15,1077 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <future>
+#include <mutex>
+#include <thread>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include <gtest/gtest.h>
 
 #include "certhandler.hpp"
+#include "encoding/pem.hpp"
+#include "swkeystorage.hpp"
+#include "testcerts.hpp"
+
+using namespace aos;
+using namespace aos::iam::certhandler;
+using namespace aos::iam::certhandler::test;
+
+/***********************************************************************************************************************
+ * Mocks
+ **********************************************************************************************************************/
+
+class TestKey : public PrivateKeyItf {
+public:
+    explicit TestKey(KeyAlgorithm algorithm)
+        : mAlgorithm(algorithm)
+    {
+    }
+
+    KeyAlgorithm GetAlgorithm() const override { return mAlgorithm; }
+
+    Error GetPublicKey(std::vector<uint8_t>& der) const override
+    {
+        der = {0x30, 0x00};
+
+        return Error::eNone;
+    }
+
+    Error Sign(const std::vector<uint8_t>&, std::vector<uint8_t>& signature) const override
+    {
+        signature = {0x00};
+
+        return Error::eNone;
+    }
+
+private:
+    KeyAlgorithm mAlgorithm;
+};
+
+class TestKeyStorage : public KeyStorageItf {
+public:
+    explicit TestKeyStorage(size_t maxConcurrency, std::chrono::milliseconds delay = std::chrono::milliseconds(0))
+        : mMaxConcurrency(maxConcurrency)
+        , mDelay(delay)
+    {
+    }
+
+    Error CreateKey(KeyAlgorithm algorithm, std::shared_ptr<PrivateKeyItf>& key) override
+    {
+        auto running = ++mRunning;
+
+        auto maxRunning = mMaxRunning.load();
+        while (running > maxRunning && !mMaxRunning.compare_exchange_weak(maxRunning, running)) { }
+
+        std::this_thread::sleep_for(mDelay);
+
+        mRunning--;
+        mNumKeys++;
+
+        if (mError != Error::eNone) {
+            return mError;
+        }
+
+        key = std::make_shared<TestKey>(algorithm);
+
+        return Error::eNone;
+    }
+
+    Error DeleteKey(const std::shared_ptr<PrivateKeyItf>&) override
+    {
+        mNumDeletedKeys++;
+
+        return Error::eNone;
+    }
+
+    size_t GetMaxConcurrency() const override { return mMaxConcurrency; }
+
+    size_t                    mMaxConcurrency;
+    std::chrono::milliseconds mDelay;
+    Error                     mError = Error::eNone;
+    std::atomic_size_t        mRunning {0};
+    std::atomic_size_t        mMaxRunning {0};
+    std::atomic_size_t        mNumKeys {0};
+    std::atomic_size_t        mNumDeletedKeys {0};
+};
+
+// Creates software keys which block public key export while closed.
+class GatedKeyStorage : public KeyStorageItf {
+public:
+    Error CreateKey(KeyAlgorithm algorithm, std::shared_ptr<PrivateKeyItf>& key) override
+    {
+        std::shared_ptr<PrivateKeyItf> swKey;
+
+        auto err = mStorage.CreateKey(algorithm, swKey);
+        if (err != Error::eNone) {
+            return err;
+        }
+
+        key = std::make_shared<GatedKey>(swKey, *this);
+
+        return Error::eNone;
+    }
+
+    Error DeleteKey(const std::shared_ptr<PrivateKeyItf>&) override { return Error::eNone; }
+
+    size_t GetMaxConcurrency() const override { return 1; }
+
+    void SetClosed(bool closed)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        mClosed = closed;
+        mCondVar.notify_all();
+    }
+
+    size_t GetNumWaiting()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        return mNumWaiting;
+    }
+
+private:
+    class GatedKey : public PrivateKeyItf {
+    public:
+        GatedKey(std::shared_ptr<PrivateKeyItf> key, GatedKeyStorage& storage)
+            : mKey(std::move(key))
+            , mStorage(storage)
+        {
+        }
+
+        KeyAlgorithm GetAlgorithm() const override { return mKey->GetAlgorithm(); }
+
+        Error GetPublicKey(std::vector<uint8_t>& der) const override
+        {
+            mStorage.Wait();
+
+            return mKey->GetPublicKey(der);
+        }
+
+        Error Sign(const std::vector<uint8_t>& data, std::vector<uint8_t>& signature) const override
+        {
+            return mKey->Sign(data, signature);
+        }
+
+    private:
+        std::shared_ptr<PrivateKeyItf> mKey;
+        GatedKeyStorage&               mStorage;
+    };
+
+    void Wait()
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+
+        mNumWaiting++;
+        mCondVar.wait(lock, [this]() { return !mClosed; });
+        mNumWaiting--;
+    }
+
+    SWKeyStorage            mStorage;
+    std::mutex              mMutex;
+    std::condition_variable mCondVar;
+    bool                    mClosed     = false;
+    size_t                  mNumWaiting = 0;
+};
+
+// Default provider counting verified signatures.
+class CountingCryptoProvider : public CryptoProviderItf {
+public:
+    const char* GetName() const override { return "counting"; }
 
-using aos::Error;
-using aos::iam::certhandler::CertHandler;
+    bool IsSupported(KeyAlgorithm algorithm) const override { return mProvider.IsSupported(algorithm); }
+
+    Error CreateKey(KeyAlgorithm algorithm, std::shared_ptr<PrivateKeyItf>& key) override
+    {
+        return mProvider.CreateKey(algorithm, key);
+    }
+
+    Error Verify(const std::vector<uint8_t>& publicKey, const std::vector<uint8_t>& data,
+        const std::vector<uint8_t>& signature) override
+    {
+        mNumVerified++;
+
+        return mProvider.Verify(publicKey, data, signature);
+    }
+
+    Error Hash(HashAlgorithm algorithm, const uint8_t* data, size_t size, std::vector<uint8_t>& digest) override
+    {
+        return mProvider.Hash(algorithm, data, size, digest);
+    }
+
+    Error CreateCSR(const PrivateKeyItf& key, const CSRParams& params, std::vector<uint8_t>& der) override
+    {
+        return mProvider.CreateCSR(key, params, der);
+    }
+
+    CryptoProviderItf& mProvider = GetDefaultCryptoProvider();
+    std::atomic_size_t mNumVerified {0};
+};
+
+/***********************************************************************************************************************
+ * Utils
+ **********************************************************************************************************************/
+
+template <typename T>
+bool WaitFor(T condition, std::chrono::milliseconds timeout = std::chrono::seconds(5))
+{
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    return true;
+}
+
+/***********************************************************************************************************************
+ * Tests
+ **********************************************************************************************************************/
 
 TEST(certhandler, CreateKey)
 {
+    CertHandler    handler;
+    TestKeyStorage storage(1);
+
+    ASSERT_EQ(handler.RegisterCertType("online", storage), Error::eNone);
+
+    std::shared_ptr<PrivateKeyItf> key;
+
+    EXPECT_EQ(handler.CreateKey("online", KeyAlgorithm::eECDSAP256, key), Error::eNone);
+    EXPECT_NE(key, nullptr);
+}
+
+TEST(certhandler, CreateKeyErrors)
+{
+    CertHandler    handler;
+    TestKeyStorage storage(1);
+
+    ASSERT_EQ(handler.RegisterCertType("online", storage), Error::eNone);
+    EXPECT_EQ(handler.RegisterCertType("online", storage), Error::eAlreadyExist);
+
+    std::shared_ptr<PrivateKeyItf> key;
+
+    EXPECT_EQ(handler.CreateKey("unknown", KeyAlgorithm::eECDSAP256, key), Error::eNotFound);
+    EXPECT_EQ(handler.CreateKeyAsync("online", KeyAlgorithm::eECDSAP256, nullptr), Error::eInvalidArgument);
+
+    storage.mError = Error::eFailed;
+
+    EXPECT_EQ(handler.CreateKey("online", KeyAlgorithm::eECDSAP256, key), Error::eFailed);
+    EXPECT_EQ(key, nullptr);
+}
+
+TEST(certhandler, CreateKeyAsync)
+{
+    constexpr size_t cNumKeys = 8;
+
+    TestKeyStorage          storage(1, std::chrono::milliseconds(10));
+    std::mutex              mutex;
+    std::condition_variable condVar;
+    size_t                  numCompleted = 0;
+
+    {
+        CertHandler handler(4);
+
+        ASSERT_EQ(handler.RegisterCertType("online", storage), Error::eNone);
+
+        auto start = std::chrono::steady_clock::now();
+
+        for (size_t i = 0; i < cNumKeys; i++) {
+            auto callback = [&](Error err, std::shared_ptr<PrivateKeyItf> key) {
+                EXPECT_EQ(err, Error::eNone);
+                EXPECT_NE(key, nullptr);
+
+                std::lock_guard<std::mutex> lock(mutex);
+
+                numCompleted++;
+                condVar.notify_all();
+            };
+
+            ASSERT_EQ(handler.CreateKeyAsync("online", KeyAlgorithm::eECDSAP256, callback), Error::eNone);
+        }
+
+        // Requests are queued and must not block the caller.
+        EXPECT_LT(std::chrono::steady_clock::now() - start, storage.mDelay * cNumKeys);
+
+        std::unique_lock<std::mutex> lock(mutex);
+
+        EXPECT_TRUE(condVar.wait_for(lock, std::chrono::seconds(5), [&] { return numCompleted == cNumKeys; }));
+    }
+
+    EXPECT_EQ(storage.mNumKeys, cNumKeys);
+    EXPECT_EQ(storage.mMaxRunning, 1);
+}
+
+TEST(certhandler, ConcurrencyPerStorage)
+{
+    constexpr size_t cNumKeys = 16;
+
+    TestKeyStorage hsmStorage(1, std::chrono::milliseconds(5));
+    TestKeyStorage swStorage(2, std::chrono::milliseconds(5));
+
+    {
+        CertHandler handler(4);
+
+        ASSERT_EQ(handler.RegisterCertType("online", hsmStorage), Error::eNone);
+        ASSERT_EQ(handler.RegisterCertType("offline", hsmStorage), Error::eNone);
+        ASSERT_EQ(handler.RegisterCertType("sm", swStorage), Error::eNone);
+
+        for (size_t i = 0; i < cNumKeys; i++) {
+            auto callback = [](Error err, std::shared_ptr<PrivateKeyItf>) { EXPECT_EQ(err, Error::eNone); };
+
+            auto certType = i % 2 ? "online" : "offline";
+
+            ASSERT_EQ(handler.CreateKeyAsync(certType, KeyAlgorithm::eECDSAP256, callback), Error::eNone);
+            ASSERT_EQ(handler.CreateKeyAsync("sm", KeyAlgorithm::eECDSAP256, callback), Error::eNone);
+        }
+    }
+
+    EXPECT_EQ(hsmStorage.mNumKeys, cNumKeys);
+    EXPECT_EQ(swStorage.mNumKeys, cNumKeys);
+    EXPECT_EQ(hsmStorage.mMaxRunning, 1);
+    EXPECT_LE(swStorage.mMaxRunning, 2);
+}
+
+TEST(certhandler, PendingLimit)
+{
+    TestKeyStorage storage(1, std::chrono::milliseconds(1));
+    CertHandler    handler(1);
+
+    ASSERT_EQ(handler.RegisterCertType("online", storage), Error::eNone);
+
+    auto callback = [](Error, std::shared_ptr<PrivateKeyItf>) {};
+    auto err      = Error::eNone;
+    auto numKeys  = 0;
+
+    while ((err = handler.CreateKeyAsync("online", KeyAlgorithm::eECDSAP256, callback)) == Error::eNone) {
+        numKeys++;
+    }
+
+    EXPECT_EQ(err, Error::eNoMemory);
+    EXPECT_GT(numKeys, CertHandler::cMaxPendingJobs);
+}
+
+TEST(certhandler, KeyPool)
+{
+    TestKeyStorage storage(1, std::chrono::milliseconds(50));
+
+    {
+        CertHandler handler;
+
+        ASSERT_EQ(handler.RegisterCertType("online", storage), Error::eNone);
+
+        KeyPoolConfig config;
+
+        config.mSize = 2;
+
+        ASSERT_EQ(handler.ConfigureKeyPool(storage, KeyAlgorithm::eECDSAP256, config), Error::eNone);
+        ASSERT_TRUE(WaitFor([&] { return storage.mNumKeys == 2; }));
+
+        std::shared_ptr<PrivateKeyItf> key;
+
+        auto start = std::chrono::steady_clock::now();
+
+        ASSERT_EQ(handler.CreateKey("online", KeyAlgorithm::eECDSAP256, key), Error::eNone);
+        EXPECT_NE(key, nullptr);
+        EXPECT_LT(std::chrono::steady_clock::now() - start, storage.mDelay);
+
+        // Taken key is replaced in background.
+        EXPECT_TRUE(WaitFor([&] { return storage.mNumKeys == 3; }));
+    }
+
+    // Unused pooled keys are disposed on exit.
+    EXPECT_EQ(storage.mNumDeletedKeys, 2);
+}
+
+TEST(certhandler, KeyPoolShrink)
+{
+    TestKeyStorage storage(2);
+    CertHandler    handler;
+
+    ASSERT_EQ(handler.RegisterCertType("online", storage), Error::eNone);
+
+    KeyPoolConfig config;
+
+    config.mSize = 4;
+
+    EXPECT_EQ(handler.ConfigureKeyPool(storage, KeyAlgorithm::eECDSAP256, config), Error::eNone);
+    ASSERT_TRUE(WaitFor([&] { return storage.mNumKeys == 4; }));
+
+    config.mSize = 1;
+
+    EXPECT_EQ(handler.ConfigureKeyPool(storage, KeyAlgorithm::eECDSAP256, config), Error::eNone);
+    EXPECT_EQ(storage.mNumDeletedKeys, 3);
+
+    config.mSize          = 0;
+    config.mSecureDispose = false;
+
+    EXPECT_EQ(handler.ConfigureKeyPool(storage, KeyAlgorithm::eECDSAP256, config), Error::eNone);
+    EXPECT_EQ(storage.mNumDeletedKeys, 3);
+
+    TestKeyStorage unknownStorage(1);
+
+    EXPECT_EQ(handler.ConfigureKeyPool(unknownStorage, KeyAlgorithm::eECDSAP256, config), Error::eNotFound);
+}
+
+TEST(certhandler, KeyPoolMaxAge)
+{
+    TestKeyStorage storage(1);
+    CertHandler    handler;
+
+    ASSERT_EQ(handler.RegisterCertType("online", storage), Error::eNone);
+
+    KeyPoolConfig config;
+
+    config.mSize      = 1;
+    config.mMaxKeyAge = std::chrono::seconds(1);
+
+    EXPECT_EQ(handler.ConfigureKeyPool(storage, KeyAlgorithm::eECDSAP256, config), Error::eNone);
+    ASSERT_TRUE(WaitFor([&] { return storage.mNumKeys == 1; }));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+
+    std::shared_ptr<PrivateKeyItf> key;
+
+    EXPECT_EQ(handler.CreateKey("online", KeyAlgorithm::eECDSAP256, key), Error::eNone);
+    EXPECT_EQ(storage.mNumDeletedKeys, 1);
+}
+
+TEST(certhandler, KeyPoolRefillFailure)
+{
+    TestKeyStorage storage(1);
+    CertHandler    handler;
+
+    ASSERT_EQ(handler.RegisterCertType("online", storage), Error::eNone);
+
+    storage.mError = Error::eFailed;
+
+    KeyPoolConfig config;
+
+    config.mSize = 1;
+
+    EXPECT_EQ(handler.ConfigureKeyPool(storage, KeyAlgorithm::eECDSAP256, config), Error::eNone);
+    ASSERT_TRUE(WaitFor([&] { return storage.mNumKeys == 1; }));
+
+    // Failed refill is not retried until the next key request.
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(storage.mNumKeys, 1);
+}
+
+TEST(certhandler, KeyPoolPerAlgorithm)
+{
+    TestKeyStorage storage(1);
+    CertHandler    handler;
+
+    ASSERT_EQ(handler.RegisterCertType("online", storage), Error::eNone);
+
+    KeyPoolConfig config;
+
+    config.mSize = 1;
+
+    EXPECT_EQ(handler.ConfigureKeyPool(storage, KeyAlgorithm::eEd25519, config), Error::eNone);
+    ASSERT_TRUE(WaitFor([&] { return storage.mNumKeys == 1; }));
+
+    std::shared_ptr<PrivateKeyItf> key;
+
+    // No pool for RSA keys: the key is generated on request.
+    ASSERT_EQ(handler.CreateKey("online", KeyAlgorithm::eRSA2048, key), Error::eNone);
+    EXPECT_EQ(key->GetAlgorithm(), KeyAlgorithm::eRSA2048);
+    EXPECT_EQ(storage.mNumKeys, 2);
+
+    ASSERT_EQ(handler.CreateKey("online", KeyAlgorithm::eEd25519, key), Error::eNone);
+    EXPECT_EQ(key->GetAlgorithm(), KeyAlgorithm::eEd25519);
+}
+
+TEST(certhandler, ApplyCert)
+{
+    TempDir        dir;
+    CertStorage    certStorage;
+    TestKeyStorage storage(1);
+    CertHandler    handler;
+    CertInfo       info;
+
+    ASSERT_EQ(handler.RegisterCertType("online", storage), Error::eNone);
+    EXPECT_EQ(handler.ApplyCert("online", "", info), Error::eWrongState);
+
+    ASSERT_EQ(certStorage.Init(dir.GetPath()), Error::eNone);
+    handler.SetCertStorage(certStorage);
+
+    auto           key = GenerateTestKey();
+    TestCertParams params;
+
+    params.mSerial = 1;
+    auto oldCert   = ConvertToPEM(CreateTestCert(params, key.get()));
+
+    params.mSerial   = 2;
+    params.mNotAfter = 730;
+    auto newCert     = ConvertToPEM(CreateTestCert(params, key.get()));
+
+    EXPECT_EQ(handler.ApplyCert("unknown", oldCert, info), Error::eNotFound);
+    EXPECT_EQ(handler.ApplyCert("online", "garbage", info), Error::eInvalidArgument);
+
+    CertInfo oldInfo, newInfo;
+
+    ASSERT_EQ(handler.ApplyCert("online", oldCert, oldInfo), Error::eNone);
+    ASSERT_EQ(handler.ApplyCert("online", newCert, newInfo), Error::eNone);
+
+    // Empty serial returns the latest certificate of the type.
+    ASSERT_EQ(handler.GetCertificate("online", {}, {}, info), Error::eNone);
+    EXPECT_EQ(info.mFingerprint, newInfo.mFingerprint);
+
+    ASSERT_EQ(handler.GetCertificate("online", oldInfo.mIssuer, oldInfo.mSerial, info), Error::eNone);
+    EXPECT_EQ(info.mFingerprint, oldInfo.mFingerprint);
+
+    EXPECT_EQ(handler.GetCertificate("offline", {}, {}, info), Error::eNotFound);
+    EXPECT_EQ(handler.GetCertificate("offline", oldInfo.mIssuer, oldInfo.mSerial, info), Error::eNotFound);
+}
+
+TEST(certhandler, ApplyCerts)
+{
+    TempDir               dir;
+    CertStorage           certStorage;
+    TestKeyStorage        storage(1);
+    CertHandler           handler;
+    std::vector<CertInfo> infos;
+
+    ASSERT_EQ(certStorage.Init(dir.GetPath()), Error::eNone);
+    ASSERT_EQ(handler.RegisterCertType("online", storage), Error::eNone);
+    ASSERT_EQ(handler.RegisterCertType("offline", storage), Error::eNone);
+    handler.SetCertStorage(certStorage);
+
+    auto           key = GenerateTestKey();
+    TestCertParams params;
+
+    params.mSerial = 1;
+    auto online    = ConvertToPEM(CreateTestCert(params, key.get()));
+
+    params.mSerial = 2;
+    auto offline   = ConvertToPEM(CreateTestCert(params, key.get()));
+
+    EXPECT_EQ(handler.ApplyCerts({{"online", online}, {"unknown", offline}}, infos), Error::eNotFound);
+    EXPECT_EQ(handler.ApplyCerts({{"online", online}, {"offline", "garbage"}}, infos), Error::eInvalidArgument);
+
+    // Certificates are applied all together or not at all.
+    EXPECT_EQ(handler.ApplyCerts({{"online", online}, {"offline", online}}, infos), Error::eAlreadyExist);
+
+    CertInfo info;
+
+    EXPECT_EQ(handler.GetCertificate("online", {}, {}, info), Error::eNotFound);
+
+    ASSERT_EQ(handler.ApplyCerts({{"online", online}, {"offline", offline}}, infos), Error::eNone);
+    ASSERT_EQ(infos.size(), 2);
+
+    ASSERT_EQ(handler.GetCertificate("online", {}, {}, info), Error::eNone);
+    EXPECT_EQ(info.mFingerprint, infos[0].mFingerprint);
+    ASSERT_EQ(handler.GetCertificate("offline", {}, {}, info), Error::eNone);
+    EXPECT_EQ(info.mFingerprint, infos[1].mFingerprint);
+}
+
+TEST(certhandler, TLSCredentials)
+{
+    TempDir      dir;
+    CertStorage  certStorage;
+    SWKeyStorage storage;
+    CertHandler  handler;
+    CertInfo     info;
+
+    ASSERT_EQ(certStorage.Init(dir.GetPath()), Error::eNone);
+    ASSERT_EQ(handler.RegisterCertType("online", storage), Error::eNone);
+    handler.SetCertStorage(certStorage);
+
+    std::shared_ptr<const TLSCredentialsSlot> slot;
+    std::shared_ptr<const TLSCredentials>     credentials;
+
+    EXPECT_EQ(handler.GetTLSCredentialsSlot("unknown", slot), Error::eNotFound);
+    ASSERT_EQ(handler.GetTLSCredentialsSlot("online", slot), Error::eNone);
+    EXPECT_EQ(slot->Load(), nullptr);
+    EXPECT_EQ(handler.GetTLSCredentials("online", credentials), Error::eNotFound);
+
+    auto           caKey = GenerateTestKey();
+    TestCertParams caParams;
+
+    caParams.mSubject = "ca";
+    caParams.mIssuer  = "ca";
+    caParams.mCA      = true;
+    auto caCert       = CreateTestCert(caParams, caKey.get());
+
+    // Issues certificate for the key of the request, followed by the CA certificate.
+    auto issue = [&](const CSRResult& result, long serial, long notAfter) {
+        std::vector<uint8_t> publicKey;
+
+        EXPECT_EQ(result.mKey->GetPublicKey(publicKey), Error::eNone);
+
+        auto           data = static_cast<const uint8_t*>(publicKey.data());
+        TestKeyPtr     key(d2i_PUBKEY(nullptr, &data, static_cast<long>(publicKey.size())), EVP_PKEY_free);
+        TestCertParams params;
+
+        params.mIssuer   = "ca";
+        params.mSerial   = serial;
+        params.mNotAfter = notAfter;
+
+        return ConvertToPEM(CreateTestCert(params, key.get(), caKey.get())) + ConvertToPEM(caCert);
+    };
+
+    CSRRequest request {"online", KeyAlgorithm::eECDSAP256, {"online", {}}};
+    CSRResult  first, second;
+
+    ASSERT_EQ(handler.CreateCSR(request, first), Error::eNone);
+    ASSERT_EQ(handler.CreateCSR(request, second), Error::eNone);
+
+    // Certificate of an unknown key doesn't publish credentials.
+    auto otherKey = GenerateTestKey();
+
+    ASSERT_EQ(handler.ApplyCert("online", ConvertToPEM(CreateTestCert({}, otherKey.get())), info), Error::eNone);
+    EXPECT_EQ(slot->Load(), nullptr);
+
+    ASSERT_EQ(handler.ApplyCert("online", issue(first, 10, 365), info), Error::eNone);
+
+    auto current = slot->Load();
+
+    ASSERT_NE(current, nullptr);
+    EXPECT_EQ(current->mGeneration, 1u);
+    EXPECT_EQ(current->mKey, first.mKey);
+    EXPECT_EQ(current->mInfo.mFingerprint, info.mFingerprint);
+    ASSERT_EQ(current->mChain.size(), 2u);
+    ASSERT_EQ(current->mChainDER.size(), 2u);
+    EXPECT_EQ(current->mChainDER[1], caCert);
+    EXPECT_EQ(X509_check_issued(current->mChain[1].get(), current->mChain[0].get()), X509_V_OK);
+
+    // Renewed certificate replaces credentials, connections keep the loaded ones.
+    ASSERT_EQ(handler.ApplyCert("online", issue(second, 11, 730), info), Error::eNone);
+    ASSERT_EQ(handler.GetTLSCredentials("online", credentials), Error::eNone);
+    EXPECT_EQ(credentials->mGeneration, 2u);
+    EXPECT_EQ(credentials->mKey, second.mKey);
+    EXPECT_EQ(current->mKey, first.mKey);
+
+    // Applying an older certificate keeps credentials of the latest one.
+    ASSERT_EQ(handler.ApplyCert("online", issue(first, 12, 100), info), Error::eNone);
+    EXPECT_EQ(slot->Load(), credentials);
+}
+
+TEST(certhandler, LockPerCertType)
+{
+    TempDir         dir;
+    CertStorage     certStorage;
+    GatedKeyStorage slowStorage;
+    SWKeyStorage    storage;
+    CertHandler     handler;
+    CertInfo        info;
+
+    ASSERT_EQ(certStorage.Init(dir.GetPath()), Error::eNone);
+    ASSERT_EQ(handler.RegisterCertType("slow", slowStorage), Error::eNone);
+    ASSERT_EQ(handler.RegisterCertType("fast", storage), Error::eNone);
+    handler.SetCertStorage(certStorage);
+
+    CSRRequest           request {"slow", KeyAlgorithm::eECDSAP256, {"slow", {}}};
+    CSRResult            result;
+    std::vector<uint8_t> publicKey;
+
+    ASSERT_EQ(handler.CreateCSR(request, result), Error::eNone);
+    ASSERT_EQ(result.mKey->GetPublicKey(publicKey), Error::eNone);
+
+    auto           data = static_cast<const uint8_t*>(publicKey.data());
+    TestKeyPtr     slowKey(d2i_PUBKEY(nullptr, &data, static_cast<long>(publicKey.size())), EVP_PKEY_free);
+    auto           caKey = GenerateTestKey();
+    TestCertParams params;
+
+    params.mSerial = 1;
+    auto slowCert  = ConvertToPEM(CreateTestCert(params, slowKey.get(), caKey.get()));
+
+    params.mSerial = 2;
+    auto fastCert  = ConvertToPEM(CreateTestCert(params, caKey.get()));
+
+    // Apply of the slow type blocks while its TLS credentials are built.
+    slowStorage.SetClosed(true);
+
+    auto apply = std::async(std::launch::async, [&]() {
+        CertInfo slowInfo;
+
+        return handler.ApplyCert("slow", slowCert, slowInfo);
+    });
+
+    ASSERT_TRUE(WaitFor([&]() { return slowStorage.GetNumWaiting() == 1; }));
+
+    // Other types are applied and queried meanwhile.
+    EXPECT_EQ(handler.ApplyCert("fast", fastCert, info), Error::eNone);
+    EXPECT_EQ(handler.GetCertificate("fast", {}, {}, info), Error::eNone);
+
+    std::shared_ptr<const TLSCredentialsSlot> slot;
+
+    EXPECT_EQ(handler.GetTLSCredentialsSlot("slow", slot), Error::eNone);
+
+    // Query of the slow type waits for the apply and sees the applied certificate.
+    auto query = std::async(std::launch::async, [&]() {
+        CertInfo slowInfo;
+
+        return handler.GetCertificate("slow", {}, {}, slowInfo);
+    });
+
+    EXPECT_EQ(query.wait_for(std::chrono::milliseconds(50)), std::future_status::timeout);
+
+    slowStorage.SetClosed(false);
+
+    EXPECT_EQ(apply.get(), Error::eNone);
+    EXPECT_EQ(query.get(), Error::eNone);
+    ASSERT_NE(slot->Load(), nullptr);
+    EXPECT_EQ(slot->Load()->mKey, result.mKey);
+}
+
+TEST(certhandler, VerifyCertChain)
+{
+    TrustStore  trustStore;
     CertHandler handler;
 
-    EXPECT_EQ(handler.CreateKey(), Error::eNone);
+    auto           rootKey = GenerateTestKey(), leafKey = GenerateTestKey();
+    TestCertParams params;
+
+    params.mSubject = "root";
+    params.mIssuer  = "root";
+    params.mCA      = true;
+
+    auto root = CreateTestCert(params, rootKey.get());
+
+    params.mSubject = "leaf";
+    params.mSerial  = 2;
+    params.mCA      = false;
+
+    auto leaf = CreateTestCert(params, leafKey.get(), rootKey.get());
+
+    EXPECT_EQ(handler.VerifyCertChain({leaf}), Error::eWrongState);
+
+    handler.SetTrustStore(trustStore);
+
+    EXPECT_EQ(handler.VerifyCertChain({leaf}), Error::eFailed);
+
+    ASSERT_EQ(trustStore.AddTrustAnchor(root), Error::eNone);
+
+    for (int i = 0; i < 3; i++) {
+        EXPECT_EQ(handler.VerifyCertChain({leaf}), Error::eNone);
+    }
+
+    auto metrics = handler.GetVerifyCacheMetrics();
+
+    EXPECT_EQ(metrics.mHits, 2);
+    EXPECT_EQ(metrics.mMisses, 2);
+    EXPECT_GT(metrics.mTimeSaved.count(), 0);
+
+    // Revocation invalidates cached result.
+    ASSERT_EQ(trustStore.SetCRL(CreateTestCRL("root", rootKey.get(), {2})), Error::eNone);
+    EXPECT_EQ(handler.VerifyCertChain({leaf}), Error::eFailed);
+    EXPECT_EQ(handler.GetVerifyCacheMetrics().mHits, 2);
+}
+
+TEST(certhandler, VerifySignatures)
+{
+    SWKeyStorage                   storage;
+    CertHandler                    handler;
+    CountingCryptoProvider         provider;
+    std::shared_ptr<PrivateKeyItf> key;
+    std::vector<SignatureItem>     items(4);
+    std::vector<Error>             results;
+
+    ASSERT_EQ(storage.CreateKey(KeyAlgorithm::eECDSAP256, key), Error::eNone);
+
+    for (size_t i = 0; i < items.size(); i++) {
+        items[i].mData = {static_cast<uint8_t>(i)};
+
+        ASSERT_EQ(key->GetPublicKey(items[i].mPublicKey), Error::eNone);
+        ASSERT_EQ(key->Sign(items[i].mData, items[i].mSignature), Error::eNone);
+    }
+
+    items[2].mData = {0xff};
+
+    EXPECT_EQ(handler.VerifySignatures(items, results), Error::eFailed);
+    EXPECT_EQ(results, std::vector<Error>({Error::eNone, Error::eNone, Error::eFailed, Error::eNone}));
+    EXPECT_EQ(provider.mNumVerified, 0u);
+
+    // Items are verified by the configured provider.
+    handler.SetCryptoProvider(provider);
+
+    EXPECT_EQ(handler.VerifySignatures(items, results), Error::eFailed);
+    EXPECT_EQ(results, std::vector<Error>({Error::eNone, Error::eNone, Error::eFailed, Error::eNone}));
+    EXPECT_EQ(provider.mNumVerified, items.size());
+}
+
+TEST(certhandler, VerifySignaturesWhileGeneratingKeys)
+{
+    constexpr size_t cNumKeys = 8;
+
+    TestKeyStorage                 storage(cNumKeys, std::chrono::milliseconds(300));
+    SWKeyStorage                   swStorage;
+    std::shared_ptr<PrivateKeyItf> key;
+    std::vector<SignatureItem>     items(4);
+    std::vector<Error>             results;
+    std::atomic_size_t             numCompleted {0};
+
+    ASSERT_EQ(swStorage.CreateKey(KeyAlgorithm::eECDSAP256, key), Error::eNone);
+
+    for (auto& item : items) {
+        item.mData = {1, 2, 3};
+
+        ASSERT_EQ(key->GetPublicKey(item.mPublicKey), Error::eNone);
+        ASSERT_EQ(key->Sign(item.mData, item.mSignature), Error::eNone);
+    }
+
+    CertHandler handler(2);
+
+    ASSERT_EQ(handler.RegisterCertType("online", storage), Error::eNone);
+
+    // Two workers generate keys, the rest of key generation jobs are queued ahead of verification.
+    for (size_t i = 0; i < cNumKeys; i++) {
+        ASSERT_EQ(handler.CreateKeyAsync("online", KeyAlgorithm::eRSA2048,
+                      [&numCompleted](Error, std::shared_ptr<PrivateKeyItf>) { numCompleted++; }),
+            Error::eNone);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    EXPECT_EQ(handler.VerifySignatures(items, results), Error::eNone);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, storage.mDelay);
+    EXPECT_EQ(numCompleted, 0u);
+
+    EXPECT_TRUE(WaitFor([&] { return numCompleted == cNumKeys; }));
+}
+
+TEST(certhandler, ApplyCRL)
+{
+    TrustStore  trustStore;
+    CertHandler handler;
+
+    auto           rootKey = GenerateTestKey(), leafKey = GenerateTestKey();
+    TestCertParams params;
+
+    params.mSubject = "root";
+    params.mIssuer  = "root";
+    params.mCA      = true;
+
+    auto root = CreateTestCert(params, rootKey.get());
+
+    params.mSubject = "leaf";
+    params.mSerial  = 2;
+    params.mCA      = false;
+
+    auto leaf = CreateTestCert(params, leafKey.get(), rootKey.get());
+
+    std::string pemCRL;
+
+    pem::Encode(pem::cCRL, CreateTestCRL("root", rootKey.get(), {2}), pemCRL);
+
+    EXPECT_EQ(handler.ApplyCRL(pemCRL), Error::eWrongState);
+
+    handler.SetTrustStore(trustStore);
+
+    ASSERT_EQ(trustStore.AddTrustAnchor(root), Error::eNone);
+    ASSERT_EQ(handler.VerifyCertChain({leaf}), Error::eNone);
+
+    // Blocks other than CRLs are skipped.
+    EXPECT_EQ(handler.ApplyCRL(ConvertToPEM(root)), Error::eInvalidArgument);
+    EXPECT_EQ(handler.ApplyCRL(ConvertToPEM(root) + pemCRL), Error::eNone);
+
+    EXPECT_EQ(handler.VerifyCertChain({leaf}), Error::eFailed);
+
+    // Already applied CRL is skipped.
+    EXPECT_EQ(handler.ApplyCRL(pemCRL), Error::eNone);
+}
+
+TEST(certhandler, CreateCSRs)
+{
+    CertHandler    handler;
+    SWKeyStorage   swStorage(2);
+    TestKeyStorage failingStorage(1), invalidKeyStorage(1);
+
+    failingStorage.mError = Error::eFailed;
+
+    ASSERT_EQ(handler.RegisterCertType("online", swStorage), Error::eNone);
+    ASSERT_EQ(handler.RegisterCertType("offline", swStorage), Error::eNone);
+    ASSERT_EQ(handler.RegisterCertType("iam", failingStorage), Error::eNone);
+    ASSERT_EQ(handler.RegisterCertType("um", invalidKeyStorage), Error::eNone);
+
+    std::vector<CSRRequest> requests = {
+        {"online", KeyAlgorithm::eECDSAP256, {"online", {}}},
+        {"offline", KeyAlgorithm::eEd25519, {"offline", {}}},
+        {"unknown", KeyAlgorithm::eECDSAP256, {}},
+        {"iam", KeyAlgorithm::eECDSAP256, {}},
+        {"um", KeyAlgorithm::eECDSAP256, {}},
+    };
+    std::vector<CSRResult> results;
+
+    EXPECT_EQ(handler.CreateCSRs(requests, results), Error::eFailed);
+    ASSERT_EQ(results.size(), requests.size());
+
+    for (size_t i = 0; i < 2; i++) {
+        EXPECT_EQ(results[i].mCertType, requests[i].mCertType);
+        ASSERT_EQ(results[i].mError, Error::eNone);
+        EXPECT_NE(results[i].mKey, nullptr);
+        EXPECT_EQ(results[i].mCSR.compare(0, 35, "-----BEGIN CERTIFICATE REQUEST-----"), 0);
+    }
+
+    EXPECT_EQ(results[2].mError, Error::eNotFound);
+    EXPECT_EQ(results[3].mError, Error::eFailed);
+    EXPECT_EQ(results[4].mError, Error::eInvalidArgument);
+
+    // Key of failed request is not leaked.
+    EXPECT_EQ(invalidKeyStorage.mNumDeletedKeys, 1);
+    EXPECT_EQ(results[4].mKey, nullptr);
+
+    CSRResult result;
+
+    EXPECT_EQ(handler.CreateCSR(requests[0], result), Error::eNone);
+    EXPECT_FALSE(result.mCSR.empty());
+    EXPECT_EQ(handler.CreateCSR(requests[2], result), Error::eNotFound);
+}
+
+TEST(certhandler, Renewal)
+{
+    TempDir        dir;
+    CertStorage    certStorage;
+    TestKeyStorage storage(1);
+    CertHandler    handler;
+    RenewalConfig  config;
+
+    std::mutex              mutex;
+    std::condition_variable condVar;
+    std::vector<CertInfo>   renewed;
+
+    auto callback = [&](const std::string& certType, const CertInfo& info) {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        EXPECT_EQ(certType, "online");
+        renewed.push_back(info);
+        condVar.notify_all();
+    };
+
+    config.mLeadTime      = std::chrono::hours(24 * 2);
+    config.mRetryInterval = std::chrono::hours(1);
+
+    ASSERT_EQ(handler.RegisterCertType("online", storage), Error::eNone);
+    EXPECT_EQ(handler.StartRenewal(config, callback), Error::eWrongState);
+
+    ASSERT_EQ(certStorage.Init(dir.GetPath()), Error::eNone);
+    handler.SetCertStorage(certStorage);
+
+    auto           key = GenerateTestKey();
+    TestCertParams params;
+    CertInfo       expiring, info;
+
+    params.mNotBefore = -10;
+    params.mNotAfter  = 1;
+
+    ASSERT_EQ(handler.ApplyCert("online", ConvertToPEM(CreateTestCert(params, key.get())), expiring), Error::eNone);
+
+    // Existing certificate is scheduled on start.
+    ASSERT_EQ(handler.StartRenewal(config, callback), Error::eNone);
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        ASSERT_TRUE(condVar.wait_for(lock, std::chrono::seconds(5), [&]() { return !renewed.empty(); }));
+        EXPECT_EQ(renewed.front().mFingerprint, expiring.mFingerprint);
+    }
+
+    handler.StopRenewal();
+
+    renewed.clear();
+
+    // Applied certificate replaces scheduled one.
+    ASSERT_EQ(handler.StartRenewal(config, callback), Error::eNone);
+
+    params.mSerial    = 2;
+    params.mNotBefore = -1;
+    params.mNotAfter  = 365;
+
+    ASSERT_EQ(handler.ApplyCert("online", ConvertToPEM(CreateTestCert(params, key.get())), info), Error::eNone);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    EXPECT_LE(renewed.size(), 1);
+}
+
+TEST(certhandler, Watch)
+{
+    TempDir        storageDir, trustDir;
+    CertStorage    certStorage;
+    TrustStore     trustStore;
+    TestKeyStorage storage(1);
+    CertHandler    handler;
+    WatchConfig    config;
+
+    auto writeFile = [](const std::string& path, const std::string& content) { std::ofstream(path) << content; };
+
+    auto createChain = [](const std::string& name, TestKeyPtr& rootKey) {
+        auto           leafKey = GenerateTestKey();
+        TestCertParams params;
+
+        params.mSubject = name;
+        params.mIssuer  = name;
+        params.mCA      = true;
+
+        auto root = CreateTestCert(params, rootKey.get());
+
+        params.mSubject = name + " leaf";
+        params.mSerial  = 2;
+        params.mCA      = false;
+
+        return CertChain {CreateTestCert(params, leafKey.get(), rootKey.get()), root};
+    };
+
+    auto firstKey = GenerateTestKey(), secondKey = GenerateTestKey();
+    auto first = createChain("first", firstKey), second = createChain("second", secondKey);
+
+    config.mTrustDir = trustDir.GetPath();
+    config.mDebounce = std::chrono::milliseconds(20);
+
+    ASSERT_EQ(handler.RegisterCertType("online", storage), Error::eNone);
+    EXPECT_EQ(handler.StartWatch(config), Error::eWrongState);
+
+    ASSERT_EQ(certStorage.Init(storageDir.GetPath()), Error::eNone);
+    handler.SetCertStorage(certStorage);
+
+    EXPECT_EQ(handler.StartWatch(config), Error::eWrongState);
+
+    handler.SetTrustStore(trustStore);
+
+    // Existing bundles are loaded on start.
+    writeFile(trustDir.GetPath() + "/first.pem", ConvertToPEM(first[1]));
+
+    ASSERT_EQ(handler.StartWatch(config), Error::eNone);
+    EXPECT_EQ(handler.VerifyCertChain({first[0]}), Error::eNone);
+
+    // Certificate dropped into a new certificate type directory is reloaded.
+    CertInfo info;
+
+    ASSERT_EQ(mkdir((storageDir.GetPath() + "/online").c_str(), 0700), 0);
+    writeFile(storageDir.GetPath() + "/online/dropped.der", std::string(second[0].begin(), second[0].end()));
+
+    EXPECT_TRUE(WaitFor([&]() { return handler.GetCertificate("online", {}, {}, info) == Error::eNone; }));
+
+    // Changed bundles are applied, anchors of removed bundles are dropped.
+    writeFile(trustDir.GetPath() + "/second.crt", ConvertToPEM(second[1]));
+
+    EXPECT_TRUE(WaitFor([&]() { return handler.VerifyCertChain({second[0]}) == Error::eNone; }));
+
+    ASSERT_EQ(unlink((trustDir.GetPath() + "/first.pem").c_str()), 0);
+
+    EXPECT_TRUE(WaitFor([&]() { return handler.VerifyCertChain({first[0]}) == Error::eFailed; }));
+    EXPECT_EQ(handler.VerifyCertChain({second[0]}), Error::eNone);
+
+    // Files are not reloaded after stop.
+    handler.StopWatch();
+
+    writeFile(trustDir.GetPath() + "/first.pem", ConvertToPEM(first[1]));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    EXPECT_EQ(handler.VerifyCertChain({first[0]}), Error::eFailed);
 }
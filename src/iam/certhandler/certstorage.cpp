@@ -0,0 +1,1347 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <set>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "crypto/sha256.hpp"
+
+#include "certstorage.hpp"
+#include "x509parser.hpp"
+
+namespace aos {
+namespace iam {
+namespace certhandler {
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+constexpr const char* CertStorage::cIndexFileName;
+constexpr const char* CertStorage::cJournalFileName;
+constexpr size_t      CertStorage::cDefaultMaxJournalSize;
+
+namespace {
+
+// Index file layout, all integers are little endian:
+//   magic[4] version:u32 count:u32
+//   count * { certType issuer serial subjectKeyID fingerprint : u16 length + bytes, notBefore:i64 notAfter:i64 }
+//   SHA-256 of all preceding bytes
+constexpr char     cIndexMagic[4] = {'A', 'O', 'S', 'I'};
+constexpr uint32_t cIndexVersion  = 1;
+constexpr size_t   cChecksumSize  = 32;
+constexpr char     cCertFileExt[] = ".der";
+
+// Record with empty fields: five u16 lengths and two i64 times.
+constexpr size_t cMinIndexRecordSize = 5 * sizeof(uint16_t) + 2 * sizeof(int64_t);
+
+// Journal is a sequence of records, all integers are little endian:
+//   size:u32 payload[size] SHA-256 of payload
+//   payload: count:u32 count * { op:u8 certType:u16 length + bytes, data:u32 length + bytes }
+// Data is DER certificate for add and certificate fingerprint for remove.
+constexpr uint8_t cJournalAdd    = 1;
+constexpr uint8_t cJournalRemove = 2;
+
+struct JournalEntry {
+    uint8_t              mOp;
+    std::string          mCertType;
+    std::vector<uint8_t> mData;
+};
+
+struct DirDeleter {
+    void operator()(DIR* dir) const { closedir(dir); }
+};
+
+using DirPtr = std::unique_ptr<DIR, DirDeleter>;
+
+class IndexWriter {
+public:
+    void PutU8(uint8_t value) { PutUInt(value, sizeof(value)); }
+    void PutU16(uint16_t value) { PutUInt(value, sizeof(value)); }
+    void PutU32(uint32_t value) { PutUInt(value, sizeof(value)); }
+    void PutI64(int64_t value) { PutUInt(static_cast<uint64_t>(value), sizeof(value)); }
+
+    void PutBytes(const void* data, size_t size)
+    {
+        auto bytes = static_cast<const uint8_t*>(data);
+
+        mData.insert(mData.end(), bytes, bytes + size);
+    }
+
+    void PutField(const void* data, size_t size)
+    {
+        PutU16(static_cast<uint16_t>(size));
+        PutBytes(data, size);
+    }
+
+    void PutLongField(const void* data, size_t size)
+    {
+        PutU32(static_cast<uint32_t>(size));
+        PutBytes(data, size);
+    }
+
+    std::vector<uint8_t>& GetData() { return mData; }
+
+private:
+    void PutUInt(uint64_t value, size_t size)
+    {
+        for (size_t i = 0; i < size; i++) {
+            mData.push_back(static_cast<uint8_t>(value >> (i * 8)));
+        }
+    }
+
+    std::vector<uint8_t> mData;
+};
+
+class IndexReader {
+public:
+    IndexReader(const uint8_t* data, size_t size)
+        : mData(data)
+        , mSize(size)
+    {
+    }
+
+    bool GetU8(uint8_t& value) { return GetUInt(value); }
+    bool GetU16(uint16_t& value) { return GetUInt(value); }
+    bool GetU32(uint32_t& value) { return GetUInt(value); }
+
+    bool GetI64(int64_t& value)
+    {
+        uint64_t tmp = 0;
+
+        if (!GetUInt(tmp)) {
+            return false;
+        }
+
+        value = static_cast<int64_t>(tmp);
+
+        return true;
+    }
+
+    bool GetBytes(void* data, size_t size)
+    {
+        if (mSize - mPos < size) {
+            return false;
+        }
+
+        memcpy(data, mData + mPos, size);
+        mPos += size;
+
+        return true;
+    }
+
+    template <typename T>
+    bool GetField(T& field)
+    {
+        uint16_t size = 0;
+
+        return GetU16(size) && GetData(size, field);
+    }
+
+    template <typename T>
+    bool GetLongField(T& field)
+    {
+        uint32_t size = 0;
+
+        return GetU32(size) && GetData(size, field);
+    }
+
+    bool IsEnd() const { return mPos == mSize; }
+
+    size_t GetRemaining() const { return mSize - mPos; }
+
+private:
+    template <typename T>
+    bool GetData(size_t size, T& field)
+    {
+        if (mSize - mPos < size) {
+            return false;
+        }
+
+        field.assign(mData + mPos, mData + mPos + size);
+        mPos += size;
+
+        return true;
+    }
+
+    template <typename T>
+    bool GetUInt(T& value)
+    {
+        if (mSize - mPos < sizeof(T)) {
+            return false;
+        }
+
+        value = 0;
+
+        for (size_t i = 0; i < sizeof(T); i++) {
+            value |= static_cast<T>(mData[mPos + i]) << (i * 8);
+        }
+
+        mPos += sizeof(T);
+
+        return true;
+    }
+
+    const uint8_t* mData;
+    size_t         mSize;
+    size_t         mPos = 0;
+};
+
+Error CalculateSHA256(const uint8_t* data, size_t size, std::vector<uint8_t>& digest)
+{
+    auto result = sha256::Calculate(data, size);
+
+    digest.assign(result.begin(), result.end());
+
+    return Error::eNone;
+}
+
+Error ReadFile(const std::string& path, std::vector<uint8_t>& data)
+{
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return errno == ENOENT ? Error::eNotFound : Error::eFailed;
+    }
+
+    struct stat st;
+
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+
+        return Error::eFailed;
+    }
+
+    data.resize(st.st_size);
+
+    size_t pos = 0;
+
+    while (pos < data.size()) {
+        auto n = read(fd, data.data() + pos, data.size() - pos);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (n <= 0) {
+            close(fd);
+
+            return Error::eFailed;
+        }
+
+        pos += n;
+    }
+
+    close(fd);
+
+    return Error::eNone;
+}
+
+Error WriteAll(int fd, const uint8_t* data, size_t size)
+{
+    size_t pos = 0;
+
+    while (pos < size) {
+        auto n = write(fd, data + pos, size - pos);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (n <= 0) {
+            return Error::eFailed;
+        }
+
+        pos += n;
+    }
+
+    return Error::eNone;
+}
+
+// Writes file to a temporary one and renames it, so readers never see partially written content.
+Error WriteFileAtomic(const std::string& path, const std::vector<uint8_t>& data, bool sync = true)
+{
+    auto tmpPath = path + ".tmp";
+
+    int fd = open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        return Error::eFailed;
+    }
+
+    if (WriteAll(fd, data.data(), data.size()) != Error::eNone) {
+        close(fd);
+        unlink(tmpPath.c_str());
+
+        return Error::eFailed;
+    }
+
+    if ((sync && fsync(fd) != 0) || close(fd) != 0) {
+        unlink(tmpPath.c_str());
+
+        return Error::eFailed;
+    }
+
+    if (rename(tmpPath.c_str(), path.c_str()) != 0) {
+        unlink(tmpPath.c_str());
+
+        return Error::eFailed;
+    }
+
+    return Error::eNone;
+}
+
+// Flushes file data or directory entries. File removed since it was written needs no flush.
+Error SyncPath(const std::string& path, bool directory)
+{
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC | (directory ? O_DIRECTORY : 0));
+    if (fd < 0) {
+        return errno == ENOENT ? Error::eNone : Error::eFailed;
+    }
+
+    auto err = (directory ? fsync(fd) : fdatasync(fd)) == 0 ? Error::eNone : Error::eFailed;
+
+    if (close(fd) != 0) {
+        err = Error::eFailed;
+    }
+
+    return err;
+}
+
+Error MakeDir(const std::string& path)
+{
+    if (mkdir(path.c_str(), 0700) != 0 && errno != EEXIST) {
+        return Error::eFailed;
+    }
+
+    return Error::eNone;
+}
+
+bool IsValidCertType(const std::string& certType)
+{
+    return !certType.empty() && certType != "." && certType != ".." && certType.find('/') == std::string::npos;
+}
+
+std::string ToHex(const std::vector<uint8_t>& data)
+{
+    static const char cDigits[] = "0123456789abcdef";
+
+    std::string hex;
+
+    hex.reserve(data.size() * 2);
+
+    for (auto byte : data) {
+        hex.push_back(cDigits[byte >> 4]);
+        hex.push_back(cDigits[byte & 0x0f]);
+    }
+
+    return hex;
+}
+
+bool FromHex(const std::string& hex, std::vector<uint8_t>& data)
+{
+    auto toNibble = [](char digit) {
+        if (digit >= '0' && digit <= '9') {
+            return digit - '0';
+        }
+
+        if (digit >= 'a' && digit <= 'f') {
+            return digit - 'a' + 10;
+        }
+
+        return -1;
+    };
+
+    if (hex.size() % 2 != 0) {
+        return false;
+    }
+
+    data.clear();
+
+    for (size_t i = 0; i < hex.size(); i += 2) {
+        auto high = toNibble(hex[i]), low = toNibble(hex[i + 1]);
+
+        if (high < 0 || low < 0) {
+            return false;
+        }
+
+        data.push_back(static_cast<uint8_t>(high << 4 | low));
+    }
+
+    return true;
+}
+
+bool HasSuffix(const std::string& str, const std::string& suffix)
+{
+    return str.size() >= suffix.size() && str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+Error EncodeRecord(const std::vector<JournalEntry>& entries, std::vector<uint8_t>& record)
+{
+    IndexWriter payload;
+
+    payload.PutU32(static_cast<uint32_t>(entries.size()));
+
+    for (const auto& entry : entries) {
+        payload.PutU8(entry.mOp);
+        payload.PutField(entry.mCertType.data(), entry.mCertType.size());
+        payload.PutLongField(entry.mData.data(), entry.mData.size());
+    }
+
+    std::vector<uint8_t> checksum;
+
+    auto err = CalculateSHA256(payload.GetData().data(), payload.GetData().size(), checksum);
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    IndexWriter writer;
+
+    writer.PutLongField(payload.GetData().data(), payload.GetData().size());
+    writer.PutBytes(checksum.data(), checksum.size());
+
+    record = std::move(writer.GetData());
+
+    return Error::eNone;
+}
+
+// Decodes record at the start of data. Returns false if the record is incomplete or damaged.
+bool DecodeRecord(const uint8_t* data, size_t size, std::vector<JournalEntry>& entries, size_t& recordSize)
+{
+    IndexReader          reader(data, size);
+    std::vector<uint8_t> payload, checksum;
+    uint8_t              storedChecksum[cChecksumSize];
+
+    if (!reader.GetLongField(payload) || !reader.GetBytes(storedChecksum, sizeof(storedChecksum))
+        || CalculateSHA256(payload.data(), payload.size(), checksum) != Error::eNone
+        || checksum.size() != cChecksumSize || memcmp(checksum.data(), storedChecksum, cChecksumSize) != 0) {
+        return false;
+    }
+
+    recordSize = sizeof(uint32_t) + payload.size() + cChecksumSize;
+
+    IndexReader payloadReader(payload.data(), payload.size());
+    uint32_t    count = 0;
+
+    if (!payloadReader.GetU32(count)) {
+        return false;
+    }
+
+    entries.clear();
+
+    for (uint32_t i = 0; i < count; i++) {
+        JournalEntry entry;
+
+        if (!payloadReader.GetU8(entry.mOp) || !payloadReader.GetField(entry.mCertType)
+            || !payloadReader.GetLongField(entry.mData) || !IsValidCertType(entry.mCertType)) {
+            return false;
+        }
+
+        entries.push_back(std::move(entry));
+    }
+
+    return payloadReader.IsEnd();
+}
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Public
+ **********************************************************************************************************************/
+
+CertStorage::CertStorage(size_t maxJournalSize)
+    : mMaxJournalSize(maxJournalSize)
+{
+}
+
+CertStorage::~CertStorage()
+{
+    if (mJournalFd >= 0) {
+        close(mJournalFd);
+    }
+}
+
+Error CertStorage::Init(const std::string& path)
+{
+    std::lock_guard<std::mutex>               writeLock(mWriteMutex);
+    std::unique_lock<std::shared_timed_mutex> lock(mMutex);
+
+    mPath = path;
+
+    mByFingerprint.clear();
+    mBySerial.clear();
+    mBySubjectKeyID.clear();
+    mByCertType.clear();
+
+    if (mJournalFd >= 0) {
+        close(mJournalFd);
+    }
+
+    mJournalFd   = -1;
+    mJournalSize = 0;
+
+    mUnsyncedFiles.clear();
+    mUnsyncedDirs.clear();
+
+    auto err = MakeDir(mPath);
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    auto indexLoaded = LoadIndex() == Error::eNone;
+
+    // Index is missing or corrupted: parse stored certificates once, the new index is persisted by checkpoint.
+    if (!indexLoaded) {
+        err = RebuildIndex();
+        if (err != Error::eNone) {
+            return err;
+        }
+    }
+
+    mJournalFd = open((mPath + "/" + cJournalFileName).c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0600);
+    if (mJournalFd < 0) {
+        return Error::eFailed;
+    }
+
+    bool replayed = false;
+
+    err = ReplayJournal(replayed);
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    if (indexLoaded && !replayed) {
+        return Error::eNone;
+    }
+
+    return Checkpoint();
+}
+
+Error CertStorage::AddCert(const std::string& certType, const std::vector<uint8_t>& der, CertInfo& info)
+{
+    std::vector<CertInfo> infos;
+
+    auto err = AddCerts({{certType, der}}, infos);
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    info = std::move(infos.front());
+
+    return Error::eNone;
+}
+
+Error CertStorage::AddCerts(const std::vector<CertItem>& certs, std::vector<CertInfo>& infos)
+{
+    if (certs.empty()) {
+        return Error::eInvalidArgument;
+    }
+
+    std::vector<JournalEntry> entries;
+
+    infos.assign(certs.size(), CertInfo());
+
+    for (size_t i = 0; i < certs.size(); i++) {
+        if (!IsValidCertType(certs[i].mCertType)) {
+            return Error::eInvalidArgument;
+        }
+
+        infos[i].mCertType = certs[i].mCertType;
+
+        auto err = ParseCertInfo(certs[i].mDER, infos[i]);
+        if (err != Error::eNone) {
+            return err;
+        }
+
+        entries.push_back({cJournalAdd, certs[i].mCertType, certs[i].mDER});
+    }
+
+    std::vector<uint8_t> record;
+
+    auto err = EncodeRecord(entries, record);
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    std::lock_guard<std::mutex> writeLock(mWriteMutex);
+
+    if (mJournalFd < 0) {
+        return Error::eWrongState;
+    }
+
+    std::set<Key> keys;
+
+    for (const auto& info : infos) {
+        auto key = MakeKey(info.mFingerprint);
+
+        if (mByFingerprint.count(key) || !keys.insert(key).second) {
+            return Error::eAlreadyExist;
+        }
+    }
+
+    auto removeFiles = [this, &infos](size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            unlink(GetCertPath(infos[i]).c_str());
+        }
+    };
+
+    // Certificate files are not flushed: the journal record holds their content until the next checkpoint.
+    for (size_t i = 0; i < certs.size(); i++) {
+        err = MakeDir(mPath + "/" + certs[i].mCertType);
+        if (err == Error::eNone) {
+            err = WriteFileAtomic(GetCertPath(infos[i]), certs[i].mDER, false);
+        }
+
+        if (err != Error::eNone) {
+            removeFiles(i);
+
+            return err;
+        }
+
+        mUnsyncedFiles.insert(GetCertPath(infos[i]));
+        mUnsyncedDirs.insert(mPath + "/" + certs[i].mCertType);
+    }
+
+    err = AppendJournal(record);
+    if (err != Error::eNone) {
+        removeFiles(certs.size());
+
+        return err;
+    }
+
+    {
+        std::unique_lock<std::shared_timed_mutex> lock(mMutex);
+
+        for (const auto& info : infos) {
+            AddToIndex(info);
+        }
+    }
+
+    // Changes are committed: failed checkpoint is retried on the next change.
+    if (mJournalSize > mMaxJournalSize) {
+        Checkpoint();
+    }
+
+    return Error::eNone;
+}
+
+Error CertStorage::RemoveCert(const std::vector<uint8_t>& fingerprint)
+{
+    std::lock_guard<std::mutex> writeLock(mWriteMutex);
+
+    if (mJournalFd < 0) {
+        return Error::eWrongState;
+    }
+
+    auto it = mByFingerprint.find(MakeKey(fingerprint));
+    if (it == mByFingerprint.end()) {
+        return Error::eNotFound;
+    }
+
+    return CommitRemoval({it->second});
+}
+
+Error CertStorage::RemoveCerts(const std::string& certType)
+{
+    if (!IsValidCertType(certType)) {
+        return Error::eInvalidArgument;
+    }
+
+    std::lock_guard<std::mutex> writeLock(mWriteMutex);
+
+    if (mJournalFd < 0) {
+        return Error::eWrongState;
+    }
+
+    auto it = mByCertType.find(certType);
+    if (it == mByCertType.end()) {
+        return Error::eNone;
+    }
+
+    std::vector<CertInfo> infos;
+
+    for (const auto& key : it->second) {
+        infos.push_back(mByFingerprint.at(key));
+    }
+
+    return CommitRemoval(infos);
+}
+
+Error CertStorage::ReloadFiles(const std::string& certType, const std::vector<std::string>& fileNames, bool& changed)
+{
+    struct File {
+        std::string          mName;
+        std::vector<uint8_t> mDER;
+        std::vector<uint8_t> mFingerprint;
+    };
+
+    changed = false;
+
+    if (!IsValidCertType(certType)) {
+        return Error::eInvalidArgument;
+    }
+
+    std::lock_guard<std::mutex> writeLock(mWriteMutex);
+
+    if (mJournalFd < 0) {
+        return Error::eWrongState;
+    }
+
+    // The index is changed by writers only, so it is read under the write mutex without locking lookups.
+    auto                     typePath = mPath + "/" + certType;
+    std::vector<std::string> names    = fileNames;
+
+    if (names.empty()) {
+        std::set<std::string> dirNames;
+        DirPtr                dir(opendir(typePath.c_str()));
+
+        while (auto entry = dir ? readdir(dir.get()) : nullptr) {
+            dirNames.insert(entry->d_name);
+        }
+
+        auto it = mByCertType.find(certType);
+        if (it != mByCertType.end()) {
+            for (const auto& key : it->second) {
+                auto name = ToHex(mByFingerprint.at(key).mFingerprint) + cCertFileExt;
+
+                if (!dirNames.erase(name)) {
+                    names.push_back(name);
+                }
+            }
+        }
+
+        names.insert(names.end(), dirNames.begin(), dirNames.end());
+    }
+
+    std::vector<File> files;
+
+    for (const auto& name : names) {
+        if (!HasSuffix(name, cCertFileExt) || name.find('/') != std::string::npos) {
+            continue;
+        }
+
+        File file {name, {}, {}};
+
+        auto err = ReadFile(typePath + "/" + name, file.mDER);
+        if (err == Error::eNone) {
+            err = CalculateSHA256(file.mDER.data(), file.mDER.size(), file.mFingerprint);
+        }
+
+        if (err != Error::eNone && err != Error::eNotFound) {
+            continue;
+        }
+
+        files.push_back(std::move(file));
+    }
+
+    std::vector<JournalEntry> entries;
+    std::vector<CertInfo>     removed, added;
+    std::set<Key>             removedKeys, addedKeys;
+
+    // Removals go first: a certificate moved to another file is removed by its old name and added by the new one.
+    for (const auto& file : files) {
+        std::vector<uint8_t> fingerprint;
+
+        if (!FromHex(file.mName.substr(0, file.mName.size() - strlen(cCertFileExt)), fingerprint)
+            || fingerprint == file.mFingerprint) {
+            continue;
+        }
+
+        auto it = mByFingerprint.find(MakeKey(fingerprint));
+        if (it == mByFingerprint.end() || it->second.mCertType != certType || !removedKeys.insert(it->first).second) {
+            continue;
+        }
+
+        removed.push_back(it->second);
+        entries.push_back({cJournalRemove, certType, fingerprint});
+    }
+
+    for (const auto& file : files) {
+        auto     key = MakeKey(file.mFingerprint);
+        CertInfo info;
+
+        info.mCertType = certType;
+
+        if (file.mDER.empty() || (mByFingerprint.count(key) && !removedKeys.count(key)) || addedKeys.count(key)) {
+            continue;
+        }
+
+        // Skip broken files as on index rebuild.
+        if (ParseCertInfo(file.mDER, info) != Error::eNone) {
+            continue;
+        }
+
+        auto path = typePath + "/" + file.mName;
+
+        if (GetCertPath(info) != path && rename(path.c_str(), GetCertPath(info).c_str()) != 0) {
+            continue;
+        }
+
+        // The file content is flushed by checkpoint, when the journal record holding it is truncated.
+        mUnsyncedFiles.insert(GetCertPath(info));
+
+        addedKeys.insert(key);
+        added.push_back(std::move(info));
+        entries.push_back({cJournalAdd, certType, file.mDER});
+    }
+
+    if (entries.empty()) {
+        return Error::eNone;
+    }
+
+    std::vector<uint8_t> record;
+
+    auto err = EncodeRecord(entries, record);
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    err = AppendJournal(record);
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    {
+        std::unique_lock<std::shared_timed_mutex> lock(mMutex);
+
+        for (const auto& info : removed) {
+            RemoveFromIndex(info);
+        }
+
+        for (const auto& info : added) {
+            AddToIndex(info);
+        }
+    }
+
+    mUnsyncedDirs.insert(typePath);
+
+    changed = true;
+
+    if (mJournalSize > mMaxJournalSize) {
+        Checkpoint();
+    }
+
+    return Error::eNone;
+}
+
+std::string CertStorage::GetPath() const
+{
+    std::shared_lock<std::shared_timed_mutex> lock(mMutex);
+
+    return mPath;
+}
+
+Error CertStorage::GetCerts(const std::string& certType, std::vector<CertInfo>& certs) const
+{
+    std::shared_lock<std::shared_timed_mutex> lock(mMutex);
+
+    certs.clear();
+
+    auto it = mByCertType.find(certType);
+    if (it == mByCertType.end()) {
+        return Error::eNone;
+    }
+
+    for (const auto& key : it->second) {
+        certs.push_back(mByFingerprint.at(key));
+    }
+
+    return Error::eNone;
+}
+
+Error CertStorage::FindBySerial(
+    const std::vector<uint8_t>& issuer, const std::vector<uint8_t>& serial, CertInfo& info) const
+{
+    std::shared_lock<std::shared_timed_mutex> lock(mMutex);
+
+    auto it = mBySerial.find(MakeSerialKey(issuer, serial));
+    if (it == mBySerial.end()) {
+        return Error::eNotFound;
+    }
+
+    info = mByFingerprint.at(it->second);
+
+    return Error::eNone;
+}
+
+Error CertStorage::FindBySubjectKeyID(const std::vector<uint8_t>& subjectKeyID, CertInfo& info) const
+{
+    std::shared_lock<std::shared_timed_mutex> lock(mMutex);
+
+    auto it = mBySubjectKeyID.find(MakeKey(subjectKeyID));
+    if (it == mBySubjectKeyID.end()) {
+        return Error::eNotFound;
+    }
+
+    const CertInfo* latest = nullptr;
+
+    for (const auto& key : it->second) {
+        const auto& cert = mByFingerprint.at(key);
+
+        if (!latest || cert.mNotAfter > latest->mNotAfter) {
+            latest = &cert;
+        }
+    }
+
+    info = *latest;
+
+    return Error::eNone;
+}
+
+Error CertStorage::FindByFingerprint(const std::vector<uint8_t>& fingerprint, CertInfo& info) const
+{
+    std::shared_lock<std::shared_timed_mutex> lock(mMutex);
+
+    auto it = mByFingerprint.find(MakeKey(fingerprint));
+    if (it == mByFingerprint.end()) {
+        return Error::eNotFound;
+    }
+
+    info = it->second;
+
+    return Error::eNone;
+}
+
+Error CertStorage::ReadCert(const CertInfo& info, std::vector<uint8_t>& der) const
+{
+    if (!IsValidCertType(info.mCertType)) {
+        return Error::eInvalidArgument;
+    }
+
+    std::string path;
+
+    {
+        std::shared_lock<std::shared_timed_mutex> lock(mMutex);
+
+        path = GetCertPath(info);
+    }
+
+    return ReadFile(path, der);
+}
+
+Error CertStorage::ParseCertInfo(const std::vector<uint8_t>& der, CertInfo& info)
+{
+    X509View cert;
+
+    auto err = ParseX509(der, cert);
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    info.mIssuer       = cert.mIssuer.ToVector();
+    info.mSerial       = cert.mSerial.ToVector();
+    info.mSubjectKeyID = cert.mSubjectKeyID.ToVector();
+    info.mNotBefore    = cert.mNotBefore;
+    info.mNotAfter     = cert.mNotAfter;
+
+    return CalculateSHA256(der.data(), der.size(), info.mFingerprint);
+}
+
+/***********************************************************************************************************************
+ * Private
+ **********************************************************************************************************************/
+
+CertStorage::Key CertStorage::MakeKey(const std::vector<uint8_t>& data)
+{
+    return Key(data.begin(), data.end());
+}
+
+CertStorage::Key CertStorage::MakeSerialKey(const std::vector<uint8_t>& issuer, const std::vector<uint8_t>& serial)
+{
+    // Length prefix keeps issuer and serial boundary unambiguous.
+    Key key;
+
+    key.reserve(sizeof(uint32_t) + issuer.size() + serial.size());
+
+    auto size = static_cast<uint32_t>(issuer.size());
+
+    key.append(reinterpret_cast<const char*>(&size), sizeof(size));
+    key.append(issuer.begin(), issuer.end());
+    key.append(serial.begin(), serial.end());
+
+    return key;
+}
+
+std::string CertStorage::GetCertPath(const CertInfo& info) const
+{
+    return mPath + "/" + info.mCertType + "/" + ToHex(info.mFingerprint) + cCertFileExt;
+}
+
+Error CertStorage::LoadIndex()
+{
+    std::vector<uint8_t> data;
+
+    auto err = ReadFile(mPath + "/" + cIndexFileName, data);
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    if (data.size() < sizeof(cIndexMagic) + cChecksumSize) {
+        return Error::eInvalidArgument;
+    }
+
+    std::vector<uint8_t> checksum;
+
+    err = CalculateSHA256(data.data(), data.size() - cChecksumSize, checksum);
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    if (checksum.size() != cChecksumSize
+        || memcmp(checksum.data(), data.data() + data.size() - cChecksumSize, cChecksumSize) != 0) {
+        return Error::eInvalidArgument;
+    }
+
+    IndexReader reader(data.data(), data.size() - cChecksumSize);
+    char        magic[sizeof(cIndexMagic)];
+    uint32_t    version = 0, count = 0;
+
+    if (!reader.GetBytes(magic, sizeof(magic)) || memcmp(magic, cIndexMagic, sizeof(magic)) != 0
+        || !reader.GetU32(version) || version != cIndexVersion || !reader.GetU32(count)) {
+        return Error::eInvalidArgument;
+    }
+
+    // Count is not trusted: the records must fit into the file before they are allocated.
+    if (count > reader.GetRemaining() / cMinIndexRecordSize) {
+        return Error::eInvalidArgument;
+    }
+
+    std::vector<CertInfo> certs(count);
+
+    for (auto& cert : certs) {
+        int64_t notBefore = 0, notAfter = 0;
+
+        if (!reader.GetField(cert.mCertType) || !reader.GetField(cert.mIssuer) || !reader.GetField(cert.mSerial)
+            || !reader.GetField(cert.mSubjectKeyID) || !reader.GetField(cert.mFingerprint) || !reader.GetI64(notBefore)
+            || !reader.GetI64(notAfter) || !IsValidCertType(cert.mCertType)) {
+            return Error::eInvalidArgument;
+        }
+
+        cert.mNotBefore = static_cast<time_t>(notBefore);
+        cert.mNotAfter  = static_cast<time_t>(notAfter);
+    }
+
+    if (!reader.IsEnd()) {
+        return Error::eInvalidArgument;
+    }
+
+    for (const auto& cert : certs) {
+        AddToIndex(cert);
+    }
+
+    return Error::eNone;
+}
+
+Error CertStorage::SaveIndex() const
+{
+    IndexWriter writer;
+
+    writer.PutBytes(cIndexMagic, sizeof(cIndexMagic));
+    writer.PutU32(cIndexVersion);
+    writer.PutU32(static_cast<uint32_t>(mByFingerprint.size()));
+
+    // Write in cert type order, so the index is loaded with the same per type ordering.
+    for (const auto& certType : mByCertType) {
+        for (const auto& key : certType.second) {
+            const auto& cert = mByFingerprint.at(key);
+
+            writer.PutField(cert.mCertType.data(), cert.mCertType.size());
+            writer.PutField(cert.mIssuer.data(), cert.mIssuer.size());
+            writer.PutField(cert.mSerial.data(), cert.mSerial.size());
+            writer.PutField(cert.mSubjectKeyID.data(), cert.mSubjectKeyID.size());
+            writer.PutField(cert.mFingerprint.data(), cert.mFingerprint.size());
+            writer.PutI64(cert.mNotBefore);
+            writer.PutI64(cert.mNotAfter);
+        }
+    }
+
+    auto&                data = writer.GetData();
+    std::vector<uint8_t> checksum;
+
+    auto err = CalculateSHA256(data.data(), data.size(), checksum);
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    data.insert(data.end(), checksum.begin(), checksum.end());
+
+    return WriteFileAtomic(mPath + "/" + cIndexFileName, data);
+}
+
+Error CertStorage::RebuildIndex()
+{
+    DirPtr root(opendir(mPath.c_str()));
+    if (!root) {
+        return Error::eFailed;
+    }
+
+    while (auto typeEntry = readdir(root.get())) {
+        std::string certType = typeEntry->d_name;
+
+        if (!IsValidCertType(certType)) {
+            continue;
+        }
+
+        DirPtr typeDir(opendir((mPath + "/" + certType).c_str()));
+        if (!typeDir) {
+            continue;
+        }
+
+        while (auto certEntry = readdir(typeDir.get())) {
+            std::string fileName = certEntry->d_name;
+
+            if (!HasSuffix(fileName, cCertFileExt)) {
+                continue;
+            }
+
+            std::vector<uint8_t> der;
+            CertInfo             info;
+
+            info.mCertType = certType;
+
+            // Skip unreadable or broken files instead of failing the whole storage.
+            if (ReadFile(mPath + "/" + certType + "/" + fileName, der) != Error::eNone
+                || ParseCertInfo(der, info) != Error::eNone || mByFingerprint.count(MakeKey(info.mFingerprint))) {
+                continue;
+            }
+
+            AddToIndex(info);
+        }
+    }
+
+    return Error::eNone;
+}
+
+Error CertStorage::ReplayJournal(bool& replayed)
+{
+    std::vector<uint8_t> data;
+
+    replayed = false;
+
+    auto err = ReadFile(mPath + "/" + cJournalFileName, data);
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    std::vector<JournalEntry> entries;
+    size_t                    pos = 0, recordSize = 0;
+
+    while (pos < data.size() && DecodeRecord(data.data() + pos, data.size() - pos, entries, recordSize)) {
+        for (const auto& entry : entries) {
+            CertInfo info;
+
+            info.mCertType = entry.mCertType;
+
+            if (entry.mOp == cJournalRemove) {
+                info.mFingerprint = entry.mData;
+
+                auto it = mByFingerprint.find(MakeKey(info.mFingerprint));
+                if (it != mByFingerprint.end()) {
+                    RemoveFromIndex(it->second);
+                }
+
+                unlink(GetCertPath(info).c_str());
+                mUnsyncedDirs.insert(mPath + "/" + info.mCertType);
+
+                continue;
+            }
+
+            err = ParseCertInfo(entry.mData, info);
+            if (err != Error::eNone) {
+                return err;
+            }
+
+            // Certificate file is rewritten: its content may have been lost before checkpoint.
+            err = MakeDir(mPath + "/" + info.mCertType);
+            if (err == Error::eNone) {
+                err = WriteFileAtomic(GetCertPath(info), entry.mData, false);
+            }
+
+            if (err != Error::eNone) {
+                return err;
+            }
+
+            mUnsyncedFiles.insert(GetCertPath(info));
+            mUnsyncedDirs.insert(mPath + "/" + info.mCertType);
+
+            if (!mByFingerprint.count(MakeKey(info.mFingerprint))) {
+                AddToIndex(info);
+            }
+        }
+
+        pos += recordSize;
+        replayed = true;
+    }
+
+    // Data after the last complete record is a change torn by power loss, it has never been committed.
+    if (pos < data.size() && ftruncate(mJournalFd, pos) != 0) {
+        return Error::eFailed;
+    }
+
+    mJournalSize = pos;
+
+    return Error::eNone;
+}
+
+Error CertStorage::AppendJournal(const std::vector<uint8_t>& record)
+{
+    // The only flush of a change: the record commits it.
+    auto err = WriteAll(mJournalFd, record.data(), record.size());
+    if (err == Error::eNone && fdatasync(mJournalFd) != 0) {
+        err = Error::eFailed;
+    }
+
+    if (err != Error::eNone) {
+        // Records appended after a partially written one would be lost on replay.
+        if (ftruncate(mJournalFd, mJournalSize) != 0) {
+            close(mJournalFd);
+            mJournalFd = -1;
+        }
+
+        return err;
+    }
+
+    mJournalSize += record.size();
+
+    return Error::eNone;
+}
+
+Error CertStorage::Checkpoint()
+{
+    auto err = SaveIndex();
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    // Only certificate files and directories changed since the previous checkpoint are flushed, the storage directory
+    // holds the index rename and new type directories.
+    mUnsyncedDirs.insert(mPath);
+
+    for (const auto& path : mUnsyncedFiles) {
+        err = SyncPath(path, false);
+        if (err != Error::eNone) {
+            return err;
+        }
+    }
+
+    for (const auto& path : mUnsyncedDirs) {
+        err = SyncPath(path, true);
+        if (err != Error::eNone) {
+            return err;
+        }
+    }
+
+    mUnsyncedFiles.clear();
+    mUnsyncedDirs.clear();
+
+    if (ftruncate(mJournalFd, 0) != 0 || fsync(mJournalFd) != 0) {
+        return Error::eFailed;
+    }
+
+    mJournalSize = 0;
+
+    return Error::eNone;
+}
+
+Error CertStorage::CommitRemoval(const std::vector<CertInfo>& infos)
+{
+    std::vector<JournalEntry> entries;
+    std::vector<uint8_t>      record;
+
+    for (const auto& info : infos) {
+        entries.push_back({cJournalRemove, info.mCertType, info.mFingerprint});
+    }
+
+    auto err = EncodeRecord(entries, record);
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    err = AppendJournal(record);
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    {
+        std::unique_lock<std::shared_timed_mutex> lock(mMutex);
+
+        for (const auto& info : infos) {
+            RemoveFromIndex(info);
+        }
+    }
+
+    // Orphaned certificate files are harmless: they are not referenced by the index.
+    for (const auto& info : infos) {
+        unlink(GetCertPath(info).c_str());
+        mUnsyncedDirs.insert(mPath + "/" + info.mCertType);
+    }
+
+    if (mJournalSize > mMaxJournalSize) {
+        Checkpoint();
+    }
+
+    return Error::eNone;
+}
+
+void CertStorage::AddToIndex(const CertInfo& info)
+{
+    auto key = MakeKey(info.mFingerprint);
+
+    mByFingerprint[key] = info;
+    mBySerial[MakeSerialKey(info.mIssuer, info.mSerial)] = key;
+    mByCertType[info.mCertType].push_back(key);
+
+    if (!info.mSubjectKeyID.empty()) {
+        mBySubjectKeyID[MakeKey(info.mSubjectKeyID)].push_back(key);
+    }
+}
+
+void CertStorage::RemoveFromIndex(const CertInfo& info)
+{
+    auto key = MakeKey(info.mFingerprint);
+
+    auto removeKey = [&key](std::vector<Key>& keys) {
+        keys.erase(std::remove(keys.begin(), keys.end(), key), keys.end());
+
+        return keys.empty();
+    };
+
+    auto serialIt = mBySerial.find(MakeSerialKey(info.mIssuer, info.mSerial));
+    if (serialIt != mBySerial.end() && serialIt->second == key) {
+        mBySerial.erase(serialIt);
+    }
+
+    auto typeIt = mByCertType.find(info.mCertType);
+    if (typeIt != mByCertType.end() && removeKey(typeIt->second)) {
+        mByCertType.erase(typeIt);
+    }
+
+    auto keyIDIt = mBySubjectKeyID.find(MakeKey(info.mSubjectKeyID));
+    if (keyIDIt != mBySubjectKeyID.end() && removeKey(keyIDIt->second)) {
+        mBySubjectKeyID.erase(keyIDIt);
+    }
+
+    mByFingerprint.erase(key);
+}
+
+} // namespace certhandler
+} // namespace iam
+} // namespace aos
@@ -0,0 +1,299 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CERTSTORAGE_HPP_
+#define CERTSTORAGE_HPP_
+
+#include <cstdint>
+#include <ctime>
+#include <mutex>
+#include <set>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "error/error.hpp"
+
+namespace aos {
+namespace iam {
+namespace certhandler {
+
+/** @addtogroup iam Identification and Access Manager
+ *  @{
+ */
+
+/**
+ * Certificate info.
+ */
+struct CertInfo {
+    /**
+     * Certificate type.
+     */
+    std::string mCertType;
+
+    /**
+     * DER encoded issuer name.
+     */
+    std::vector<uint8_t> mIssuer;
+
+    /**
+     * Serial number, big endian without leading zeros.
+     */
+    std::vector<uint8_t> mSerial;
+
+    /**
+     * Subject key identifier.
+     */
+    std::vector<uint8_t> mSubjectKeyID;
+
+    /**
+     * SHA-256 fingerprint of DER certificate.
+     */
+    std::vector<uint8_t> mFingerprint;
+
+    /**
+     * Validity start.
+     */
+    time_t mNotBefore = 0;
+
+    /**
+     * Validity end.
+     */
+    time_t mNotAfter = 0;
+};
+
+/**
+ * Certificate to add.
+ */
+struct CertItem {
+    /**
+     * Certificate type.
+     */
+    std::string mCertType;
+
+    /**
+     * DER encoded certificate.
+     */
+    std::vector<uint8_t> mDER;
+};
+
+/**
+ * Persistent certificate storage indexed by certificate type, issuer and serial, subject key identifier and
+ * fingerprint.
+ *
+ * Certificates are stored as DER files in per certificate type subdirectories. The index is kept in memory and
+ * persisted in a compact binary file, so startup does not parse certificates unless the index is missing or corrupted.
+ *
+ * Changes are committed to a write-ahead journal: each add or remove is a single checksummed record which is flushed
+ * with one fsync, certificate files are written without flushing. A journal exceeding its max size is checkpointed:
+ * the index is saved, certificate files and directories changed since the previous checkpoint are flushed and the
+ * journal is truncated. On startup records of the journal are replayed, so recovery work is bounded by the journal size
+ * rather than by the number of stored certificates. A record torn by power loss is discarded together with its change.
+ */
+class CertStorage {
+public:
+    /**
+     * Index file name.
+     */
+    static constexpr const char* cIndexFileName = "index.bin";
+
+    /**
+     * Journal file name.
+     */
+    static constexpr const char* cJournalFileName = "journal.bin";
+
+    /**
+     * Default journal size which triggers checkpoint.
+     */
+    static constexpr size_t cDefaultMaxJournalSize = 256 * 1024;
+
+    /**
+     * Creates certificate storage.
+     *
+     * @param maxJournalSize journal size which triggers checkpoint.
+     */
+    explicit CertStorage(size_t maxJournalSize = cDefaultMaxJournalSize);
+
+    /**
+     * Destroys certificate storage.
+     */
+    ~CertStorage();
+
+    CertStorage(const CertStorage&) = delete;
+    CertStorage& operator=(const CertStorage&) = delete;
+
+    /**
+     * Loads storage index. Rebuilds the index from certificate files if it is missing or corrupted.
+     *
+     * @param path storage directory.
+     * @return Error.
+     */
+    Error Init(const std::string& path);
+
+    /**
+     * Adds certificate.
+     *
+     * @param certType certificate type.
+     * @param der DER encoded certificate.
+     * @param[out] info certificate info.
+     * @return Error.
+     */
+    Error AddCert(const std::string& certType, const std::vector<uint8_t>& der, CertInfo& info);
+
+    /**
+     * Adds certificates atomically: either all certificates are added or none, also across power loss.
+     *
+     * @param certs certificates.
+     * @param[out] infos certificates info in the order of certificates.
+     * @return Error eAlreadyExist if any certificate is already stored or repeated.
+     */
+    Error AddCerts(const std::vector<CertItem>& certs, std::vector<CertInfo>& infos);
+
+    /**
+     * Removes certificate.
+     *
+     * @param fingerprint certificate fingerprint.
+     * @return Error.
+     */
+    Error RemoveCert(const std::vector<uint8_t>& fingerprint);
+
+    /**
+     * Removes all certificates of the type atomically: the removal is committed with one journal record.
+     *
+     * @param certType certificate type.
+     * @return Error.
+     */
+    Error RemoveCerts(const std::string& certType);
+
+    /**
+     * Reloads certificate files of the type changed by external tools. Files of indexed certificates which are gone
+     * or replaced are removed from the index, new files are parsed, renamed to the storage naming scheme and added.
+     * All changes are committed with one journal record. Only the given files are read, so reload cost depends on the
+     * number of changed files rather than on the storage size.
+     *
+     * @param certType certificate type.
+     * @param fileNames changed file names in the type directory, empty to rescan the directory. On rescan, files of
+     *                  indexed certificates are not read again.
+     * @param[out] changed whether the index is changed.
+     * @return Error.
+     */
+    Error ReloadFiles(const std::string& certType, const std::vector<std::string>& fileNames, bool& changed);
+
+    /**
+     * Returns storage directory.
+     *
+     * @return std::string.
+     */
+    std::string GetPath() const;
+
+    /**
+     * Returns certificates of the type.
+     *
+     * @param certType certificate type.
+     * @param[out] certs certificates info.
+     * @return Error.
+     */
+    Error GetCerts(const std::string& certType, std::vector<CertInfo>& certs) const;
+
+    /**
+     * Finds certificate by issuer and serial number.
+     *
+     * @param issuer DER encoded issuer name.
+     * @param serial serial number.
+     * @param[out] info certificate info.
+     * @return Error.
+     */
+    Error FindBySerial(const std::vector<uint8_t>& issuer, const std::vector<uint8_t>& serial, CertInfo& info) const;
+
+    /**
+     * Finds certificate by subject key identifier. If several certificates share the key, the one with the latest
+     * validity end is returned.
+     *
+     * @param subjectKeyID subject key identifier.
+     * @param[out] info certificate info.
+     * @return Error.
+     */
+    Error FindBySubjectKeyID(const std::vector<uint8_t>& subjectKeyID, CertInfo& info) const;
+
+    /**
+     * Finds certificate by fingerprint.
+     *
+     * @param fingerprint SHA-256 fingerprint.
+     * @param[out] info certificate info.
+     * @return Error.
+     */
+    Error FindByFingerprint(const std::vector<uint8_t>& fingerprint, CertInfo& info) const;
+
+    /**
+     * Reads DER encoded certificate.
+     *
+     * @param info certificate info.
+     * @param[out] der DER encoded certificate.
+     * @return Error.
+     */
+    Error ReadCert(const CertInfo& info, std::vector<uint8_t>& der) const;
+
+    /**
+     * Parses certificate info.
+     *
+     * @param der DER encoded certificate.
+     * @param[out] info certificate info, certificate type is not changed.
+     * @return Error.
+     */
+    static Error ParseCertInfo(const std::vector<uint8_t>& der, CertInfo& info);
+
+private:
+    using Key = std::string;
+
+    static Key MakeKey(const std::vector<uint8_t>& data);
+    static Key MakeSerialKey(const std::vector<uint8_t>& issuer, const std::vector<uint8_t>& serial);
+
+    std::string GetCertPath(const CertInfo& info) const;
+    Error       LoadIndex();
+    Error       SaveIndex() const;
+    Error       RebuildIndex();
+    Error       ReplayJournal(bool& replayed);
+    Error       AppendJournal(const std::vector<uint8_t>& record);
+    Error       Checkpoint();
+    Error       CommitRemoval(const std::vector<CertInfo>& infos);
+    void        AddToIndex(const CertInfo& info);
+    void        RemoveFromIndex(const CertInfo& info);
+
+    // Writers are serialized by the write mutex and keep it while files are written. The index itself is guarded by the
+    // shared mutex, which writers hold exclusively only to update it, so lookups don't wait for disk I/O.
+    std::string                                        mPath;
+    size_t                                             mMaxJournalSize;
+    size_t                                             mJournalSize = 0;
+    int                                                mJournalFd = -1;
+    std::mutex                                         mWriteMutex;
+    mutable std::shared_timed_mutex                    mMutex;
+    std::unordered_map<Key, CertInfo>                  mByFingerprint;
+    std::unordered_map<Key, Key>                       mBySerial;
+    std::unordered_map<Key, std::vector<Key>>          mBySubjectKeyID;
+    std::unordered_map<std::string, std::vector<Key>> mByCertType;
+    std::set<std::string>                              mUnsyncedFiles;
+    std::set<std::string>                              mUnsyncedDirs;
+};
+
+/** @}*/
+
+} // namespace certhandler
+} // namespace iam
+} // namespace aos
+
+#endif
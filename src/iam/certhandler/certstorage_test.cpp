@@ -0,0 +1,512 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include "certstorage.hpp"
+#include "crypto/sha256.hpp"
+#include "testcerts.hpp"
+
+using namespace aos;
+using namespace aos::iam::certhandler;
+using namespace aos::iam::certhandler::test;
+
+/***********************************************************************************************************************
+ * Utils
+ **********************************************************************************************************************/
+
+static std::vector<uint8_t> CreateCert(long serial, long notAfter, EVP_PKEY* key)
+{
+    TestCertParams params;
+
+    params.mSerial   = serial;
+    params.mNotAfter = notAfter;
+
+    return CreateTestCert(params, key);
+}
+
+static std::string ToHex(const std::vector<uint8_t>& data)
+{
+    std::string hex;
+
+    for (auto byte : data) {
+        hex += "0123456789abcdef"[byte >> 4];
+        hex += "0123456789abcdef"[byte & 0x0f];
+    }
+
+    return hex;
+}
+
+static size_t GetFileSize(const std::string& path)
+{
+    struct stat st;
+
+    return stat(path.c_str(), &st) == 0 ? static_cast<size_t>(st.st_size) : 0;
+}
+
+/***********************************************************************************************************************
+ * Tests
+ **********************************************************************************************************************/
+
+TEST(certstorage, Lookup)
+{
+    TempDir     dir;
+    CertStorage storage;
+
+    ASSERT_EQ(storage.Init(dir.GetPath()), Error::eNone);
+
+    auto key      = GenerateTestKey();
+    auto otherKey = GenerateTestKey();
+    auto oldCert  = CreateCert(1, 365, key.get());
+    auto newCert  = CreateCert(2, 730, key.get());
+    auto other    = CreateCert(3, 365, otherKey.get());
+
+    CertInfo oldInfo, newInfo, otherInfo, info;
+
+    ASSERT_EQ(storage.AddCert("online", oldCert, oldInfo), Error::eNone);
+    ASSERT_EQ(storage.AddCert("online", newCert, newInfo), Error::eNone);
+    ASSERT_EQ(storage.AddCert("offline", other, otherInfo), Error::eNone);
+
+    EXPECT_EQ(oldInfo.mCertType, "online");
+    EXPECT_EQ(oldInfo.mSerial, std::vector<uint8_t> {1});
+    EXPECT_EQ(oldInfo.mFingerprint.size(), 32);
+    EXPECT_FALSE(oldInfo.mSubjectKeyID.empty());
+    EXPECT_LT(oldInfo.mNotBefore, oldInfo.mNotAfter);
+
+    ASSERT_EQ(storage.FindBySerial(newInfo.mIssuer, newInfo.mSerial, info), Error::eNone);
+    EXPECT_EQ(info.mFingerprint, newInfo.mFingerprint);
+
+    ASSERT_EQ(storage.FindByFingerprint(otherInfo.mFingerprint, info), Error::eNone);
+    EXPECT_EQ(info.mCertType, "offline");
+
+    // Renewed certificate with the same key wins.
+    ASSERT_EQ(storage.FindBySubjectKeyID(oldInfo.mSubjectKeyID, info), Error::eNone);
+    EXPECT_EQ(info.mFingerprint, newInfo.mFingerprint);
+
+    std::vector<CertInfo> certs;
+
+    ASSERT_EQ(storage.GetCerts("online", certs), Error::eNone);
+    EXPECT_EQ(certs.size(), 2);
+
+    std::vector<uint8_t> der;
+
+    ASSERT_EQ(storage.ReadCert(newInfo, der), Error::eNone);
+    EXPECT_EQ(der, newCert);
+
+    EXPECT_EQ(storage.FindBySerial(newInfo.mIssuer, {9}, info), Error::eNotFound);
+    EXPECT_EQ(storage.FindByFingerprint({}, info), Error::eNotFound);
+}
+
+TEST(certstorage, AddErrors)
+{
+    TempDir     dir;
+    CertStorage storage;
+    CertInfo    info;
+
+    ASSERT_EQ(storage.Init(dir.GetPath()), Error::eNone);
+
+    auto key  = GenerateTestKey();
+    auto cert = CreateCert(1, 365, key.get());
+
+    EXPECT_EQ(storage.AddCert("../online", cert, info), Error::eInvalidArgument);
+    EXPECT_EQ(storage.AddCert("online", {0x30, 0x00}, info), Error::eInvalidArgument);
+    EXPECT_EQ(storage.AddCert("online", cert, info), Error::eNone);
+    EXPECT_EQ(storage.AddCert("online", cert, info), Error::eAlreadyExist);
+}
+
+TEST(certstorage, RemoveCert)
+{
+    TempDir     dir;
+    CertStorage storage;
+    CertInfo    info;
+
+    ASSERT_EQ(storage.Init(dir.GetPath()), Error::eNone);
+
+    auto key = GenerateTestKey();
+
+    ASSERT_EQ(storage.AddCert("online", CreateCert(1, 365, key.get()), info), Error::eNone);
+    ASSERT_EQ(storage.RemoveCert(info.mFingerprint), Error::eNone);
+    EXPECT_EQ(storage.RemoveCert(info.mFingerprint), Error::eNotFound);
+
+    CertInfo found;
+
+    EXPECT_EQ(storage.FindBySerial(info.mIssuer, info.mSerial, found), Error::eNotFound);
+    EXPECT_EQ(storage.FindBySubjectKeyID(info.mSubjectKeyID, found), Error::eNotFound);
+
+    std::vector<CertInfo> certs;
+
+    ASSERT_EQ(storage.GetCerts("online", certs), Error::eNone);
+    EXPECT_TRUE(certs.empty());
+
+    std::vector<uint8_t> der;
+
+    EXPECT_EQ(storage.ReadCert(info, der), Error::eNotFound);
+}
+
+TEST(certstorage, RemoveCerts)
+{
+    TempDir               dir;
+    std::vector<CertInfo> infos, certs;
+    auto                  key         = GenerateTestKey();
+    auto                  journalPath = dir.GetPath() + "/" + CertStorage::cJournalFileName;
+
+    {
+        CertStorage           storage;
+        std::vector<CertItem> items {{"online", CreateCert(1, 365, key.get())},
+            {"online", CreateCert(2, 365, key.get())}, {"offline", CreateCert(3, 365, key.get())}};
+
+        ASSERT_EQ(storage.Init(dir.GetPath()), Error::eNone);
+        ASSERT_EQ(storage.AddCerts(items, infos), Error::eNone);
+
+        EXPECT_EQ(storage.RemoveCerts("../online"), Error::eInvalidArgument);
+        EXPECT_EQ(storage.RemoveCerts("unknown"), Error::eNone);
+
+        ASSERT_EQ(storage.RemoveCerts("online"), Error::eNone);
+
+        ASSERT_EQ(storage.GetCerts("online", certs), Error::eNone);
+        EXPECT_TRUE(certs.empty());
+        ASSERT_EQ(storage.GetCerts("offline", certs), Error::eNone);
+        EXPECT_EQ(certs.size(), 1);
+    }
+
+    // Emulate power loss tearing the removal record: removal of all certificates is discarded together.
+    ASSERT_EQ(truncate(journalPath.c_str(), GetFileSize(journalPath) - 1), 0);
+
+    CertStorage storage;
+
+    ASSERT_EQ(storage.Init(dir.GetPath()), Error::eNone);
+    ASSERT_EQ(storage.GetCerts("online", certs), Error::eNone);
+    EXPECT_EQ(certs.size(), 2);
+}
+
+TEST(certstorage, LoadIndex)
+{
+    TempDir  dir;
+    CertInfo info;
+    auto     key = GenerateTestKey();
+
+    {
+        CertStorage storage;
+
+        ASSERT_EQ(storage.Init(dir.GetPath()), Error::eNone);
+        ASSERT_EQ(storage.AddCert("online", CreateCert(1, 365, key.get()), info), Error::eNone);
+    }
+
+    // Certificate file added behind storage back is not seen: startup loads the index without scanning certificates.
+    auto extra = CreateCert(2, 365, key.get());
+
+    std::ofstream(dir.GetPath() + "/online/extra.der", std::ios::binary)
+        .write(reinterpret_cast<const char*>(extra.data()), extra.size());
+
+    CertStorage storage;
+    CertInfo    found;
+
+    ASSERT_EQ(storage.Init(dir.GetPath()), Error::eNone);
+
+    ASSERT_EQ(storage.FindByFingerprint(info.mFingerprint, found), Error::eNone);
+    EXPECT_EQ(found.mCertType, "online");
+    EXPECT_EQ(found.mSerial, info.mSerial);
+    EXPECT_EQ(found.mIssuer, info.mIssuer);
+    EXPECT_EQ(found.mSubjectKeyID, info.mSubjectKeyID);
+    EXPECT_EQ(found.mNotAfter, info.mNotAfter);
+
+    std::vector<CertInfo> certs;
+
+    ASSERT_EQ(storage.GetCerts("online", certs), Error::eNone);
+    EXPECT_EQ(certs.size(), 1);
+}
+
+TEST(certstorage, RebuildCorruptedIndex)
+{
+    TempDir  dir;
+    CertInfo info;
+    auto     key = GenerateTestKey();
+
+    {
+        CertStorage storage;
+
+        ASSERT_EQ(storage.Init(dir.GetPath()), Error::eNone);
+        ASSERT_EQ(storage.AddCert("online", CreateCert(1, 365, key.get()), info), Error::eNone);
+        ASSERT_EQ(storage.AddCert("offline", CreateCert(2, 365, key.get()), info), Error::eNone);
+    }
+
+    auto indexPath = dir.GetPath() + "/" + CertStorage::cIndexFileName;
+
+    {
+        std::fstream index(indexPath, std::ios::binary | std::ios::in | std::ios::out);
+
+        index.seekp(12);
+        index.put('\xff');
+    }
+
+    CertStorage storage;
+    CertInfo    found;
+
+    ASSERT_EQ(storage.Init(dir.GetPath()), Error::eNone);
+    ASSERT_EQ(storage.FindByFingerprint(info.mFingerprint, found), Error::eNone);
+    EXPECT_EQ(found.mCertType, "offline");
+
+    std::vector<CertInfo> certs;
+
+    ASSERT_EQ(storage.GetCerts("online", certs), Error::eNone);
+    EXPECT_EQ(certs.size(), 1);
+}
+
+TEST(certstorage, IndexCountOutOfRange)
+{
+    TempDir  dir;
+    CertInfo info;
+    auto     key = GenerateTestKey();
+
+    {
+        CertStorage storage;
+
+        ASSERT_EQ(storage.Init(dir.GetPath()), Error::eNone);
+        ASSERT_EQ(storage.AddCert("online", CreateCert(1, 365, key.get()), info), Error::eNone);
+    }
+
+    // Index with valid checksum and record count far beyond the file size.
+    auto                 indexPath = dir.GetPath() + "/" + CertStorage::cIndexFileName;
+    std::vector<uint8_t> data;
+
+    {
+        std::ifstream index(indexPath, std::ios::binary);
+
+        data.assign(std::istreambuf_iterator<char>(index), std::istreambuf_iterator<char>());
+    }
+
+    ASSERT_GE(data.size(), 12 + sha256::cDigestSize);
+
+    data.resize(data.size() - sha256::cDigestSize);
+    std::fill(data.begin() + 8, data.begin() + 12, 0xff);
+
+    auto digest = sha256::Calculate(data.data(), data.size());
+
+    data.insert(data.end(), digest.begin(), digest.end());
+
+    {
+        std::ofstream index(indexPath, std::ios::binary | std::ios::trunc);
+
+        index.write(reinterpret_cast<const char*>(data.data()), data.size());
+    }
+
+    // Index is rejected and rebuilt from certificate files.
+    CertStorage storage;
+    CertInfo    found;
+
+    ASSERT_EQ(storage.Init(dir.GetPath()), Error::eNone);
+    ASSERT_EQ(storage.FindByFingerprint(info.mFingerprint, found), Error::eNone);
+    EXPECT_EQ(found.mCertType, "online");
+}
+
+TEST(certstorage, AddCerts)
+{
+    TempDir               dir;
+    CertStorage           storage;
+    std::vector<CertInfo> infos;
+
+    auto key    = GenerateTestKey();
+    auto online = CreateCert(1, 365, key.get());
+    auto other  = CreateCert(2, 365, key.get());
+
+    EXPECT_EQ(storage.AddCerts({{"online", online}}, infos), Error::eWrongState);
+
+    ASSERT_EQ(storage.Init(dir.GetPath()), Error::eNone);
+
+    EXPECT_EQ(storage.AddCerts({}, infos), Error::eInvalidArgument);
+
+    // Nothing is added if any certificate of the batch fails.
+    EXPECT_EQ(storage.AddCerts({{"online", online}, {"offline", {0x30, 0x00}}}, infos), Error::eInvalidArgument);
+    EXPECT_EQ(storage.AddCerts({{"online", online}, {"offline", online}}, infos), Error::eAlreadyExist);
+
+    std::vector<CertInfo> certs;
+
+    ASSERT_EQ(storage.GetCerts("online", certs), Error::eNone);
+    EXPECT_TRUE(certs.empty());
+
+    ASSERT_EQ(storage.AddCerts({{"online", online}, {"offline", other}}, infos), Error::eNone);
+    ASSERT_EQ(infos.size(), 2);
+    EXPECT_EQ(infos[0].mCertType, "online");
+    EXPECT_EQ(infos[1].mCertType, "offline");
+
+    CertInfo             info;
+    std::vector<uint8_t> der;
+
+    ASSERT_EQ(storage.FindByFingerprint(infos[1].mFingerprint, info), Error::eNone);
+    ASSERT_EQ(storage.ReadCert(info, der), Error::eNone);
+    EXPECT_EQ(der, other);
+
+    EXPECT_EQ(storage.AddCerts({{"offline", other}}, infos), Error::eAlreadyExist);
+}
+
+TEST(certstorage, ReplayJournal)
+{
+    TempDir               dir;
+    std::vector<CertInfo> infos;
+    CertInfo              removed;
+    auto                  key         = GenerateTestKey();
+    auto                  cert        = CreateCert(2, 365, key.get());
+    auto                  journalPath = dir.GetPath() + "/" + CertStorage::cJournalFileName;
+
+    {
+        CertStorage storage;
+
+        ASSERT_EQ(storage.Init(dir.GetPath()), Error::eNone);
+        ASSERT_EQ(storage.AddCert("online", CreateCert(1, 365, key.get()), removed), Error::eNone);
+        auto other = CreateCert(3, 365, key.get());
+
+        ASSERT_EQ(storage.AddCerts({{"online", cert}, {"offline", other}}, infos), Error::eNone);
+        ASSERT_EQ(storage.RemoveCert(removed.mFingerprint), Error::eNone);
+    }
+
+    EXPECT_GT(GetFileSize(journalPath), 0);
+
+    // Emulate power loss: unflushed certificate file is lost and the last change is torn.
+    ASSERT_EQ(unlink((dir.GetPath() + "/online/" + ToHex(infos[0].mFingerprint) + ".der").c_str()), 0);
+
+    {
+        std::ofstream journal(journalPath, std::ios::binary | std::ios::app);
+
+        journal.write("\x40\x00\x00\x00\x01", 5);
+    }
+
+    CertStorage           storage;
+    std::vector<CertInfo> certs;
+    std::vector<uint8_t>  der;
+    CertInfo              info;
+
+    ASSERT_EQ(storage.Init(dir.GetPath()), Error::eNone);
+
+    ASSERT_EQ(storage.GetCerts("online", certs), Error::eNone);
+    ASSERT_EQ(certs.size(), 1);
+    EXPECT_EQ(certs[0].mFingerprint, infos[0].mFingerprint);
+    ASSERT_EQ(storage.ReadCert(certs[0], der), Error::eNone);
+    EXPECT_EQ(der, cert);
+
+    EXPECT_EQ(storage.FindByFingerprint(infos[1].mFingerprint, info), Error::eNone);
+    EXPECT_EQ(storage.FindByFingerprint(removed.mFingerprint, info), Error::eNotFound);
+
+    // Replayed changes are checkpointed to the index.
+    EXPECT_EQ(GetFileSize(journalPath), 0);
+}
+
+TEST(certstorage, Checkpoint)
+{
+    TempDir               dir;
+    CertStorage           storage(4096);
+    std::vector<CertInfo> infos;
+    auto                  key         = GenerateTestKey();
+    auto                  journalPath = dir.GetPath() + "/" + CertStorage::cJournalFileName;
+
+    ASSERT_EQ(storage.Init(dir.GetPath()), Error::eNone);
+
+    for (long serial = 1; serial <= 32; serial++) {
+        CertInfo info;
+
+        ASSERT_EQ(storage.AddCert("online", CreateCert(serial, 365, key.get()), info), Error::eNone);
+
+        // Files removed before the checkpoint are not flushed.
+        if (serial % 4 == 0) {
+            ASSERT_EQ(storage.RemoveCert(info.mFingerprint), Error::eNone);
+        }
+
+        // Recovery work is bounded: the journal never exceeds the limit by more than one change.
+        EXPECT_LE(GetFileSize(journalPath), 4096 + 1024);
+    }
+
+    CertStorage           reopened;
+    std::vector<CertInfo> certs;
+
+    ASSERT_EQ(reopened.Init(dir.GetPath()), Error::eNone);
+    ASSERT_EQ(reopened.GetCerts("online", certs), Error::eNone);
+    EXPECT_EQ(certs.size(), 24);
+}
+
+TEST(certstorage, ReloadFiles)
+{
+    TempDir     dir;
+    CertStorage storage;
+    CertInfo    info, dropped;
+    bool        changed = false;
+    auto        key     = GenerateTestKey();
+    auto        typeDir = dir.GetPath() + "/online/";
+
+    auto writeFile = [](const std::string& path, const std::vector<uint8_t>& data) {
+        std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(data.data()), data.size());
+    };
+
+    ASSERT_EQ(storage.Init(dir.GetPath()), Error::eNone);
+    ASSERT_EQ(storage.AddCert("online", CreateCert(1, 365, key.get()), info), Error::eNone);
+    EXPECT_EQ(storage.GetPath(), dir.GetPath());
+
+    // Files written by the storage itself are not reloaded.
+    ASSERT_EQ(storage.ReloadFiles("online", {ToHex(info.mFingerprint) + ".der"}, changed), Error::eNone);
+    EXPECT_FALSE(changed);
+
+    // Dropped certificate is added and renamed to the storage naming scheme, broken files are skipped.
+    auto cert = CreateCert(2, 365, key.get());
+
+    writeFile(typeDir + "dropped.der", cert);
+    writeFile(typeDir + "broken.der", {0x30, 0x00});
+
+    ASSERT_EQ(storage.ReloadFiles("online", {"dropped.der", "broken.der", "readme.txt"}, changed), Error::eNone);
+    EXPECT_TRUE(changed);
+    ASSERT_EQ(storage.FindBySerial(info.mIssuer, {2}, dropped), Error::eNone);
+    EXPECT_EQ(dropped.mCertType, "online");
+    EXPECT_EQ(GetFileSize(typeDir + "dropped.der"), 0u);
+    EXPECT_EQ(GetFileSize(typeDir + ToHex(dropped.mFingerprint) + ".der"), cert.size());
+
+    ASSERT_EQ(storage.ReloadFiles("online", {"dropped.der", ToHex(dropped.mFingerprint) + ".der"}, changed),
+        Error::eNone);
+    EXPECT_FALSE(changed);
+
+    // Removed file removes the certificate.
+    ASSERT_EQ(unlink((typeDir + ToHex(info.mFingerprint) + ".der").c_str()), 0);
+    ASSERT_EQ(storage.ReloadFiles("online", {ToHex(info.mFingerprint) + ".der"}, changed), Error::eNone);
+    EXPECT_TRUE(changed);
+    EXPECT_EQ(storage.FindByFingerprint(info.mFingerprint, info), Error::eNotFound);
+
+    // Rescan finds both added and removed files.
+    writeFile(typeDir + "new.der", CreateCert(3, 365, key.get()));
+    ASSERT_EQ(unlink((typeDir + ToHex(dropped.mFingerprint) + ".der").c_str()), 0);
+
+    ASSERT_EQ(storage.ReloadFiles("online", {}, changed), Error::eNone);
+    EXPECT_TRUE(changed);
+
+    std::vector<CertInfo> certs;
+
+    ASSERT_EQ(storage.GetCerts("online", certs), Error::eNone);
+    ASSERT_EQ(certs.size(), 1u);
+    EXPECT_EQ(certs[0].mSerial, std::vector<uint8_t> {3});
+
+    EXPECT_EQ(storage.ReloadFiles("../online", {}, changed), Error::eInvalidArgument);
+
+    // Reloaded changes are committed.
+    CertStorage reopened;
+
+    ASSERT_EQ(reopened.Init(dir.GetPath()), Error::eNone);
+    ASSERT_EQ(reopened.GetCerts("online", certs), Error::eNone);
+    ASSERT_EQ(certs.size(), 1u);
+    EXPECT_EQ(certs[0].mSerial, std::vector<uint8_t> {3});
+}
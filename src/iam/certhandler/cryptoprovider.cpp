@@ -0,0 +1,90 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "cryptoprovider.hpp"
+#include "opensslcryptoprovider.hpp"
+
+#ifdef WITH_MBEDTLS
+#include "mbedtlscryptoprovider.hpp"
+#endif
+
+namespace aos {
+namespace iam {
+namespace certhandler {
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+namespace {
+
+std::vector<CryptoProviderItf*>& GetProviders()
+{
+    static OpenSSLCryptoProvider sOpenSSL;
+#ifdef WITH_MBEDTLS
+    static MbedTLSCryptoProvider sMbedTLS;
+#endif
+
+    static std::vector<CryptoProviderItf*> sProviders = {
+        &sOpenSSL,
+#ifdef WITH_MBEDTLS
+        &sMbedTLS,
+#endif
+    };
+
+    return sProviders;
+}
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Public
+ **********************************************************************************************************************/
+
+std::vector<std::string> GetCryptoProviderNames()
+{
+    std::vector<std::string> names;
+
+    for (auto provider : GetProviders()) {
+        names.emplace_back(provider->GetName());
+    }
+
+    return names;
+}
+
+Error GetCryptoProvider(const std::string& name, CryptoProviderItf*& provider)
+{
+    for (auto item : GetProviders()) {
+        if (name == item->GetName()) {
+            provider = item;
+
+            return Error::eNone;
+        }
+    }
+
+    return Error::eNotFound;
+}
+
+CryptoProviderItf& GetDefaultCryptoProvider()
+{
+    return *GetProviders().front();
+}
+
+} // namespace certhandler
+} // namespace iam
+} // namespace aos
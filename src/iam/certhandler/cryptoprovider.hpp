@@ -0,0 +1,146 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef CRYPTOPROVIDER_HPP_
+#define CRYPTOPROVIDER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "csr.hpp"
+#include "error/error.hpp"
+#include "keystorage.hpp"
+
+namespace aos {
+namespace iam {
+namespace certhandler {
+
+/** @addtogroup iam Identification and Access Manager
+ *  @{
+ */
+
+/**
+ * Hash algorithm.
+ */
+enum class HashAlgorithm {
+    eSHA256,
+    eSHA384,
+};
+
+/**
+ * Cryptographic library backend. Providers are stateless from the caller point of view and may be used from multiple
+ * threads concurrently.
+ */
+class CryptoProviderItf {
+public:
+    /**
+     * Destroys crypto provider.
+     */
+    virtual ~CryptoProviderItf() = default;
+
+    /**
+     * Returns provider name.
+     *
+     * @return const char*.
+     */
+    virtual const char* GetName() const = 0;
+
+    /**
+     * Returns true if the provider supports key algorithm.
+     *
+     * @param algorithm key algorithm.
+     * @return bool.
+     */
+    virtual bool IsSupported(KeyAlgorithm algorithm) const = 0;
+
+    /**
+     * Generates private key held in memory.
+     *
+     * @param algorithm key algorithm.
+     * @param[out] key created key.
+     * @return Error.
+     */
+    virtual Error CreateKey(KeyAlgorithm algorithm, std::shared_ptr<PrivateKeyItf>& key) = 0;
+
+    /**
+     * Verifies signature created by PrivateKeyItf::Sign. Signature scheme is selected by the public key type.
+     *
+     * @param publicKey public key in DER encoded SubjectPublicKeyInfo format.
+     * @param data signed data.
+     * @param signature signature.
+     * @return Error eNone if signature is valid.
+     */
+    virtual Error Verify(const std::vector<uint8_t>& publicKey, const std::vector<uint8_t>& data,
+        const std::vector<uint8_t>& signature)
+        = 0;
+
+    /**
+     * Calculates hash.
+     *
+     * @param algorithm hash algorithm.
+     * @param data data.
+     * @param size data size.
+     * @param[out] digest digest.
+     * @return Error.
+     */
+    virtual Error Hash(HashAlgorithm algorithm, const uint8_t* data, size_t size, std::vector<uint8_t>& digest) = 0;
+
+    /**
+     * Creates PKCS#10 certificate signing request signed by the key.
+     *
+     * @param key private key.
+     * @param params request parameters.
+     * @param[out] der DER encoded request.
+     * @return Error.
+     */
+    virtual Error CreateCSR(const PrivateKeyItf& key, const CSRParams& params, std::vector<uint8_t>& der) = 0;
+};
+
+/**
+ * Returns names of crypto providers compiled in, the default one goes first.
+ *
+ * @return std::vector<std::string>.
+ */
+std::vector<std::string> GetCryptoProviderNames();
+
+/**
+ * Returns crypto provider by name.
+ *
+ * @param name provider name.
+ * @param[out] provider crypto provider.
+ * @return Error eNotFound if the provider is not compiled in.
+ */
+Error GetCryptoProvider(const std::string& name, CryptoProviderItf*& provider);
+
+/**
+ * Returns default crypto provider: OpenSSL.
+ *
+ * @return CryptoProviderItf&.
+ */
+CryptoProviderItf& GetDefaultCryptoProvider();
+
+/** @}*/
+
+} // namespace certhandler
+} // namespace iam
+} // namespace aos
+
+#endif
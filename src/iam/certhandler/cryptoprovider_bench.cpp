@@ -0,0 +1,176 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <benchmark/benchmark.h>
+
+#include "cryptoprovider.hpp"
+
+using namespace aos;
+using namespace aos::iam::certhandler;
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+namespace {
+
+constexpr size_t cHashDataSize = 16 * 1024;
+
+using Operation = void (*)(CryptoProviderItf&, KeyAlgorithm, benchmark::State&);
+
+void CreateKey(CryptoProviderItf& provider, KeyAlgorithm algorithm, benchmark::State& state)
+{
+    for (auto _ : state) {
+        std::shared_ptr<PrivateKeyItf> key;
+
+        if (provider.CreateKey(algorithm, key) != Error::eNone) {
+            state.SkipWithError("create key failed");
+
+            return;
+        }
+    }
+}
+
+void Sign(CryptoProviderItf& provider, KeyAlgorithm algorithm, benchmark::State& state)
+{
+    std::shared_ptr<PrivateKeyItf> key;
+    std::vector<uint8_t>           data(256, 0x5a), signature;
+
+    if (provider.CreateKey(algorithm, key) != Error::eNone) {
+        state.SkipWithError("create key failed");
+
+        return;
+    }
+
+    for (auto _ : state) {
+        if (key->Sign(data, signature) != Error::eNone) {
+            state.SkipWithError("sign failed");
+
+            return;
+        }
+    }
+}
+
+void Verify(CryptoProviderItf& provider, KeyAlgorithm algorithm, benchmark::State& state)
+{
+    std::shared_ptr<PrivateKeyItf> key;
+    std::vector<uint8_t>           data(256, 0x5a), publicKey, signature;
+
+    if (provider.CreateKey(algorithm, key) != Error::eNone || key->GetPublicKey(publicKey) != Error::eNone
+        || key->Sign(data, signature) != Error::eNone) {
+        state.SkipWithError("sign failed");
+
+        return;
+    }
+
+    for (auto _ : state) {
+        if (provider.Verify(publicKey, data, signature) != Error::eNone) {
+            state.SkipWithError("verify failed");
+
+            return;
+        }
+    }
+}
+
+void CreateCSR(CryptoProviderItf& provider, KeyAlgorithm algorithm, benchmark::State& state)
+{
+    std::shared_ptr<PrivateKeyItf> key;
+    std::vector<uint8_t>           der;
+
+    if (provider.CreateKey(algorithm, key) != Error::eNone) {
+        state.SkipWithError("create key failed");
+
+        return;
+    }
+
+    for (auto _ : state) {
+        if (provider.CreateCSR(*key, {"unit-01", {}}, der) != Error::eNone) {
+            state.SkipWithError("create CSR failed");
+
+            return;
+        }
+    }
+}
+
+void Hash(CryptoProviderItf& provider, benchmark::State& state)
+{
+    std::vector<uint8_t> data(cHashDataSize, 0x5a), digest;
+
+    for (auto _ : state) {
+        provider.Hash(HashAlgorithm::eSHA256, data.data(), data.size(), digest);
+    }
+
+    state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+// Benchmarks are registered per operation and algorithm, providers next to each other: compare the times within a
+// group to rank providers for the operation on the current host.
+int RegisterBenchmarks()
+{
+    const std::vector<std::pair<const char*, Operation>> operations = {
+        {"CreateKey", CreateKey},
+        {"Sign", Sign},
+        {"Verify", Verify},
+        {"CreateCSR", CreateCSR},
+    };
+    const std::vector<std::pair<const char*, KeyAlgorithm>> algorithms = {
+        {"RSA2048", KeyAlgorithm::eRSA2048},
+        {"ECDSAP256", KeyAlgorithm::eECDSAP256},
+        {"ECDSAP384", KeyAlgorithm::eECDSAP384},
+        {"Ed25519", KeyAlgorithm::eEd25519},
+    };
+
+    for (const auto& operation : operations) {
+        for (const auto& algorithm : algorithms) {
+            for (const auto& name : GetCryptoProviderNames()) {
+                CryptoProviderItf* provider = nullptr;
+
+                if (GetCryptoProvider(name, provider) != Error::eNone || !provider->IsSupported(algorithm.second)) {
+                    continue;
+                }
+
+                auto benchmarkName = std::string("Provider/") + operation.first + "/" + algorithm.first + "/" + name;
+                auto func          = operation.second;
+                auto keyAlgorithm  = algorithm.second;
+
+                auto bench = benchmark::RegisterBenchmark(benchmarkName.c_str(),
+                    [func, provider, keyAlgorithm](benchmark::State& state) { func(*provider, keyAlgorithm, state); });
+
+                // RSA key generation takes tens of milliseconds.
+                if (func == CreateKey && keyAlgorithm == KeyAlgorithm::eRSA2048) {
+                    bench->Iterations(20);
+                }
+            }
+        }
+    }
+
+    for (const auto& name : GetCryptoProviderNames()) {
+        CryptoProviderItf* provider = nullptr;
+
+        if (GetCryptoProvider(name, provider) == Error::eNone) {
+            benchmark::RegisterBenchmark(("Provider/Hash/SHA256/" + name).c_str(),
+                [provider](benchmark::State& state) { Hash(*provider, state); });
+        }
+    }
+
+    return 0;
+}
+
+const int sRegistered = RegisterBenchmarks();
+
+} // namespace
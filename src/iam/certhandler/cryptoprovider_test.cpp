@@ -0,0 +1,139 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <memory>
+
+#include <gtest/gtest.h>
+#include <openssl/x509.h>
+
+#include "cryptoprovider.hpp"
+
+using namespace aos;
+using namespace aos::iam::certhandler;
+
+/***********************************************************************************************************************
+ * Suite
+ **********************************************************************************************************************/
+
+class CryptoProviderTest : public testing::TestWithParam<std::string> {
+protected:
+    void SetUp() override { ASSERT_EQ(GetCryptoProvider(GetParam(), mProvider), Error::eNone); }
+
+    CryptoProviderItf* mProvider = nullptr;
+};
+
+/***********************************************************************************************************************
+ * Tests
+ **********************************************************************************************************************/
+
+TEST(cryptoprovider, GetCryptoProvider)
+{
+    auto names = GetCryptoProviderNames();
+
+    ASSERT_FALSE(names.empty());
+    EXPECT_EQ(names.front(), "openssl");
+    EXPECT_STREQ(GetDefaultCryptoProvider().GetName(), "openssl");
+
+    CryptoProviderItf* provider = nullptr;
+
+    EXPECT_EQ(GetCryptoProvider("unknown", provider), Error::eNotFound);
+}
+
+TEST_P(CryptoProviderTest, SignVerify)
+{
+    const std::vector<uint8_t> data = {'d', 'a', 't', 'a'};
+
+    for (auto algorithm : {KeyAlgorithm::eRSA2048, KeyAlgorithm::eECDSAP256, KeyAlgorithm::eECDSAP384,
+             KeyAlgorithm::eEd25519}) {
+        std::shared_ptr<PrivateKeyItf> key;
+
+        if (!mProvider->IsSupported(algorithm)) {
+            EXPECT_EQ(mProvider->CreateKey(algorithm, key), Error::eInvalidArgument);
+
+            continue;
+        }
+
+        ASSERT_EQ(mProvider->CreateKey(algorithm, key), Error::eNone);
+        EXPECT_EQ(key->GetAlgorithm(), algorithm);
+
+        std::vector<uint8_t> publicKey, signature;
+
+        ASSERT_EQ(key->GetPublicKey(publicKey), Error::eNone);
+        ASSERT_EQ(key->Sign(data, signature), Error::eNone);
+
+        // Signatures are interchangeable between providers.
+        for (const auto& name : GetCryptoProviderNames()) {
+            CryptoProviderItf* verifier = nullptr;
+
+            ASSERT_EQ(GetCryptoProvider(name, verifier), Error::eNone);
+
+            if (!verifier->IsSupported(algorithm)) {
+                continue;
+            }
+
+            EXPECT_EQ(verifier->Verify(publicKey, data, signature), Error::eNone) << name;
+            EXPECT_EQ(verifier->Verify(publicKey, {'o', 't', 'h', 'e', 'r'}, signature), Error::eFailed) << name;
+        }
+    }
+
+    EXPECT_EQ(mProvider->Verify({0x30, 0x00}, data, {}), Error::eInvalidArgument);
+}
+
+TEST_P(CryptoProviderTest, Hash)
+{
+    const std::vector<uint8_t> data = {'a', 'b', 'c'};
+    std::vector<uint8_t>       digest;
+
+    ASSERT_EQ(mProvider->Hash(HashAlgorithm::eSHA256, data.data(), data.size(), digest), Error::eNone);
+    ASSERT_EQ(digest.size(), 32);
+    EXPECT_EQ(digest[0], 0xba);
+    EXPECT_EQ(digest[31], 0xad);
+
+    ASSERT_EQ(mProvider->Hash(HashAlgorithm::eSHA384, data.data(), data.size(), digest), Error::eNone);
+    ASSERT_EQ(digest.size(), 48);
+    EXPECT_EQ(digest[0], 0xcb);
+    EXPECT_EQ(digest[47], 0xa7);
+}
+
+TEST_P(CryptoProviderTest, CreateCSR)
+{
+    std::shared_ptr<PrivateKeyItf> key;
+
+    ASSERT_EQ(mProvider->CreateKey(KeyAlgorithm::eECDSAP256, key), Error::eNone);
+
+    std::vector<uint8_t> der;
+
+    ASSERT_EQ(mProvider->CreateCSR(*key, {"unit, 01", {}}, der), Error::eNone);
+
+    const uint8_t* data = der.data();
+
+    std::unique_ptr<X509_REQ, decltype(&X509_REQ_free)> req(d2i_X509_REQ(nullptr, &data, der.size()), X509_REQ_free);
+    ASSERT_NE(req, nullptr);
+
+    std::unique_ptr<EVP_PKEY, decltype(&EVP_PKEY_free)> pkey(X509_REQ_get_pubkey(req.get()), EVP_PKEY_free);
+    ASSERT_NE(pkey, nullptr);
+
+    EXPECT_EQ(X509_REQ_verify(req.get(), pkey.get()), 1);
+
+    char commonName[64] = {};
+
+    X509_NAME_get_text_by_NID(X509_REQ_get_subject_name(req.get()), NID_commonName, commonName, sizeof(commonName));
+    EXPECT_STREQ(commonName, "unit, 01");
+}
+
+INSTANTIATE_TEST_SUITE_P(cryptoprovider, CryptoProviderTest, testing::ValuesIn(GetCryptoProviderNames()));
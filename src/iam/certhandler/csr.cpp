@@ -0,0 +1,239 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <memory>
+
+#include <openssl/x509.h>
+#include <openssl/x509v3.h>
+
+#include "csr.hpp"
+
+namespace aos {
+namespace iam {
+namespace certhandler {
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+namespace {
+
+struct ExtensionStackDeleter {
+    void operator()(STACK_OF(X509_EXTENSION) * stack) const { sk_X509_EXTENSION_pop_free(stack, X509_EXTENSION_free); }
+};
+
+struct GeneralNamesDeleter {
+    void operator()(GENERAL_NAMES* names) const { GENERAL_NAMES_free(names); }
+};
+
+Error GetSignatureNID(KeyAlgorithm algorithm, int& nid, int& paramType)
+{
+    paramType = V_ASN1_UNDEF;
+
+    switch (algorithm) {
+    case KeyAlgorithm::eRSA2048:
+    case KeyAlgorithm::eRSA3072:
+        nid       = NID_sha256WithRSAEncryption;
+        paramType = V_ASN1_NULL;
+        break;
+
+    case KeyAlgorithm::eECDSAP256:
+        nid = NID_ecdsa_with_SHA256;
+        break;
+
+    case KeyAlgorithm::eECDSAP384:
+        nid = NID_ecdsa_with_SHA384;
+        break;
+
+    case KeyAlgorithm::eEd25519:
+        nid = NID_ED25519;
+        break;
+
+    default:
+        return Error::eInvalidArgument;
+    }
+
+    return Error::eNone;
+}
+
+Error AddDNSNames(X509_REQ* req, const std::vector<std::string>& dnsNames)
+{
+    std::unique_ptr<GENERAL_NAMES, GeneralNamesDeleter> names(GENERAL_NAMES_new());
+    if (!names) {
+        return Error::eNoMemory;
+    }
+
+    for (const auto& dnsName : dnsNames) {
+        auto value = ASN1_IA5STRING_new();
+
+        if (!value || !ASN1_STRING_set(value, dnsName.data(), static_cast<int>(dnsName.size()))) {
+            ASN1_IA5STRING_free(value);
+
+            return Error::eNoMemory;
+        }
+
+        auto name = GENERAL_NAME_new();
+        if (!name) {
+            ASN1_IA5STRING_free(value);
+
+            return Error::eNoMemory;
+        }
+
+        GENERAL_NAME_set0_value(name, GEN_DNS, value);
+
+        if (!sk_GENERAL_NAME_push(names.get(), name)) {
+            GENERAL_NAME_free(name);
+
+            return Error::eNoMemory;
+        }
+    }
+
+    STACK_OF(X509_EXTENSION)* extensions = nullptr;
+
+    if (X509V3_add1_i2d(&extensions, NID_subject_alt_name, names.get(), 0, X509V3_ADD_DEFAULT) != 1) {
+        return Error::eFailed;
+    }
+
+    std::unique_ptr<STACK_OF(X509_EXTENSION), ExtensionStackDeleter> extensionsPtr(extensions);
+
+    if (!X509_REQ_add_extensions(req, extensions)) {
+        return Error::eFailed;
+    }
+
+    return Error::eNone;
+}
+
+Error SetSignature(X509_REQ* req, KeyAlgorithm algorithm, const std::vector<uint8_t>& signature)
+{
+    int nid = 0, paramType = 0;
+
+    auto err = GetSignatureNID(algorithm, nid, paramType);
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    std::unique_ptr<X509_ALGOR, decltype(&X509_ALGOR_free)> signatureAlgorithm(X509_ALGOR_new(), X509_ALGOR_free);
+
+    if (!signatureAlgorithm || !X509_ALGOR_set0(signatureAlgorithm.get(), OBJ_nid2obj(nid), paramType, nullptr)
+        || !X509_REQ_set1_signature_algo(req, signatureAlgorithm.get())) {
+        return Error::eNoMemory;
+    }
+
+    auto signatureValue = ASN1_BIT_STRING_new();
+    auto signatureData  = const_cast<uint8_t*>(signature.data());
+
+    if (!signatureValue || !ASN1_BIT_STRING_set(signatureValue, signatureData, static_cast<int>(signature.size()))) {
+        ASN1_BIT_STRING_free(signatureValue);
+
+        return Error::eNoMemory;
+    }
+
+    // Signature is a whole number of bytes.
+    signatureValue->flags &= ~0x07;
+    signatureValue->flags |= ASN1_STRING_FLAG_BITS_LEFT;
+
+    X509_REQ_set0_signature(req, signatureValue);
+
+    return Error::eNone;
+}
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Public
+ **********************************************************************************************************************/
+
+Error CreateCSR(const PrivateKeyItf& key, const CSRParams& params, std::vector<uint8_t>& der)
+{
+    std::vector<uint8_t> publicKey;
+
+    auto err = key.GetPublicKey(publicKey);
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    const uint8_t* buffer = publicKey.data();
+
+    std::unique_ptr<EVP_PKEY, decltype(&EVP_PKEY_free)> pkey(
+        d2i_PUBKEY(nullptr, &buffer, publicKey.size()), EVP_PKEY_free);
+    if (!pkey) {
+        return Error::eInvalidArgument;
+    }
+
+    std::unique_ptr<X509_REQ, decltype(&X509_REQ_free)> req(X509_REQ_new(), X509_REQ_free);
+    if (!req) {
+        return Error::eNoMemory;
+    }
+
+    if (!X509_REQ_set_version(req.get(), X509_REQ_VERSION_1) || !X509_REQ_set_pubkey(req.get(), pkey.get())) {
+        return Error::eFailed;
+    }
+
+    if (!params.mCommonName.empty()
+        && !X509_NAME_add_entry_by_txt(X509_REQ_get_subject_name(req.get()), "CN", MBSTRING_UTF8,
+            reinterpret_cast<const unsigned char*>(params.mCommonName.data()),
+            static_cast<int>(params.mCommonName.size()), -1, 0)) {
+        return Error::eInvalidArgument;
+    }
+
+    if (!params.mDNSNames.empty()) {
+        err = AddDNSNames(req.get(), params.mDNSNames);
+        if (err != Error::eNone) {
+            return err;
+        }
+    }
+
+    // The key may be stored in HSM: sign encoded request info with the key interface instead of X509_REQ_sign.
+    unsigned char* tbsData = nullptr;
+    int            tbsSize = i2d_re_X509_REQ_tbs(req.get(), &tbsData);
+
+    if (tbsSize <= 0) {
+        return Error::eFailed;
+    }
+
+    std::vector<uint8_t> tbs(tbsData, tbsData + tbsSize), signature;
+
+    OPENSSL_free(tbsData);
+
+    err = key.Sign(tbs, signature);
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    err = SetSignature(req.get(), key.GetAlgorithm(), signature);
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    unsigned char* derData = nullptr;
+    int            derSize = i2d_X509_REQ(req.get(), &derData);
+
+    if (derSize <= 0) {
+        return Error::eFailed;
+    }
+
+    der.assign(derData, derData + derSize);
+
+    OPENSSL_free(derData);
+
+    return Error::eNone;
+}
+
+} // namespace certhandler
+} // namespace iam
+} // namespace aos
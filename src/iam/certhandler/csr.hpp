@@ -0,0 +1,69 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef CSR_HPP_
+#define CSR_HPP_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "error/error.hpp"
+#include "keystorage.hpp"
+
+namespace aos {
+namespace iam {
+namespace certhandler {
+
+/** @addtogroup iam Identification and Access Manager
+ *  @{
+ */
+
+/**
+ * Certificate signing request parameters.
+ */
+struct CSRParams {
+    /**
+     * Subject common name.
+     */
+    std::string mCommonName;
+
+    /**
+     * DNS names added as subject alternative names, optional.
+     */
+    std::vector<std::string> mDNSNames;
+};
+
+/**
+ * Creates PKCS#10 certificate signing request signed by the key. Signature algorithm is selected by the key algorithm
+ * as described in PrivateKeyItf::Sign.
+ *
+ * @param key private key.
+ * @param params request parameters.
+ * @param[out] der DER encoded request.
+ * @return Error.
+ */
+Error CreateCSR(const PrivateKeyItf& key, const CSRParams& params, std::vector<uint8_t>& der);
+
+/** @}*/
+
+} // namespace certhandler
+} // namespace iam
+} // namespace aos
+
+#endif
@@ -0,0 +1,82 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <memory>
+
+#include <gtest/gtest.h>
+#include <openssl/x509.h>
+#include <openssl/x509v3.h>
+
+#include "csr.hpp"
+#include "swkeystorage.hpp"
+
+using namespace aos;
+using namespace aos::iam::certhandler;
+
+class CSRTest : public testing::TestWithParam<KeyAlgorithm> { };
+
+TEST_P(CSRTest, CreateCSR)
+{
+    SWKeyStorage storage;
+
+    std::shared_ptr<PrivateKeyItf> key;
+
+    ASSERT_EQ(storage.CreateKey(GetParam(), key), Error::eNone);
+
+    CSRParams            params {"unit-01", {"unit-01.local", "unit-01.example.com"}};
+    std::vector<uint8_t> der;
+
+    ASSERT_EQ(CreateCSR(*key, params, der), Error::eNone);
+
+    const uint8_t* data = der.data();
+
+    std::unique_ptr<X509_REQ, decltype(&X509_REQ_free)> req(d2i_X509_REQ(nullptr, &data, der.size()), X509_REQ_free);
+    ASSERT_NE(req, nullptr);
+
+    std::unique_ptr<EVP_PKEY, decltype(&EVP_PKEY_free)> pkey(X509_REQ_get_pubkey(req.get()), EVP_PKEY_free);
+    ASSERT_NE(pkey, nullptr);
+
+    EXPECT_EQ(X509_REQ_verify(req.get(), pkey.get()), 1);
+
+    char commonName[64] = {};
+
+    X509_NAME_get_text_by_NID(X509_REQ_get_subject_name(req.get()), NID_commonName, commonName, sizeof(commonName));
+    EXPECT_STREQ(commonName, "unit-01");
+
+    std::unique_ptr<STACK_OF(X509_EXTENSION), void (*)(STACK_OF(X509_EXTENSION)*)> extensions(
+        X509_REQ_get_extensions(req.get()),
+        [](STACK_OF(X509_EXTENSION) * stack) { sk_X509_EXTENSION_pop_free(stack, X509_EXTENSION_free); });
+    ASSERT_NE(extensions, nullptr);
+
+    auto names = static_cast<GENERAL_NAMES*>(X509V3_get_d2i(extensions.get(), NID_subject_alt_name, nullptr, nullptr));
+    ASSERT_NE(names, nullptr);
+    ASSERT_EQ(sk_GENERAL_NAME_num(names), 2);
+
+    auto dnsName = sk_GENERAL_NAME_value(names, 1);
+
+    EXPECT_EQ(dnsName->type, GEN_DNS);
+    EXPECT_EQ(std::string(reinterpret_cast<const char*>(ASN1_STRING_get0_data(dnsName->d.dNSName)),
+                  ASN1_STRING_length(dnsName->d.dNSName)),
+        "unit-01.example.com");
+
+    GENERAL_NAMES_free(names);
+}
+
+INSTANTIATE_TEST_SUITE_P(csr, CSRTest,
+    testing::Values(
+        KeyAlgorithm::eRSA2048, KeyAlgorithm::eECDSAP256, KeyAlgorithm::eECDSAP384, KeyAlgorithm::eEd25519));
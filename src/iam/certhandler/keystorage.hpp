@@ -0,0 +1,123 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef KEYSTORAGE_HPP_
+#define KEYSTORAGE_HPP_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "error/error.hpp"
+
+namespace aos {
+namespace iam {
+namespace certhandler {
+
+/** @addtogroup iam Identification and Access Manager
+ *  @{
+ */
+
+/**
+ * Key algorithm.
+ */
+enum class KeyAlgorithm {
+    eRSA2048,
+    eRSA3072,
+    eECDSAP256,
+    eECDSAP384,
+    eEd25519,
+};
+
+/**
+ * Private key handle.
+ */
+class PrivateKeyItf {
+public:
+    /**
+     * Destroys private key handle.
+     */
+    virtual ~PrivateKeyItf() = default;
+
+    /**
+     * Returns key algorithm.
+     *
+     * @return KeyAlgorithm.
+     */
+    virtual KeyAlgorithm GetAlgorithm() const = 0;
+
+    /**
+     * Returns public part of the key.
+     *
+     * @param[out] der public key in DER encoded SubjectPublicKeyInfo format.
+     * @return Error.
+     */
+    virtual Error GetPublicKey(std::vector<uint8_t>& der) const = 0;
+
+    /**
+     * Signs data. RSA keys use PKCS#1 v1.5 padding, ECDSA signatures are DER encoded. Data is hashed with SHA-256,
+     * SHA-384 for P-384 keys, Ed25519 signs data as is.
+     *
+     * @param data data to sign.
+     * @param[out] signature signature.
+     * @return Error.
+     */
+    virtual Error Sign(const std::vector<uint8_t>& data, std::vector<uint8_t>& signature) const = 0;
+};
+
+/**
+ * Key storage backend.
+ */
+class KeyStorageItf {
+public:
+    /**
+     * Destroys key storage.
+     */
+    virtual ~KeyStorageItf() = default;
+
+    /**
+     * Creates private key.
+     *
+     * @param algorithm key algorithm.
+     * @param[out] key created key.
+     * @return Error.
+     */
+    virtual Error CreateKey(KeyAlgorithm algorithm, std::shared_ptr<PrivateKeyItf>& key) = 0;
+
+    /**
+     * Securely deletes key from the storage.
+     *
+     * @param key key to delete.
+     * @return Error.
+     */
+    virtual Error DeleteKey(const std::shared_ptr<PrivateKeyItf>& key) = 0;
+
+    /**
+     * Returns max number of key operations the storage may run in parallel.
+     *
+     * @return size_t.
+     */
+    virtual size_t GetMaxConcurrency() const = 0;
+};
+
+/** @}*/
+
+} // namespace certhandler
+} // namespace iam
+} // namespace aos
+
+#endif
@@ -0,0 +1,359 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <mbedtls/ecp.h>
+#include <mbedtls/md.h>
+#include <mbedtls/pk.h>
+#include <mbedtls/rsa.h>
+#include <mbedtls/version.h>
+#include <mbedtls/x509_csr.h>
+
+#include "mbedtlscryptoprovider.hpp"
+
+namespace aos {
+namespace iam {
+namespace certhandler {
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+namespace {
+
+constexpr char   cPersonalization[] = "aos_iam";
+constexpr size_t cMaxPublicKeySize  = 1024;
+constexpr size_t cMaxCSRSize        = 4096;
+constexpr int    cRSAExponent       = 65537;
+
+struct PKDeleter {
+    void operator()(mbedtls_pk_context* pk)
+    {
+        mbedtls_pk_free(pk);
+        delete pk;
+    }
+};
+
+using PKPtr = std::unique_ptr<mbedtls_pk_context, PKDeleter>;
+
+PKPtr MakePK()
+{
+    PKPtr pk(new mbedtls_pk_context);
+
+    mbedtls_pk_init(pk.get());
+
+    return pk;
+}
+
+mbedtls_md_type_t GetMDType(KeyAlgorithm algorithm)
+{
+    return algorithm == KeyAlgorithm::eECDSAP384 ? MBEDTLS_MD_SHA384 : MBEDTLS_MD_SHA256;
+}
+
+Error CalculateHash(mbedtls_md_type_t type, const uint8_t* data, size_t size, unsigned char* hash, size_t& hashSize)
+{
+    auto info = mbedtls_md_info_from_type(type);
+    if (!info) {
+        return Error::eFailed;
+    }
+
+    if (mbedtls_md(info, data, size, hash) != 0) {
+        return Error::eFailed;
+    }
+
+    hashSize = mbedtls_md_get_size(info);
+
+    return Error::eNone;
+}
+
+// Escapes RFC 4514 special characters for mbedtls_x509_string_to_names().
+std::string EscapeName(const std::string& name)
+{
+    std::string result;
+
+    for (auto c : name) {
+        if (c == ',' || c == '=' || c == '+' || c == '<' || c == '>' || c == '#' || c == ';' || c == '\\'
+            || c == '"') {
+            result.push_back('\\');
+        }
+
+        result.push_back(c);
+    }
+
+    return result;
+}
+
+class MbedTLSPrivateKey : public PrivateKeyItf {
+public:
+    MbedTLSPrivateKey(KeyAlgorithm algorithm, PKPtr pk, MbedTLSCryptoProvider& provider)
+        : mAlgorithm(algorithm)
+        , mPK(std::move(pk))
+        , mProvider(provider)
+    {
+    }
+
+    KeyAlgorithm GetAlgorithm() const override { return mAlgorithm; }
+
+    Error GetPublicKey(std::vector<uint8_t>& der) const override
+    {
+        unsigned char buffer[cMaxPublicKeySize];
+
+        // mbedTLS writes DER at the end of the buffer.
+        auto size = mbedtls_pk_write_pubkey_der(mPK.get(), buffer, sizeof(buffer));
+        if (size <= 0) {
+            return Error::eFailed;
+        }
+
+        der.assign(buffer + sizeof(buffer) - size, buffer + sizeof(buffer));
+
+        return Error::eNone;
+    }
+
+    Error Sign(const std::vector<uint8_t>& data, std::vector<uint8_t>& signature) const override
+    {
+        unsigned char hash[MBEDTLS_MD_MAX_SIZE];
+        size_t        hashSize = 0;
+        auto          mdType   = GetMDType(mAlgorithm);
+
+        auto err = CalculateHash(mdType, data.data(), data.size(), hash, hashSize);
+        if (err != Error::eNone) {
+            return err;
+        }
+
+        size_t size = 0;
+
+        signature.resize(MBEDTLS_PK_SIGNATURE_MAX_SIZE);
+
+        {
+            // RSA blinding values are kept in the key context.
+            std::lock_guard<std::mutex> lock(mMutex);
+
+            if (mbedtls_pk_sign(mPK.get(), mdType, hash, hashSize, signature.data(), signature.size(), &size,
+                    MbedTLSCryptoProvider::Random, &mProvider)
+                != 0) {
+                return Error::eFailed;
+            }
+        }
+
+        signature.resize(size);
+
+        return Error::eNone;
+    }
+
+    Error WriteCSR(mbedtls_x509write_csr& csr, std::vector<uint8_t>& der) const
+    {
+        std::vector<unsigned char> buffer(cMaxCSRSize);
+
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        mbedtls_x509write_csr_set_key(&csr, mPK.get());
+
+        auto size = mbedtls_x509write_csr_der(
+            &csr, buffer.data(), buffer.size(), MbedTLSCryptoProvider::Random, &mProvider);
+        if (size <= 0) {
+            return Error::eFailed;
+        }
+
+        der.assign(buffer.end() - size, buffer.end());
+
+        return Error::eNone;
+    }
+
+private:
+    KeyAlgorithm           mAlgorithm;
+    PKPtr                  mPK;
+    MbedTLSCryptoProvider& mProvider;
+    mutable std::mutex     mMutex;
+};
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Public
+ **********************************************************************************************************************/
+
+MbedTLSCryptoProvider::MbedTLSCryptoProvider()
+{
+    mbedtls_entropy_init(&mEntropy);
+    mbedtls_ctr_drbg_init(&mDRBG);
+
+    mSeeded = mbedtls_ctr_drbg_seed(&mDRBG, mbedtls_entropy_func, &mEntropy,
+                  reinterpret_cast<const unsigned char*>(cPersonalization), sizeof(cPersonalization) - 1)
+        == 0;
+}
+
+MbedTLSCryptoProvider::~MbedTLSCryptoProvider()
+{
+    mbedtls_ctr_drbg_free(&mDRBG);
+    mbedtls_entropy_free(&mEntropy);
+}
+
+const char* MbedTLSCryptoProvider::GetName() const
+{
+    return "mbedtls";
+}
+
+bool MbedTLSCryptoProvider::IsSupported(KeyAlgorithm algorithm) const
+{
+    return algorithm != KeyAlgorithm::eEd25519;
+}
+
+Error MbedTLSCryptoProvider::CreateKey(KeyAlgorithm algorithm, std::shared_ptr<PrivateKeyItf>& key)
+{
+    auto pk  = MakePK();
+    int  ret = 0;
+
+    switch (algorithm) {
+    case KeyAlgorithm::eRSA2048:
+    case KeyAlgorithm::eRSA3072:
+        ret = mbedtls_pk_setup(pk.get(), mbedtls_pk_info_from_type(MBEDTLS_PK_RSA));
+        if (ret == 0) {
+            ret = mbedtls_rsa_gen_key(mbedtls_pk_rsa(*pk), Random, this,
+                algorithm == KeyAlgorithm::eRSA2048 ? 2048 : 3072, cRSAExponent);
+        }
+
+        break;
+
+    case KeyAlgorithm::eECDSAP256:
+    case KeyAlgorithm::eECDSAP384:
+        ret = mbedtls_pk_setup(pk.get(), mbedtls_pk_info_from_type(MBEDTLS_PK_ECKEY));
+        if (ret == 0) {
+            ret = mbedtls_ecp_gen_key(
+                algorithm == KeyAlgorithm::eECDSAP256 ? MBEDTLS_ECP_DP_SECP256R1 : MBEDTLS_ECP_DP_SECP384R1,
+                mbedtls_pk_ec(*pk), Random, this);
+        }
+
+        break;
+
+    default:
+        return Error::eInvalidArgument;
+    }
+
+    if (ret != 0) {
+        return Error::eFailed;
+    }
+
+    key = std::make_shared<MbedTLSPrivateKey>(algorithm, std::move(pk), *this);
+
+    return Error::eNone;
+}
+
+Error MbedTLSCryptoProvider::Verify(
+    const std::vector<uint8_t>& publicKey, const std::vector<uint8_t>& data, const std::vector<uint8_t>& signature)
+{
+    auto pk = MakePK();
+
+    if (mbedtls_pk_parse_public_key(pk.get(), publicKey.data(), publicKey.size()) != 0) {
+        return Error::eInvalidArgument;
+    }
+
+    auto mdType = MBEDTLS_MD_SHA256;
+
+    if (mbedtls_pk_get_type(pk.get()) == MBEDTLS_PK_ECKEY && mbedtls_pk_get_bitlen(pk.get()) > 256) {
+        mdType = MBEDTLS_MD_SHA384;
+    }
+
+    unsigned char hash[MBEDTLS_MD_MAX_SIZE];
+    size_t        hashSize = 0;
+
+    auto err = CalculateHash(mdType, data.data(), data.size(), hash, hashSize);
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    if (mbedtls_pk_verify(pk.get(), mdType, hash, hashSize, signature.data(), signature.size()) != 0) {
+        return Error::eFailed;
+    }
+
+    return Error::eNone;
+}
+
+Error MbedTLSCryptoProvider::Hash(
+    HashAlgorithm algorithm, const uint8_t* data, size_t size, std::vector<uint8_t>& digest)
+{
+    unsigned char hash[MBEDTLS_MD_MAX_SIZE];
+    size_t        hashSize = 0;
+
+    auto err = CalculateHash(
+        algorithm == HashAlgorithm::eSHA384 ? MBEDTLS_MD_SHA384 : MBEDTLS_MD_SHA256, data, size, hash, hashSize);
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    digest.assign(hash, hash + hashSize);
+
+    return Error::eNone;
+}
+
+Error MbedTLSCryptoProvider::CreateCSR(const PrivateKeyItf& key, const CSRParams& params, std::vector<uint8_t>& der)
+{
+    auto mbedTLSKey = dynamic_cast<const MbedTLSPrivateKey*>(&key);
+    if (!mbedTLSKey) {
+        return Error::eInvalidArgument;
+    }
+
+    std::unique_ptr<mbedtls_x509write_csr, decltype(&mbedtls_x509write_csr_free)> csr(
+        new mbedtls_x509write_csr, mbedtls_x509write_csr_free);
+
+    mbedtls_x509write_csr_init(csr.get());
+    mbedtls_x509write_csr_set_md_alg(csr.get(), GetMDType(key.GetAlgorithm()));
+
+    auto subject = "CN=" + EscapeName(params.mCommonName);
+
+    if (mbedtls_x509write_csr_set_subject_name(csr.get(), subject.c_str()) != 0) {
+        return Error::eInvalidArgument;
+    }
+
+    if (!params.mDNSNames.empty()) {
+#if MBEDTLS_VERSION_NUMBER >= 0x03050000
+        std::vector<mbedtls_x509_san_list> names(params.mDNSNames.size());
+
+        for (size_t i = 0; i < names.size(); i++) {
+            names[i].node.type                  = MBEDTLS_X509_SAN_DNS_NAME;
+            names[i].node.san.unstructured_name = {MBEDTLS_ASN1_CONTEXT_SPECIFIC | 2, params.mDNSNames[i].size(),
+                reinterpret_cast<unsigned char*>(const_cast<char*>(params.mDNSNames[i].data()))};
+            names[i].next                       = i + 1 < names.size() ? &names[i + 1] : nullptr;
+        }
+
+        if (mbedtls_x509write_csr_set_subject_alternative_name(csr.get(), names.data()) != 0) {
+            return Error::eFailed;
+        }
+#else
+        // Subject alternative names in requests are supported since mbedTLS 3.5.
+        return Error::eInvalidArgument;
+#endif
+    }
+
+    return mbedTLSKey->WriteCSR(*csr, der);
+}
+
+int MbedTLSCryptoProvider::Random(void* context, unsigned char* output, size_t size)
+{
+    auto provider = static_cast<MbedTLSCryptoProvider*>(context);
+
+    if (!provider->mSeeded) {
+        return MBEDTLS_ERR_CTR_DRBG_ENTROPY_SOURCE_FAILED;
+    }
+
+    std::lock_guard<std::mutex> lock(provider->mMutex);
+
+    return mbedtls_ctr_drbg_random(&provider->mDRBG, output, size);
+}
+
+} // namespace certhandler
+} // namespace iam
+} // namespace aos
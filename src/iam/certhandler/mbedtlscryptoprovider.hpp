@@ -0,0 +1,136 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef MBEDTLSCRYPTOPROVIDER_HPP_
+#define MBEDTLSCRYPTOPROVIDER_HPP_
+
+#include <mutex>
+
+#include <mbedtls/ctr_drbg.h>
+#include <mbedtls/entropy.h>
+
+#include "cryptoprovider.hpp"
+
+namespace aos {
+namespace iam {
+namespace certhandler {
+
+/** @addtogroup iam Identification and Access Manager
+ *  @{
+ */
+
+/**
+ * mbedTLS 3.x crypto provider. Ed25519 is not supported by mbedTLS.
+ */
+class MbedTLSCryptoProvider : public CryptoProviderItf {
+public:
+    /**
+     * Creates provider and seeds its random generator.
+     */
+    MbedTLSCryptoProvider();
+
+    /**
+     * Destroys provider.
+     */
+    ~MbedTLSCryptoProvider();
+
+    MbedTLSCryptoProvider(const MbedTLSCryptoProvider&) = delete;
+    MbedTLSCryptoProvider& operator=(const MbedTLSCryptoProvider&) = delete;
+
+    /**
+     * Returns provider name.
+     *
+     * @return const char*.
+     */
+    const char* GetName() const override;
+
+    /**
+     * Returns true if the provider supports key algorithm.
+     *
+     * @param algorithm key algorithm.
+     * @return bool.
+     */
+    bool IsSupported(KeyAlgorithm algorithm) const override;
+
+    /**
+     * Generates private key held in memory.
+     *
+     * @param algorithm key algorithm.
+     * @param[out] key created key.
+     * @return Error.
+     */
+    Error CreateKey(KeyAlgorithm algorithm, std::shared_ptr<PrivateKeyItf>& key) override;
+
+    /**
+     * Verifies signature.
+     *
+     * @param publicKey public key in DER encoded SubjectPublicKeyInfo format.
+     * @param data signed data.
+     * @param signature signature.
+     * @return Error eNone if signature is valid.
+     */
+    Error Verify(const std::vector<uint8_t>& publicKey, const std::vector<uint8_t>& data,
+        const std::vector<uint8_t>& signature) override;
+
+    /**
+     * Calculates hash.
+     *
+     * @param algorithm hash algorithm.
+     * @param data data.
+     * @param size data size.
+     * @param[out] digest digest.
+     * @return Error.
+     */
+    Error Hash(HashAlgorithm algorithm, const uint8_t* data, size_t size, std::vector<uint8_t>& digest) override;
+
+    /**
+     * Creates PKCS#10 certificate signing request. mbedTLS signs requests with its own key contexts only, so the key
+     * must be created by this provider.
+     *
+     * @param key private key.
+     * @param params request parameters.
+     * @param[out] der DER encoded request.
+     * @return Error.
+     */
+    Error CreateCSR(const PrivateKeyItf& key, const CSRParams& params, std::vector<uint8_t>& der) override;
+
+    /**
+     * Random generator callback in mbedTLS f_rng format.
+     *
+     * @param context provider.
+     * @param output output buffer.
+     * @param size output size.
+     * @return int.
+     */
+    static int Random(void* context, unsigned char* output, size_t size);
+
+private:
+    // DRBG is not thread safe unless mbedTLS is built with MBEDTLS_THREADING_C.
+    std::mutex               mMutex;
+    mbedtls_entropy_context  mEntropy;
+    mbedtls_ctr_drbg_context mDRBG;
+    bool                     mSeeded = false;
+};
+
+/** @}*/
+
+} // namespace certhandler
+} // namespace iam
+} // namespace aos
+
+#endif
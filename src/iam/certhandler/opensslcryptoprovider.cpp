@@ -0,0 +1,256 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <openssl/ec.h>
+#include <openssl/evp.h>
+#include <openssl/obj_mac.h>
+#include <openssl/rsa.h>
+#include <openssl/x509.h>
+
+#include "opensslcryptoprovider.hpp"
+#include "signature.hpp"
+
+namespace aos {
+namespace iam {
+namespace certhandler {
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+namespace {
+
+using PKeyCtxPtr = std::unique_ptr<EVP_PKEY_CTX, decltype(&EVP_PKEY_CTX_free)>;
+using MDCtxPtr   = std::unique_ptr<EVP_MD_CTX, decltype(&EVP_MD_CTX_free)>;
+
+class SWPrivateKey : public PrivateKeyItf {
+public:
+    SWPrivateKey(KeyAlgorithm algorithm, EVP_PKEY* pkey)
+        : mAlgorithm(algorithm)
+        , mPKey(pkey)
+    {
+    }
+
+    // OpenSSL clears private key components on free.
+    ~SWPrivateKey() { EVP_PKEY_free(mPKey); }
+
+    KeyAlgorithm GetAlgorithm() const override { return mAlgorithm; }
+
+    Error GetPublicKey(std::vector<uint8_t>& der) const override
+    {
+        auto size = i2d_PUBKEY(mPKey, nullptr);
+        if (size <= 0) {
+            return Error::eFailed;
+        }
+
+        der.resize(size);
+
+        auto data = der.data();
+
+        if (i2d_PUBKEY(mPKey, &data) != size) {
+            return Error::eFailed;
+        }
+
+        return Error::eNone;
+    }
+
+    Error Sign(const std::vector<uint8_t>& data, std::vector<uint8_t>& signature) const override
+    {
+        MDCtxPtr ctx(EVP_MD_CTX_new(), EVP_MD_CTX_free);
+        if (!ctx) {
+            return Error::eNoMemory;
+        }
+
+        const EVP_MD* md = nullptr;
+
+        switch (mAlgorithm) {
+        case KeyAlgorithm::eECDSAP384:
+            md = EVP_sha384();
+            break;
+
+        case KeyAlgorithm::eEd25519:
+            break;
+
+        default:
+            md = EVP_sha256();
+            break;
+        }
+
+        size_t size = 0;
+
+        // Ed25519 supports one-shot signing only.
+        if (EVP_DigestSignInit(ctx.get(), nullptr, md, nullptr, mPKey) <= 0
+            || EVP_DigestSign(ctx.get(), nullptr, &size, data.data(), data.size()) <= 0) {
+            return Error::eFailed;
+        }
+
+        signature.resize(size);
+
+        if (EVP_DigestSign(ctx.get(), signature.data(), &size, data.data(), data.size()) <= 0) {
+            return Error::eFailed;
+        }
+
+        signature.resize(size);
+
+        return Error::eNone;
+    }
+
+private:
+    KeyAlgorithm mAlgorithm;
+    EVP_PKEY*    mPKey;
+};
+
+Error GenerateKey(PKeyCtxPtr& ctx, EVP_PKEY*& pkey)
+{
+    if (EVP_PKEY_keygen(ctx.get(), &pkey) <= 0) {
+        return Error::eFailed;
+    }
+
+    return Error::eNone;
+}
+
+Error GenerateRSAKey(int bits, EVP_PKEY*& pkey)
+{
+    PKeyCtxPtr ctx(EVP_PKEY_CTX_new_id(EVP_PKEY_RSA, nullptr), EVP_PKEY_CTX_free);
+    if (!ctx) {
+        return Error::eNoMemory;
+    }
+
+    if (EVP_PKEY_keygen_init(ctx.get()) <= 0 || EVP_PKEY_CTX_set_rsa_keygen_bits(ctx.get(), bits) <= 0) {
+        return Error::eFailed;
+    }
+
+    return GenerateKey(ctx, pkey);
+}
+
+Error GenerateECKey(int curve, EVP_PKEY*& pkey)
+{
+    PKeyCtxPtr ctx(EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr), EVP_PKEY_CTX_free);
+    if (!ctx) {
+        return Error::eNoMemory;
+    }
+
+    // Named curve encoding keeps public keys and certificates compact.
+    if (EVP_PKEY_keygen_init(ctx.get()) <= 0 || EVP_PKEY_CTX_set_ec_paramgen_curve_nid(ctx.get(), curve) <= 0
+        || EVP_PKEY_CTX_set_ec_param_enc(ctx.get(), OPENSSL_EC_NAMED_CURVE) <= 0) {
+        return Error::eFailed;
+    }
+
+    return GenerateKey(ctx, pkey);
+}
+
+Error GenerateEd25519Key(EVP_PKEY*& pkey)
+{
+    PKeyCtxPtr ctx(EVP_PKEY_CTX_new_id(EVP_PKEY_ED25519, nullptr), EVP_PKEY_CTX_free);
+    if (!ctx) {
+        return Error::eNoMemory;
+    }
+
+    if (EVP_PKEY_keygen_init(ctx.get()) <= 0) {
+        return Error::eFailed;
+    }
+
+    return GenerateKey(ctx, pkey);
+}
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Public
+ **********************************************************************************************************************/
+
+const char* OpenSSLCryptoProvider::GetName() const
+{
+    return "openssl";
+}
+
+bool OpenSSLCryptoProvider::IsSupported(KeyAlgorithm algorithm) const
+{
+    (void)algorithm;
+
+    return true;
+}
+
+Error OpenSSLCryptoProvider::CreateKey(KeyAlgorithm algorithm, std::shared_ptr<PrivateKeyItf>& key)
+{
+    EVP_PKEY* pkey = nullptr;
+    Error     err  = Error::eNone;
+
+    switch (algorithm) {
+    case KeyAlgorithm::eRSA2048:
+        err = GenerateRSAKey(2048, pkey);
+        break;
+
+    case KeyAlgorithm::eRSA3072:
+        err = GenerateRSAKey(3072, pkey);
+        break;
+
+    case KeyAlgorithm::eECDSAP256:
+        err = GenerateECKey(NID_X9_62_prime256v1, pkey);
+        break;
+
+    case KeyAlgorithm::eECDSAP384:
+        err = GenerateECKey(NID_secp384r1, pkey);
+        break;
+
+    case KeyAlgorithm::eEd25519:
+        err = GenerateEd25519Key(pkey);
+        break;
+
+    default:
+        return Error::eInvalidArgument;
+    }
+
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    key = std::make_shared<SWPrivateKey>(algorithm, pkey);
+
+    return Error::eNone;
+}
+
+Error OpenSSLCryptoProvider::Verify(
+    const std::vector<uint8_t>& publicKey, const std::vector<uint8_t>& data, const std::vector<uint8_t>& signature)
+{
+    return VerifySignature(publicKey, data, signature);
+}
+
+Error OpenSSLCryptoProvider::Hash(
+    HashAlgorithm algorithm, const uint8_t* data, size_t size, std::vector<uint8_t>& digest)
+{
+    auto         md         = algorithm == HashAlgorithm::eSHA384 ? EVP_sha384() : EVP_sha256();
+    unsigned int digestSize = 0;
+
+    digest.resize(EVP_MD_get_size(md));
+
+    if (!EVP_Digest(data, size, digest.data(), &digestSize, md, nullptr)) {
+        return Error::eFailed;
+    }
+
+    return Error::eNone;
+}
+
+Error OpenSSLCryptoProvider::CreateCSR(const PrivateKeyItf& key, const CSRParams& params, std::vector<uint8_t>& der)
+{
+    return certhandler::CreateCSR(key, params, der);
+}
+
+} // namespace certhandler
+} // namespace iam
+} // namespace aos
@@ -0,0 +1,971 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cstring>
+
+#include <dlfcn.h>
+
+#include <openssl/bn.h>
+#include <openssl/core_names.h>
+#include <openssl/ec.h>
+#include <openssl/evp.h>
+#include <openssl/param_build.h>
+#include <openssl/rand.h>
+#include <openssl/x509.h>
+
+#include "pkcs11keystorage.hpp"
+
+namespace aos {
+namespace iam {
+namespace certhandler {
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+namespace {
+
+// DER encoded curve OIDs used as CKA_EC_PARAMS.
+const std::vector<uint8_t> cP256Params    = {0x06, 0x08, 0x2a, 0x86, 0x48, 0xce, 0x3d, 0x03, 0x01, 0x07};
+const std::vector<uint8_t> cP384Params    = {0x06, 0x05, 0x2b, 0x81, 0x04, 0x00, 0x22};
+const std::vector<uint8_t> cEd25519Params = {0x06, 0x03, 0x2b, 0x65, 0x70};
+
+Error ConvertError(CK_RV rv)
+{
+    switch (rv) {
+    case CKR_OK:
+        return Error::eNone;
+
+    case CKR_HOST_MEMORY:
+    case CKR_DEVICE_MEMORY:
+        return Error::eNoMemory;
+
+    case CKR_ARGUMENTS_BAD:
+    case CKR_MECHANISM_INVALID:
+    case CKR_KEY_TYPE_INCONSISTENT:
+        return Error::eInvalidArgument;
+
+    case CKR_OBJECT_HANDLE_INVALID:
+    case CKR_KEY_HANDLE_INVALID:
+        return Error::eNotFound;
+
+    default:
+        return Error::eFailed;
+    }
+}
+
+bool IsECDSA(KeyAlgorithm algorithm)
+{
+    return algorithm == KeyAlgorithm::eECDSAP256 || algorithm == KeyAlgorithm::eECDSAP384;
+}
+
+// Converts raw r||s PKCS#11 ECDSA signature to DER.
+Error ConvertECDSASignature(std::vector<uint8_t>& signature)
+{
+    if (signature.empty() || signature.size() % 2) {
+        return Error::eFailed;
+    }
+
+    auto half = signature.size() / 2;
+
+    std::unique_ptr<ECDSA_SIG, decltype(&ECDSA_SIG_free)> sig(ECDSA_SIG_new(), ECDSA_SIG_free);
+
+    auto r = BN_bin2bn(signature.data(), half, nullptr);
+    auto s = BN_bin2bn(signature.data() + half, half, nullptr);
+
+    if (!sig || !r || !s || ECDSA_SIG_set0(sig.get(), r, s) != 1) {
+        BN_free(r);
+        BN_free(s);
+
+        return Error::eNoMemory;
+    }
+
+    auto size = i2d_ECDSA_SIG(sig.get(), nullptr);
+    if (size <= 0) {
+        return Error::eFailed;
+    }
+
+    signature.resize(size);
+
+    auto data = signature.data();
+
+    if (i2d_ECDSA_SIG(sig.get(), &data) != size) {
+        return Error::eFailed;
+    }
+
+    return Error::eNone;
+}
+
+// Unwraps DER OCTET STRING of CKA_EC_POINT, returns data as is if it is not wrapped.
+std::vector<uint8_t> UnwrapECPoint(const std::vector<uint8_t>& point)
+{
+    auto data = point.data();
+
+    std::unique_ptr<ASN1_OCTET_STRING, decltype(&ASN1_OCTET_STRING_free)> octets(
+        d2i_ASN1_OCTET_STRING(nullptr, &data, point.size()), ASN1_OCTET_STRING_free);
+    if (!octets || data != point.data() + point.size()) {
+        return point;
+    }
+
+    auto begin = ASN1_STRING_get0_data(octets.get());
+
+    return std::vector<uint8_t>(begin, begin + ASN1_STRING_length(octets.get()));
+}
+
+Error CreatePublicKeyFromParams(const char* type, OSSL_PARAM_BLD* builder, EVP_PKEY*& pkey)
+{
+    std::unique_ptr<OSSL_PARAM, decltype(&OSSL_PARAM_free)> params(OSSL_PARAM_BLD_to_param(builder), OSSL_PARAM_free);
+    std::unique_ptr<EVP_PKEY_CTX, decltype(&EVP_PKEY_CTX_free)> ctx(
+        EVP_PKEY_CTX_new_from_name(nullptr, type, nullptr), EVP_PKEY_CTX_free);
+
+    if (!params || !ctx) {
+        return Error::eNoMemory;
+    }
+
+    if (EVP_PKEY_fromdata_init(ctx.get()) <= 0
+        || EVP_PKEY_fromdata(ctx.get(), &pkey, EVP_PKEY_PUBLIC_KEY, params.get()) <= 0) {
+        return Error::eFailed;
+    }
+
+    return Error::eNone;
+}
+
+Error EncodePublicKey(EVP_PKEY* pkey, std::vector<uint8_t>& der)
+{
+    auto size = i2d_PUBKEY(pkey, nullptr);
+    if (size <= 0) {
+        return Error::eFailed;
+    }
+
+    der.resize(size);
+
+    auto data = der.data();
+
+    if (i2d_PUBKEY(pkey, &data) != size) {
+        return Error::eFailed;
+    }
+
+    return Error::eNone;
+}
+
+class PKCS11PrivateKey : public PrivateKeyItf {
+public:
+    PKCS11PrivateKey(std::shared_ptr<PKCS11SessionPool> sessions, CK_FUNCTION_LIST_PTR functions,
+        KeyAlgorithm algorithm, const std::vector<uint8_t>& id, CK_OBJECT_HANDLE handle,
+        const std::vector<uint8_t>& publicKey)
+        : mSessions(std::move(sessions))
+        , mFunctions(functions)
+        , mAlgorithm(algorithm)
+        , mID(id)
+        , mHandle(handle)
+        , mPublicKey(publicKey)
+    {
+    }
+
+    KeyAlgorithm GetAlgorithm() const override { return mAlgorithm; }
+
+    Error GetPublicKey(std::vector<uint8_t>& der) const override
+    {
+        der = mPublicKey;
+
+        return Error::eNone;
+    }
+
+    Error Sign(const std::vector<uint8_t>& data, std::vector<uint8_t>& signature) const override
+    {
+        CK_MECHANISM mechanism = {CKM_SHA256_RSA_PKCS, nullptr, 0};
+
+        switch (mAlgorithm) {
+        case KeyAlgorithm::eECDSAP256:
+            mechanism.mechanism = CKM_ECDSA_SHA256;
+            break;
+
+        case KeyAlgorithm::eECDSAP384:
+            mechanism.mechanism = CKM_ECDSA_SHA384;
+            break;
+
+        case KeyAlgorithm::eEd25519:
+            mechanism.mechanism = CKM_EDDSA;
+            break;
+
+        default:
+            break;
+        }
+
+        auto rv = mSessions->Execute([&](CK_SESSION_HANDLE session) {
+            auto rv = mFunctions->C_SignInit(session, &mechanism, mHandle);
+            if (rv != CKR_OK) {
+                return rv;
+            }
+
+            auto      input = const_cast<CK_BYTE_PTR>(data.data());
+            CK_ULONG size  = 0;
+
+            // Querying the size keeps the sign operation active.
+            if ((rv = mFunctions->C_Sign(session, input, data.size(), nullptr, &size)) != CKR_OK) {
+                return rv;
+            }
+
+            signature.resize(size);
+
+            if ((rv = mFunctions->C_Sign(session, input, data.size(), signature.data(), &size)) != CKR_OK) {
+                return rv;
+            }
+
+            signature.resize(size);
+
+            return rv;
+        });
+        if (rv != CKR_OK) {
+            return ConvertError(rv);
+        }
+
+        if (IsECDSA(mAlgorithm)) {
+            return ConvertECDSASignature(signature);
+        }
+
+        return Error::eNone;
+    }
+
+    const std::vector<uint8_t>& GetID() const { return mID; }
+
+private:
+    std::shared_ptr<PKCS11SessionPool> mSessions;
+    CK_FUNCTION_LIST_PTR               mFunctions;
+    KeyAlgorithm                       mAlgorithm;
+    std::vector<uint8_t>               mID;
+    CK_OBJECT_HANDLE                   mHandle;
+    std::vector<uint8_t>               mPublicKey;
+};
+
+} // namespace
+
+/***********************************************************************************************************************
+ * PKCS11Module
+ **********************************************************************************************************************/
+
+PKCS11Module::~PKCS11Module()
+{
+    // Module initialized by another user of the process is left initialized.
+    if (mFinalize) {
+        mFunctions->C_Finalize(nullptr);
+    }
+
+    if (mLibrary) {
+        dlclose(mLibrary);
+    }
+}
+
+Error PKCS11Module::Load(const std::string& library, std::shared_ptr<PKCS11Module>& module)
+{
+    auto handle = dlopen(library.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (!handle) {
+        return Error::eNotFound;
+    }
+
+    auto getFunctionList = reinterpret_cast<CK_C_GetFunctionList>(dlsym(handle, "C_GetFunctionList"));
+    if (!getFunctionList) {
+        dlclose(handle);
+
+        return Error::eNotFound;
+    }
+
+    CK_FUNCTION_LIST_PTR functions = nullptr;
+
+    if (getFunctionList(&functions) != CKR_OK || !functions) {
+        dlclose(handle);
+
+        return Error::eFailed;
+    }
+
+    return Get(handle, functions, module);
+}
+
+Error PKCS11Module::Attach(CK_FUNCTION_LIST_PTR functions, std::shared_ptr<PKCS11Module>& module)
+{
+    if (!functions) {
+        return Error::eInvalidArgument;
+    }
+
+    return Get(nullptr, functions, module);
+}
+
+/***********************************************************************************************************************
+ * PKCS11Module private
+ **********************************************************************************************************************/
+
+PKCS11Module::PKCS11Module(void* library, CK_FUNCTION_LIST_PTR functions)
+    : mLibrary(library)
+    , mFunctions(functions)
+{
+}
+
+Error PKCS11Module::Get(void* library, CK_FUNCTION_LIST_PTR functions, std::shared_ptr<PKCS11Module>& module)
+{
+    static std::mutex                                                   sMutex;
+    static std::map<CK_FUNCTION_LIST_PTR, std::weak_ptr<PKCS11Module>> sModules;
+
+    std::lock_guard<std::mutex> lock(sMutex);
+
+    // Module is finalized once for the whole process: share it between all storages using the same function list.
+    module = sModules[functions].lock();
+    if (module) {
+        if (library) {
+            dlclose(library);
+        }
+
+        return Error::eNone;
+    }
+
+    std::shared_ptr<PKCS11Module> newModule(new PKCS11Module(library, functions));
+
+    CK_C_INITIALIZE_ARGS args {};
+
+    args.flags = CKF_OS_LOCKING_OK;
+
+    auto rv = functions->C_Initialize(&args);
+    if (rv != CKR_OK && rv != CKR_CRYPTOKI_ALREADY_INITIALIZED) {
+        return ConvertError(rv);
+    }
+
+    newModule->mFinalize = rv == CKR_OK;
+
+    sModules[functions] = newModule;
+    module              = std::move(newModule);
+
+    return Error::eNone;
+}
+
+/***********************************************************************************************************************
+ * PKCS11SessionPool
+ **********************************************************************************************************************/
+
+PKCS11SessionPool::~PKCS11SessionPool()
+{
+    Close();
+}
+
+Error PKCS11SessionPool::Init(
+    std::shared_ptr<PKCS11Module> module, CK_SLOT_ID slotID, const std::string& pin, size_t size)
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        // PIN is kept for re-login after session loss: keep it in locked memory, zeroized when the pool is destroyed.
+        auto err = SecureArena::GetDefault().Allocate(pin.data(), pin.size(), mPIN);
+        if (err != Error::eNone) {
+            return err;
+        }
+
+        mFunctions = module->GetFunctions();
+        mModule    = std::move(module);
+        mSlotID    = slotID;
+        mSize      = size;
+        mClosed    = false;
+    }
+
+    for (size_t i = 0; i < size; i++) {
+        CK_SESSION_HANDLE session = CK_INVALID_HANDLE;
+
+        auto rv = OpenSession(session);
+        if (rv == CKR_OK && i == 0) {
+            // Login state is shared by all sessions of the application.
+            rv = Login(session);
+        }
+
+        if (rv != CKR_OK) {
+            if (session != CK_INVALID_HANDLE) {
+                mFunctions->C_CloseSession(session);
+            }
+
+            Close();
+
+            return ConvertError(rv);
+        }
+
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        mFreeSessions.push_back(session);
+        mNumSessions++;
+    }
+
+    return Error::eNone;
+}
+
+void PKCS11SessionPool::Close()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    if (!mClosed) {
+        mClosed = true;
+
+        for (auto session : mFreeSessions) {
+            mFunctions->C_CloseSession(session);
+        }
+
+        mNumSessions -= mFreeSessions.size();
+        mFreeSessions.clear();
+
+        mCondVar.notify_all();
+    }
+
+    // Busy sessions are closed by running operations on release.
+    mCondVar.wait(lock, [this] { return mNumSessions == 0; });
+}
+
+/***********************************************************************************************************************
+ * PKCS11SessionPool private
+ **********************************************************************************************************************/
+
+bool PKCS11SessionPool::IsSessionInvalid(CK_RV rv)
+{
+    return rv == CKR_SESSION_HANDLE_INVALID || rv == CKR_SESSION_CLOSED || rv == CKR_DEVICE_REMOVED
+        || rv == CKR_TOKEN_NOT_PRESENT;
+}
+
+CK_RV PKCS11SessionPool::Acquire(CK_SESSION_HANDLE& session)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    if (mSize != 0) {
+        mCondVar.wait(lock, [this] { return mClosed || !mFreeSessions.empty() || mNumSessions < mSize; });
+    }
+
+    if (mClosed) {
+        return CKR_CRYPTOKI_NOT_INITIALIZED;
+    }
+
+    if (!mFreeSessions.empty()) {
+        session = mFreeSessions.back();
+        mFreeSessions.pop_back();
+
+        return CKR_OK;
+    }
+
+    // Session lost after invalidation or pooling is disabled: open a new one.
+    mNumSessions++;
+
+    lock.unlock();
+
+    auto rv = OpenSession(session);
+    if (rv == CKR_OK) {
+        rv = Login(session);
+        if (rv != CKR_OK) {
+            mFunctions->C_CloseSession(session);
+        }
+    }
+
+    if (rv != CKR_OK) {
+        lock.lock();
+
+        mNumSessions--;
+        mCondVar.notify_all();
+    }
+
+    return rv;
+}
+
+void PKCS11SessionPool::Release(CK_SESSION_HANDLE session, CK_RV rv)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    if (mClosed || mSize == 0 || IsSessionInvalid(rv)) {
+        mNumSessions--;
+
+        lock.unlock();
+
+        mFunctions->C_CloseSession(session);
+
+        lock.lock();
+        mCondVar.notify_all();
+
+        return;
+    }
+
+    mFreeSessions.push_back(session);
+    mCondVar.notify_one();
+}
+
+CK_RV PKCS11SessionPool::OpenSession(CK_SESSION_HANDLE& session)
+{
+    return mFunctions->C_OpenSession(mSlotID, CKF_SERIAL_SESSION | CKF_RW_SESSION, nullptr, nullptr, &session);
+}
+
+CK_RV PKCS11SessionPool::Login(CK_SESSION_HANDLE session)
+{
+    CK_UTF8CHAR emptyPIN = 0;
+
+    // Empty PIN is passed as a valid pointer: null PIN requests protected authentication path.
+    auto pin = mPIN.IsEmpty() ? &emptyPIN : mPIN.GetData();
+    auto rv  = mFunctions->C_Login(session, CKU_USER, pin, mPIN.GetSize());
+    if (rv == CKR_USER_ALREADY_LOGGED_IN) {
+        return CKR_OK;
+    }
+
+    return rv;
+}
+
+/***********************************************************************************************************************
+ * PKCS11KeyStorage
+ **********************************************************************************************************************/
+
+PKCS11KeyStorage::~PKCS11KeyStorage()
+{
+    Release();
+}
+
+Error PKCS11KeyStorage::Init(const PKCS11Config& config)
+{
+    Release();
+
+    std::shared_ptr<PKCS11Module> module;
+
+    auto err = PKCS11Module::Load(config.mLibrary, module);
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    if ((err = InitModule(config, std::move(module))) != Error::eNone) {
+        Release();
+    }
+
+    return err;
+}
+
+Error PKCS11KeyStorage::Init(const PKCS11Config& config, CK_FUNCTION_LIST_PTR functions)
+{
+    Release();
+
+    std::shared_ptr<PKCS11Module> module;
+
+    auto err = PKCS11Module::Attach(functions, module);
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    if ((err = InitModule(config, std::move(module))) != Error::eNone) {
+        Release();
+    }
+
+    return err;
+}
+
+Error PKCS11KeyStorage::CreateKey(KeyAlgorithm algorithm, std::shared_ptr<PrivateKeyItf>& key)
+{
+    if (!mSessions) {
+        return Error::eWrongState;
+    }
+
+    std::vector<uint8_t> id(cKeyIDSize);
+
+    if (RAND_bytes(id.data(), id.size()) != 1) {
+        return Error::eFailed;
+    }
+
+    CK_BBOOL     yes = CK_TRUE, no = CK_FALSE;
+    CK_ULONG     modulusBits = 0;
+    CK_BYTE      exponent[] = {0x01, 0x00, 0x01};
+    CK_MECHANISM mechanism = {CKM_EC_KEY_PAIR_GEN, nullptr, 0};
+
+    const std::vector<uint8_t>* ecParams = nullptr;
+
+    switch (algorithm) {
+    case KeyAlgorithm::eRSA2048:
+    case KeyAlgorithm::eRSA3072:
+        mechanism.mechanism = CKM_RSA_PKCS_KEY_PAIR_GEN;
+        modulusBits         = algorithm == KeyAlgorithm::eRSA2048 ? 2048 : 3072;
+        break;
+
+    case KeyAlgorithm::eECDSAP256:
+        ecParams = &cP256Params;
+        break;
+
+    case KeyAlgorithm::eECDSAP384:
+        ecParams = &cP384Params;
+        break;
+
+    case KeyAlgorithm::eEd25519:
+        mechanism.mechanism = CKM_EC_EDWARDS_KEY_PAIR_GEN;
+        ecParams            = &cEd25519Params;
+        break;
+
+    default:
+        return Error::eInvalidArgument;
+    }
+
+    std::vector<CK_ATTRIBUTE> publicTemplate = {
+        {CKA_TOKEN, &yes, sizeof(yes)},
+        {CKA_VERIFY, &yes, sizeof(yes)},
+        {CKA_ID, id.data(), id.size()},
+    };
+
+    if (ecParams) {
+        publicTemplate.push_back({CKA_EC_PARAMS, const_cast<uint8_t*>(ecParams->data()), ecParams->size()});
+    } else {
+        publicTemplate.push_back({CKA_MODULUS_BITS, &modulusBits, sizeof(modulusBits)});
+        publicTemplate.push_back({CKA_PUBLIC_EXPONENT, exponent, sizeof(exponent)});
+    }
+
+    std::vector<CK_ATTRIBUTE> privateTemplate = {
+        {CKA_TOKEN, &yes, sizeof(yes)},
+        {CKA_PRIVATE, &yes, sizeof(yes)},
+        {CKA_SENSITIVE, &yes, sizeof(yes)},
+        {CKA_EXTRACTABLE, &no, sizeof(no)},
+        {CKA_SIGN, &yes, sizeof(yes)},
+        {CKA_ID, id.data(), id.size()},
+    };
+
+    KeyHandles handles;
+
+    auto rv = mSessions->Execute([&](CK_SESSION_HANDLE session) {
+        return mFunctions->C_GenerateKeyPair(session, &mechanism, publicTemplate.data(), publicTemplate.size(),
+            privateTemplate.data(), privateTemplate.size(), &handles.mPublicKey, &handles.mPrivateKey);
+    });
+    if (rv != CKR_OK) {
+        return ConvertError(rv);
+    }
+
+    std::vector<uint8_t> publicKey;
+
+    auto err = ReadPublicKey(algorithm, handles.mPublicKey, publicKey);
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        mKeyHandles[id] = handles;
+    }
+
+    key = std::make_shared<PKCS11PrivateKey>(mSessions, mFunctions, algorithm, id, handles.mPrivateKey, publicKey);
+
+    return Error::eNone;
+}
+
+Error PKCS11KeyStorage::DeleteKey(const std::shared_ptr<PrivateKeyItf>& key)
+{
+    std::vector<uint8_t> id;
+
+    if (!key || GetKeyID(*key, id) != Error::eNone) {
+        return Error::eInvalidArgument;
+    }
+
+    if (!mSessions) {
+        return Error::eWrongState;
+    }
+
+    KeyHandles handles;
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        auto it = mKeyHandles.find(id);
+        if (it == mKeyHandles.end()) {
+            return Error::eNotFound;
+        }
+
+        handles = it->second;
+
+        mKeyHandles.erase(it);
+    }
+
+    auto rv = mSessions->Execute([&](CK_SESSION_HANDLE session) {
+        auto rv = mFunctions->C_DestroyObject(session, handles.mPrivateKey);
+
+        if (handles.mPublicKey != CK_INVALID_HANDLE) {
+            auto publicRv = mFunctions->C_DestroyObject(session, handles.mPublicKey);
+            if (rv == CKR_OK) {
+                rv = publicRv;
+            }
+        }
+
+        return rv;
+    });
+
+    return ConvertError(rv);
+}
+
+size_t PKCS11KeyStorage::GetMaxConcurrency() const
+{
+    return mPoolSize ? mPoolSize : 1;
+}
+
+Error PKCS11KeyStorage::GetKey(
+    const std::vector<uint8_t>& id, KeyAlgorithm algorithm, std::shared_ptr<PrivateKeyItf>& key)
+{
+    if (!mSessions) {
+        return Error::eWrongState;
+    }
+
+    KeyHandles handles;
+    bool       cached = false;
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        auto it = mKeyHandles.find(id);
+        if (it != mKeyHandles.end()) {
+            handles = it->second;
+            cached  = true;
+        }
+    }
+
+    if (!cached) {
+        auto err = FindKeyObject(id, CKO_PRIVATE_KEY, handles.mPrivateKey);
+        if (err != Error::eNone) {
+            return err;
+        }
+
+        if ((err = FindKeyObject(id, CKO_PUBLIC_KEY, handles.mPublicKey)) != Error::eNone) {
+            return err;
+        }
+    }
+
+    std::vector<uint8_t> publicKey;
+
+    auto err = ReadPublicKey(algorithm, handles.mPublicKey, publicKey);
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    if (!cached) {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        mKeyHandles[id] = handles;
+    }
+
+    key = std::make_shared<PKCS11PrivateKey>(mSessions, mFunctions, algorithm, id, handles.mPrivateKey, publicKey);
+
+    return Error::eNone;
+}
+
+Error PKCS11KeyStorage::GetKeyID(const PrivateKeyItf& key, std::vector<uint8_t>& id)
+{
+    auto pkcs11Key = dynamic_cast<const PKCS11PrivateKey*>(&key);
+    if (!pkcs11Key) {
+        return Error::eInvalidArgument;
+    }
+
+    id = pkcs11Key->GetID();
+
+    return Error::eNone;
+}
+
+/***********************************************************************************************************************
+ * PKCS11KeyStorage private
+ **********************************************************************************************************************/
+
+Error PKCS11KeyStorage::InitModule(const PKCS11Config& config, std::shared_ptr<PKCS11Module> module)
+{
+    mFunctions = module->GetFunctions();
+    mModule    = module;
+
+    CK_SLOT_ID slotID = 0;
+
+    auto err = FindSlot(config, slotID);
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    auto sessions = std::make_shared<PKCS11SessionPool>();
+
+    if ((err = sessions->Init(std::move(module), slotID, config.mPIN, config.mPoolSize)) != Error::eNone) {
+        return err;
+    }
+
+    mPoolSize = config.mPoolSize;
+    mSessions = std::move(sessions);
+
+    return Error::eNone;
+}
+
+Error PKCS11KeyStorage::FindSlot(const PKCS11Config& config, CK_SLOT_ID& slotID)
+{
+    if (config.mTokenLabel.empty()) {
+        slotID = config.mSlotID;
+
+        return Error::eNone;
+    }
+
+    CK_ULONG count = 0;
+
+    auto rv = mFunctions->C_GetSlotList(CK_TRUE, nullptr, &count);
+    if (rv != CKR_OK) {
+        return ConvertError(rv);
+    }
+
+    std::vector<CK_SLOT_ID> slots(count);
+
+    if ((rv = mFunctions->C_GetSlotList(CK_TRUE, slots.data(), &count)) != CKR_OK) {
+        return ConvertError(rv);
+    }
+
+    for (CK_ULONG i = 0; i < count; i++) {
+        CK_TOKEN_INFO info;
+
+        if (mFunctions->C_GetTokenInfo(slots[i], &info) != CKR_OK) {
+            continue;
+        }
+
+        // Token label is blank padded.
+        std::string label(reinterpret_cast<const char*>(info.label), sizeof(info.label));
+
+        label.erase(label.find_last_not_of(' ') + 1);
+
+        if (label == config.mTokenLabel) {
+            slotID = slots[i];
+
+            return Error::eNone;
+        }
+    }
+
+    return Error::eNotFound;
+}
+
+Error PKCS11KeyStorage::FindKeyObject(
+    const std::vector<uint8_t>& id, CK_OBJECT_CLASS objectClass, CK_OBJECT_HANDLE& handle)
+{
+    CK_ATTRIBUTE findTemplate[] = {
+        {CKA_CLASS, &objectClass, sizeof(objectClass)},
+        {CKA_ID, const_cast<uint8_t*>(id.data()), id.size()},
+    };
+
+    CK_ULONG count = 0;
+
+    auto rv = mSessions->Execute([&](CK_SESSION_HANDLE session) {
+        auto rv = mFunctions->C_FindObjectsInit(session, findTemplate, 2);
+        if (rv != CKR_OK) {
+            return rv;
+        }
+
+        rv = mFunctions->C_FindObjects(session, &handle, 1, &count);
+
+        auto finalRv = mFunctions->C_FindObjectsFinal(session);
+
+        return rv != CKR_OK ? rv : finalRv;
+    });
+    if (rv != CKR_OK) {
+        return ConvertError(rv);
+    }
+
+    return count ? Error::eNone : Error::eNotFound;
+}
+
+Error PKCS11KeyStorage::ReadPublicKey(KeyAlgorithm algorithm, CK_OBJECT_HANDLE handle, std::vector<uint8_t>& der)
+{
+    std::vector<CK_ATTRIBUTE> attributes;
+
+    if (algorithm == KeyAlgorithm::eRSA2048 || algorithm == KeyAlgorithm::eRSA3072) {
+        attributes = {{CKA_MODULUS, nullptr, 0}, {CKA_PUBLIC_EXPONENT, nullptr, 0}};
+    } else {
+        attributes = {{CKA_EC_POINT, nullptr, 0}};
+    }
+
+    std::vector<std::vector<uint8_t>> values(attributes.size());
+
+    auto rv = mSessions->Execute([&](CK_SESSION_HANDLE session) {
+        auto rv = mFunctions->C_GetAttributeValue(session, handle, attributes.data(), attributes.size());
+        if (rv != CKR_OK) {
+            return rv;
+        }
+
+        for (size_t i = 0; i < attributes.size(); i++) {
+            values[i].resize(attributes[i].ulValueLen);
+            attributes[i].pValue = values[i].data();
+        }
+
+        return mFunctions->C_GetAttributeValue(session, handle, attributes.data(), attributes.size());
+    });
+    if (rv != CKR_OK) {
+        return ConvertError(rv);
+    }
+
+    EVP_PKEY* pkey = nullptr;
+    Error     err  = Error::eNone;
+
+    if (algorithm == KeyAlgorithm::eEd25519) {
+        auto point = UnwrapECPoint(values[0]);
+
+        pkey = EVP_PKEY_new_raw_public_key(EVP_PKEY_ED25519, nullptr, point.data(), point.size());
+        if (!pkey) {
+            return Error::eFailed;
+        }
+    } else {
+        std::unique_ptr<OSSL_PARAM_BLD, decltype(&OSSL_PARAM_BLD_free)> builder(
+            OSSL_PARAM_BLD_new(), OSSL_PARAM_BLD_free);
+        if (!builder) {
+            return Error::eNoMemory;
+        }
+
+        std::unique_ptr<BIGNUM, decltype(&BN_free)> n(nullptr, BN_free), e(nullptr, BN_free);
+        std::vector<uint8_t>                         point;
+
+        if (!IsECDSA(algorithm)) {
+            n.reset(BN_bin2bn(values[0].data(), values[0].size(), nullptr));
+            e.reset(BN_bin2bn(values[1].data(), values[1].size(), nullptr));
+
+            if (!n || !e || !OSSL_PARAM_BLD_push_BN(builder.get(), OSSL_PKEY_PARAM_RSA_N, n.get())
+                || !OSSL_PARAM_BLD_push_BN(builder.get(), OSSL_PKEY_PARAM_RSA_E, e.get())) {
+                return Error::eNoMemory;
+            }
+
+            err = CreatePublicKeyFromParams("RSA", builder.get(), pkey);
+        } else {
+            auto curve = algorithm == KeyAlgorithm::eECDSAP256 ? "prime256v1" : "secp384r1";
+
+            point = UnwrapECPoint(values[0]);
+
+            if (!OSSL_PARAM_BLD_push_utf8_string(builder.get(), OSSL_PKEY_PARAM_GROUP_NAME, curve, 0)
+                || !OSSL_PARAM_BLD_push_octet_string(
+                    builder.get(), OSSL_PKEY_PARAM_PUB_KEY, point.data(), point.size())) {
+                return Error::eNoMemory;
+            }
+
+            err = CreatePublicKeyFromParams("EC", builder.get(), pkey);
+        }
+
+        if (err != Error::eNone) {
+            return err;
+        }
+    }
+
+    err = EncodePublicKey(pkey, der);
+
+    EVP_PKEY_free(pkey);
+
+    return err;
+}
+
+void PKCS11KeyStorage::Release()
+{
+    if (mSessions) {
+        mSessions->Close();
+        mSessions.reset();
+    }
+
+    // Keys outliving the storage keep the module loaded through their session pool.
+    mModule.reset();
+    mFunctions = nullptr;
+
+    mKeyHandles.clear();
+}
+
+} // namespace certhandler
+} // namespace iam
+} // namespace aos
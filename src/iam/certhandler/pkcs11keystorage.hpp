@@ -0,0 +1,295 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PKCS11KEYSTORAGE_HPP_
+#define PKCS11KEYSTORAGE_HPP_
+
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <p11-kit/pkcs11.h>
+
+#include "keystorage.hpp"
+#include "securearena.hpp"
+
+namespace aos {
+namespace iam {
+namespace certhandler {
+
+/** @addtogroup iam Identification and Access Manager
+ *  @{
+ */
+
+/**
+ * PKCS#11 key storage configuration.
+ */
+struct PKCS11Config {
+    /**
+     * PKCS#11 module path.
+     */
+    std::string mLibrary;
+
+    /**
+     * Token slot ID, used if token label is empty.
+     */
+    CK_SLOT_ID mSlotID = 0;
+
+    /**
+     * Token label.
+     */
+    std::string mTokenLabel;
+
+    /**
+     * User PIN.
+     */
+    std::string mPIN;
+
+    /**
+     * Number of open logged in sessions. 0 disables pooling: a session is opened and logged in for each operation.
+     */
+    size_t mPoolSize = 4;
+};
+
+/**
+ * Loaded and initialized PKCS#11 module shared by storages, session pools and keys. One instance exists per function
+ * list: the module is finalized and unloaded when the last user releases it.
+ */
+class PKCS11Module {
+public:
+    /**
+     * Finalizes module if it was initialized by this instance and unloads library.
+     */
+    ~PKCS11Module();
+
+    /**
+     * Loads PKCS#11 module library and initializes it.
+     *
+     * @param library module path.
+     * @param[out] module loaded module.
+     * @return Error.
+     */
+    static Error Load(const std::string& library, std::shared_ptr<PKCS11Module>& module);
+
+    /**
+     * Initializes already loaded PKCS#11 module.
+     *
+     * @param functions PKCS#11 function list.
+     * @param[out] module initialized module.
+     * @return Error.
+     */
+    static Error Attach(CK_FUNCTION_LIST_PTR functions, std::shared_ptr<PKCS11Module>& module);
+
+    /**
+     * Returns module function list.
+     *
+     * @return CK_FUNCTION_LIST_PTR.
+     */
+    CK_FUNCTION_LIST_PTR GetFunctions() const { return mFunctions; }
+
+private:
+    PKCS11Module(void* library, CK_FUNCTION_LIST_PTR functions);
+
+    static Error Get(void* library, CK_FUNCTION_LIST_PTR functions, std::shared_ptr<PKCS11Module>& module);
+
+    void*                mLibrary = nullptr;
+    CK_FUNCTION_LIST_PTR mFunctions = nullptr;
+    bool                 mFinalize = false;
+};
+
+/**
+ * Pool of open logged in PKCS#11 sessions of one token slot.
+ */
+class PKCS11SessionPool {
+public:
+    /**
+     * Destroys session pool.
+     */
+    ~PKCS11SessionPool();
+
+    /**
+     * Opens pool sessions and logs in. The pool keeps the module loaded until it is destroyed.
+     *
+     * @param module PKCS#11 module.
+     * @param slotID token slot ID.
+     * @param pin user PIN.
+     * @param size number of pooled sessions.
+     * @return Error.
+     */
+    Error Init(std::shared_ptr<PKCS11Module> module, CK_SLOT_ID slotID, const std::string& pin, size_t size);
+
+    /**
+     * Closes all sessions. Waits until sessions used by running operations are released and closed.
+     */
+    void Close();
+
+    /**
+     * Executes operation on a pooled session. Waits for a free session if all sessions are busy. If the session is
+     * not logged in, logs in and retries the operation once. Invalidated sessions are reopened and the operation is
+     * retried once on a new session.
+     *
+     * @param operation operation to execute.
+     * @return CK_RV operation result.
+     */
+    template <typename T>
+    CK_RV Execute(T operation)
+    {
+        // Retry once on a new session if the token has invalidated the used one.
+        for (int attempt = 0;; attempt++) {
+            CK_SESSION_HANDLE session = CK_INVALID_HANDLE;
+
+            auto rv = Acquire(session);
+            if (rv != CKR_OK) {
+                return rv;
+            }
+
+            rv = operation(session);
+
+            if (rv == CKR_USER_NOT_LOGGED_IN && Login(session) == CKR_OK) {
+                rv = operation(session);
+            }
+
+            Release(session, rv);
+
+            if (attempt > 0 || !IsSessionInvalid(rv)) {
+                return rv;
+            }
+        }
+    }
+
+private:
+    static bool IsSessionInvalid(CK_RV rv);
+
+    CK_RV Acquire(CK_SESSION_HANDLE& session);
+    void  Release(CK_SESSION_HANDLE session, CK_RV rv);
+    CK_RV OpenSession(CK_SESSION_HANDLE& session);
+    CK_RV Login(CK_SESSION_HANDLE session);
+
+    std::shared_ptr<PKCS11Module>  mModule;
+    CK_FUNCTION_LIST_PTR           mFunctions = nullptr;
+    CK_SLOT_ID                     mSlotID = 0;
+    SecureBuffer                   mPIN;
+    size_t                         mSize = 0;
+    bool                           mClosed = true;
+    std::mutex                     mMutex;
+    std::condition_variable        mCondVar;
+    std::vector<CK_SESSION_HANDLE> mFreeSessions;
+    size_t                         mNumSessions = 0;
+};
+
+/**
+ * PKCS#11 key storage.
+ */
+class PKCS11KeyStorage : public KeyStorageItf {
+public:
+    /**
+     * Destroys PKCS#11 key storage.
+     */
+    ~PKCS11KeyStorage();
+
+    /**
+     * Loads PKCS#11 module and opens session pool.
+     *
+     * @param config configuration.
+     * @return Error.
+     */
+    Error Init(const PKCS11Config& config);
+
+    /**
+     * Initializes storage with already loaded PKCS#11 module, config library is ignored.
+     *
+     * @param config configuration.
+     * @param functions PKCS#11 function list.
+     * @return Error.
+     */
+    Error Init(const PKCS11Config& config, CK_FUNCTION_LIST_PTR functions);
+
+    /**
+     * Creates private key.
+     *
+     * @param algorithm key algorithm.
+     * @param[out] key created key.
+     * @return Error.
+     */
+    Error CreateKey(KeyAlgorithm algorithm, std::shared_ptr<PrivateKeyItf>& key) override;
+
+    /**
+     * Securely deletes key from the storage.
+     *
+     * @param key key to delete.
+     * @return Error.
+     */
+    Error DeleteKey(const std::shared_ptr<PrivateKeyItf>& key) override;
+
+    /**
+     * Returns max number of key operations the storage may run in parallel.
+     *
+     * @return size_t.
+     */
+    size_t GetMaxConcurrency() const override;
+
+    /**
+     * Returns key by CKA_ID. Object handles of found keys are cached.
+     *
+     * @param id key ID.
+     * @param algorithm key algorithm.
+     * @param[out] key found key.
+     * @return Error.
+     */
+    Error GetKey(const std::vector<uint8_t>& id, KeyAlgorithm algorithm, std::shared_ptr<PrivateKeyItf>& key);
+
+    /**
+     * Returns CKA_ID of the key created by this storage.
+     *
+     * @param key key.
+     * @param[out] id key ID.
+     * @return Error.
+     */
+    static Error GetKeyID(const PrivateKeyItf& key, std::vector<uint8_t>& id);
+
+private:
+    static constexpr size_t cKeyIDSize = 16;
+
+    struct KeyHandles {
+        CK_OBJECT_HANDLE mPrivateKey = CK_INVALID_HANDLE;
+        CK_OBJECT_HANDLE mPublicKey = CK_INVALID_HANDLE;
+    };
+
+    Error InitModule(const PKCS11Config& config, std::shared_ptr<PKCS11Module> module);
+    Error FindSlot(const PKCS11Config& config, CK_SLOT_ID& slotID);
+    Error FindKeyObject(const std::vector<uint8_t>& id, CK_OBJECT_CLASS objectClass, CK_OBJECT_HANDLE& handle);
+    Error ReadPublicKey(KeyAlgorithm algorithm, CK_OBJECT_HANDLE handle, std::vector<uint8_t>& der);
+    void  Release();
+
+    std::shared_ptr<PKCS11Module>              mModule;
+    CK_FUNCTION_LIST_PTR                       mFunctions = nullptr;
+    size_t                                     mPoolSize = 0;
+    std::shared_ptr<PKCS11SessionPool>         mSessions;
+    std::mutex                                 mMutex;
+    std::map<std::vector<uint8_t>, KeyHandles> mKeyHandles;
+};
+
+/** @}*/
+
+} // namespace certhandler
+} // namespace iam
+} // namespace aos
+
+#endif
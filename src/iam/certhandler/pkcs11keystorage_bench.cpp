@@ -0,0 +1,133 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdlib>
+#include <map>
+#include <mutex>
+
+#include <benchmark/benchmark.h>
+
+#include "pkcs11keystorage.hpp"
+
+using namespace aos;
+using namespace aos::iam::certhandler;
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+namespace {
+
+struct Context {
+    Error                          mErr = Error::eNone;
+    PKCS11KeyStorage               mStorage;
+    std::shared_ptr<PrivateKeyItf> mKey;
+};
+
+std::mutex                                 sMutex;
+std::map<size_t, std::unique_ptr<Context>> sContexts;
+
+// Storage per pool size shared by benchmark threads. Token is set by AOS_PKCS11_MODULE, AOS_PKCS11_TOKEN and
+// AOS_PKCS11_PIN environment variables.
+Context* GetContext(size_t poolSize)
+{
+    std::lock_guard<std::mutex> lock(sMutex);
+
+    auto& context = sContexts[poolSize];
+
+    if (!context) {
+        context.reset(new Context);
+
+        auto library = getenv("AOS_PKCS11_MODULE");
+        auto token   = getenv("AOS_PKCS11_TOKEN");
+        auto pin     = getenv("AOS_PKCS11_PIN");
+
+        if (!library || !token || !pin) {
+            context->mErr = Error::eNotFound;
+
+            return context.get();
+        }
+
+        PKCS11Config config;
+
+        config.mLibrary    = library;
+        config.mTokenLabel = token;
+        config.mPIN        = pin;
+        config.mPoolSize   = poolSize;
+
+        context->mErr = context->mStorage.Init(config);
+        if (context->mErr == Error::eNone) {
+            context->mErr = context->mStorage.CreateKey(KeyAlgorithm::eECDSAP256, context->mKey);
+        }
+    }
+
+    return context.get();
+}
+
+// Token keys are persistent: delete the key created by the benchmark.
+void ReleaseContext(const benchmark::State& state)
+{
+    std::lock_guard<std::mutex> lock(sMutex);
+
+    auto it = sContexts.find(state.range(0));
+    if (it == sContexts.end()) {
+        return;
+    }
+
+    if (it->second->mKey) {
+        it->second->mStorage.DeleteKey(it->second->mKey);
+    }
+
+    sContexts.erase(it);
+}
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Benchmarks
+ **********************************************************************************************************************/
+
+// Sign operations per second depending on session pool size, pool size 0 opens and logs in a session per operation.
+static void SignPoolSize(benchmark::State& state)
+{
+    auto context = GetContext(state.range(0));
+
+    if (context->mErr != Error::eNone) {
+        state.SkipWithError("PKCS#11 token is not available");
+    }
+
+    std::vector<uint8_t> data(64, 0x5a), signature;
+
+    for (auto _ : state) {
+        if (context->mKey->Sign(data, signature) != Error::eNone) {
+            state.SkipWithError("sign failed");
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(SignPoolSize)
+    ->Teardown(ReleaseContext)
+    ->Arg(0)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8)
+    ->Threads(1)
+    ->Threads(8)
+    ->UseRealTime();
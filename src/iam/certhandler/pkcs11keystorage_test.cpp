@@ -0,0 +1,852 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <set>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include <openssl/core_names.h>
+#include <openssl/ec.h>
+#include <openssl/evp.h>
+
+#include "pkcs11keystorage.hpp"
+#include "signature.hpp"
+
+using namespace aos;
+using namespace aos::iam::certhandler;
+
+/***********************************************************************************************************************
+ * Mocks
+ **********************************************************************************************************************/
+
+namespace {
+
+// Minimal PKCS#11 token emulation on top of OpenSSL.
+struct MockObject {
+    CK_OBJECT_CLASS      mClass;
+    std::vector<uint8_t> mID;
+    CK_MECHANISM_TYPE    mSignMechanism;
+    EVP_PKEY*            mPKey;
+};
+
+struct MockSignState {
+    CK_OBJECT_HANDLE  mKey = CK_INVALID_HANDLE;
+    CK_MECHANISM_TYPE mMechanism = 0;
+};
+
+struct MockFindState {
+    std::vector<CK_OBJECT_HANDLE> mHandles;
+};
+
+struct MockToken {
+    std::mutex                                 mMutex;
+    std::set<CK_SESSION_HANDLE>                mSessions;
+    std::map<CK_OBJECT_HANDLE, MockObject>     mObjects;
+    std::map<CK_SESSION_HANDLE, MockSignState> mSignStates;
+    std::map<CK_SESSION_HANDLE, MockFindState> mFindStates;
+    CK_SESSION_HANDLE                          mNextSession = 1;
+    CK_OBJECT_HANDLE                           mNextObject = 1;
+    bool                                       mLoggedIn = false;
+    size_t                                     mNumOpened = 0;
+    size_t                                     mNumLogins = 0;
+    size_t                                     mNumFinds = 0;
+    size_t                                     mNumInvalidSessions = 0;
+    size_t                                     mNumFinalizes = 0;
+    CK_RV                                      mInitializeResult = CKR_OK;
+    std::string                                mPIN = "1234";
+    std::string                                mLabel = "aos";
+};
+
+MockToken* sToken = nullptr;
+
+std::vector<uint8_t> WrapOctetString(const uint8_t* data, size_t size)
+{
+    std::vector<uint8_t> result = {0x04, static_cast<uint8_t>(size)};
+
+    result.insert(result.end(), data, data + size);
+
+    return result;
+}
+
+CK_RV SetAttribute(CK_ATTRIBUTE& attribute, const std::vector<uint8_t>& value)
+{
+    if (attribute.pValue) {
+        if (attribute.ulValueLen < value.size()) {
+            return CKR_BUFFER_TOO_SMALL;
+        }
+
+        memcpy(attribute.pValue, value.data(), value.size());
+    }
+
+    attribute.ulValueLen = value.size();
+
+    return CKR_OK;
+}
+
+std::vector<uint8_t> GetBNParam(EVP_PKEY* pkey, const char* name)
+{
+    BIGNUM* bn = nullptr;
+
+    EVP_PKEY_get_bn_param(pkey, name, &bn);
+
+    std::vector<uint8_t> result(BN_num_bytes(bn));
+
+    BN_bn2bin(bn, result.data());
+    BN_free(bn);
+
+    return result;
+}
+
+CK_RV MockInitialize(CK_VOID_PTR)
+{
+    std::lock_guard<std::mutex> lock(sToken->mMutex);
+
+    return sToken->mInitializeResult;
+}
+
+CK_RV MockFinalize(CK_VOID_PTR)
+{
+    std::lock_guard<std::mutex> lock(sToken->mMutex);
+
+    sToken->mNumFinalizes++;
+
+    return CKR_OK;
+}
+
+CK_RV MockGetSlotList(CK_BBOOL, CK_SLOT_ID_PTR slots, CK_ULONG_PTR count)
+{
+    if (slots) {
+        slots[0] = 7;
+    }
+
+    *count = 1;
+
+    return CKR_OK;
+}
+
+CK_RV MockGetTokenInfo(CK_SLOT_ID, CK_TOKEN_INFO_PTR info)
+{
+    memset(info, ' ', sizeof(*info));
+    memcpy(info->label, sToken->mLabel.data(), sToken->mLabel.size());
+
+    return CKR_OK;
+}
+
+CK_RV MockOpenSession(CK_SLOT_ID, CK_FLAGS, CK_VOID_PTR, CK_NOTIFY, CK_SESSION_HANDLE_PTR session)
+{
+    std::lock_guard<std::mutex> lock(sToken->mMutex);
+
+    *session = sToken->mNextSession++;
+
+    sToken->mSessions.insert(*session);
+    sToken->mNumOpened++;
+
+    return CKR_OK;
+}
+
+CK_RV MockCloseSession(CK_SESSION_HANDLE session)
+{
+    std::lock_guard<std::mutex> lock(sToken->mMutex);
+
+    if (!sToken->mSessions.erase(session)) {
+        return CKR_SESSION_HANDLE_INVALID;
+    }
+
+    // Closing the last session logs out.
+    if (sToken->mSessions.empty()) {
+        sToken->mLoggedIn = false;
+    }
+
+    return CKR_OK;
+}
+
+CK_RV MockLogin(CK_SESSION_HANDLE, CK_USER_TYPE, CK_UTF8CHAR_PTR pin, CK_ULONG pinLen)
+{
+    std::lock_guard<std::mutex> lock(sToken->mMutex);
+
+    if (sToken->mLoggedIn) {
+        return CKR_USER_ALREADY_LOGGED_IN;
+    }
+
+    if (std::string(reinterpret_cast<char*>(pin), pinLen) != sToken->mPIN) {
+        return CKR_PIN_INCORRECT;
+    }
+
+    sToken->mLoggedIn = true;
+    sToken->mNumLogins++;
+
+    return CKR_OK;
+}
+
+CK_RV CheckSession(CK_SESSION_HANDLE session)
+{
+    if (sToken->mNumInvalidSessions) {
+        sToken->mNumInvalidSessions--;
+        sToken->mSessions.erase(session);
+
+        return CKR_SESSION_HANDLE_INVALID;
+    }
+
+    if (!sToken->mSessions.count(session)) {
+        return CKR_SESSION_HANDLE_INVALID;
+    }
+
+    if (!sToken->mLoggedIn) {
+        return CKR_USER_NOT_LOGGED_IN;
+    }
+
+    return CKR_OK;
+}
+
+CK_RV MockGenerateKeyPair(CK_SESSION_HANDLE session, CK_MECHANISM_PTR mechanism, CK_ATTRIBUTE_PTR publicTemplate,
+    CK_ULONG publicCount, CK_ATTRIBUTE_PTR privateTemplate, CK_ULONG privateCount, CK_OBJECT_HANDLE_PTR publicKey,
+    CK_OBJECT_HANDLE_PTR privateKey)
+{
+    std::lock_guard<std::mutex> lock(sToken->mMutex);
+
+    auto rv = CheckSession(session);
+    if (rv != CKR_OK) {
+        return rv;
+    }
+
+    std::vector<uint8_t> id;
+    CK_ULONG             bits = 0;
+
+    for (CK_ULONG i = 0; i < publicCount; i++) {
+        if (publicTemplate[i].type == CKA_MODULUS_BITS) {
+            bits = *static_cast<CK_ULONG*>(publicTemplate[i].pValue);
+        }
+    }
+
+    for (CK_ULONG i = 0; i < privateCount; i++) {
+        if (privateTemplate[i].type == CKA_ID) {
+            auto data = static_cast<uint8_t*>(privateTemplate[i].pValue);
+
+            id.assign(data, data + privateTemplate[i].ulValueLen);
+        }
+    }
+
+    EVP_PKEY*         pkey = nullptr;
+    CK_MECHANISM_TYPE signMechanism = 0;
+
+    switch (mechanism->mechanism) {
+    case CKM_RSA_PKCS_KEY_PAIR_GEN:
+        pkey          = EVP_PKEY_Q_keygen(nullptr, nullptr, "RSA", static_cast<size_t>(bits));
+        signMechanism = CKM_SHA256_RSA_PKCS;
+        break;
+
+    case CKM_EC_KEY_PAIR_GEN:
+        pkey          = EVP_PKEY_Q_keygen(nullptr, nullptr, "EC", "P-256");
+        signMechanism = CKM_ECDSA_SHA256;
+        break;
+
+    case CKM_EC_EDWARDS_KEY_PAIR_GEN:
+        pkey          = EVP_PKEY_Q_keygen(nullptr, nullptr, "ED25519");
+        signMechanism = CKM_EDDSA;
+        break;
+
+    default:
+        return CKR_MECHANISM_INVALID;
+    }
+
+    *publicKey  = sToken->mNextObject++;
+    *privateKey = sToken->mNextObject++;
+
+    EVP_PKEY_up_ref(pkey);
+
+    sToken->mObjects[*publicKey]  = {CKO_PUBLIC_KEY, id, signMechanism, pkey};
+    sToken->mObjects[*privateKey] = {CKO_PRIVATE_KEY, id, signMechanism, pkey};
+
+    return CKR_OK;
+}
+
+CK_RV MockDestroyObject(CK_SESSION_HANDLE session, CK_OBJECT_HANDLE handle)
+{
+    std::lock_guard<std::mutex> lock(sToken->mMutex);
+
+    auto rv = CheckSession(session);
+    if (rv != CKR_OK) {
+        return rv;
+    }
+
+    auto it = sToken->mObjects.find(handle);
+    if (it == sToken->mObjects.end()) {
+        return CKR_OBJECT_HANDLE_INVALID;
+    }
+
+    EVP_PKEY_free(it->second.mPKey);
+    sToken->mObjects.erase(it);
+
+    return CKR_OK;
+}
+
+CK_RV MockGetAttributeValue(CK_SESSION_HANDLE session, CK_OBJECT_HANDLE handle, CK_ATTRIBUTE_PTR attributes,
+    CK_ULONG count)
+{
+    std::lock_guard<std::mutex> lock(sToken->mMutex);
+
+    auto rv = CheckSession(session);
+    if (rv != CKR_OK) {
+        return rv;
+    }
+
+    auto it = sToken->mObjects.find(handle);
+    if (it == sToken->mObjects.end()) {
+        return CKR_OBJECT_HANDLE_INVALID;
+    }
+
+    auto pkey = it->second.mPKey;
+
+    for (CK_ULONG i = 0; i < count; i++) {
+        std::vector<uint8_t> value;
+
+        switch (attributes[i].type) {
+        case CKA_MODULUS:
+            value = GetBNParam(pkey, OSSL_PKEY_PARAM_RSA_N);
+            break;
+
+        case CKA_PUBLIC_EXPONENT:
+            value = GetBNParam(pkey, OSSL_PKEY_PARAM_RSA_E);
+            break;
+
+        case CKA_EC_POINT: {
+            uint8_t buffer[128];
+            size_t  size = sizeof(buffer);
+
+            if (EVP_PKEY_get_base_id(pkey) == EVP_PKEY_ED25519) {
+                EVP_PKEY_get_raw_public_key(pkey, buffer, &size);
+            } else {
+                EVP_PKEY_get_octet_string_param(
+                    pkey, OSSL_PKEY_PARAM_ENCODED_PUBLIC_KEY, buffer, sizeof(buffer), &size);
+            }
+
+            value = WrapOctetString(buffer, size);
+
+            break;
+        }
+
+        default:
+            return CKR_ATTRIBUTE_TYPE_INVALID;
+        }
+
+        if ((rv = SetAttribute(attributes[i], value)) != CKR_OK) {
+            return rv;
+        }
+    }
+
+    return CKR_OK;
+}
+
+CK_RV MockFindObjectsInit(CK_SESSION_HANDLE session, CK_ATTRIBUTE_PTR findTemplate, CK_ULONG count)
+{
+    std::lock_guard<std::mutex> lock(sToken->mMutex);
+
+    auto rv = CheckSession(session);
+    if (rv != CKR_OK) {
+        return rv;
+    }
+
+    CK_OBJECT_CLASS      objectClass = 0;
+    std::vector<uint8_t> id;
+
+    for (CK_ULONG i = 0; i < count; i++) {
+        if (findTemplate[i].type == CKA_CLASS) {
+            objectClass = *static_cast<CK_OBJECT_CLASS*>(findTemplate[i].pValue);
+        } else if (findTemplate[i].type == CKA_ID) {
+            auto data = static_cast<uint8_t*>(findTemplate[i].pValue);
+
+            id.assign(data, data + findTemplate[i].ulValueLen);
+        }
+    }
+
+    auto& state = sToken->mFindStates[session];
+
+    state.mHandles.clear();
+
+    for (const auto& object : sToken->mObjects) {
+        if (object.second.mClass == objectClass && object.second.mID == id) {
+            state.mHandles.push_back(object.first);
+        }
+    }
+
+    sToken->mNumFinds++;
+
+    return CKR_OK;
+}
+
+CK_RV MockFindObjects(CK_SESSION_HANDLE session, CK_OBJECT_HANDLE_PTR handles, CK_ULONG maxCount, CK_ULONG_PTR count)
+{
+    std::lock_guard<std::mutex> lock(sToken->mMutex);
+
+    auto& state = sToken->mFindStates[session];
+
+    *count = 0;
+
+    while (*count < maxCount && !state.mHandles.empty()) {
+        handles[(*count)++] = state.mHandles.back();
+        state.mHandles.pop_back();
+    }
+
+    return CKR_OK;
+}
+
+CK_RV MockFindObjectsFinal(CK_SESSION_HANDLE session)
+{
+    std::lock_guard<std::mutex> lock(sToken->mMutex);
+
+    sToken->mFindStates.erase(session);
+
+    return CKR_OK;
+}
+
+CK_RV MockSignInit(CK_SESSION_HANDLE session, CK_MECHANISM_PTR mechanism, CK_OBJECT_HANDLE key)
+{
+    std::lock_guard<std::mutex> lock(sToken->mMutex);
+
+    auto rv = CheckSession(session);
+    if (rv != CKR_OK) {
+        return rv;
+    }
+
+    auto it = sToken->mObjects.find(key);
+    if (it == sToken->mObjects.end() || it->second.mClass != CKO_PRIVATE_KEY) {
+        return CKR_KEY_HANDLE_INVALID;
+    }
+
+    if (it->second.mSignMechanism != mechanism->mechanism) {
+        return CKR_MECHANISM_INVALID;
+    }
+
+    sToken->mSignStates[session] = {key, mechanism->mechanism};
+
+    return CKR_OK;
+}
+
+CK_RV MockSign(
+    CK_SESSION_HANDLE session, CK_BYTE_PTR data, CK_ULONG dataLen, CK_BYTE_PTR signature, CK_ULONG_PTR signatureLen)
+{
+    std::lock_guard<std::mutex> lock(sToken->mMutex);
+
+    auto state = sToken->mSignStates.find(session);
+    if (state == sToken->mSignStates.end()) {
+        return CKR_OPERATION_NOT_INITIALIZED;
+    }
+
+    auto pkey      = sToken->mObjects[state->second.mKey].mPKey;
+    auto mechanism = state->second.mMechanism;
+
+    if (!signature) {
+        *signatureLen = mechanism == CKM_ECDSA_SHA256 ? 64 : EVP_PKEY_get_size(pkey);
+
+        return CKR_OK;
+    }
+
+    sToken->mSignStates.erase(state);
+
+    std::unique_ptr<EVP_MD_CTX, decltype(&EVP_MD_CTX_free)> ctx(EVP_MD_CTX_new(), EVP_MD_CTX_free);
+
+    std::vector<uint8_t> result(EVP_PKEY_get_size(pkey));
+    size_t               size = result.size();
+
+    if (EVP_DigestSignInit(ctx.get(), nullptr, mechanism == CKM_EDDSA ? nullptr : EVP_sha256(), nullptr, pkey) <= 0
+        || EVP_DigestSign(ctx.get(), result.data(), &size, data, dataLen) <= 0) {
+        return CKR_FUNCTION_FAILED;
+    }
+
+    result.resize(size);
+
+    if (mechanism == CKM_ECDSA_SHA256) {
+        const uint8_t* buffer = result.data();
+
+        auto sig = d2i_ECDSA_SIG(nullptr, &buffer, result.size());
+
+        result.assign(64, 0);
+
+        BN_bn2binpad(ECDSA_SIG_get0_r(sig), result.data(), 32);
+        BN_bn2binpad(ECDSA_SIG_get0_s(sig), result.data() + 32, 32);
+
+        ECDSA_SIG_free(sig);
+    }
+
+    memcpy(signature, result.data(), result.size());
+    *signatureLen = result.size();
+
+    return CKR_OK;
+}
+
+CK_FUNCTION_LIST CreateMockFunctions()
+{
+    CK_FUNCTION_LIST functions {};
+
+    functions.C_Initialize        = MockInitialize;
+    functions.C_Finalize          = MockFinalize;
+    functions.C_GetSlotList       = MockGetSlotList;
+    functions.C_GetTokenInfo      = MockGetTokenInfo;
+    functions.C_OpenSession       = MockOpenSession;
+    functions.C_CloseSession      = MockCloseSession;
+    functions.C_Login             = MockLogin;
+    functions.C_GenerateKeyPair   = MockGenerateKeyPair;
+    functions.C_DestroyObject     = MockDestroyObject;
+    functions.C_GetAttributeValue = MockGetAttributeValue;
+    functions.C_FindObjectsInit   = MockFindObjectsInit;
+    functions.C_FindObjects       = MockFindObjects;
+    functions.C_FindObjectsFinal  = MockFindObjectsFinal;
+    functions.C_SignInit          = MockSignInit;
+    functions.C_Sign              = MockSign;
+
+    return functions;
+}
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Suite
+ **********************************************************************************************************************/
+
+class PKCS11KeyStorageTest : public testing::Test {
+protected:
+    void SetUp() override
+    {
+        sToken     = &mToken;
+        mFunctions = CreateMockFunctions();
+
+        mConfig.mSlotID   = 7;
+        mConfig.mPIN      = mToken.mPIN;
+        mConfig.mPoolSize = 2;
+    }
+
+    void TearDown() override
+    {
+        for (auto& object : mToken.mObjects) {
+            EVP_PKEY_free(object.second.mPKey);
+        }
+
+        sToken = nullptr;
+    }
+
+    MockToken        mToken;
+    CK_FUNCTION_LIST mFunctions;
+    PKCS11Config     mConfig;
+};
+
+/***********************************************************************************************************************
+ * Tests
+ **********************************************************************************************************************/
+
+TEST_F(PKCS11KeyStorageTest, SessionsAreReused)
+{
+    PKCS11KeyStorage storage;
+
+    ASSERT_EQ(storage.Init(mConfig, &mFunctions), Error::eNone);
+    EXPECT_EQ(storage.GetMaxConcurrency(), 2);
+    EXPECT_EQ(mToken.mNumOpened, 2);
+    EXPECT_EQ(mToken.mNumLogins, 1);
+
+    std::shared_ptr<PrivateKeyItf> key;
+
+    ASSERT_EQ(storage.CreateKey(KeyAlgorithm::eECDSAP256, key), Error::eNone);
+
+    std::vector<uint8_t> data = {1, 2, 3}, signature;
+
+    for (int i = 0; i < 10; i++) {
+        ASSERT_EQ(key->Sign(data, signature), Error::eNone);
+    }
+
+    EXPECT_EQ(mToken.mNumOpened, 2);
+    EXPECT_EQ(mToken.mNumLogins, 1);
+}
+
+TEST_F(PKCS11KeyStorageTest, NoPooling)
+{
+    PKCS11KeyStorage storage;
+
+    mConfig.mPoolSize = 0;
+
+    ASSERT_EQ(storage.Init(mConfig, &mFunctions), Error::eNone);
+    EXPECT_EQ(storage.GetMaxConcurrency(), 1);
+
+    std::shared_ptr<PrivateKeyItf> key;
+
+    // Key generation and public key read.
+    ASSERT_EQ(storage.CreateKey(KeyAlgorithm::eECDSAP256, key), Error::eNone);
+    EXPECT_EQ(mToken.mNumOpened, 2);
+    EXPECT_EQ(mToken.mNumLogins, 2);
+    EXPECT_TRUE(mToken.mSessions.empty());
+}
+
+TEST_F(PKCS11KeyStorageTest, SessionRecovery)
+{
+    PKCS11KeyStorage storage;
+
+    mConfig.mPoolSize = 1;
+
+    ASSERT_EQ(storage.Init(mConfig, &mFunctions), Error::eNone);
+
+    std::shared_ptr<PrivateKeyItf> key;
+
+    ASSERT_EQ(storage.CreateKey(KeyAlgorithm::eECDSAP256, key), Error::eNone);
+
+    std::vector<uint8_t> data = {1, 2, 3}, signature;
+
+    // Operation is retried on a new session if the token invalidates the used one.
+    mToken.mNumInvalidSessions = 1;
+
+    EXPECT_EQ(key->Sign(data, signature), Error::eNone);
+    EXPECT_EQ(mToken.mNumOpened, 2);
+
+    mToken.mNumInvalidSessions = 2;
+
+    EXPECT_EQ(key->Sign(data, signature), Error::eFailed);
+    EXPECT_EQ(key->Sign(data, signature), Error::eNone);
+    EXPECT_EQ(mToken.mNumOpened, 4);
+
+    // Lost login is restored on demand.
+    mToken.mLoggedIn = false;
+
+    EXPECT_EQ(key->Sign(data, signature), Error::eNone);
+    EXPECT_EQ(mToken.mNumLogins, 2);
+}
+
+TEST_F(PKCS11KeyStorageTest, WrongPIN)
+{
+    PKCS11KeyStorage storage;
+
+    mConfig.mPIN = "0000";
+
+    EXPECT_EQ(storage.Init(mConfig, &mFunctions), Error::eFailed);
+    EXPECT_TRUE(mToken.mSessions.empty());
+
+    std::shared_ptr<PrivateKeyItf> key;
+
+    EXPECT_EQ(storage.CreateKey(KeyAlgorithm::eECDSAP256, key), Error::eWrongState);
+}
+
+TEST_F(PKCS11KeyStorageTest, TokenLabel)
+{
+    PKCS11KeyStorage storage;
+
+    mConfig.mSlotID     = 0;
+    mConfig.mTokenLabel = "unknown";
+
+    EXPECT_EQ(storage.Init(mConfig, &mFunctions), Error::eNotFound);
+
+    mConfig.mTokenLabel = mToken.mLabel;
+
+    EXPECT_EQ(storage.Init(mConfig, &mFunctions), Error::eNone);
+}
+
+TEST_F(PKCS11KeyStorageTest, SignVerify)
+{
+    PKCS11KeyStorage storage;
+
+    ASSERT_EQ(storage.Init(mConfig, &mFunctions), Error::eNone);
+
+    for (auto algorithm : {KeyAlgorithm::eRSA2048, KeyAlgorithm::eECDSAP256, KeyAlgorithm::eEd25519}) {
+        std::shared_ptr<PrivateKeyItf> key;
+
+        ASSERT_EQ(storage.CreateKey(algorithm, key), Error::eNone);
+        EXPECT_EQ(key->GetAlgorithm(), algorithm);
+
+        std::vector<uint8_t> publicKey, data = {'d', 'a', 't', 'a'}, signature;
+
+        ASSERT_EQ(key->GetPublicKey(publicKey), Error::eNone);
+        ASSERT_EQ(key->Sign(data, signature), Error::eNone);
+        EXPECT_EQ(VerifySignature(publicKey, data, signature), Error::eNone);
+    }
+}
+
+TEST_F(PKCS11KeyStorageTest, GetKeyUsesCachedHandles)
+{
+    PKCS11KeyStorage storage;
+
+    ASSERT_EQ(storage.Init(mConfig, &mFunctions), Error::eNone);
+
+    std::shared_ptr<PrivateKeyItf> key, foundKey;
+    std::vector<uint8_t>           id, publicKey, foundPublicKey;
+
+    ASSERT_EQ(storage.CreateKey(KeyAlgorithm::eECDSAP256, key), Error::eNone);
+    ASSERT_EQ(PKCS11KeyStorage::GetKeyID(*key, id), Error::eNone);
+
+    ASSERT_EQ(storage.GetKey(id, KeyAlgorithm::eECDSAP256, foundKey), Error::eNone);
+    EXPECT_EQ(mToken.mNumFinds, 0);
+
+    ASSERT_EQ(key->GetPublicKey(publicKey), Error::eNone);
+    ASSERT_EQ(foundKey->GetPublicKey(foundPublicKey), Error::eNone);
+    EXPECT_EQ(publicKey, foundPublicKey);
+
+    // New storage instance looks objects up on the token once.
+    PKCS11KeyStorage otherStorage;
+
+    ASSERT_EQ(otherStorage.Init(mConfig, &mFunctions), Error::eNone);
+    ASSERT_EQ(otherStorage.GetKey(id, KeyAlgorithm::eECDSAP256, foundKey), Error::eNone);
+    EXPECT_EQ(mToken.mNumFinds, 2);
+    ASSERT_EQ(otherStorage.GetKey(id, KeyAlgorithm::eECDSAP256, foundKey), Error::eNone);
+    EXPECT_EQ(mToken.mNumFinds, 2);
+
+    std::vector<uint8_t> data = {1}, signature;
+
+    ASSERT_EQ(foundKey->Sign(data, signature), Error::eNone);
+    EXPECT_EQ(VerifySignature(publicKey, data, signature), Error::eNone);
+
+    EXPECT_EQ(otherStorage.GetKey({1, 2, 3}, KeyAlgorithm::eECDSAP256, foundKey), Error::eNotFound);
+}
+
+TEST_F(PKCS11KeyStorageTest, DeleteKey)
+{
+    PKCS11KeyStorage storage;
+
+    ASSERT_EQ(storage.Init(mConfig, &mFunctions), Error::eNone);
+
+    std::shared_ptr<PrivateKeyItf> key;
+
+    ASSERT_EQ(storage.CreateKey(KeyAlgorithm::eECDSAP256, key), Error::eNone);
+    EXPECT_EQ(mToken.mObjects.size(), 2);
+
+    EXPECT_EQ(storage.DeleteKey(key), Error::eNone);
+    EXPECT_TRUE(mToken.mObjects.empty());
+    EXPECT_EQ(storage.DeleteKey(key), Error::eNotFound);
+    EXPECT_EQ(storage.DeleteKey(nullptr), Error::eInvalidArgument);
+}
+
+TEST_F(PKCS11KeyStorageTest, ParallelSign)
+{
+    PKCS11KeyStorage storage;
+
+    ASSERT_EQ(storage.Init(mConfig, &mFunctions), Error::eNone);
+
+    std::shared_ptr<PrivateKeyItf> key;
+
+    ASSERT_EQ(storage.CreateKey(KeyAlgorithm::eEd25519, key), Error::eNone);
+
+    std::vector<std::thread> threads;
+
+    for (int i = 0; i < 4; i++) {
+        threads.emplace_back([&key]() {
+            std::vector<uint8_t> data = {1, 2, 3}, signature;
+
+            for (int j = 0; j < 20; j++) {
+                EXPECT_EQ(key->Sign(data, signature), Error::eNone);
+            }
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(mToken.mNumOpened, 2);
+}
+
+TEST_F(PKCS11KeyStorageTest, KeyOutlivesStorage)
+{
+    std::shared_ptr<PrivateKeyItf> key;
+
+    {
+        PKCS11KeyStorage storage;
+
+        ASSERT_EQ(storage.Init(mConfig, &mFunctions), Error::eNone);
+        ASSERT_EQ(storage.CreateKey(KeyAlgorithm::eECDSAP256, key), Error::eNone);
+    }
+
+    // Sessions are closed with the storage, the module stays initialized while the key is alive.
+    EXPECT_TRUE(mToken.mSessions.empty());
+    EXPECT_EQ(mToken.mNumFinalizes, 0);
+
+    std::vector<uint8_t> data = {1, 2, 3}, signature;
+
+    EXPECT_NE(key->Sign(data, signature), Error::eNone);
+
+    key.reset();
+
+    EXPECT_EQ(mToken.mNumFinalizes, 1);
+}
+
+TEST_F(PKCS11KeyStorageTest, SharedModule)
+{
+    std::unique_ptr<PKCS11KeyStorage> storage(new PKCS11KeyStorage), otherStorage(new PKCS11KeyStorage);
+
+    ASSERT_EQ(storage->Init(mConfig, &mFunctions), Error::eNone);
+    ASSERT_EQ(otherStorage->Init(mConfig, &mFunctions), Error::eNone);
+
+    // Releasing one storage doesn't finalize the module used by another one.
+    storage.reset();
+
+    EXPECT_EQ(mToken.mNumFinalizes, 0);
+
+    std::shared_ptr<PrivateKeyItf> key;
+
+    EXPECT_EQ(otherStorage->CreateKey(KeyAlgorithm::eECDSAP256, key), Error::eNone);
+
+    otherStorage.reset();
+    key.reset();
+
+    EXPECT_EQ(mToken.mNumFinalizes, 1);
+}
+
+TEST_F(PKCS11KeyStorageTest, ModuleInitializedElsewhere)
+{
+    mToken.mInitializeResult = CKR_CRYPTOKI_ALREADY_INITIALIZED;
+
+    {
+        PKCS11KeyStorage storage;
+
+        ASSERT_EQ(storage.Init(mConfig, &mFunctions), Error::eNone);
+    }
+
+    EXPECT_EQ(mToken.mNumFinalizes, 0);
+}
+
+// Runs against real token, e.g. SoftHSM:
+//   softhsm2-util --init-token --free --label aos --pin 1234 --so-pin 1234
+//   AOS_PKCS11_MODULE=/usr/lib/softhsm/libsofthsm2.so AOS_PKCS11_TOKEN=aos AOS_PKCS11_PIN=1234 aosiamcpp_test
+TEST(pkcs11keystorage, Token)
+{
+    auto library = getenv("AOS_PKCS11_MODULE");
+    auto token   = getenv("AOS_PKCS11_TOKEN");
+    auto pin     = getenv("AOS_PKCS11_PIN");
+
+    if (!library || !token || !pin) {
+        GTEST_SKIP() << "AOS_PKCS11_MODULE, AOS_PKCS11_TOKEN and AOS_PKCS11_PIN are not set";
+    }
+
+    PKCS11KeyStorage storage;
+    PKCS11Config     config;
+
+    config.mLibrary    = library;
+    config.mTokenLabel = token;
+    config.mPIN        = pin;
+
+    ASSERT_EQ(storage.Init(config), Error::eNone);
+
+    for (auto algorithm : {KeyAlgorithm::eRSA2048, KeyAlgorithm::eECDSAP256, KeyAlgorithm::eECDSAP384,
+             KeyAlgorithm::eEd25519}) {
+        std::shared_ptr<PrivateKeyItf> key;
+
+        ASSERT_EQ(storage.CreateKey(algorithm, key), Error::eNone);
+
+        std::vector<uint8_t> publicKey, data = {'d', 'a', 't', 'a'}, signature;
+
+        ASSERT_EQ(key->GetPublicKey(publicKey), Error::eNone);
+        ASSERT_EQ(key->Sign(data, signature), Error::eNone);
+        EXPECT_EQ(VerifySignature(publicKey, data, signature), Error::eNone);
+        EXPECT_EQ(storage.DeleteKey(key), Error::eNone);
+    }
+}
@@ -0,0 +1,286 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <mutex>
+
+#include "tools/threadpool.hpp"
+
+#include "provisioning.hpp"
+
+namespace aos {
+namespace iam {
+namespace certhandler {
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Runs each step on the thread pool as soon as all steps it depends on succeed.
+class Pipeline {
+public:
+    using StepFunc = std::function<Error()>;
+
+    size_t AddStep(ProvisioningStepType type, const std::string& target, StepFunc func,
+        const std::vector<size_t>& dependencies = {})
+    {
+        Step step;
+
+        step.mReport.mType   = type;
+        step.mReport.mTarget = target;
+        step.mFunc           = std::move(func);
+        step.mNumPending     = dependencies.size();
+
+        for (auto dependency : dependencies) {
+            mSteps[dependency].mDependents.push_back(mSteps.size());
+        }
+
+        mSteps.push_back(std::move(step));
+
+        return mSteps.size() - 1;
+    }
+
+    void Run(size_t numThreads)
+    {
+        ThreadPool pool(numThreads, mSteps.size());
+
+        mPool  = &pool;
+        mStart = Clock::now();
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+
+            for (size_t i = 0; i < mSteps.size(); i++) {
+                if (mSteps[i].mNumPending == 0) {
+                    Schedule(i);
+                }
+            }
+        }
+
+        pool.Wait();
+    }
+
+    Error GetError(size_t index) const { return mSteps[index].mReport.mError; }
+
+    bool IsFailed() const
+    {
+        return std::any_of(
+            mSteps.begin(), mSteps.end(), [](const Step& step) { return step.mReport.mError != Error::eNone; });
+    }
+
+    void GetReports(std::vector<ProvisioningStep>& reports) const
+    {
+        reports.clear();
+
+        for (const auto& step : mSteps) {
+            reports.push_back(step.mReport);
+        }
+
+        std::stable_sort(reports.begin(), reports.end(),
+            [](const ProvisioningStep& lhs, const ProvisioningStep& rhs) { return lhs.mStart < rhs.mStart; });
+    }
+
+private:
+    struct Step {
+        ProvisioningStep    mReport;
+        StepFunc            mFunc;
+        std::vector<size_t> mDependents;
+        size_t              mNumPending = 0;
+        bool                mDone       = false;
+    };
+
+    void Schedule(size_t index)
+    {
+        auto err = mPool->AddJob([this, index] {
+            auto start = Clock::now();
+            auto err   = mSteps[index].mFunc();
+            auto end   = Clock::now();
+
+            std::lock_guard<std::mutex> lock(mMutex);
+
+            Finish(index, err, start, end);
+        });
+        if (err != Error::eNone) {
+            auto now = Clock::now();
+
+            Finish(index, err, now, now);
+        }
+    }
+
+    void Finish(size_t index, Error err, Clock::time_point start, Clock::time_point end)
+    {
+        auto& step = mSteps[index];
+
+        step.mDone             = true;
+        step.mReport.mError    = err;
+        step.mReport.mStart    = std::chrono::duration_cast<std::chrono::microseconds>(start - mStart);
+        step.mReport.mDuration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+
+        for (auto dependent : step.mDependents) {
+            if (mSteps[dependent].mDone) {
+                continue;
+            }
+
+            // Dependents of a failed step are not run.
+            if (err != Error::eNone) {
+                Finish(dependent, Error::eWrongState, end, end);
+            } else if (--mSteps[dependent].mNumPending == 0) {
+                Schedule(dependent);
+            }
+        }
+    }
+
+    std::vector<Step> mSteps;
+    std::mutex        mMutex;
+    ThreadPool*       mPool = nullptr;
+    Clock::time_point mStart;
+};
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Public
+ **********************************************************************************************************************/
+
+Error Provision(CertHandler& handler, const ProvisioningConfig& config, ProvisioningResult& result)
+{
+    auto start = Clock::now();
+
+    // Key generation of a type waits for initialization of its storage.
+    std::map<KeyStorageItf*, std::vector<size_t>> storageSteps;
+    Pipeline                                      pipeline;
+
+    for (const auto& storage : config.mStorages) {
+        if (!storage.mStorage) {
+            return Error::eInvalidArgument;
+        }
+
+        storageSteps[storage.mStorage];
+    }
+
+    for (const auto& certType : config.mCertTypes) {
+        if (storageSteps.find(certType.mStorage) == storageSteps.end()) {
+            return Error::eInvalidArgument;
+        }
+
+        auto err = handler.RegisterCertType(certType.mCertType, *certType.mStorage);
+        if (err != Error::eNone && err != Error::eAlreadyExist) {
+            return err;
+        }
+    }
+
+    result.mCSRs.assign(config.mCertTypes.size(), CSRResult());
+
+    for (const auto& storage : config.mStorages) {
+        auto provisioner = storage.mProvisioner;
+
+        if (!provisioner) {
+            continue;
+        }
+
+        auto keyStorage = storage.mStorage;
+
+        // Pooled keys don't survive clearing: drop them and stop refills until the storage is initialized.
+        auto clear = pipeline.AddStep(ProvisioningStepType::eClear, storage.mName, [&handler, provisioner, keyStorage] {
+            auto err = handler.SuspendKeyPools(*keyStorage);
+            if (err != Error::eNone && err != Error::eNotFound) {
+                return err;
+            }
+
+            return provisioner->Clear();
+        });
+
+        storageSteps[storage.mStorage].push_back(pipeline.AddStep(ProvisioningStepType::eInit, storage.mName,
+            [&handler, provisioner, keyStorage, &config] {
+                auto err = provisioner->Init(config.mOwnerPassword);
+                if (err != Error::eNone) {
+                    return err;
+                }
+
+                handler.ResumeKeyPools(*keyStorage);
+
+                return Error::eNone;
+            },
+            {clear}));
+    }
+
+    std::vector<size_t> keygenSteps, csrSteps;
+
+    for (size_t i = 0; i < config.mCertTypes.size(); i++) {
+        auto& certType     = config.mCertTypes[i];
+        auto& csr          = result.mCSRs[i];
+        auto  dependencies = storageSteps[certType.mStorage];
+
+        csr.mCertType = certType.mCertType;
+
+        dependencies.push_back(pipeline.AddStep(ProvisioningStepType::eClear, certType.mCertType,
+            [&handler, &certType] { return handler.RemoveCerts(certType.mCertType); }));
+
+        auto keygen = pipeline.AddStep(ProvisioningStepType::eKeygen, certType.mCertType,
+            [&handler, &certType, &csr] {
+                return handler.CreateKey(certType.mCertType, certType.mAlgorithm, csr.mKey);
+            },
+            dependencies);
+
+        keygenSteps.push_back(keygen);
+
+        csrSteps.push_back(pipeline.AddStep(ProvisioningStepType::eCSR, certType.mCertType,
+            [&handler, &certType, &csr] {
+                auto err = handler.CreateCSR(certType.mCertType, csr.mKey, certType.mParams, csr.mCSR);
+                if (err != Error::eNone) {
+                    certType.mStorage->DeleteKey(csr.mKey);
+                    csr.mKey.reset();
+                }
+
+                return err;
+            },
+            {keygen}));
+    }
+
+    // Steps mostly wait for storages, the widest stage runs a step per storage and per certificate type.
+    pipeline.Run(config.mStorages.size() + config.mCertTypes.size());
+
+    // Resume pools of storages which failed to clear or initialize.
+    for (const auto& storage : config.mStorages) {
+        if (storage.mProvisioner) {
+            handler.ResumeKeyPools(*storage.mStorage);
+        }
+    }
+
+    // Report key generation error rather than skipped request.
+    for (size_t i = 0; i < csrSteps.size(); i++) {
+        auto err = pipeline.GetError(keygenSteps[i]);
+
+        result.mCSRs[i].mError = err != Error::eNone ? err : pipeline.GetError(csrSteps[i]);
+    }
+
+    pipeline.GetReports(result.mSteps);
+
+    result.mDuration = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start);
+
+    return pipeline.IsFailed() ? Error::eFailed : Error::eNone;
+}
+
+} // namespace certhandler
+} // namespace iam
+} // namespace aos
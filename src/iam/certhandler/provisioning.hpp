@@ -0,0 +1,208 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PROVISIONING_HPP_
+#define PROVISIONING_HPP_
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "certhandler.hpp"
+
+namespace aos {
+namespace iam {
+namespace certhandler {
+
+/** @addtogroup iam Identification and Access Manager
+ *  @{
+ */
+
+/**
+ * Provisioning operations of a key storage backend.
+ */
+class StorageProvisionerItf {
+public:
+    /**
+     * Destroys storage provisioner.
+     */
+    virtual ~StorageProvisionerItf() = default;
+
+    /**
+     * Removes all keys and objects left by previous provisioning.
+     *
+     * @return Error.
+     */
+    virtual Error Clear() = 0;
+
+    /**
+     * Initializes cleared storage and takes its ownership.
+     *
+     * @param password owner password.
+     * @return Error.
+     */
+    virtual Error Init(const std::string& password) = 0;
+};
+
+/**
+ * Key storage of the node.
+ */
+struct ProvisioningStorage {
+    /**
+     * Storage name used in step reports.
+     */
+    std::string mName;
+
+    /**
+     * Key storage.
+     */
+    KeyStorageItf* mStorage = nullptr;
+
+    /**
+     * Storage provisioner, optional: storages without provisioner are not cleared and initialized.
+     */
+    StorageProvisionerItf* mProvisioner = nullptr;
+};
+
+/**
+ * Certificate type of the node.
+ */
+struct ProvisioningCertType {
+    /**
+     * Certificate type.
+     */
+    std::string mCertType;
+
+    /**
+     * Key storage of the type, one of the provisioned storages.
+     */
+    KeyStorageItf* mStorage = nullptr;
+
+    /**
+     * Key algorithm.
+     */
+    KeyAlgorithm mAlgorithm = KeyAlgorithm::eECDSAP256;
+
+    /**
+     * Request parameters.
+     */
+    CSRParams mParams;
+};
+
+/**
+ * Node provisioning configuration.
+ */
+struct ProvisioningConfig {
+    /**
+     * Key storages.
+     */
+    std::vector<ProvisioningStorage> mStorages;
+
+    /**
+     * Certificate types.
+     */
+    std::vector<ProvisioningCertType> mCertTypes;
+
+    /**
+     * Owner password of the storages.
+     */
+    std::string mOwnerPassword;
+};
+
+/**
+ * Provisioning step.
+ */
+enum class ProvisioningStepType {
+    eClear,
+    eInit,
+    eKeygen,
+    eCSR,
+};
+
+/**
+ * Provisioning step report.
+ */
+struct ProvisioningStep {
+    /**
+     * Step type.
+     */
+    ProvisioningStepType mType = ProvisioningStepType::eClear;
+
+    /**
+     * Storage name for storage steps, certificate type otherwise.
+     */
+    std::string mTarget;
+
+    /**
+     * Step error, eWrongState if the step was not run because a step it depends on failed.
+     */
+    Error mError = Error::eNone;
+
+    /**
+     * Step start relative to the provisioning start.
+     */
+    std::chrono::microseconds mStart {0};
+
+    /**
+     * Step duration.
+     */
+    std::chrono::microseconds mDuration {0};
+};
+
+/**
+ * Node provisioning result.
+ */
+struct ProvisioningResult {
+    /**
+     * Created keys and requests in the order of configured certificate types.
+     */
+    std::vector<CSRResult> mCSRs;
+
+    /**
+     * Steps in the order of start.
+     */
+    std::vector<ProvisioningStep> mSteps;
+
+    /**
+     * Total provisioning duration.
+     */
+    std::chrono::microseconds mDuration {0};
+};
+
+/**
+ * Provisions node: clears and initializes key storages, removes certificates of the certificate types, creates keys
+ * and certificate signing requests. Steps run as a dependency graph rather than a sequence: storages are cleared and
+ * initialized in parallel, key generation of a type waits only for its own storage, and requests of a type are signed
+ * as soon as its key is ready. A failed step fails only the steps that depend on it.
+ *
+ * Certificate types not registered yet are registered with their storages. Key pools of a storage are suspended and
+ * drained before it is cleared and refilled once it is initialized. Certificate storage must be set.
+ *
+ * @param handler certificate handler.
+ * @param config provisioning configuration.
+ * @param[out] result created requests and step reports.
+ * @return Error eFailed if any step failed, see step reports and per type errors in results.
+ */
+Error Provision(CertHandler& handler, const ProvisioningConfig& config, ProvisioningResult& result);
+
+/** @}*/
+
+} // namespace certhandler
+} // namespace iam
+} // namespace aos
+
+#endif
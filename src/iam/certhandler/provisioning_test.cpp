@@ -0,0 +1,381 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "encoding/pem.hpp"
+#include "provisioning.hpp"
+#include "swkeystorage.hpp"
+#include "testcerts.hpp"
+
+using namespace aos;
+using namespace aos::iam::certhandler;
+using namespace aos::iam::certhandler::test;
+
+/***********************************************************************************************************************
+ * Mocks
+ **********************************************************************************************************************/
+
+class TestProvisioner : public StorageProvisionerItf {
+public:
+    explicit TestProvisioner(std::chrono::milliseconds delay = std::chrono::milliseconds(0))
+        : mDelay(delay)
+    {
+    }
+
+    Error Clear() override
+    {
+        std::this_thread::sleep_for(mDelay);
+
+        mNumClears++;
+
+        return mClearError;
+    }
+
+    Error Init(const std::string& password) override
+    {
+        std::this_thread::sleep_for(mDelay);
+
+        mPassword = password;
+
+        return mInitError;
+    }
+
+    std::chrono::milliseconds mDelay;
+    Error                     mClearError = Error::eNone;
+    Error                     mInitError  = Error::eNone;
+    std::atomic_size_t        mNumClears {0};
+    std::string               mPassword;
+};
+
+// Storage invalidating its keys on clear.
+class ClearableKeyStorage : public KeyStorageItf, public StorageProvisionerItf {
+public:
+    Error CreateKey(KeyAlgorithm algorithm, std::shared_ptr<PrivateKeyItf>& key) override
+    {
+        mNumRunning++;
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+        auto err = mStorage.CreateKey(algorithm, key);
+        if (err == Error::eNone) {
+            std::lock_guard<std::mutex> lock(mMutex);
+
+            mGenerations[key.get()] = mGeneration;
+            mNumKeys++;
+        }
+
+        mNumRunning--;
+
+        return err;
+    }
+
+    Error DeleteKey(const std::shared_ptr<PrivateKeyItf>& key) override
+    {
+        mNumDeletedKeys++;
+
+        return mStorage.DeleteKey(key);
+    }
+
+    size_t GetMaxConcurrency() const override { return 1; }
+
+    Error Clear() override
+    {
+        if (mNumRunning != 0) {
+            mClearedWhileBusy = true;
+        }
+
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        mGeneration++;
+
+        return Error::eNone;
+    }
+
+    Error Init(const std::string&) override { return Error::eNone; }
+
+    bool IsValid(const std::shared_ptr<PrivateKeyItf>& key)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        auto it = mGenerations.find(key.get());
+
+        return it != mGenerations.end() && it->second == mGeneration;
+    }
+
+    SWKeyStorage                        mStorage;
+    std::mutex                          mMutex;
+    std::map<const PrivateKeyItf*, int> mGenerations;
+    int                                 mGeneration = 0;
+    std::atomic_size_t                  mNumRunning {0};
+    std::atomic_size_t                  mNumKeys {0};
+    std::atomic_size_t                  mNumDeletedKeys {0};
+    std::atomic_bool                    mClearedWhileBusy {false};
+};
+
+/***********************************************************************************************************************
+ * Utils
+ **********************************************************************************************************************/
+
+static const ProvisioningStep* FindStep(
+    const ProvisioningResult& result, ProvisioningStepType type, const std::string& target)
+{
+    for (const auto& step : result.mSteps) {
+        if (step.mType == type && step.mTarget == target) {
+            return &step;
+        }
+    }
+
+    return nullptr;
+}
+
+template <typename T>
+static bool WaitFor(T condition, std::chrono::milliseconds timeout = std::chrono::seconds(5))
+{
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    return true;
+}
+
+static std::chrono::microseconds GetEnd(const ProvisioningStep& step)
+{
+    return step.mStart + step.mDuration;
+}
+
+/***********************************************************************************************************************
+ * Tests
+ **********************************************************************************************************************/
+
+TEST(provisioning, Provision)
+{
+    TempDir         dir;
+    CertStorage     certStorage;
+    CertHandler     handler;
+    SWKeyStorage    tpmStorage, hsmStorage;
+    TestProvisioner tpm(std::chrono::milliseconds(50)), hsm(std::chrono::milliseconds(50));
+    CertInfo        info;
+
+    ASSERT_EQ(certStorage.Init(dir.GetPath()), Error::eNone);
+
+    handler.SetCertStorage(certStorage);
+
+    // Certificate left by previous provisioning.
+    auto oldKey = GenerateTestKey();
+
+    ASSERT_EQ(handler.RegisterCertType("online", tpmStorage), Error::eNone);
+    ASSERT_EQ(handler.ApplyCert("online", ConvertToPEM(CreateTestCert({}, oldKey.get())), info), Error::eNone);
+
+    ProvisioningConfig config;
+    ProvisioningResult result;
+
+    config.mStorages      = {{"tpm", &tpmStorage, &tpm}, {"hsm", &hsmStorage, &hsm}};
+    config.mCertTypes     = {{"online", &tpmStorage, KeyAlgorithm::eECDSAP256, {"online", {}}},
+        {"offline", &tpmStorage, KeyAlgorithm::eECDSAP384, {"offline", {}}},
+        {"iam", &hsmStorage, KeyAlgorithm::eECDSAP256, {"iam", {"iam.local"}}}};
+    config.mOwnerPassword = "owner";
+
+    ASSERT_EQ(Provision(handler, config, result), Error::eNone);
+
+    EXPECT_EQ(tpm.mNumClears, 1u);
+    EXPECT_EQ(hsm.mPassword, "owner");
+    EXPECT_EQ(handler.GetCertificate("online", {}, {}, info), Error::eNotFound);
+    EXPECT_EQ(result.mSteps.size(), 2 * config.mStorages.size() + 3 * config.mCertTypes.size());
+    EXPECT_GT(result.mDuration.count(), 0);
+
+    ASSERT_EQ(result.mCSRs.size(), config.mCertTypes.size());
+
+    for (size_t i = 0; i < config.mCertTypes.size(); i++) {
+        const auto&          certType = config.mCertTypes[i];
+        const auto&          csr      = result.mCSRs[i];
+        std::vector<uint8_t> der;
+
+        EXPECT_EQ(csr.mCertType, certType.mCertType);
+        EXPECT_EQ(csr.mError, Error::eNone);
+        ASSERT_NE(csr.mKey, nullptr);
+        EXPECT_EQ(csr.mKey->GetAlgorithm(), certType.mAlgorithm);
+        EXPECT_EQ(pem::Decode(csr.mCSR, pem::cCertificateRequest, der), Error::eNone);
+
+        // Steps of the type wait for its storage and for each other.
+        auto storageName = certType.mStorage == &tpmStorage ? "tpm" : "hsm";
+        auto init        = FindStep(result, ProvisioningStepType::eInit, storageName);
+        auto clear       = FindStep(result, ProvisioningStepType::eClear, certType.mCertType);
+        auto keygen      = FindStep(result, ProvisioningStepType::eKeygen, certType.mCertType);
+        auto request     = FindStep(result, ProvisioningStepType::eCSR, certType.mCertType);
+
+        ASSERT_TRUE(init && clear && keygen && request);
+        EXPECT_GE(keygen->mStart, GetEnd(*init));
+        EXPECT_GE(keygen->mStart, GetEnd(*clear));
+        EXPECT_GE(request->mStart, GetEnd(*keygen));
+    }
+
+    // Storages are cleared and initialized in parallel.
+    auto tpmInit = FindStep(result, ProvisioningStepType::eInit, "tpm");
+    auto hsmInit = FindStep(result, ProvisioningStepType::eInit, "hsm");
+
+    ASSERT_TRUE(tpmInit && hsmInit);
+    EXPECT_LT(hsmInit->mStart, GetEnd(*tpmInit));
+    EXPECT_LT(tpmInit->mStart, GetEnd(*hsmInit));
+
+    // Provisioned keys are used for TLS credentials of issued certificates.
+    std::vector<uint8_t> publicKey;
+
+    ASSERT_EQ(result.mCSRs[0].mKey->GetPublicKey(publicKey), Error::eNone);
+
+    auto       data = static_cast<const uint8_t*>(publicKey.data());
+    TestKeyPtr key(d2i_PUBKEY(nullptr, &data, static_cast<long>(publicKey.size())), EVP_PKEY_free);
+    auto       caKey = GenerateTestKey();
+    auto       cert  = ConvertToPEM(CreateTestCert({}, key.get(), caKey.get()));
+
+    std::shared_ptr<const TLSCredentials> credentials;
+
+    ASSERT_EQ(handler.ApplyCert("online", cert, info), Error::eNone);
+    ASSERT_EQ(handler.GetTLSCredentials("online", credentials), Error::eNone);
+    EXPECT_EQ(credentials->mKey, result.mCSRs[0].mKey);
+
+    // Removing certificates drops credentials.
+    EXPECT_EQ(handler.RemoveCerts("online"), Error::eNone);
+    EXPECT_EQ(handler.GetCertificate("online", {}, {}, info), Error::eNotFound);
+    EXPECT_EQ(handler.GetTLSCredentials("online", credentials), Error::eNotFound);
+}
+
+TEST(provisioning, FailedStep)
+{
+    TempDir         dir;
+    CertStorage     certStorage;
+    CertHandler     handler;
+    SWKeyStorage    tpmStorage, hsmStorage;
+    TestProvisioner tpm, hsm;
+
+    ASSERT_EQ(certStorage.Init(dir.GetPath()), Error::eNone);
+
+    handler.SetCertStorage(certStorage);
+
+    hsm.mInitError = Error::eFailed;
+
+    ProvisioningConfig config;
+    ProvisioningResult result;
+
+    config.mStorages  = {{"tpm", &tpmStorage, &tpm}, {"hsm", &hsmStorage, &hsm}};
+    config.mCertTypes = {{"online", &tpmStorage, KeyAlgorithm::eECDSAP256, {"online", {}}},
+        {"iam", &hsmStorage, KeyAlgorithm::eECDSAP256, {"iam", {}}}};
+
+    ASSERT_EQ(Provision(handler, config, result), Error::eFailed);
+
+    // Only steps depending on the failed one are not run.
+    ASSERT_EQ(result.mCSRs.size(), 2u);
+    EXPECT_EQ(result.mCSRs[0].mError, Error::eNone);
+    EXPECT_FALSE(result.mCSRs[0].mCSR.empty());
+    EXPECT_EQ(result.mCSRs[1].mError, Error::eWrongState);
+    EXPECT_EQ(result.mCSRs[1].mKey, nullptr);
+    EXPECT_TRUE(result.mCSRs[1].mCSR.empty());
+
+    auto init    = FindStep(result, ProvisioningStepType::eInit, "hsm");
+    auto clear   = FindStep(result, ProvisioningStepType::eClear, "iam");
+    auto keygen  = FindStep(result, ProvisioningStepType::eKeygen, "iam");
+    auto request = FindStep(result, ProvisioningStepType::eCSR, "iam");
+
+    ASSERT_TRUE(init && clear && keygen && request);
+    EXPECT_EQ(init->mError, Error::eFailed);
+    EXPECT_EQ(clear->mError, Error::eNone);
+    EXPECT_EQ(keygen->mError, Error::eWrongState);
+    EXPECT_EQ(request->mError, Error::eWrongState);
+}
+
+TEST(provisioning, KeyPool)
+{
+    TempDir             dir;
+    CertStorage         certStorage;
+    ClearableKeyStorage storage;
+    CertHandler         handler;
+    KeyPoolConfig       poolConfig;
+
+    ASSERT_EQ(certStorage.Init(dir.GetPath()), Error::eNone);
+
+    handler.SetCertStorage(certStorage);
+
+    poolConfig.mSize       = 2;
+    poolConfig.mIdleRefill = false;
+
+    ASSERT_EQ(handler.RegisterCertType("online", storage), Error::eNone);
+    ASSERT_EQ(handler.ConfigureKeyPool(storage, KeyAlgorithm::eECDSAP256, poolConfig), Error::eNone);
+    ASSERT_TRUE(WaitFor([&] { return storage.mNumKeys == 2; }));
+
+    // Taking a key starts refill, provisioning clears the storage while it runs.
+    std::shared_ptr<PrivateKeyItf> key;
+
+    ASSERT_EQ(handler.CreateKey("online", KeyAlgorithm::eECDSAP256, key), Error::eNone);
+    ASSERT_TRUE(WaitFor([&] { return storage.mNumRunning == 1; }));
+
+    ProvisioningConfig config;
+    ProvisioningResult result;
+
+    config.mStorages  = {{"tpm", &storage, &storage}};
+    config.mCertTypes = {{"online", &storage, KeyAlgorithm::eECDSAP256, {"online", {}}}};
+
+    ASSERT_EQ(Provision(handler, config, result), Error::eNone);
+    ASSERT_EQ(result.mCSRs.size(), 1u);
+
+    // Keys pooled before clearing are disposed, provisioned key is created on the cleared storage.
+    EXPECT_FALSE(storage.mClearedWhileBusy);
+    EXPECT_FALSE(storage.IsValid(key));
+    EXPECT_TRUE(storage.IsValid(result.mCSRs[0].mKey));
+    EXPECT_GE(storage.mNumDeletedKeys, 2u);
+
+    // Pool is refilled after initialization.
+    ASSERT_TRUE(WaitFor([&] { return storage.mNumKeys >= 5; }));
+    ASSERT_EQ(handler.CreateKey("online", KeyAlgorithm::eECDSAP256, key), Error::eNone);
+    EXPECT_TRUE(storage.IsValid(key));
+}
+
+TEST(provisioning, InvalidConfig)
+{
+    CertHandler        handler;
+    SWKeyStorage       storage, otherStorage;
+    ProvisioningConfig config;
+    ProvisioningResult result;
+
+    config.mStorages  = {{"sw", &storage, nullptr}};
+    config.mCertTypes = {{"online", &otherStorage, KeyAlgorithm::eECDSAP256, {"online", {}}}};
+
+    EXPECT_EQ(Provision(handler, config, result), Error::eInvalidArgument);
+
+    config.mStorages = {{"sw", nullptr, nullptr}};
+
+    EXPECT_EQ(Provision(handler, config, result), Error::eInvalidArgument);
+
+    // Certificate types removal requires certificate storage.
+    config.mStorages  = {{"sw", &storage, nullptr}};
+    config.mCertTypes = {{"online", &storage, KeyAlgorithm::eECDSAP256, {"online", {}}}};
+
+    EXPECT_EQ(Provision(handler, config, result), Error::eFailed);
+    ASSERT_EQ(result.mCSRs.size(), 1u);
+    EXPECT_EQ(result.mCSRs[0].mError, Error::eWrongState);
+}
@@ -0,0 +1,232 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <algorithm>
+
+#include "renewalscheduler.hpp"
+
+namespace aos {
+namespace iam {
+namespace certhandler {
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+namespace {
+
+// Max number of outdated heap deadlines relative to the number of scheduled certificates before the heap is rebuilt.
+constexpr size_t cMaxOutdatedFactor = 2;
+
+// Clock time point has limited range: certificates valid until 9999 year are clamped.
+RenewalScheduler::Clock::time_point ToTimePoint(time_t time)
+{
+    using Clock = RenewalScheduler::Clock;
+
+    static const auto sMaxTime = Clock::to_time_t(Clock::time_point::max()) - 365 * 24 * 3600;
+
+    return Clock::from_time_t(std::min(time, sMaxTime));
+}
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Public
+ **********************************************************************************************************************/
+
+RenewalScheduler::~RenewalScheduler()
+{
+    Stop();
+}
+
+Error RenewalScheduler::Start(const RenewalConfig& config, RenewalCallback callback)
+{
+    if (!callback) {
+        return Error::eInvalidArgument;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    if (mStarted) {
+        return Error::eWrongState;
+    }
+
+    mConfig   = config;
+    mCallback = std::move(callback);
+    mStarted  = true;
+    mStop     = false;
+    mThread   = std::thread(&RenewalScheduler::Run, this);
+
+    return Error::eNone;
+}
+
+void RenewalScheduler::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        if (!mStarted) {
+            return;
+        }
+
+        mStop = true;
+    }
+
+    mCondVar.notify_all();
+    mThread.join();
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    mStarted = false;
+    mEntries.clear();
+    mDeadlines = DeadlineHeap();
+    mCallback  = nullptr;
+}
+
+Error RenewalScheduler::Schedule(const std::string& certType, const CertInfo& info)
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        if (!mStarted) {
+            return Error::eWrongState;
+        }
+
+        auto& entry = mEntries[certType];
+
+        entry.mInfo = info;
+
+        Push(certType, entry, GetRenewalTime(info));
+    }
+
+    mCondVar.notify_all();
+
+    return Error::eNone;
+}
+
+Error RenewalScheduler::Cancel(const std::string& certType)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    // Heap deadline becomes outdated and is skipped by the scheduler thread.
+    if (mEntries.erase(certType) == 0) {
+        return Error::eNotFound;
+    }
+
+    return Error::eNone;
+}
+
+Error RenewalScheduler::GetRenewalTime(const std::string& certType, Clock::time_point& renewalTime) const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    auto it = mEntries.find(certType);
+    if (it == mEntries.end()) {
+        return Error::eNotFound;
+    }
+
+    renewalTime = it->second.mTime;
+
+    return Error::eNone;
+}
+
+/***********************************************************************************************************************
+ * Private
+ **********************************************************************************************************************/
+
+RenewalScheduler::Clock::time_point RenewalScheduler::GetRenewalTime(const CertInfo& info)
+{
+    auto notAfter = ToTimePoint(info.mNotAfter);
+    auto lifetime = std::chrono::duration_cast<std::chrono::milliseconds>(
+        notAfter - ToTimePoint(std::min(info.mNotBefore, info.mNotAfter)));
+
+    // Short lived certificates are renewed after two thirds of their lifetime.
+    auto leadTime = std::min<std::chrono::milliseconds>(mConfig.mLeadTime, lifetime / 3);
+    auto jitter   = std::min<std::chrono::milliseconds>(mConfig.mJitter, leadTime);
+
+    std::uniform_int_distribution<int64_t> distribution(0, jitter.count());
+
+    return notAfter - leadTime - std::chrono::milliseconds(distribution(mRandom));
+}
+
+void RenewalScheduler::Push(const std::string& certType, Entry& entry, Clock::time_point time)
+{
+    entry.mTime    = time;
+    entry.mVersion = ++mVersion;
+
+    if (mDeadlines.size() >= (mEntries.size() + 1) * cMaxOutdatedFactor) {
+        std::vector<Deadline> deadlines;
+
+        deadlines.reserve(mEntries.size());
+
+        for (const auto& it : mEntries) {
+            if (it.first != certType) {
+                deadlines.push_back({it.second.mTime, it.first, it.second.mVersion});
+            }
+        }
+
+        mDeadlines = DeadlineHeap(std::greater<Deadline>(), std::move(deadlines));
+    }
+
+    mDeadlines.push({time, certType, entry.mVersion});
+}
+
+void RenewalScheduler::Run()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    while (!mStop) {
+        if (mDeadlines.empty()) {
+            mCondVar.wait(lock);
+
+            continue;
+        }
+
+        auto deadline = mDeadlines.top();
+
+        auto it = mEntries.find(deadline.mCertType);
+        if (it == mEntries.end() || it->second.mVersion != deadline.mVersion) {
+            mDeadlines.pop();
+
+            continue;
+        }
+
+        auto now = Clock::now();
+
+        if (deadline.mTime > now) {
+            mCondVar.wait_until(lock, deadline.mTime);
+
+            continue;
+        }
+
+        mDeadlines.pop();
+
+        // Retry until a new certificate of the type is scheduled.
+        auto info = it->second.mInfo;
+
+        Push(deadline.mCertType, it->second, now + mConfig.mRetryInterval);
+
+        lock.unlock();
+        mCallback(deadline.mCertType, info);
+        lock.lock();
+    }
+}
+
+} // namespace certhandler
+} // namespace iam
+} // namespace aos
@@ -0,0 +1,167 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RENEWALSCHEDULER_HPP_
+#define RENEWALSCHEDULER_HPP_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "certstorage.hpp"
+#include "error/error.hpp"
+
+namespace aos {
+namespace iam {
+namespace certhandler {
+
+/** @addtogroup iam Identification and Access Manager
+ *  @{
+ */
+
+/**
+ * Certificate renewal configuration.
+ */
+struct RenewalConfig {
+    /**
+     * Renewal starts this time before certificate expiration. Limited to one third of the certificate lifetime.
+     */
+    std::chrono::seconds mLeadTime {std::chrono::hours(24 * 7)};
+
+    /**
+     * Max random time by which renewal is moved earlier, spreads renewal of certificates issued at the same time.
+     * Limited to the lead time.
+     */
+    std::chrono::seconds mJitter {std::chrono::hours(12)};
+
+    /**
+     * Renewal callback is called again after this interval until a new certificate of the type is scheduled.
+     */
+    std::chrono::milliseconds mRetryInterval {std::chrono::minutes(10)};
+};
+
+/**
+ * Calls renewal callback when certificates are due for renewal. Renewal deadlines are kept in a min-heap, so only the
+ * earliest deadline is waited for. Each certificate type has a single scheduled certificate.
+ */
+class RenewalScheduler {
+public:
+    /**
+     * Renewal callback. Called from scheduler thread, must not call Stop().
+     */
+    using RenewalCallback = std::function<void(const std::string& certType, const CertInfo& info)>;
+
+    /**
+     * Clock used for renewal deadlines.
+     */
+    using Clock = std::chrono::system_clock;
+
+    /**
+     * Destroys scheduler. Stops scheduler thread.
+     */
+    ~RenewalScheduler();
+
+    /**
+     * Starts scheduler thread.
+     *
+     * @param config renewal configuration.
+     * @param callback renewal callback.
+     * @return Error.
+     */
+    Error Start(const RenewalConfig& config, RenewalCallback callback);
+
+    /**
+     * Stops scheduler thread and clears scheduled certificates. Waits for running renewal callback.
+     */
+    void Stop();
+
+    /**
+     * Schedules certificate renewal. Replaces previously scheduled certificate of the same type.
+     *
+     * @param certType certificate type.
+     * @param info certificate info.
+     * @return Error eWrongState if scheduler is not started.
+     */
+    Error Schedule(const std::string& certType, const CertInfo& info);
+
+    /**
+     * Cancels renewal of the certificate type.
+     *
+     * @param certType certificate type.
+     * @return Error.
+     */
+    Error Cancel(const std::string& certType);
+
+    /**
+     * Returns renewal time of the certificate type.
+     *
+     * @param certType certificate type.
+     * @param[out] renewalTime renewal time.
+     * @return Error.
+     */
+    Error GetRenewalTime(const std::string& certType, Clock::time_point& renewalTime) const;
+
+private:
+    struct Deadline {
+        Clock::time_point mTime;
+        std::string       mCertType;
+        uint64_t          mVersion;
+
+        bool operator>(const Deadline& other) const { return mTime > other.mTime; }
+    };
+
+    struct Entry {
+        CertInfo          mInfo;
+        Clock::time_point mTime;
+        uint64_t          mVersion;
+    };
+
+    using DeadlineHeap = std::priority_queue<Deadline, std::vector<Deadline>, std::greater<Deadline>>;
+
+    Clock::time_point GetRenewalTime(const CertInfo& info);
+    void              Push(const std::string& certType, Entry& entry, Clock::time_point time);
+    void              Run();
+
+    mutable std::mutex           mMutex;
+    std::condition_variable      mCondVar;
+    std::thread                  mThread;
+    bool                         mStarted = false;
+    bool                         mStop    = false;
+    RenewalConfig                mConfig;
+    RenewalCallback              mCallback;
+    std::map<std::string, Entry> mEntries;
+    DeadlineHeap                 mDeadlines;
+    uint64_t                     mVersion = 0;
+    std::mt19937_64              mRandom {std::random_device()()};
+};
+
+/** @}*/
+
+} // namespace certhandler
+} // namespace iam
+} // namespace aos
+
+#endif
@@ -0,0 +1,181 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <atomic>
+#include <set>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "renewalscheduler.hpp"
+
+using namespace aos;
+using namespace aos::iam::certhandler;
+
+/***********************************************************************************************************************
+ * Utils
+ **********************************************************************************************************************/
+
+static CertInfo CreateCertInfo(time_t notBefore, time_t notAfter)
+{
+    CertInfo info;
+
+    info.mCertType  = "online";
+    info.mNotBefore = notBefore;
+    info.mNotAfter  = notAfter;
+
+    return info;
+}
+
+static bool WaitFor(std::function<bool()> condition)
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    return true;
+}
+
+/***********************************************************************************************************************
+ * Tests
+ **********************************************************************************************************************/
+
+TEST(renewalscheduler, RenewalTime)
+{
+    constexpr time_t cDay = 24 * 3600;
+
+    RenewalScheduler scheduler;
+    RenewalConfig    config;
+
+    config.mLeadTime = std::chrono::hours(24 * 10);
+    config.mJitter   = std::chrono::hours(1);
+
+    auto now  = time(nullptr);
+    auto info = CreateCertInfo(now - cDay, now + 365 * cDay);
+
+    EXPECT_EQ(scheduler.Schedule("online", info), Error::eWrongState);
+    EXPECT_EQ(scheduler.Start(config, nullptr), Error::eInvalidArgument);
+    ASSERT_EQ(scheduler.Start(config, [](const std::string&, const CertInfo&) {}), Error::eNone);
+    EXPECT_EQ(scheduler.Start(config, [](const std::string&, const CertInfo&) {}), Error::eWrongState);
+
+    RenewalScheduler::Clock::time_point renewalTime;
+
+    ASSERT_EQ(scheduler.Schedule("online", info), Error::eNone);
+    ASSERT_EQ(scheduler.GetRenewalTime("online", renewalTime), Error::eNone);
+
+    auto notAfter = RenewalScheduler::Clock::from_time_t(info.mNotAfter);
+
+    EXPECT_LE(renewalTime, notAfter - config.mLeadTime);
+    EXPECT_GE(renewalTime, notAfter - config.mLeadTime - config.mJitter);
+
+    // Lead time of short lived certificate is limited to one third of its lifetime.
+    info = CreateCertInfo(now, now + 3 * 3600);
+
+    ASSERT_EQ(scheduler.Schedule("offline", info), Error::eNone);
+    ASSERT_EQ(scheduler.GetRenewalTime("offline", renewalTime), Error::eNone);
+
+    notAfter = RenewalScheduler::Clock::from_time_t(info.mNotAfter);
+
+    EXPECT_LE(renewalTime, notAfter - std::chrono::hours(1));
+    EXPECT_GE(renewalTime, notAfter - std::chrono::hours(2));
+
+    // Certificates without well defined expiration.
+    ASSERT_EQ(scheduler.Schedule("iam", CreateCertInfo(now, 253402300799)), Error::eNone);
+    ASSERT_EQ(scheduler.GetRenewalTime("iam", renewalTime), Error::eNone);
+    EXPECT_GT(renewalTime, RenewalScheduler::Clock::now() + std::chrono::hours(24 * 365 * 100));
+
+    EXPECT_EQ(scheduler.Cancel("online"), Error::eNone);
+    EXPECT_EQ(scheduler.Cancel("online"), Error::eNotFound);
+    EXPECT_EQ(scheduler.GetRenewalTime("online", renewalTime), Error::eNotFound);
+}
+
+TEST(renewalscheduler, Spread)
+{
+    constexpr size_t cNumCerts = 100;
+
+    RenewalScheduler scheduler;
+
+    ASSERT_EQ(scheduler.Start(RenewalConfig(), [](const std::string&, const CertInfo&) {}), Error::eNone);
+
+    auto             now  = time(nullptr);
+    auto             info = CreateCertInfo(now, now + 365 * 24 * 3600);
+    std::set<time_t> renewalSeconds;
+
+    // Certificates issued at the same time are renewed at different times.
+    for (size_t i = 0; i < cNumCerts; i++) {
+        RenewalScheduler::Clock::time_point renewalTime;
+
+        ASSERT_EQ(scheduler.Schedule(std::to_string(i), info), Error::eNone);
+        ASSERT_EQ(scheduler.GetRenewalTime(std::to_string(i), renewalTime), Error::eNone);
+
+        renewalSeconds.insert(RenewalScheduler::Clock::to_time_t(renewalTime));
+    }
+
+    EXPECT_GT(renewalSeconds.size(), cNumCerts * 9 / 10);
+}
+
+TEST(renewalscheduler, Callback)
+{
+    RenewalScheduler   scheduler;
+    RenewalConfig      config;
+    std::atomic_size_t onlineCalls {0}, offlineCalls {0};
+
+    config.mLeadTime      = std::chrono::hours(24 * 2);
+    config.mJitter        = std::chrono::seconds(0);
+    config.mRetryInterval = std::chrono::milliseconds(20);
+
+    ASSERT_EQ(scheduler.Start(config,
+                  [&](const std::string& certType, const CertInfo&) {
+                      if (certType == "online") {
+                          onlineCalls++;
+                      } else {
+                          offlineCalls++;
+                      }
+                  }),
+        Error::eNone);
+
+    auto now = time(nullptr);
+
+    // Due for renewal: expires in one day.
+    ASSERT_EQ(scheduler.Schedule("online", CreateCertInfo(now - 10 * 24 * 3600, now + 24 * 3600)), Error::eNone);
+    ASSERT_EQ(scheduler.Schedule("offline", CreateCertInfo(now, now + 365 * 24 * 3600)), Error::eNone);
+
+    // Renewal is retried until a new certificate is scheduled.
+    EXPECT_TRUE(WaitFor([&]() { return onlineCalls >= 2; }));
+
+    ASSERT_EQ(scheduler.Schedule("online", CreateCertInfo(now, now + 365 * 24 * 3600)), Error::eNone);
+
+    auto calls = onlineCalls.load();
+
+    std::this_thread::sleep_for(config.mRetryInterval * 5);
+
+    EXPECT_LE(onlineCalls, calls + 1);
+    EXPECT_EQ(offlineCalls, 0);
+
+    scheduler.Stop();
+
+    RenewalScheduler::Clock::time_point renewalTime;
+
+    EXPECT_EQ(scheduler.GetRenewalTime("offline", renewalTime), Error::eNotFound);
+}
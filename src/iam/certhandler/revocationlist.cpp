@@ -0,0 +1,324 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <algorithm>
+#include <cstring>
+
+#include "asn1time.hpp"
+#include "revocationlist.hpp"
+#include "x509parser.hpp"
+
+namespace aos {
+namespace iam {
+namespace certhandler {
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+constexpr size_t RevocationList::cBitsPerEntry;
+constexpr size_t RevocationList::cNumHashes;
+
+namespace {
+
+constexpr size_t cMinFilterBits = 64;
+
+// FNV-1a followed by a 64-bit finalizer: serials of the same CA often differ in a few bytes only.
+uint64_t Hash(const uint8_t* data, size_t size)
+{
+    uint64_t hash = 0xcbf29ce484222325;
+
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ data[i]) * 0x100000001b3;
+    }
+
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccd;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53;
+    hash ^= hash >> 33;
+
+    return hash;
+}
+
+// Serial numbers are ordered by size first, which is numeric order for integers without leading zeros.
+int CompareSerials(const uint8_t* lhs, size_t lhsSize, const uint8_t* rhs, size_t rhsSize)
+{
+    if (lhsSize != rhsSize) {
+        return lhsSize < rhsSize ? -1 : 1;
+    }
+
+    return lhsSize == 0 ? 0 : memcmp(lhs, rhs, lhsSize);
+}
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Public
+ **********************************************************************************************************************/
+
+Error RevocationList::Create(const std::vector<uint8_t>& der, std::shared_ptr<const RevocationList>& list)
+{
+    const uint8_t* data = der.data();
+
+    std::shared_ptr<X509_CRL> crl(d2i_X509_CRL(nullptr, &data, static_cast<long>(der.size())), X509_CRL_free);
+    if (!crl) {
+        return Error::eInvalidArgument;
+    }
+
+    std::shared_ptr<RevocationList> result(new RevocationList());
+
+    result->mCRL = crl;
+
+    unsigned char* issuer     = nullptr;
+    int            issuerSize = i2d_X509_NAME(X509_CRL_get_issuer(crl.get()), &issuer);
+
+    if (issuerSize <= 0) {
+        return Error::eInvalidArgument;
+    }
+
+    result->mIssuer.assign(issuer, issuer + issuerSize);
+    OPENSSL_free(issuer);
+
+    auto err = ConvertTime(X509_CRL_get0_lastUpdate(crl.get()), result->mThisUpdate);
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    if (X509_CRL_get0_nextUpdate(crl.get())) {
+        err = ConvertTime(X509_CRL_get0_nextUpdate(crl.get()), result->mNextUpdate);
+        if (err != Error::eNone) {
+            return err;
+        }
+    }
+
+    int  critical = 0;
+    auto number   = static_cast<ASN1_INTEGER*>(X509_CRL_get_ext_d2i(crl.get(), NID_crl_number, &critical, nullptr));
+
+    if (number) {
+        err = ConvertSerial(number, result->mNumber);
+        ASN1_INTEGER_free(number);
+
+        if (err != Error::eNone) {
+            return err;
+        }
+    } else if (critical != -1) {
+        // Malformed or repeated CRL number extension.
+        return Error::eInvalidArgument;
+    }
+
+    auto revoked    = X509_CRL_get_REVOKED(crl.get());
+    int  numRevoked = revoked ? sk_X509_REVOKED_num(revoked) : 0;
+
+    std::vector<std::vector<uint8_t>> serials(numRevoked);
+
+    for (int i = 0; i < numRevoked; i++) {
+        auto err = ConvertSerial(X509_REVOKED_get0_serialNumber(sk_X509_REVOKED_value(revoked, i)), serials[i]);
+        if (err != Error::eNone) {
+            return err;
+        }
+    }
+
+    std::sort(serials.begin(), serials.end(), [](const std::vector<uint8_t>& lhs, const std::vector<uint8_t>& rhs) {
+        return CompareSerials(lhs.data(), lhs.size(), rhs.data(), rhs.size()) < 0;
+    });
+    serials.erase(std::unique(serials.begin(), serials.end()), serials.end());
+
+    result->mOffsets.reserve(serials.size() + 1);
+    result->mOffsets.push_back(0);
+
+    for (const auto& serial : serials) {
+        result->mSerials.insert(result->mSerials.end(), serial.begin(), serial.end());
+        result->mOffsets.push_back(static_cast<uint32_t>(result->mSerials.size()));
+    }
+
+    result->BuildFilter();
+
+    list = std::move(result);
+
+    return Error::eNone;
+}
+
+Error RevocationList::ConvertSerial(const ASN1_INTEGER* integer, std::vector<uint8_t>& serial)
+{
+    int size = i2d_ASN1_INTEGER(integer, nullptr);
+    if (size <= 0) {
+        return Error::eInvalidArgument;
+    }
+
+    std::vector<uint8_t> der(size);
+    auto                 data = der.data();
+
+    i2d_ASN1_INTEGER(integer, &data);
+
+    DERReader reader(DERView(der.data(), der.size()));
+    DERView   value;
+
+    if (reader.Expect(dertag::cInteger, value) != Error::eNone) {
+        return Error::eInvalidArgument;
+    }
+
+    while (!value.IsEmpty() && value.mData[0] == 0) {
+        value.mData++;
+        value.mSize--;
+    }
+
+    serial = value.ToVector();
+
+    return Error::eNone;
+}
+
+bool RevocationList::IsNewerThan(const RevocationList& other) const
+{
+    if (!mNumber.empty() && !other.mNumber.empty()) {
+        return CompareSerials(mNumber.data(), mNumber.size(), other.mNumber.data(), other.mNumber.size()) > 0;
+    }
+
+    return mThisUpdate > other.mThisUpdate;
+}
+
+bool RevocationList::IsRevoked(const uint8_t* serial, size_t size) const
+{
+    if (!MayBeRevoked(serial, size)) {
+        return false;
+    }
+
+    size_t low = 0, high = GetSize();
+
+    while (low < high) {
+        auto           middle = low + (high - low) / 2;
+        const uint8_t* value  = nullptr;
+        auto           length = GetSerial(middle, value);
+
+        auto result = CompareSerials(value, length, serial, size);
+        if (result == 0) {
+            return true;
+        }
+
+        if (result < 0) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    return false;
+}
+
+bool RevocationList::MayBeRevoked(const uint8_t* serial, size_t size) const
+{
+    auto hash  = Hash(serial, size);
+    auto hash1 = hash & 0xffffffff;
+    auto hash2 = (hash >> 32) | 1;
+
+    for (size_t i = 0; i < cNumHashes; i++) {
+        auto bit = (hash1 + i * hash2) & mFilterMask;
+
+        if (!(mFilter[bit / 64] & (uint64_t(1) << (bit % 64)))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+Error RevocationList::VerifySignature(EVP_PKEY* issuerKey) const
+{
+    unsigned char* data = nullptr;
+    int            size = i2d_PUBKEY(issuerKey, &data);
+
+    if (size <= 0) {
+        return Error::eInvalidArgument;
+    }
+
+    auto key = std::make_shared<const std::vector<uint8_t>>(data, data + size);
+
+    OPENSSL_free(data);
+
+    auto verifiedKey = std::atomic_load(&mVerifiedKey);
+    if (verifiedKey && *verifiedKey == *key) {
+        return Error::eNone;
+    }
+
+    if (X509_CRL_verify(mCRL.get(), issuerKey) != 1) {
+        return Error::eFailed;
+    }
+
+    std::atomic_store(&mVerifiedKey, key);
+
+    return Error::eNone;
+}
+
+Error RevocationList::VerifySignature(const RevocationList& other) const
+{
+    auto verifiedKey = std::atomic_load(&other.mVerifiedKey);
+    if (!verifiedKey) {
+        return Error::eNotFound;
+    }
+
+    const uint8_t* data = verifiedKey->data();
+
+    std::unique_ptr<EVP_PKEY, decltype(&EVP_PKEY_free)> key(
+        d2i_PUBKEY(nullptr, &data, static_cast<long>(verifiedKey->size())), EVP_PKEY_free);
+    if (!key) {
+        return Error::eFailed;
+    }
+
+    return VerifySignature(key.get());
+}
+
+/***********************************************************************************************************************
+ * Private
+ **********************************************************************************************************************/
+
+size_t RevocationList::GetSerial(size_t index, const uint8_t*& serial) const
+{
+    serial = mSerials.data() + mOffsets[index];
+
+    return mOffsets[index + 1] - mOffsets[index];
+}
+
+void RevocationList::BuildFilter()
+{
+    size_t numBits = cMinFilterBits;
+
+    while (numBits < GetSize() * cBitsPerEntry) {
+        numBits *= 2;
+    }
+
+    mFilter.assign(numBits / 64, 0);
+    mFilterMask = numBits - 1;
+
+    for (size_t i = 0; i < GetSize(); i++) {
+        const uint8_t* serial = nullptr;
+        auto           size   = GetSerial(i, serial);
+        auto           hash   = Hash(serial, size);
+        auto           hash1  = hash & 0xffffffff;
+        auto           hash2  = (hash >> 32) | 1;
+
+        for (size_t j = 0; j < cNumHashes; j++) {
+            auto bit = (hash1 + j * hash2) & mFilterMask;
+
+            mFilter[bit / 64] |= uint64_t(1) << (bit % 64);
+        }
+    }
+}
+
+} // namespace certhandler
+} // namespace iam
+} // namespace aos
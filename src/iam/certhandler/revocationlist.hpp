@@ -0,0 +1,179 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef REVOCATIONLIST_HPP_
+#define REVOCATIONLIST_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <vector>
+
+#include <openssl/x509.h>
+
+#include "error/error.hpp"
+
+namespace aos {
+namespace iam {
+namespace certhandler {
+
+/** @addtogroup iam Identification and Access Manager
+ *  @{
+ */
+
+/**
+ * Immutable parsed CRL. Revoked serial numbers are kept in a sorted packed array with a Bloom filter in front of it,
+ * so checking a not revoked serial usually takes a few bit tests and no binary search. Instances are shared between
+ * readers, an update creates a new instance.
+ */
+class RevocationList {
+public:
+    /**
+     * Parses DER CRL.
+     *
+     * @param der DER encoded CRL.
+     * @param[out] list revocation list.
+     * @return Error.
+     */
+    static Error Create(const std::vector<uint8_t>& der, std::shared_ptr<const RevocationList>& list);
+
+    /**
+     * Converts ASN.1 integer to serial number in the CertInfo format: big endian content without leading zeros.
+     *
+     * @param integer ASN.1 integer.
+     * @param[out] serial serial number.
+     * @return Error.
+     */
+    static Error ConvertSerial(const ASN1_INTEGER* integer, std::vector<uint8_t>& serial);
+
+    /**
+     * Returns DER encoded issuer name.
+     *
+     * @return const std::vector<uint8_t>&.
+     */
+    const std::vector<uint8_t>& GetIssuer() const { return mIssuer; }
+
+    /**
+     * Returns this update time.
+     *
+     * @return time_t.
+     */
+    time_t GetThisUpdate() const { return mThisUpdate; }
+
+    /**
+     * Returns next update time, 0 if not set.
+     *
+     * @return time_t.
+     */
+    time_t GetNextUpdate() const { return mNextUpdate; }
+
+    /**
+     * Returns CRL number in the CertInfo serial format, empty if the CRL has no CRL number extension.
+     *
+     * @return const std::vector<uint8_t>&.
+     */
+    const std::vector<uint8_t>& GetNumber() const { return mNumber; }
+
+    /**
+     * Returns true if the CRL supersedes other CRL of the same issuer: CRL numbers are compared if both CRLs have them,
+     * this update times otherwise.
+     *
+     * @param other other CRL.
+     * @return bool.
+     */
+    bool IsNewerThan(const RevocationList& other) const;
+
+    /**
+     * Returns number of revoked certificates.
+     *
+     * @return size_t.
+     */
+    size_t GetSize() const { return mOffsets.size() - 1; }
+
+    /**
+     * Returns true if serial number is revoked.
+     *
+     * @param serial serial number in the CertInfo format.
+     * @param size serial number size.
+     * @return bool.
+     */
+    bool IsRevoked(const uint8_t* serial, size_t size) const;
+
+    /**
+     * Returns true if serial number is revoked.
+     *
+     * @param serial serial number in the CertInfo format.
+     * @return bool.
+     */
+    bool IsRevoked(const std::vector<uint8_t>& serial) const { return IsRevoked(serial.data(), serial.size()); }
+
+    /**
+     * Returns false if serial number is definitely not revoked. Bloom filter check only.
+     *
+     * @param serial serial number in the CertInfo format.
+     * @param size serial number size.
+     * @return bool.
+     */
+    bool MayBeRevoked(const uint8_t* serial, size_t size) const;
+
+    /**
+     * Verifies CRL signature. The last successfully verified issuer key is remembered, so repeated verification with
+     * the same key doesn't repeat the signature check.
+     *
+     * @param issuerKey issuer public key.
+     * @return Error.
+     */
+    Error VerifySignature(EVP_PKEY* issuerKey) const;
+
+    /**
+     * Verifies CRL signature with the issuer key which verified other CRL.
+     *
+     * @param other other CRL of the same issuer.
+     * @return Error eNotFound if other CRL signature is not verified yet.
+     */
+    Error VerifySignature(const RevocationList& other) const;
+
+private:
+    static constexpr size_t cBitsPerEntry = 10;
+    static constexpr size_t cNumHashes    = 7;
+
+    RevocationList() = default;
+
+    size_t GetSerial(size_t index, const uint8_t*& serial) const;
+    void   BuildFilter();
+
+    std::shared_ptr<X509_CRL>                           mCRL;
+    std::vector<uint8_t>                                mIssuer;
+    time_t                                              mThisUpdate = 0;
+    time_t                                              mNextUpdate = 0;
+    std::vector<uint8_t>                                mNumber;
+    std::vector<uint8_t>                                mSerials;
+    std::vector<uint32_t>                               mOffsets;
+    std::vector<uint64_t>                               mFilter;
+    uint64_t                                            mFilterMask = 0;
+    mutable std::shared_ptr<const std::vector<uint8_t>> mVerifiedKey;
+};
+
+/** @}*/
+
+} // namespace certhandler
+} // namespace iam
+} // namespace aos
+
+#endif
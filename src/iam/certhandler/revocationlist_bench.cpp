@@ -0,0 +1,123 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <benchmark/benchmark.h>
+
+#include "revocationlist.hpp"
+#include "testcerts.hpp"
+
+using namespace aos;
+using namespace aos::iam::certhandler;
+using namespace aos::iam::certhandler::test;
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+namespace {
+
+constexpr long cNumRevoked = 50000;
+
+const std::vector<uint8_t>& GetCRL()
+{
+    static std::vector<uint8_t> sCRL;
+
+    if (sCRL.empty()) {
+        auto              key = GenerateTestKey();
+        std::vector<long> serials;
+
+        // Even serials are revoked, odd ones are not.
+        for (long i = 0; i < cNumRevoked; i++) {
+            serials.push_back(0x10000000 + i * 2);
+        }
+
+        sCRL = CreateTestCRL("root", key.get(), serials);
+    }
+
+    return sCRL;
+}
+
+std::vector<std::vector<uint8_t>> GetSerials(bool revoked)
+{
+    std::unique_ptr<ASN1_INTEGER, decltype(&ASN1_INTEGER_free)> integer(ASN1_INTEGER_new(), ASN1_INTEGER_free);
+    std::vector<std::vector<uint8_t>>                           serials(1024);
+
+    for (size_t i = 0; i < serials.size(); i++) {
+        ASN1_INTEGER_set(integer.get(), 0x10000000 + static_cast<long>(i * 97 % cNumRevoked) * 2 + (revoked ? 0 : 1));
+        RevocationList::ConvertSerial(integer.get(), serials[i]);
+    }
+
+    return serials;
+}
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Benchmarks
+ **********************************************************************************************************************/
+
+// Lookup in OpenSSL CRL: serial is converted to ASN.1 integer as done by X509_CRL_get0_by_cert.
+static void LookupOpenSSL(benchmark::State& state)
+{
+    const auto& der     = GetCRL();
+    auto        data    = der.data();
+    auto        serials = GetSerials(state.range(0));
+
+    std::unique_ptr<X509_CRL, decltype(&X509_CRL_free)> crl(d2i_X509_CRL(nullptr, &data, der.size()), X509_CRL_free);
+    std::vector<std::unique_ptr<ASN1_INTEGER, decltype(&ASN1_INTEGER_free)>> integers;
+
+    for (const auto& serial : serials) {
+        std::unique_ptr<BIGNUM, decltype(&BN_free)> number(
+            BN_bin2bn(serial.data(), static_cast<int>(serial.size()), nullptr), BN_free);
+
+        integers.emplace_back(BN_to_ASN1_INTEGER(number.get(), nullptr), ASN1_INTEGER_free);
+    }
+
+    size_t index = 0;
+
+    for (auto _ : state) {
+        X509_REVOKED* revoked = nullptr;
+
+        benchmark::DoNotOptimize(X509_CRL_get0_by_serial(crl.get(), &revoked, integers[index].get()));
+
+        index = (index + 1) % integers.size();
+    }
+}
+
+static void LookupRevocationList(benchmark::State& state)
+{
+    std::shared_ptr<const RevocationList> list;
+
+    if (RevocationList::Create(GetCRL(), list) != Error::eNone) {
+        state.SkipWithError("parse failed");
+
+        return;
+    }
+
+    auto   serials = GetSerials(state.range(0));
+    size_t index   = 0;
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(list->IsRevoked(serials[index]));
+
+        index = (index + 1) % serials.size();
+    }
+}
+
+BENCHMARK(LookupOpenSSL)->ArgName("revoked")->Arg(0)->Arg(1);
+BENCHMARK(LookupRevocationList)->ArgName("revoked")->Arg(0)->Arg(1);
@@ -0,0 +1,171 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+
+#include "revocationlist.hpp"
+#include "testcerts.hpp"
+
+using namespace aos;
+using namespace aos::iam::certhandler;
+using namespace aos::iam::certhandler::test;
+
+/***********************************************************************************************************************
+ * Suite
+ **********************************************************************************************************************/
+
+class RevocationListTest : public testing::Test {
+protected:
+    static std::vector<uint8_t> ToSerial(long value)
+    {
+        std::unique_ptr<ASN1_INTEGER, decltype(&ASN1_INTEGER_free)> integer(ASN1_INTEGER_new(), ASN1_INTEGER_free);
+        std::vector<uint8_t>                                        serial;
+
+        ASN1_INTEGER_set(integer.get(), value);
+
+        EXPECT_EQ(RevocationList::ConvertSerial(integer.get(), serial), Error::eNone);
+
+        return serial;
+    }
+
+    TestKeyPtr mKey = GenerateTestKey();
+};
+
+/***********************************************************************************************************************
+ * Tests
+ **********************************************************************************************************************/
+
+TEST_F(RevocationListTest, Create)
+{
+    std::shared_ptr<const RevocationList> list;
+
+    EXPECT_EQ(RevocationList::Create({0x30, 0x00}, list), Error::eInvalidArgument);
+
+    ASSERT_EQ(RevocationList::Create(CreateTestCRL("root", mKey.get(), {5, 3, 5, 0x80}, 7), list), Error::eNone);
+
+    // Duplicates are merged.
+    EXPECT_EQ(list->GetSize(), 3);
+
+    auto now = time(nullptr);
+
+    EXPECT_GT(list->GetNextUpdate(), now + 6 * 24 * 3600);
+    EXPECT_LE(list->GetNextUpdate(), now + 7 * 24 * 3600);
+
+    std::unique_ptr<X509_NAME, decltype(&X509_NAME_free)> name(X509_NAME_new(), X509_NAME_free);
+
+    X509_NAME_add_entry_by_txt(
+        name.get(), "CN", MBSTRING_ASC, reinterpret_cast<const unsigned char*>("root"), -1, -1, 0);
+
+    unsigned char* issuer = nullptr;
+    int            size   = i2d_X509_NAME(name.get(), &issuer);
+
+    EXPECT_EQ(list->GetIssuer(), std::vector<uint8_t>(issuer, issuer + size));
+
+    OPENSSL_free(issuer);
+}
+
+TEST_F(RevocationListTest, IsNewerThan)
+{
+    std::shared_ptr<const RevocationList> older, newer, numbered, renumbered;
+
+    ASSERT_EQ(RevocationList::Create(CreateTestCRL("root", mKey.get(), {}, 7, -2), older), Error::eNone);
+    ASSERT_EQ(RevocationList::Create(CreateTestCRL("root", mKey.get(), {}, 7, -1), newer), Error::eNone);
+
+    EXPECT_LT(older->GetThisUpdate(), newer->GetThisUpdate());
+    EXPECT_TRUE(older->GetNumber().empty());
+
+    EXPECT_TRUE(newer->IsNewerThan(*older));
+    EXPECT_FALSE(older->IsNewerThan(*newer));
+    EXPECT_FALSE(newer->IsNewerThan(*newer));
+
+    ASSERT_EQ(RevocationList::Create(CreateTestCRL("root", mKey.get(), {}, 7, -2, 0x100), numbered), Error::eNone);
+    ASSERT_EQ(RevocationList::Create(CreateTestCRL("root", mKey.get(), {}, 7, -1, 0xff), renumbered), Error::eNone);
+
+    EXPECT_EQ(numbered->GetNumber(), ToSerial(0x100));
+
+    // CRL numbers are compared if both CRLs have them.
+    EXPECT_TRUE(numbered->IsNewerThan(*renumbered));
+    EXPECT_FALSE(renumbered->IsNewerThan(*numbered));
+    EXPECT_TRUE(renumbered->IsNewerThan(*older));
+}
+
+TEST_F(RevocationListTest, ConvertSerial)
+{
+    // DER adds leading zero to 0x80, CertInfo serial doesn't have it.
+    EXPECT_EQ(ToSerial(0x80), std::vector<uint8_t>({0x80}));
+    EXPECT_EQ(ToSerial(0x1234), std::vector<uint8_t>({0x12, 0x34}));
+}
+
+TEST_F(RevocationListTest, IsRevoked)
+{
+    std::vector<long> revoked;
+
+    for (long i = 0; i < 1000; i++) {
+        revoked.push_back(i * 7 + 1);
+    }
+
+    std::shared_ptr<const RevocationList> list;
+
+    ASSERT_EQ(RevocationList::Create(CreateTestCRL("root", mKey.get(), revoked), list), Error::eNone);
+    ASSERT_EQ(list->GetSize(), revoked.size());
+
+    size_t falsePositives = 0;
+
+    for (long i = 0; i < 7000; i++) {
+        auto serial    = ToSerial(i);
+        bool isRevoked = i % 7 == 1;
+
+        EXPECT_EQ(list->IsRevoked(serial), isRevoked) << i;
+
+        if (isRevoked) {
+            EXPECT_TRUE(list->MayBeRevoked(serial.data(), serial.size())) << i;
+        } else if (list->MayBeRevoked(serial.data(), serial.size())) {
+            falsePositives++;
+        }
+    }
+
+    // About 1% with 10 bits per entry.
+    EXPECT_LT(falsePositives, 6000 * 3 / 100);
+}
+
+TEST_F(RevocationListTest, Empty)
+{
+    std::shared_ptr<const RevocationList> list;
+
+    ASSERT_EQ(RevocationList::Create(CreateTestCRL("root", mKey.get(), {}), list), Error::eNone);
+
+    EXPECT_EQ(list->GetSize(), 0);
+    EXPECT_FALSE(list->IsRevoked(ToSerial(1)));
+}
+
+TEST_F(RevocationListTest, VerifySignature)
+{
+    std::shared_ptr<const RevocationList> list;
+
+    ASSERT_EQ(RevocationList::Create(CreateTestCRL("root", mKey.get(), {1}), list), Error::eNone);
+
+    auto otherKey = GenerateTestKey();
+
+    EXPECT_EQ(list->VerifySignature(otherKey.get()), Error::eFailed);
+
+    // Second check is served by the remembered key.
+    EXPECT_EQ(list->VerifySignature(mKey.get()), Error::eNone);
+    EXPECT_EQ(list->VerifySignature(mKey.get()), Error::eNone);
+
+    EXPECT_EQ(list->VerifySignature(otherKey.get()), Error::eFailed);
+}
@@ -0,0 +1,267 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <algorithm>
+#include <limits>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <openssl/crypto.h>
+
+#include "securearena.hpp"
+
+namespace aos {
+namespace iam {
+namespace certhandler {
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+constexpr size_t SecureArena::cDefaultSlotSize;
+constexpr size_t SecureArena::cDefaultNumSlots;
+constexpr size_t SecureArena::cSlotAlignment;
+
+/***********************************************************************************************************************
+ * Public
+ **********************************************************************************************************************/
+
+SecureBuffer& SecureBuffer::operator=(SecureBuffer&& other) noexcept
+{
+    if (this != &other) {
+        Reset();
+
+        mArena = other.mArena;
+        mData  = other.mData;
+        mSize  = other.mSize;
+        mHeap  = other.mHeap;
+
+        other.mArena = nullptr;
+        other.mData  = nullptr;
+        other.mSize  = 0;
+        other.mHeap  = false;
+    }
+
+    return *this;
+}
+
+void SecureBuffer::Reset()
+{
+    if (mArena) {
+        mArena->Release(mData, mSize, mHeap);
+    }
+
+    mArena = nullptr;
+    mData  = nullptr;
+    mSize  = 0;
+    mHeap  = false;
+}
+
+SecureArena::~SecureArena()
+{
+    if (!mRegion) {
+        return;
+    }
+
+    OPENSSL_cleanse(mSlots, mSlotsSize);
+    munlock(mSlots, mSlotsSize);
+    munmap(mRegion, mRegionSize);
+}
+
+SecureArena& SecureArena::GetDefault()
+{
+    // Leaked on purpose: buffers owned by other static objects may be released after static destructors run.
+    static auto           sArena = new SecureArena();
+    static std::once_flag sInitOnce;
+
+    std::call_once(sInitOnce, []() { sArena->Init(); });
+
+    return *sArena;
+}
+
+Error SecureArena::Init(size_t slotSize, size_t numSlots)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    if (mRegion) {
+        return Error::eWrongState;
+    }
+
+    // Until initialized successfully, buffers are allocated on the heap.
+    mInitFailed = true;
+
+    if (slotSize == 0 || numSlots == 0 || numSlots > std::numeric_limits<uint32_t>::max()
+        || slotSize > std::numeric_limits<size_t>::max() / 2 / numSlots) {
+        return Error::eInvalidArgument;
+    }
+
+    auto pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+
+    slotSize       = (slotSize + cSlotAlignment - 1) / cSlotAlignment * cSlotAlignment;
+    auto slotsSize = (slotSize * numSlots + pageSize - 1) / pageSize * pageSize;
+
+    // Guard pages before and after the slots stay inaccessible: buffer overruns fault instead of leaking secrets.
+    auto regionSize = slotsSize + 2 * pageSize;
+    auto region     = mmap(nullptr, regionSize, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (region == MAP_FAILED) {
+        return Error::eNoMemory;
+    }
+
+    auto slots = static_cast<uint8_t*>(region) + pageSize;
+
+    if (mprotect(slots, slotsSize, PROT_READ | PROT_WRITE) != 0 || mlock(slots, slotsSize) != 0) {
+        munmap(region, regionSize);
+
+        return Error::eFailed;
+    }
+
+#ifdef MADV_DONTDUMP
+    madvise(slots, slotsSize, MADV_DONTDUMP);
+#endif
+
+    mInitFailed = false;
+    mRegion     = static_cast<uint8_t*>(region);
+    mRegionSize = regionSize;
+    mSlots      = slots;
+    mSlotsSize  = slotsSize;
+
+    // Heap buffers allocated after a failed attempt stay in use.
+    auto numHeapAllocated = mMetrics.mNumHeapAllocated;
+
+    mMetrics                   = SecureArenaMetrics();
+    mMetrics.mSlotSize         = slotSize;
+    mMetrics.mNumSlots         = numSlots;
+    mMetrics.mLocked           = true;
+    mMetrics.mNumHeapAllocated = numHeapAllocated;
+
+    // Lower slots are allocated first.
+    mFreeSlots.resize(numSlots);
+
+    for (size_t i = 0; i < numSlots; i++) {
+        mFreeSlots[i] = static_cast<uint32_t>(numSlots - 1 - i);
+    }
+
+    return Error::eNone;
+}
+
+Error SecureArena::Allocate(size_t size, SecureBuffer& buffer)
+{
+    // Release the previous slot before locking: it takes the lock as well.
+    buffer.Reset();
+
+    if (size == 0) {
+        return Error::eNone;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    if (!mRegion) {
+        return mInitFailed ? AllocateHeap(size, buffer) : Error::eWrongState;
+    }
+
+    if (size > mMetrics.mSlotSize) {
+        return Error::eInvalidArgument;
+    }
+
+    if (mFreeSlots.empty()) {
+        mMetrics.mNumExhausted++;
+
+        return Error::eNoMemory;
+    }
+
+    auto index = mFreeSlots.back();
+
+    mFreeSlots.pop_back();
+
+    mMetrics.mNumAllocated++;
+    mMetrics.mHighWaterMark = std::max(mMetrics.mHighWaterMark, mMetrics.mNumAllocated);
+
+    buffer.mArena = this;
+    buffer.mData  = mSlots + index * mMetrics.mSlotSize;
+    buffer.mSize  = size;
+
+    return Error::eNone;
+}
+
+Error SecureArena::Allocate(const void* data, size_t size, SecureBuffer& buffer)
+{
+    auto err = Allocate(size, buffer);
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    std::copy_n(static_cast<const uint8_t*>(data), size, buffer.GetData());
+
+    return Error::eNone;
+}
+
+SecureArenaMetrics SecureArena::GetMetrics() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    return mMetrics;
+}
+
+/***********************************************************************************************************************
+ * Private
+ **********************************************************************************************************************/
+
+Error SecureArena::AllocateHeap(size_t size, SecureBuffer& buffer)
+{
+    // Uses OpenSSL secure heap if the application has initialized it.
+    auto data = static_cast<uint8_t*>(OPENSSL_secure_zalloc(size));
+    if (!data) {
+        return Error::eNoMemory;
+    }
+
+    mMetrics.mNumHeapAllocated++;
+
+    buffer.mArena = this;
+    buffer.mData  = data;
+    buffer.mSize  = size;
+    buffer.mHeap  = true;
+
+    return Error::eNone;
+}
+
+void SecureArena::Release(uint8_t* data, size_t size, bool heap)
+{
+    if (heap) {
+        OPENSSL_secure_clear_free(data, size);
+
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        mMetrics.mNumHeapAllocated--;
+
+        return;
+    }
+
+    // The slot is still owned by the caller, zeroize it without the lock. Slot size is fixed, so is the cost.
+    OPENSSL_cleanse(data, mMetrics.mSlotSize);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    mFreeSlots.push_back(static_cast<uint32_t>((data - mSlots) / mMetrics.mSlotSize));
+    mMetrics.mNumAllocated--;
+}
+
+} // namespace certhandler
+} // namespace iam
+} // namespace aos
@@ -0,0 +1,260 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef SECUREARENA_HPP_
+#define SECUREARENA_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "error/error.hpp"
+
+namespace aos {
+namespace iam {
+namespace certhandler {
+
+/** @addtogroup iam Identification and Access Manager
+ *  @{
+ */
+
+class SecureArena;
+
+/**
+ * Secure arena metrics.
+ */
+struct SecureArenaMetrics {
+    /**
+     * Slot size.
+     */
+    size_t mSlotSize = 0;
+
+    /**
+     * Number of slots.
+     */
+    size_t mNumSlots = 0;
+
+    /**
+     * Number of allocated slots.
+     */
+    size_t mNumAllocated = 0;
+
+    /**
+     * Max number of simultaneously allocated slots.
+     */
+    size_t mHighWaterMark = 0;
+
+    /**
+     * Number of allocations failed because the arena is full.
+     */
+    size_t mNumExhausted = 0;
+
+    /**
+     * Arena memory is reserved and locked.
+     */
+    bool mLocked = false;
+
+    /**
+     * Number of allocated heap buffers, used instead of slots if the arena failed to initialize.
+     */
+    size_t mNumHeapAllocated = 0;
+};
+
+/**
+ * Buffer allocated from the secure arena. Move only, returns its slot to the arena on destruction.
+ */
+class SecureBuffer {
+public:
+    /**
+     * Creates empty buffer.
+     */
+    SecureBuffer() = default;
+
+    /**
+     * Destroys buffer.
+     */
+    ~SecureBuffer() { Reset(); }
+
+    SecureBuffer(const SecureBuffer&) = delete;
+    SecureBuffer& operator=(const SecureBuffer&) = delete;
+
+    /**
+     * Moves buffer.
+     *
+     * @param other buffer to move.
+     */
+    SecureBuffer(SecureBuffer&& other) noexcept { *this = std::move(other); }
+
+    /**
+     * Moves buffer.
+     *
+     * @param other buffer to move.
+     * @return SecureBuffer&.
+     */
+    SecureBuffer& operator=(SecureBuffer&& other) noexcept;
+
+    /**
+     * Returns buffer data.
+     *
+     * @return uint8_t*.
+     */
+    uint8_t* GetData() { return mData; }
+
+    /**
+     * Returns buffer data.
+     *
+     * @return const uint8_t*.
+     */
+    const uint8_t* GetData() const { return mData; }
+
+    /**
+     * Returns buffer size.
+     *
+     * @return size_t.
+     */
+    size_t GetSize() const { return mSize; }
+
+    /**
+     * Returns true if buffer is empty.
+     *
+     * @return bool.
+     */
+    bool IsEmpty() const { return mSize == 0; }
+
+    /**
+     * Zeroizes buffer and returns its slot to the arena.
+     */
+    void Reset();
+
+private:
+    friend class SecureArena;
+
+    SecureArena* mArena = nullptr;
+    uint8_t*     mData  = nullptr;
+    size_t       mSize  = 0;
+    bool         mHeap  = false;
+};
+
+/**
+ * Arena for private keys, PINs and secrets. Memory is reserved once, locked in RAM, excluded from core dumps and
+ * surrounded by guard pages. The arena is split into fixed size slots: allocation and release are O(1) and don't
+ * fragment the heap. Slots are zeroized on release.
+ *
+ * If the arena fails to initialize, e.g. memory can't be locked, buffers are allocated on the heap and zeroized on
+ * release: secrets stay usable without the locking guarantees, which is reported by the metrics.
+ *
+ * The arena holds only secrets the library copies itself, currently the PKCS#11 PIN. Software keys are OpenSSL key
+ * objects allocated by OpenSSL and stay on its heap: replacing OpenSSL memory functions would route all its
+ * allocations to the arena. To lock software keys, the application enables the OpenSSL secure heap with
+ * CRYPTO_secure_malloc_init(), which OpenSSL uses for private key components.
+ */
+class SecureArena {
+public:
+    /**
+     * Default slot size.
+     */
+    static constexpr size_t cDefaultSlotSize = 256;
+
+    /**
+     * Default number of slots.
+     */
+    static constexpr size_t cDefaultNumSlots = 64;
+
+    /**
+     * Creates arena.
+     */
+    SecureArena() = default;
+
+    /**
+     * Destroys arena. All buffers must be released before.
+     */
+    ~SecureArena();
+
+    SecureArena(const SecureArena&) = delete;
+    SecureArena& operator=(const SecureArena&) = delete;
+
+    /**
+     * Returns process wide arena with default parameters, initialized on first use. If its memory can't be locked,
+     * buffers are allocated on the heap.
+     *
+     * @return SecureArena&.
+     */
+    static SecureArena& GetDefault();
+
+    /**
+     * Reserves and locks arena memory. If it fails, buffers are allocated on the heap until the arena is initialized.
+     *
+     * @param slotSize slot size, rounded up to 16 bytes.
+     * @param numSlots number of slots.
+     * @return Error eFailed if memory can't be locked.
+     */
+    Error Init(size_t slotSize = cDefaultSlotSize, size_t numSlots = cDefaultNumSlots);
+
+    /**
+     * Allocates zeroed buffer.
+     *
+     * @param size buffer size, not more than slot size. Zero size returns empty buffer without using a slot.
+     * @param[out] buffer allocated buffer.
+     * @return Error eNoMemory if there are no free slots, eWrongState if the arena is not initialized.
+     */
+    Error Allocate(size_t size, SecureBuffer& buffer);
+
+    /**
+     * Allocates buffer and copies data into it.
+     *
+     * @param data data.
+     * @param size data size, not more than slot size.
+     * @param[out] buffer allocated buffer.
+     * @return Error.
+     */
+    Error Allocate(const void* data, size_t size, SecureBuffer& buffer);
+
+    /**
+     * Returns metrics.
+     *
+     * @return SecureArenaMetrics.
+     */
+    SecureArenaMetrics GetMetrics() const;
+
+private:
+    friend class SecureBuffer;
+
+    static constexpr size_t cSlotAlignment = 16;
+
+    Error AllocateHeap(size_t size, SecureBuffer& buffer);
+    void  Release(uint8_t* data, size_t size, bool heap);
+
+    mutable std::mutex    mMutex;
+    bool                  mInitFailed = false;
+    uint8_t*              mRegion = nullptr;
+    size_t                mRegionSize = 0;
+    uint8_t*              mSlots = nullptr;
+    size_t                mSlotsSize = 0;
+    SecureArenaMetrics    mMetrics;
+    std::vector<uint32_t> mFreeSlots;
+};
+
+/** @}*/
+
+} // namespace certhandler
+} // namespace iam
+} // namespace aos
+
+#endif
@@ -0,0 +1,170 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <algorithm>
+#include <cstring>
+
+#include <gtest/gtest.h>
+
+#include "securearena.hpp"
+
+using namespace aos;
+using namespace aos::iam::certhandler;
+
+/***********************************************************************************************************************
+ * Tests
+ **********************************************************************************************************************/
+
+TEST(securearena, Init)
+{
+    SecureArena  arena;
+    SecureBuffer buffer;
+
+    EXPECT_EQ(arena.Allocate(16, buffer), Error::eWrongState);
+
+    EXPECT_EQ(arena.Init(0, 4), Error::eInvalidArgument);
+    EXPECT_EQ(arena.Init(16, 0), Error::eInvalidArgument);
+
+    ASSERT_EQ(arena.Init(100, 4), Error::eNone);
+    EXPECT_EQ(arena.Init(100, 4), Error::eWrongState);
+
+    auto metrics = arena.GetMetrics();
+
+    EXPECT_EQ(metrics.mSlotSize, 112u);
+    EXPECT_EQ(metrics.mNumSlots, 4u);
+    EXPECT_EQ(metrics.mNumAllocated, 0u);
+    EXPECT_TRUE(metrics.mLocked);
+}
+
+TEST(securearena, Allocate)
+{
+    SecureArena arena;
+
+    ASSERT_EQ(arena.Init(64, 4), Error::eNone);
+
+    SecureBuffer buffers[5];
+
+    EXPECT_EQ(arena.Allocate(65, buffers[0]), Error::eInvalidArgument);
+
+    ASSERT_EQ(arena.Allocate(0, buffers[0]), Error::eNone);
+    EXPECT_TRUE(buffers[0].IsEmpty());
+
+    for (size_t i = 0; i < 4; i++) {
+        ASSERT_EQ(arena.Allocate(64, buffers[i]), Error::eNone);
+        ASSERT_EQ(buffers[i].GetSize(), 64u);
+        EXPECT_TRUE(std::all_of(buffers[i].GetData(), buffers[i].GetData() + 64, [](uint8_t b) { return b == 0; }));
+
+        memset(buffers[i].GetData(), 0xa5, buffers[i].GetSize());
+    }
+
+    EXPECT_EQ(arena.Allocate(1, buffers[4]), Error::eNoMemory);
+
+    auto metrics = arena.GetMetrics();
+
+    EXPECT_EQ(metrics.mNumAllocated, 4u);
+    EXPECT_EQ(metrics.mHighWaterMark, 4u);
+    EXPECT_EQ(metrics.mNumExhausted, 1u);
+
+    // Released slot is zeroized and reused.
+    auto data = buffers[1].GetData();
+
+    buffers[1].Reset();
+    EXPECT_TRUE(std::all_of(data, data + 64, [](uint8_t b) { return b == 0; }));
+
+    const char secret[] = "secret";
+
+    ASSERT_EQ(arena.Allocate(secret, sizeof(secret), buffers[4]), Error::eNone);
+    EXPECT_EQ(buffers[4].GetData(), data);
+    EXPECT_EQ(memcmp(buffers[4].GetData(), secret, sizeof(secret)), 0);
+
+    // Moved buffer owns the slot.
+    SecureBuffer moved(std::move(buffers[4]));
+
+    EXPECT_TRUE(buffers[4].IsEmpty());
+    EXPECT_EQ(moved.GetData(), data);
+
+    for (auto& buffer : buffers) {
+        buffer.Reset();
+    }
+
+    metrics = arena.GetMetrics();
+
+    EXPECT_EQ(metrics.mNumAllocated, 1u);
+    EXPECT_EQ(metrics.mHighWaterMark, 4u);
+}
+
+TEST(securearena, InitFailed)
+{
+    SecureArena  arena;
+    SecureBuffer buffer;
+
+    ASSERT_EQ(arena.Init(0, 4), Error::eInvalidArgument);
+
+    // Buffers are allocated on the heap, without locked memory.
+    const char secret[] = "secret";
+
+    ASSERT_EQ(arena.Allocate(secret, sizeof(secret), buffer), Error::eNone);
+    EXPECT_EQ(memcmp(buffer.GetData(), secret, sizeof(secret)), 0);
+
+    auto metrics = arena.GetMetrics();
+
+    EXPECT_FALSE(metrics.mLocked);
+    EXPECT_EQ(metrics.mNumAllocated, 0u);
+    EXPECT_EQ(metrics.mNumHeapAllocated, 1u);
+
+    // Heap buffer outlives later successful initialization.
+    SecureBuffer slotBuffer;
+
+    ASSERT_EQ(arena.Init(16, 1), Error::eNone);
+    ASSERT_EQ(arena.Allocate(16, slotBuffer), Error::eNone);
+
+    metrics = arena.GetMetrics();
+
+    EXPECT_TRUE(metrics.mLocked);
+    EXPECT_EQ(metrics.mNumAllocated, 1u);
+    EXPECT_EQ(metrics.mNumHeapAllocated, 1u);
+
+    buffer.Reset();
+    slotBuffer.Reset();
+
+    metrics = arena.GetMetrics();
+
+    EXPECT_EQ(metrics.mNumAllocated, 0u);
+    EXPECT_EQ(metrics.mNumHeapAllocated, 0u);
+}
+
+TEST(securearena, GuardPages)
+{
+    SecureArena  arena;
+    SecureBuffer buffer;
+
+    ASSERT_EQ(arena.Init(16, 1), Error::eNone);
+    ASSERT_EQ(arena.Allocate(16, buffer), Error::eNone);
+
+    auto data = buffer.GetData();
+
+    EXPECT_DEATH(*(static_cast<volatile uint8_t*>(data) - 1) = 0, "");
+}
+
+TEST(securearena, Default)
+{
+    auto& arena = SecureArena::GetDefault();
+
+    EXPECT_EQ(&arena, &SecureArena::GetDefault());
+    EXPECT_EQ(arena.GetMetrics().mNumSlots, SecureArena::cDefaultNumSlots);
+}
@@ -0,0 +1,215 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include <openssl/evp.h>
+#include <openssl/x509.h>
+
+#include "signature.hpp"
+
+namespace aos {
+namespace iam {
+namespace certhandler {
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+namespace {
+
+using PKeyPtr = std::unique_ptr<EVP_PKEY, decltype(&EVP_PKEY_free)>;
+
+PKeyPtr ParsePublicKey(const std::vector<uint8_t>& publicKey)
+{
+    auto buffer = publicKey.data();
+
+    return PKeyPtr(d2i_PUBKEY(nullptr, &buffer, publicKey.size()), EVP_PKEY_free);
+}
+
+// Key is only read, so the same key may be used by multiple threads with their own contexts.
+Error Verify(EVP_PKEY* pkey, const std::vector<uint8_t>& data, const std::vector<uint8_t>& signature)
+{
+    const EVP_MD* md = nullptr;
+
+    switch (EVP_PKEY_get_base_id(pkey)) {
+    case EVP_PKEY_ED25519:
+        break;
+
+    case EVP_PKEY_EC:
+        md = EVP_PKEY_get_bits(pkey) > 256 ? EVP_sha384() : EVP_sha256();
+        break;
+
+    default:
+        md = EVP_sha256();
+        break;
+    }
+
+    std::unique_ptr<EVP_MD_CTX, decltype(&EVP_MD_CTX_free)> ctx(EVP_MD_CTX_new(), EVP_MD_CTX_free);
+    if (!ctx) {
+        return Error::eNoMemory;
+    }
+
+    if (EVP_DigestVerifyInit(ctx.get(), nullptr, md, nullptr, pkey) <= 0) {
+        return Error::eFailed;
+    }
+
+    if (EVP_DigestVerify(ctx.get(), signature.data(), signature.size(), data.data(), data.size()) != 1) {
+        return Error::eFailed;
+    }
+
+    return Error::eNone;
+}
+
+// Shared by the caller and pool jobs: jobs may start after the caller has returned.
+struct VerifyState {
+    const std::function<Error(size_t)>* mVerifyItem = nullptr;
+    std::vector<Error>*                 mResults    = nullptr;
+    size_t                              mNumItems   = 0;
+    std::atomic<size_t>                 mNext {0};
+    std::mutex                          mMutex;
+    std::condition_variable             mCondVar;
+    size_t                              mNumRunning = 0;
+    bool                                mDone       = false;
+};
+
+// Items are taken one by one: verification time differs a lot between key types.
+void VerifyNext(VerifyState& state)
+{
+    for (size_t i = state.mNext++; i < state.mNumItems; i = state.mNext++) {
+        (*state.mResults)[i] = (*state.mVerifyItem)(i);
+    }
+}
+
+Error VerifyItems(size_t numItems, const std::function<Error(size_t)>& verifyItem, std::vector<Error>& results,
+    ThreadPool* pool)
+{
+    auto state = std::make_shared<VerifyState>();
+
+    results.assign(numItems, Error::eNone);
+
+    state->mVerifyItem = &verifyItem;
+    state->mResults    = &results;
+    state->mNumItems   = numItems;
+
+    auto numJobs = pool ? std::min(pool->GetNumThreads(), numItems) : 0;
+
+    for (size_t i = 0; i < numJobs; i++) {
+        // Jobs queued behind long running ones, e.g. key generation, are not waited for: a job started after the
+        // caller has finished doesn't touch the items.
+        auto err = pool->AddJob([state]() {
+            {
+                std::lock_guard<std::mutex> lock(state->mMutex);
+
+                if (state->mDone) {
+                    return;
+                }
+
+                state->mNumRunning++;
+            }
+
+            VerifyNext(*state);
+
+            std::lock_guard<std::mutex> lock(state->mMutex);
+
+            if (--state->mNumRunning == 0) {
+                state->mCondVar.notify_one();
+            }
+        });
+        if (err != Error::eNone) {
+            break;
+        }
+    }
+
+    // Calling thread takes part as well and handles everything if the pool is busy or not used.
+    VerifyNext(*state);
+
+    std::unique_lock<std::mutex> lock(state->mMutex);
+
+    state->mDone = true;
+    state->mCondVar.wait(lock, [&state] { return state->mNumRunning == 0; });
+
+    return std::all_of(results.begin(), results.end(), [](Error err) { return err == Error::eNone; })
+        ? Error::eNone
+        : Error::eFailed;
+}
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Public
+ **********************************************************************************************************************/
+
+Error VerifySignature(
+    const std::vector<uint8_t>& publicKey, const std::vector<uint8_t>& data, const std::vector<uint8_t>& signature)
+{
+    auto pkey = ParsePublicKey(publicKey);
+    if (!pkey) {
+        return Error::eInvalidArgument;
+    }
+
+    return Verify(pkey.get(), data, signature);
+}
+
+Error VerifySignatures(const std::vector<SignatureItem>& items, std::vector<Error>& results, ThreadPool* pool)
+{
+    std::map<std::vector<uint8_t>, PKeyPtr> keys;
+    std::vector<EVP_PKEY*>                  itemKeys(items.size());
+
+    // Manifests are usually signed by a few keys: parse each of them once.
+    for (size_t i = 0; i < items.size(); i++) {
+        auto it = keys.find(items[i].mPublicKey);
+        if (it == keys.end()) {
+            it = keys.emplace(items[i].mPublicKey, ParsePublicKey(items[i].mPublicKey)).first;
+        }
+
+        itemKeys[i] = it->second.get();
+    }
+
+    return VerifyItems(
+        items.size(),
+        [&items, &itemKeys](size_t i) {
+            if (!itemKeys[i]) {
+                return Error::eInvalidArgument;
+            }
+
+            return Verify(itemKeys[i], items[i].mData, items[i].mSignature);
+        },
+        results, pool);
+}
+
+Error VerifySignatures(
+    const std::vector<SignatureItem>& items, std::vector<Error>& results, CryptoProviderItf& provider, ThreadPool* pool)
+{
+    return VerifyItems(
+        items.size(),
+        [&items, &provider](size_t i) {
+            return provider.Verify(items[i].mPublicKey, items[i].mData, items[i].mSignature);
+        },
+        results, pool);
+}
+
+} // namespace certhandler
+} // namespace iam
+} // namespace aos
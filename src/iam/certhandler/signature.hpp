@@ -0,0 +1,100 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SIGNATURE_HPP_
+#define SIGNATURE_HPP_
+
+#include <cstdint>
+#include <vector>
+
+#include "cryptoprovider.hpp"
+#include "error/error.hpp"
+#include "tools/threadpool.hpp"
+
+namespace aos {
+namespace iam {
+namespace certhandler {
+
+/** @addtogroup iam Identification and Access Manager
+ *  @{
+ */
+
+/**
+ * Verifies signature created by PrivateKeyItf::Sign. Signature scheme is selected by the public key type.
+ *
+ * @param publicKey public key in DER encoded SubjectPublicKeyInfo format.
+ * @param data signed data.
+ * @param signature signature.
+ * @return Error eNone if signature is valid.
+ */
+Error VerifySignature(
+    const std::vector<uint8_t>& publicKey, const std::vector<uint8_t>& data, const std::vector<uint8_t>& signature);
+
+/**
+ * Signed item of batch verification.
+ */
+struct SignatureItem {
+    /**
+     * Public key in DER encoded SubjectPublicKeyInfo format.
+     */
+    std::vector<uint8_t> mPublicKey;
+
+    /**
+     * Signed data.
+     */
+    std::vector<uint8_t> mData;
+
+    /**
+     * Signature.
+     */
+    std::vector<uint8_t> mSignature;
+};
+
+/**
+ * Verifies multiple signatures. Each distinct public key is parsed once, verification is spread across the pool
+ * threads and the calling thread. Only pool jobs which have started are waited for: jobs queued behind other work
+ * find no items left and return. Must not be called from a job of the same pool.
+ *
+ * @param items signed items.
+ * @param[out] results verification results in the order of items, see VerifySignature().
+ * @param pool thread pool, nullptr to verify in the calling thread.
+ * @return Error eFailed if any signature is not valid.
+ */
+Error VerifySignatures(
+    const std::vector<SignatureItem>& items, std::vector<Error>& results, ThreadPool* pool = nullptr);
+
+/**
+ * Verifies multiple signatures with the crypto provider. Each item is verified by CryptoProviderItf::Verify, public
+ * keys are not cached between items. Verification is spread across the pool threads and the calling thread. Must not
+ * be called from a job of the same pool.
+ *
+ * @param items signed items.
+ * @param[out] results verification results in the order of items, see CryptoProviderItf::Verify().
+ * @param provider crypto provider.
+ * @param pool thread pool, nullptr to verify in the calling thread.
+ * @return Error eFailed if any signature is not valid.
+ */
+Error VerifySignatures(const std::vector<SignatureItem>& items, std::vector<Error>& results,
+    CryptoProviderItf& provider, ThreadPool* pool = nullptr);
+
+/** @}*/
+
+} // namespace certhandler
+} // namespace iam
+} // namespace aos
+
+#endif
@@ -0,0 +1,56 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "swkeystorage.hpp"
+
+namespace aos {
+namespace iam {
+namespace certhandler {
+
+/***********************************************************************************************************************
+ * Public
+ **********************************************************************************************************************/
+
+SWKeyStorage::SWKeyStorage(size_t maxConcurrency, CryptoProviderItf& provider)
+    : mMaxConcurrency(maxConcurrency ? maxConcurrency : 1)
+    , mProvider(provider)
+{
+}
+
+Error SWKeyStorage::CreateKey(KeyAlgorithm algorithm, std::shared_ptr<PrivateKeyItf>& key)
+{
+    return mProvider.CreateKey(algorithm, key);
+}
+
+Error SWKeyStorage::DeleteKey(const std::shared_ptr<PrivateKeyItf>& key)
+{
+    if (!key) {
+        return Error::eInvalidArgument;
+    }
+
+    // Key material is kept in memory only and is wiped when the last reference is released.
+    return Error::eNone;
+}
+
+size_t SWKeyStorage::GetMaxConcurrency() const
+{
+    return mMaxConcurrency;
+}
+
+} // namespace certhandler
+} // namespace iam
+} // namespace aos
@@ -0,0 +1,81 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SWKEYSTORAGE_HPP_
+#define SWKEYSTORAGE_HPP_
+
+#include "cryptoprovider.hpp"
+#include "keystorage.hpp"
+
+namespace aos {
+namespace iam {
+namespace certhandler {
+
+/** @addtogroup iam Identification and Access Manager
+ *  @{
+ */
+
+/**
+ * Software key storage: keys are generated and kept in process memory. Key material is allocated by OpenSSL, not by
+ * the secure arena, see SecureArena.
+ */
+class SWKeyStorage : public KeyStorageItf {
+public:
+    /**
+     * Creates software key storage.
+     *
+     * @param maxConcurrency max number of parallel key operations.
+     * @param provider crypto provider used to generate keys.
+     */
+    explicit SWKeyStorage(size_t maxConcurrency = 1, CryptoProviderItf& provider = GetDefaultCryptoProvider());
+
+    /**
+     * Creates private key.
+     *
+     * @param algorithm key algorithm.
+     * @param[out] key created key.
+     * @return Error.
+     */
+    Error CreateKey(KeyAlgorithm algorithm, std::shared_ptr<PrivateKeyItf>& key) override;
+
+    /**
+     * Securely deletes key from the storage.
+     *
+     * @param key key to delete.
+     * @return Error.
+     */
+    Error DeleteKey(const std::shared_ptr<PrivateKeyItf>& key) override;
+
+    /**
+     * Returns max number of key operations the storage may run in parallel.
+     *
+     * @return size_t.
+     */
+    size_t GetMaxConcurrency() const override;
+
+private:
+    size_t             mMaxConcurrency;
+    CryptoProviderItf& mProvider;
+};
+
+/** @}*/
+
+} // namespace certhandler
+} // namespace iam
+} // namespace aos
+
+#endif
@@ -0,0 +1,159 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+
+#include "signature.hpp"
+#include "swkeystorage.hpp"
+
+using namespace aos;
+using namespace aos::iam::certhandler;
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+namespace {
+
+const std::vector<uint8_t> cData(256, 0x5a);
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Benchmarks
+ **********************************************************************************************************************/
+
+static void KeyGen(benchmark::State& state, KeyAlgorithm algorithm)
+{
+    SWKeyStorage storage;
+
+    for (auto _ : state) {
+        std::shared_ptr<PrivateKeyItf> key;
+
+        if (storage.CreateKey(algorithm, key) != Error::eNone) {
+            state.SkipWithError("create key failed");
+        }
+    }
+}
+
+static void Sign(benchmark::State& state, KeyAlgorithm algorithm)
+{
+    SWKeyStorage                   storage;
+    std::shared_ptr<PrivateKeyItf> key;
+    std::vector<uint8_t>           signature;
+
+    if (storage.CreateKey(algorithm, key) != Error::eNone) {
+        state.SkipWithError("create key failed");
+    }
+
+    for (auto _ : state) {
+        if (key->Sign(cData, signature) != Error::eNone) {
+            state.SkipWithError("sign failed");
+        }
+    }
+}
+
+static void Verify(benchmark::State& state, KeyAlgorithm algorithm)
+{
+    SWKeyStorage                   storage;
+    std::shared_ptr<PrivateKeyItf> key;
+    std::vector<uint8_t>           publicKey, signature;
+
+    if (storage.CreateKey(algorithm, key) != Error::eNone || key->GetPublicKey(publicKey) != Error::eNone
+        || key->Sign(cData, signature) != Error::eNone) {
+        state.SkipWithError("create signature failed");
+    }
+
+    for (auto _ : state) {
+        if (VerifySignature(publicKey, cData, signature) != Error::eNone) {
+            state.SkipWithError("verify failed");
+        }
+    }
+}
+
+// Desired state with many signed components: one by one verification vs batch verification.
+static void VerifyManifests(benchmark::State& state)
+{
+    constexpr size_t cNumItems   = 48;
+    constexpr size_t cNumSigners = 4;
+
+    SWKeyStorage               storage;
+    std::vector<SignatureItem> items;
+    std::vector<Error>         results;
+
+    for (size_t i = 0; i < cNumSigners; i++) {
+        std::shared_ptr<PrivateKeyItf> key;
+        std::vector<uint8_t>           publicKey;
+
+        if (storage.CreateKey(KeyAlgorithm::eECDSAP256, key) != Error::eNone
+            || key->GetPublicKey(publicKey) != Error::eNone) {
+            state.SkipWithError("create key failed");
+
+            return;
+        }
+
+        for (size_t j = 0; j < cNumItems / cNumSigners; j++) {
+            SignatureItem item {publicKey, cData, {}};
+
+            item.mData[0] = static_cast<uint8_t>(j);
+
+            if (key->Sign(item.mData, item.mSignature) != Error::eNone) {
+                state.SkipWithError("sign failed");
+
+                return;
+            }
+
+            items.push_back(item);
+        }
+    }
+
+    auto       numThreads = static_cast<size_t>(state.range(0));
+    ThreadPool pool(numThreads, cNumItems);
+
+    for (auto _ : state) {
+        if (numThreads == 0) {
+            for (const auto& item : items) {
+                benchmark::DoNotOptimize(VerifySignature(item.mPublicKey, item.mData, item.mSignature));
+            }
+        } else {
+            benchmark::DoNotOptimize(VerifySignatures(items, results, numThreads > 1 ? &pool : nullptr));
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * items.size());
+}
+
+#define KEY_ALGORITHM_BENCHMARK(func)                                                                                  \
+    BENCHMARK_CAPTURE(func, RSA2048, KeyAlgorithm::eRSA2048)->Unit(benchmark::kMicrosecond);                           \
+    BENCHMARK_CAPTURE(func, RSA3072, KeyAlgorithm::eRSA3072)->Unit(benchmark::kMicrosecond);                           \
+    BENCHMARK_CAPTURE(func, ECDSAP256, KeyAlgorithm::eECDSAP256)->Unit(benchmark::kMicrosecond);                       \
+    BENCHMARK_CAPTURE(func, ECDSAP384, KeyAlgorithm::eECDSAP384)->Unit(benchmark::kMicrosecond);                       \
+    BENCHMARK_CAPTURE(func, Ed25519, KeyAlgorithm::eEd25519)->Unit(benchmark::kMicrosecond)
+
+KEY_ALGORITHM_BENCHMARK(KeyGen);
+KEY_ALGORITHM_BENCHMARK(Sign);
+KEY_ALGORITHM_BENCHMARK(Verify);
+
+// 0: one by one, 1: batch in the calling thread, N: batch on N pool threads and the calling thread.
+BENCHMARK(VerifyManifests)
+    ->ArgName("threads")
+    ->Arg(0)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
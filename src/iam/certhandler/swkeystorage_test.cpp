@@ -0,0 +1,120 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include "signature.hpp"
+#include "swkeystorage.hpp"
+
+using namespace aos;
+using namespace aos::iam::certhandler;
+
+class SWKeyStorageTest : public testing::TestWithParam<KeyAlgorithm> { };
+
+TEST(swkeystorage, DeleteKey)
+{
+    SWKeyStorage storage(2);
+
+    EXPECT_EQ(storage.GetMaxConcurrency(), 2);
+
+    std::shared_ptr<PrivateKeyItf> key;
+
+    ASSERT_EQ(storage.CreateKey(KeyAlgorithm::eECDSAP256, key), Error::eNone);
+
+    EXPECT_EQ(storage.DeleteKey(key), Error::eNone);
+    EXPECT_EQ(storage.DeleteKey(nullptr), Error::eInvalidArgument);
+}
+
+TEST_P(SWKeyStorageTest, SignVerify)
+{
+    SWKeyStorage storage;
+
+    std::shared_ptr<PrivateKeyItf> key;
+
+    ASSERT_EQ(storage.CreateKey(GetParam(), key), Error::eNone);
+    ASSERT_NE(key, nullptr);
+    EXPECT_EQ(key->GetAlgorithm(), GetParam());
+
+    std::vector<uint8_t> publicKey;
+
+    ASSERT_EQ(key->GetPublicKey(publicKey), Error::eNone);
+    ASSERT_FALSE(publicKey.empty());
+    EXPECT_EQ(publicKey[0], 0x30);
+
+    std::vector<uint8_t> data = {'t', 'e', 's', 't'}, signature;
+
+    ASSERT_EQ(key->Sign(data, signature), Error::eNone);
+    EXPECT_EQ(VerifySignature(publicKey, data, signature), Error::eNone);
+
+    data[0] = 'T';
+
+    EXPECT_EQ(VerifySignature(publicKey, data, signature), Error::eFailed);
+    EXPECT_EQ(VerifySignature({0x30, 0x00}, data, signature), Error::eInvalidArgument);
+}
+
+TEST(swkeystorage, VerifySignatures)
+{
+    SWKeyStorage storage;
+    ThreadPool   pool(3, 8);
+
+    std::vector<SignatureItem> items;
+
+    for (auto algorithm : {KeyAlgorithm::eRSA2048, KeyAlgorithm::eECDSAP256, KeyAlgorithm::eEd25519}) {
+        std::shared_ptr<PrivateKeyItf> key;
+        std::vector<uint8_t>           publicKey;
+
+        ASSERT_EQ(storage.CreateKey(algorithm, key), Error::eNone);
+        ASSERT_EQ(key->GetPublicKey(publicKey), Error::eNone);
+
+        for (uint8_t i = 0; i < 4; i++) {
+            SignatureItem item {publicKey, {'i', 't', 'e', 'm', i}, {}};
+
+            ASSERT_EQ(key->Sign(item.mData, item.mSignature), Error::eNone);
+
+            items.push_back(item);
+        }
+    }
+
+    std::vector<Error> results;
+
+    EXPECT_EQ(VerifySignatures(items, results, &pool), Error::eNone);
+    EXPECT_EQ(results, std::vector<Error>(items.size(), Error::eNone));
+
+    // Wrong data, invalid key and wrong signature.
+    items[1].mData[0]   = 'I';
+    items[6].mPublicKey = {0x30, 0x00};
+
+    items[11].mSignature.back() ^= 0x01;
+
+    for (auto usePool : {false, true}) {
+        EXPECT_EQ(VerifySignatures(items, results, usePool ? &pool : nullptr), Error::eFailed);
+        ASSERT_EQ(results.size(), items.size());
+
+        for (size_t i = 0; i < items.size(); i++) {
+            auto expected = i == 1 || i == 11 ? Error::eFailed : (i == 6 ? Error::eInvalidArgument : Error::eNone);
+
+            EXPECT_EQ(results[i], expected) << i;
+        }
+    }
+
+    EXPECT_EQ(VerifySignatures({}, results, &pool), Error::eNone);
+    EXPECT_TRUE(results.empty());
+}
+
+INSTANTIATE_TEST_SUITE_P(swkeystorage, SWKeyStorageTest,
+    testing::Values(KeyAlgorithm::eRSA2048, KeyAlgorithm::eRSA3072, KeyAlgorithm::eECDSAP256, KeyAlgorithm::eECDSAP384,
+        KeyAlgorithm::eEd25519));
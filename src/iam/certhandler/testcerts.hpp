@@ -0,0 +1,231 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TESTCERTS_HPP_
+#define TESTCERTS_HPP_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <ftw.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+#include <openssl/x509v3.h>
+
+namespace aos {
+namespace iam {
+namespace certhandler {
+namespace test {
+
+/**
+ * Test key.
+ */
+using TestKeyPtr = std::shared_ptr<EVP_PKEY>;
+
+/**
+ * Test certificate parameters.
+ */
+struct TestCertParams {
+    std::string mSubject   = "test";
+    std::string mIssuer    = "test";
+    long        mSerial    = 1;
+    long        mNotBefore = -1;
+    long        mNotAfter  = 365;
+    bool        mCA        = false;
+};
+
+/**
+ * Generates P-256 test key.
+ *
+ * @return TestKeyPtr.
+ */
+inline TestKeyPtr GenerateTestKey()
+{
+    return TestKeyPtr(EVP_EC_gen("P-256"), EVP_PKEY_free);
+}
+
+/**
+ * Creates DER test certificate. Validity is set in days relative to the current time.
+ *
+ * @param params certificate parameters.
+ * @param key certificate key.
+ * @param issuerKey issuer key, self signed if null.
+ * @return std::vector<uint8_t>.
+ */
+inline std::vector<uint8_t> CreateTestCert(const TestCertParams& params, EVP_PKEY* key, EVP_PKEY* issuerKey = nullptr)
+{
+    std::unique_ptr<X509, decltype(&X509_free)> cert(X509_new(), X509_free);
+
+    X509_set_version(cert.get(), X509_VERSION_3);
+    ASN1_INTEGER_set(X509_get_serialNumber(cert.get()), params.mSerial);
+    X509_gmtime_adj(X509_getm_notBefore(cert.get()), params.mNotBefore * 24 * 3600);
+    X509_gmtime_adj(X509_getm_notAfter(cert.get()), params.mNotAfter * 24 * 3600);
+    X509_set_pubkey(cert.get(), key);
+
+    X509_NAME_add_entry_by_txt(X509_get_subject_name(cert.get()), "CN", MBSTRING_ASC,
+        reinterpret_cast<const unsigned char*>(params.mSubject.c_str()), -1, -1, 0);
+    X509_NAME_add_entry_by_txt(X509_get_issuer_name(cert.get()), "CN", MBSTRING_ASC,
+        reinterpret_cast<const unsigned char*>(params.mIssuer.c_str()), -1, -1, 0);
+
+    X509V3_CTX ctx;
+
+    X509V3_set_ctx_nodb(&ctx);
+    X509V3_set_ctx(&ctx, cert.get(), cert.get(), nullptr, nullptr, 0);
+    X509V3_set_issuer_pkey(&ctx, issuerKey ? issuerKey : key);
+
+    const char* extensions[][2] = {
+        {"subjectKeyIdentifier", "hash"},
+        {"authorityKeyIdentifier", "keyid"},
+        {"basicConstraints", params.mCA ? "critical,CA:TRUE" : "CA:FALSE"},
+    };
+
+    for (const auto& extension : extensions) {
+        auto ext = X509V3_EXT_conf(nullptr, &ctx, extension[0], extension[1]);
+
+        X509_add_ext(cert.get(), ext, -1);
+        X509_EXTENSION_free(ext);
+    }
+
+    X509_sign(cert.get(), issuerKey ? issuerKey : key, EVP_sha256());
+
+    unsigned char* data = nullptr;
+    int            size = i2d_X509(cert.get(), &data);
+
+    std::vector<uint8_t> der(data, data + size);
+
+    OPENSSL_free(data);
+
+    return der;
+}
+
+/**
+ * Creates DER test CRL. This and next updates are set in days relative to the current time.
+ *
+ * @param issuer issuer common name.
+ * @param issuerKey issuer key.
+ * @param revokedSerials revoked certificate serials.
+ * @param nextUpdate next update.
+ * @param thisUpdate this update.
+ * @param number CRL number, the extension is not added if negative.
+ * @return std::vector<uint8_t>.
+ */
+inline std::vector<uint8_t> CreateTestCRL(const std::string& issuer, EVP_PKEY* issuerKey,
+    const std::vector<long>& revokedSerials, long nextUpdate = 7, long thisUpdate = -1, long number = -1)
+{
+    std::unique_ptr<X509_CRL, decltype(&X509_CRL_free)>   crl(X509_CRL_new(), X509_CRL_free);
+    std::unique_ptr<X509_NAME, decltype(&X509_NAME_free)> name(X509_NAME_new(), X509_NAME_free);
+    std::unique_ptr<ASN1_TIME, decltype(&ASN1_TIME_free)> time(ASN1_TIME_new(), ASN1_TIME_free);
+
+    X509_NAME_add_entry_by_txt(
+        name.get(), "CN", MBSTRING_ASC, reinterpret_cast<const unsigned char*>(issuer.c_str()), -1, -1, 0);
+
+    X509_CRL_set_version(crl.get(), X509_CRL_VERSION_2);
+    X509_CRL_set_issuer_name(crl.get(), name.get());
+
+    X509_gmtime_adj(time.get(), thisUpdate * 24 * 3600);
+    X509_CRL_set1_lastUpdate(crl.get(), time.get());
+    X509_gmtime_adj(time.get(), nextUpdate * 24 * 3600);
+    X509_CRL_set1_nextUpdate(crl.get(), time.get());
+
+    for (auto serial : revokedSerials) {
+        auto revoked = X509_REVOKED_new();
+        auto number  = ASN1_INTEGER_new();
+
+        X509_gmtime_adj(time.get(), -3600);
+        ASN1_INTEGER_set(number, serial);
+        X509_REVOKED_set_serialNumber(revoked, number);
+        X509_REVOKED_set_revocationDate(revoked, time.get());
+        X509_CRL_add0_revoked(crl.get(), revoked);
+        ASN1_INTEGER_free(number);
+    }
+
+    if (number >= 0) {
+        auto value = ASN1_INTEGER_new();
+
+        ASN1_INTEGER_set(value, number);
+        X509_CRL_add1_ext_i2d(crl.get(), NID_crl_number, value, 0, 0);
+        ASN1_INTEGER_free(value);
+    }
+
+    X509_CRL_sort(crl.get());
+    X509_CRL_sign(crl.get(), issuerKey, EVP_sha256());
+
+    unsigned char* data = nullptr;
+    int            size = i2d_X509_CRL(crl.get(), &data);
+
+    std::vector<uint8_t> der(data, data + size);
+
+    OPENSSL_free(data);
+
+    return der;
+}
+
+/**
+ * Converts DER certificate to PEM.
+ *
+ * @param der DER certificate.
+ * @return std::string.
+ */
+inline std::string ConvertToPEM(const std::vector<uint8_t>& der)
+{
+    std::unique_ptr<BIO, decltype(&BIO_free)> bio(BIO_new(BIO_s_mem()), BIO_free);
+
+    PEM_write_bio(bio.get(), PEM_STRING_X509, "", der.data(), static_cast<long>(der.size()));
+
+    char* data = nullptr;
+    long  size = BIO_get_mem_data(bio.get(), &data);
+
+    return std::string(data, size);
+}
+
+/**
+ * Temporary directory removed on destruction.
+ */
+class TempDir {
+public:
+    TempDir()
+    {
+        char path[] = "/tmp/aos_test_XXXXXX";
+
+        mPath = mkdtemp(path);
+    }
+
+    ~TempDir()
+    {
+        nftw(
+            mPath.c_str(), [](const char* path, const struct stat*, int, struct FTW*) { return remove(path); }, 16,
+            FTW_DEPTH | FTW_PHYS);
+    }
+
+    const std::string& GetPath() const { return mPath; }
+
+private:
+    std::string mPath;
+};
+
+} // namespace test
+} // namespace certhandler
+} // namespace iam
+} // namespace aos
+
+#endif
@@ -0,0 +1,104 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef TLSCREDENTIALS_HPP_
+#define TLSCREDENTIALS_HPP_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <openssl/x509.h>
+
+#include "tools/rcu.hpp"
+
+#include "certstorage.hpp"
+#include "keystorage.hpp"
+#include "truststore.hpp"
+
+namespace aos {
+namespace iam {
+namespace certhandler {
+
+/** @addtogroup iam Identification and Access Manager
+ *  @{
+ */
+
+/**
+ * Ready to use TLS credentials of a certificate type: parsed certificate chain and the key handle.
+ */
+struct TLSCredentials {
+    /**
+     * Leaf certificate info.
+     */
+    CertInfo mInfo;
+
+    /**
+     * DER encoded certificate chain, leaf first.
+     */
+    CertChain mChainDER;
+
+    /**
+     * Parsed certificate chain, leaf first.
+     */
+    std::vector<std::shared_ptr<X509>> mChain;
+
+    /**
+     * Private key of the leaf certificate.
+     */
+    std::shared_ptr<PrivateKeyItf> mKey;
+
+    /**
+     * Number of credentials published for the certificate type, starts from 1.
+     */
+    uint64_t mGeneration = 0;
+};
+
+/**
+ * TLS credentials slot of a certificate type. TLS servers and clients keep the slot and load credentials for each new
+ * connection: loading takes no locks as credentials are published through RCU, renewed credentials replace the current
+ * ones and the previous holder is freed after a grace period. Publishing must not be done inside a read side critical
+ * section.
+ */
+class TLSCredentialsSlot {
+public:
+    /**
+     * Returns current credentials.
+     *
+     * @return std::shared_ptr<const TLSCredentials> null if no credentials are published yet.
+     */
+    std::shared_ptr<const TLSCredentials> Load() const { return mCredentials.Load(); }
+
+    /**
+     * Publishes credentials. Connections which already loaded the previous credentials keep using them.
+     *
+     * @param credentials credentials.
+     */
+    void Publish(std::shared_ptr<const TLSCredentials> credentials) { mCredentials.Store(std::move(credentials)); }
+
+private:
+    rcu::SharedPtr<const TLSCredentials> mCredentials;
+};
+
+/** @}*/
+
+} // namespace certhandler
+} // namespace iam
+} // namespace aos
+
+#endif
@@ -0,0 +1,718 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <algorithm>
+#include <mutex>
+
+#include <openssl/bn.h>
+#include <openssl/core_names.h>
+#include <openssl/ec.h>
+#include <openssl/evp.h>
+#include <openssl/param_build.h>
+#include <openssl/x509.h>
+
+#include <tss2/tss2_esys.h>
+#include <tss2/tss2_mu.h>
+#include <tss2/tss2_tctildr.h>
+
+#include "tpmkeystorage.hpp"
+
+namespace aos {
+namespace iam {
+namespace certhandler {
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+namespace {
+
+constexpr uint32_t cRSAExponent = 65537;
+
+Error ConvertError(TSS2_RC rc)
+{
+    if (rc == TSS2_RC_SUCCESS) {
+        return Error::eNone;
+    }
+
+    // TPM response codes have no layer bits, TSS codes carry the layer of the failed component.
+    if ((rc & TSS2_RC_LAYER_MASK) == TSS2_TPM_RC_LAYER) {
+        switch (rc) {
+        case TPM2_RC_OBJECT_MEMORY:
+        case TPM2_RC_SESSION_MEMORY:
+        case TPM2_RC_MEMORY:
+            return Error::eNoMemory;
+
+        default:
+            return Error::eFailed;
+        }
+    }
+
+    switch (rc & ~TSS2_RC_LAYER_MASK) {
+    case TSS2_BASE_RC_MEMORY:
+        return Error::eNoMemory;
+
+    case TSS2_BASE_RC_BAD_REFERENCE:
+    case TSS2_BASE_RC_BAD_VALUE:
+    case TSS2_BASE_RC_INSUFFICIENT_BUFFER:
+        return Error::eInvalidArgument;
+
+    default:
+        return Error::eFailed;
+    }
+}
+
+bool IsECDSA(KeyAlgorithm algorithm)
+{
+    return algorithm == KeyAlgorithm::eECDSAP256 || algorithm == KeyAlgorithm::eECDSAP384;
+}
+
+// Unrestricted signing key template, signing scheme is selected per operation.
+Error CreateKeyTemplate(KeyAlgorithm algorithm, TPM2B_PUBLIC& keyTemplate)
+{
+    auto& area = keyTemplate.publicArea;
+
+    keyTemplate = TPM2B_PUBLIC();
+
+    area.nameAlg          = TPM2_ALG_SHA256;
+    area.objectAttributes = TPMA_OBJECT_SIGN_ENCRYPT | TPMA_OBJECT_FIXEDTPM | TPMA_OBJECT_FIXEDPARENT
+        | TPMA_OBJECT_SENSITIVEDATAORIGIN | TPMA_OBJECT_USERWITHAUTH;
+
+    switch (algorithm) {
+    case KeyAlgorithm::eRSA2048:
+    case KeyAlgorithm::eRSA3072:
+        area.type                                     = TPM2_ALG_RSA;
+        area.parameters.rsaDetail.symmetric.algorithm = TPM2_ALG_NULL;
+        area.parameters.rsaDetail.scheme.scheme       = TPM2_ALG_NULL;
+        area.parameters.rsaDetail.keyBits             = algorithm == KeyAlgorithm::eRSA2048 ? 2048 : 3072;
+        break;
+
+    case KeyAlgorithm::eECDSAP256:
+    case KeyAlgorithm::eECDSAP384: {
+        auto curve = algorithm == KeyAlgorithm::eECDSAP256 ? TPM2_ECC_NIST_P256 : TPM2_ECC_NIST_P384;
+
+        area.type                                     = TPM2_ALG_ECC;
+        area.parameters.eccDetail.symmetric.algorithm = TPM2_ALG_NULL;
+        area.parameters.eccDetail.scheme.scheme       = TPM2_ALG_NULL;
+        area.parameters.eccDetail.curveID             = curve;
+        area.parameters.eccDetail.kdf.scheme          = TPM2_ALG_NULL;
+        break;
+    }
+
+    default:
+        return Error::eInvalidArgument;
+    }
+
+    return Error::eNone;
+}
+
+// Deterministic storage primary key: the same key is recreated from the owner seed, so key blobs survive restarts.
+TPM2B_PUBLIC CreatePrimaryTemplate()
+{
+    TPM2B_PUBLIC primaryTemplate = TPM2B_PUBLIC();
+    auto&        area            = primaryTemplate.publicArea;
+
+    area.type             = TPM2_ALG_ECC;
+    area.nameAlg          = TPM2_ALG_SHA256;
+    area.objectAttributes = TPMA_OBJECT_RESTRICTED | TPMA_OBJECT_DECRYPT | TPMA_OBJECT_FIXEDTPM
+        | TPMA_OBJECT_FIXEDPARENT | TPMA_OBJECT_SENSITIVEDATAORIGIN | TPMA_OBJECT_USERWITHAUTH;
+
+    area.parameters.eccDetail.symmetric.algorithm   = TPM2_ALG_AES;
+    area.parameters.eccDetail.symmetric.keyBits.aes = 128;
+    area.parameters.eccDetail.symmetric.mode.aes    = TPM2_ALG_CFB;
+    area.parameters.eccDetail.scheme.scheme         = TPM2_ALG_NULL;
+    area.parameters.eccDetail.curveID               = TPM2_ECC_NIST_P256;
+    area.parameters.eccDetail.kdf.scheme            = TPM2_ALG_NULL;
+
+    return primaryTemplate;
+}
+
+Error MarshalBlob(const TPM2B_PRIVATE& tpmPrivate, const TPM2B_PUBLIC& tpmPublic, std::vector<uint8_t>& blob)
+{
+    size_t offset = 0;
+
+    blob.resize(sizeof(TPM2B_PRIVATE) + sizeof(TPM2B_PUBLIC));
+
+    auto rc = Tss2_MU_TPM2B_PRIVATE_Marshal(&tpmPrivate, blob.data(), blob.size(), &offset);
+    if (rc == TSS2_RC_SUCCESS) {
+        rc = Tss2_MU_TPM2B_PUBLIC_Marshal(&tpmPublic, blob.data(), blob.size(), &offset);
+    }
+
+    blob.resize(offset);
+
+    return ConvertError(rc);
+}
+
+Error UnmarshalBlob(const std::vector<uint8_t>& blob, TPM2B_PRIVATE& tpmPrivate, TPM2B_PUBLIC& tpmPublic)
+{
+    size_t offset = 0;
+
+    tpmPrivate = TPM2B_PRIVATE();
+    tpmPublic  = TPM2B_PUBLIC();
+
+    if (Tss2_MU_TPM2B_PRIVATE_Unmarshal(blob.data(), blob.size(), &offset, &tpmPrivate) != TSS2_RC_SUCCESS
+        || Tss2_MU_TPM2B_PUBLIC_Unmarshal(blob.data(), blob.size(), &offset, &tpmPublic) != TSS2_RC_SUCCESS
+        || offset != blob.size()) {
+        return Error::eInvalidArgument;
+    }
+
+    return Error::eNone;
+}
+
+// Copies big endian TPM parameter right aligned into the fixed size field.
+void CopyParameter(const uint8_t* data, size_t size, uint8_t* field, size_t fieldSize)
+{
+    size = std::min(size, fieldSize);
+
+    std::copy_n(data, size, field + fieldSize - size);
+}
+
+// Converts TPM public area to DER encoded SubjectPublicKeyInfo.
+Error ConvertPublicKey(const TPM2B_PUBLIC& tpmPublic, KeyAlgorithm& algorithm, std::vector<uint8_t>& der)
+{
+    const auto& area = tpmPublic.publicArea;
+
+    std::unique_ptr<OSSL_PARAM_BLD, decltype(&OSSL_PARAM_BLD_free)> builder(OSSL_PARAM_BLD_new(), OSSL_PARAM_BLD_free);
+    std::unique_ptr<BIGNUM, decltype(&BN_free)>                     n(nullptr, BN_free), e(nullptr, BN_free);
+    std::vector<uint8_t>                                            point;
+    const char*                                                     type = "EC";
+
+    if (!builder) {
+        return Error::eNoMemory;
+    }
+
+    if (area.type == TPM2_ALG_ECC) {
+        const char* curve = nullptr;
+        size_t      size  = 0;
+
+        switch (area.parameters.eccDetail.curveID) {
+        case TPM2_ECC_NIST_P256:
+            algorithm = KeyAlgorithm::eECDSAP256;
+            curve     = "prime256v1";
+            size      = 32;
+            break;
+
+        case TPM2_ECC_NIST_P384:
+            algorithm = KeyAlgorithm::eECDSAP384;
+            curve     = "secp384r1";
+            size      = 48;
+            break;
+
+        default:
+            return Error::eInvalidArgument;
+        }
+
+        // Uncompressed point.
+        point.assign(1 + 2 * size, 0);
+        point[0] = 0x04;
+
+        CopyParameter(area.unique.ecc.x.buffer, area.unique.ecc.x.size, &point[1], size);
+        CopyParameter(area.unique.ecc.y.buffer, area.unique.ecc.y.size, &point[1 + size], size);
+
+        if (!OSSL_PARAM_BLD_push_utf8_string(builder.get(), OSSL_PKEY_PARAM_GROUP_NAME, curve, 0)
+            || !OSSL_PARAM_BLD_push_octet_string(builder.get(), OSSL_PKEY_PARAM_PUB_KEY, point.data(), point.size())) {
+            return Error::eNoMemory;
+        }
+    } else if (area.type == TPM2_ALG_RSA) {
+        switch (area.parameters.rsaDetail.keyBits) {
+        case 2048:
+            algorithm = KeyAlgorithm::eRSA2048;
+            break;
+
+        case 3072:
+            algorithm = KeyAlgorithm::eRSA3072;
+            break;
+
+        default:
+            return Error::eInvalidArgument;
+        }
+
+        // Zero exponent stands for the default one.
+        auto exponent = area.parameters.rsaDetail.exponent ? area.parameters.rsaDetail.exponent : cRSAExponent;
+
+        type = "RSA";
+        n.reset(BN_bin2bn(area.unique.rsa.buffer, area.unique.rsa.size, nullptr));
+        e.reset(BN_new());
+
+        if (!n || !e || !BN_set_word(e.get(), exponent)
+            || !OSSL_PARAM_BLD_push_BN(builder.get(), OSSL_PKEY_PARAM_RSA_N, n.get())
+            || !OSSL_PARAM_BLD_push_BN(builder.get(), OSSL_PKEY_PARAM_RSA_E, e.get())) {
+            return Error::eNoMemory;
+        }
+    } else {
+        return Error::eInvalidArgument;
+    }
+
+    std::unique_ptr<OSSL_PARAM, decltype(&OSSL_PARAM_free)> params(
+        OSSL_PARAM_BLD_to_param(builder.get()), OSSL_PARAM_free);
+    std::unique_ptr<EVP_PKEY_CTX, decltype(&EVP_PKEY_CTX_free)> ctx(
+        EVP_PKEY_CTX_new_from_name(nullptr, type, nullptr), EVP_PKEY_CTX_free);
+    EVP_PKEY* pkey = nullptr;
+
+    if (!params || !ctx) {
+        return Error::eNoMemory;
+    }
+
+    if (EVP_PKEY_fromdata_init(ctx.get()) <= 0
+        || EVP_PKEY_fromdata(ctx.get(), &pkey, EVP_PKEY_PUBLIC_KEY, params.get()) <= 0) {
+        return Error::eFailed;
+    }
+
+    std::unique_ptr<EVP_PKEY, decltype(&EVP_PKEY_free)> key(pkey, EVP_PKEY_free);
+
+    auto size = i2d_PUBKEY(key.get(), nullptr);
+    if (size <= 0) {
+        return Error::eFailed;
+    }
+
+    der.resize(size);
+
+    auto data = der.data();
+
+    return i2d_PUBKEY(key.get(), &data) == size ? Error::eNone : Error::eFailed;
+}
+
+// Converts TPM ECDSA signature to DER.
+Error ConvertECDSASignature(const TPMS_SIGNATURE_ECDSA& ecdsa, std::vector<uint8_t>& signature)
+{
+    std::unique_ptr<ECDSA_SIG, decltype(&ECDSA_SIG_free)> sig(ECDSA_SIG_new(), ECDSA_SIG_free);
+
+    auto r = BN_bin2bn(ecdsa.signatureR.buffer, ecdsa.signatureR.size, nullptr);
+    auto s = BN_bin2bn(ecdsa.signatureS.buffer, ecdsa.signatureS.size, nullptr);
+
+    if (!sig || !r || !s || ECDSA_SIG_set0(sig.get(), r, s) != 1) {
+        BN_free(r);
+        BN_free(s);
+
+        return Error::eNoMemory;
+    }
+
+    auto size = i2d_ECDSA_SIG(sig.get(), nullptr);
+    if (size <= 0) {
+        return Error::eFailed;
+    }
+
+    signature.resize(size);
+
+    auto data = signature.data();
+
+    return i2d_ECDSA_SIG(sig.get(), &data) == size ? Error::eNone : Error::eFailed;
+}
+
+} // namespace
+
+/***********************************************************************************************************************
+ * TPMState
+ **********************************************************************************************************************/
+
+// ESAPI context is not thread safe: all calls are made under the mutex.
+struct TPMState : public TPMObjectContextItf {
+    ~TPMState()
+    {
+        mCache.reset();
+
+        if (mSession != ESYS_TR_NONE) {
+            Esys_FlushContext(mContext, mSession);
+        }
+
+        if (mPrimary != ESYS_TR_NONE) {
+            Esys_FlushContext(mContext, mPrimary);
+        }
+
+        if (mContext) {
+            Esys_Finalize(&mContext);
+        }
+
+        if (mTCTI) {
+            Tss2_TctiLdr_Finalize(&mTCTI);
+        }
+    }
+
+    Error Load(const std::vector<uint8_t>& blob, TPMHandle& handle) override
+    {
+        TPM2B_PRIVATE tpmPrivate;
+        TPM2B_PUBLIC  tpmPublic;
+
+        auto err = UnmarshalBlob(blob, tpmPrivate, tpmPublic);
+        if (err != Error::eNone) {
+            return err;
+        }
+
+        ESYS_TR object = ESYS_TR_NONE;
+
+        auto rc = Esys_Load(mContext, mPrimary, mSession, ESYS_TR_NONE, ESYS_TR_NONE, &tpmPrivate, &tpmPublic, &object);
+        if (rc != TSS2_RC_SUCCESS) {
+            return ConvertError(rc);
+        }
+
+        handle = object;
+
+        return Error::eNone;
+    }
+
+    Error ContextSave(TPMHandle handle, std::vector<uint8_t>& context) override
+    {
+        TPMS_CONTEXT* saved = nullptr;
+
+        auto rc = Esys_ContextSave(mContext, handle, &saved);
+        if (rc != TSS2_RC_SUCCESS) {
+            return ConvertError(rc);
+        }
+
+        size_t offset = 0;
+
+        context.resize(sizeof(TPMS_CONTEXT));
+
+        rc = Tss2_MU_TPMS_CONTEXT_Marshal(saved, context.data(), context.size(), &offset);
+
+        context.resize(offset);
+        Esys_Free(saved);
+
+        return ConvertError(rc);
+    }
+
+    Error ContextLoad(const std::vector<uint8_t>& context, TPMHandle& handle) override
+    {
+        TPMS_CONTEXT saved  = TPMS_CONTEXT();
+        size_t       offset = 0;
+
+        if (Tss2_MU_TPMS_CONTEXT_Unmarshal(context.data(), context.size(), &offset, &saved) != TSS2_RC_SUCCESS) {
+            return Error::eInvalidArgument;
+        }
+
+        ESYS_TR object = ESYS_TR_NONE;
+
+        auto rc = Esys_ContextLoad(mContext, &saved, &object);
+        if (rc != TSS2_RC_SUCCESS) {
+            return ConvertError(rc);
+        }
+
+        handle = object;
+
+        return Error::eNone;
+    }
+
+    Error Flush(TPMHandle handle) override { return ConvertError(Esys_FlushContext(mContext, handle)); }
+
+    Error Connect(const TPMConfig& config)
+    {
+        auto rc = Tss2_TctiLdr_Initialize(config.mTCTI.empty() ? nullptr : config.mTCTI.c_str(), &mTCTI);
+        if (rc != TSS2_RC_SUCCESS) {
+            return ConvertError(rc);
+        }
+
+        if ((rc = Esys_Initialize(&mContext, mTCTI, nullptr)) != TSS2_RC_SUCCESS) {
+            return ConvertError(rc);
+        }
+
+        // Simulators may be powered on without startup, already started TPM returns TPM2_RC_INITIALIZE.
+        rc = Esys_Startup(mContext, TPM2_SU_CLEAR);
+        if (rc != TSS2_RC_SUCCESS && rc != TPM2_RC_INITIALIZE) {
+            return ConvertError(rc);
+        }
+
+        TPM2B_SENSITIVE_CREATE sensitive       = TPM2B_SENSITIVE_CREATE();
+        TPM2B_PUBLIC           primaryTemplate = CreatePrimaryTemplate();
+        TPM2B_DATA             outsideInfo     = TPM2B_DATA();
+        TPML_PCR_SELECTION     pcrSelection    = TPML_PCR_SELECTION();
+
+        rc = Esys_CreatePrimary(mContext, ESYS_TR_RH_OWNER, ESYS_TR_PASSWORD, ESYS_TR_NONE, ESYS_TR_NONE, &sensitive,
+            &primaryTemplate, &outsideInfo, &pcrSelection, &mPrimary, nullptr, nullptr, nullptr, nullptr);
+        if (rc != TSS2_RC_SUCCESS) {
+            return ConvertError(rc);
+        }
+
+        // One salted HMAC session is reused by all commands instead of password authorization or a session per
+        // command. Command parameters, e.g. key blobs, are encrypted.
+        TPMT_SYM_DEF symmetric = TPMT_SYM_DEF();
+
+        symmetric.algorithm   = TPM2_ALG_AES;
+        symmetric.keyBits.aes = 128;
+        symmetric.mode.aes    = TPM2_ALG_CFB;
+
+        rc = Esys_StartAuthSession(mContext, mPrimary, ESYS_TR_NONE, ESYS_TR_NONE, ESYS_TR_NONE, ESYS_TR_NONE, nullptr,
+            TPM2_SE_HMAC, &symmetric, TPM2_ALG_SHA256, &mSession);
+        if (rc != TSS2_RC_SUCCESS) {
+            return ConvertError(rc);
+        }
+
+        return ConvertError(Esys_TRSess_SetAttributes(
+            mContext, mSession, TPMA_SESSION_CONTINUESESSION | TPMA_SESSION_DECRYPT, 0xff));
+    }
+
+    std::mutex                      mMutex;
+    TSS2_TCTI_CONTEXT*              mTCTI = nullptr;
+    ESYS_CONTEXT*                   mContext = nullptr;
+    ESYS_TR                         mPrimary = ESYS_TR_NONE;
+    ESYS_TR                         mSession = ESYS_TR_NONE;
+    std::unique_ptr<TPMObjectCache> mCache;
+    uint64_t                        mNextID = 1;
+};
+
+/***********************************************************************************************************************
+ * TPMPrivateKey
+ **********************************************************************************************************************/
+
+namespace {
+
+class TPMPrivateKey : public PrivateKeyItf {
+public:
+    TPMPrivateKey(std::shared_ptr<TPMState> state, uint64_t id, KeyAlgorithm algorithm,
+        const std::vector<uint8_t>& blob, const std::vector<uint8_t>& publicKey)
+        : mState(std::move(state))
+        , mID(id)
+        , mAlgorithm(algorithm)
+        , mBlob(blob)
+        , mPublicKey(publicKey)
+    {
+    }
+
+    ~TPMPrivateKey()
+    {
+        std::lock_guard<std::mutex> lock(mState->mMutex);
+
+        mState->mCache->Remove(mID);
+    }
+
+    KeyAlgorithm GetAlgorithm() const override { return mAlgorithm; }
+
+    Error GetPublicKey(std::vector<uint8_t>& der) const override
+    {
+        der = mPublicKey;
+
+        return Error::eNone;
+    }
+
+    Error Sign(const std::vector<uint8_t>& data, std::vector<uint8_t>& signature) const override
+    {
+        auto isP384  = mAlgorithm == KeyAlgorithm::eECDSAP384;
+        auto hashAlg = isP384 ? TPM2_ALG_SHA384 : TPM2_ALG_SHA256;
+
+        TPM2B_DIGEST digest = TPM2B_DIGEST();
+        unsigned int size   = 0;
+
+        if (EVP_Digest(data.data(), data.size(), digest.buffer, &size, isP384 ? EVP_sha384() : EVP_sha256(), nullptr)
+            != 1) {
+            return Error::eFailed;
+        }
+
+        digest.size = static_cast<UINT16>(size);
+
+        TPMT_SIG_SCHEME   scheme     = TPMT_SIG_SCHEME();
+        TPMT_TK_HASHCHECK validation = TPMT_TK_HASHCHECK();
+        TPMT_SIGNATURE*   result     = nullptr;
+
+        scheme.scheme              = IsECDSA(mAlgorithm) ? TPM2_ALG_ECDSA : TPM2_ALG_RSASSA;
+        scheme.details.any.hashAlg = hashAlg;
+        validation.tag             = TPM2_ST_HASHCHECK;
+        validation.hierarchy       = TPM2_RH_NULL;
+
+        {
+            std::lock_guard<std::mutex> lock(mState->mMutex);
+
+            TPMHandle handle = 0;
+
+            auto err = mState->mCache->Get(mID, handle);
+            if (err != Error::eNone) {
+                return err;
+            }
+
+            auto rc = Esys_Sign(mState->mContext, handle, mState->mSession, ESYS_TR_NONE, ESYS_TR_NONE, &digest,
+                &scheme, &validation, &result);
+            if (rc != TSS2_RC_SUCCESS) {
+                return ConvertError(rc);
+            }
+        }
+
+        std::unique_ptr<TPMT_SIGNATURE, decltype(&Esys_Free)> signatureHolder(result, Esys_Free);
+
+        if (IsECDSA(mAlgorithm)) {
+            return ConvertECDSASignature(result->signature.ecdsa, signature);
+        }
+
+        signature.assign(result->signature.rsassa.sig.buffer,
+            result->signature.rsassa.sig.buffer + result->signature.rsassa.sig.size);
+
+        return Error::eNone;
+    }
+
+    const std::shared_ptr<TPMState>& GetState() const { return mState; }
+    uint64_t                                     GetID() const { return mID; }
+    const std::vector<uint8_t>&                  GetBlob() const { return mBlob; }
+
+private:
+    std::shared_ptr<TPMState> mState;
+    uint64_t                              mID;
+    KeyAlgorithm                          mAlgorithm;
+    std::vector<uint8_t>                  mBlob;
+    std::vector<uint8_t>                  mPublicKey;
+};
+
+} // namespace
+
+/***********************************************************************************************************************
+ * TPMKeyStorage
+ **********************************************************************************************************************/
+
+Error TPMKeyStorage::Init(const TPMConfig& config)
+{
+    auto state = std::make_shared<TPMState>();
+
+    auto err = state->Connect(config);
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    state->mCache.reset(new TPMObjectCache(*state, config.mMaxLoadedObjects));
+
+    mState = std::move(state);
+
+    return Error::eNone;
+}
+
+Error TPMKeyStorage::CreateKey(KeyAlgorithm algorithm, std::shared_ptr<PrivateKeyItf>& key)
+{
+    if (!mState) {
+        return Error::eWrongState;
+    }
+
+    TPM2B_PUBLIC keyTemplate;
+
+    auto err = CreateKeyTemplate(algorithm, keyTemplate);
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    TPM2B_SENSITIVE_CREATE sensitive    = TPM2B_SENSITIVE_CREATE();
+    TPM2B_DATA             outsideInfo  = TPM2B_DATA();
+    TPML_PCR_SELECTION     pcrSelection = TPML_PCR_SELECTION();
+    TPM2B_PRIVATE*         tpmPrivate   = nullptr;
+    TPM2B_PUBLIC*          tpmPublic    = nullptr;
+
+    {
+        std::lock_guard<std::mutex> lock(mState->mMutex);
+
+        auto rc = Esys_Create(mState->mContext, mState->mPrimary, mState->mSession, ESYS_TR_NONE, ESYS_TR_NONE,
+            &sensitive, &keyTemplate, &outsideInfo, &pcrSelection, &tpmPrivate, &tpmPublic, nullptr, nullptr, nullptr);
+        if (rc != TSS2_RC_SUCCESS) {
+            return ConvertError(rc);
+        }
+    }
+
+    std::unique_ptr<TPM2B_PRIVATE, decltype(&Esys_Free)> privateHolder(tpmPrivate, Esys_Free);
+    std::unique_ptr<TPM2B_PUBLIC, decltype(&Esys_Free)>  publicHolder(tpmPublic, Esys_Free);
+    std::vector<uint8_t>                                 blob;
+
+    if ((err = MarshalBlob(*tpmPrivate, *tpmPublic, blob)) != Error::eNone) {
+        return err;
+    }
+
+    return AddKey(blob, key);
+}
+
+Error TPMKeyStorage::DeleteKey(const std::shared_ptr<PrivateKeyItf>& key)
+{
+    auto tpmKey = dynamic_cast<const TPMPrivateKey*>(key.get());
+    if (!tpmKey || !mState || tpmKey->GetState() != mState) {
+        return Error::eInvalidArgument;
+    }
+
+    std::lock_guard<std::mutex> lock(mState->mMutex);
+
+    return mState->mCache->Remove(tpmKey->GetID());
+}
+
+size_t TPMKeyStorage::GetMaxConcurrency() const
+{
+    // TPM executes one command at a time.
+    return 1;
+}
+
+Error TPMKeyStorage::LoadKey(const std::vector<uint8_t>& blob, std::shared_ptr<PrivateKeyItf>& key)
+{
+    if (!mState) {
+        return Error::eWrongState;
+    }
+
+    return AddKey(blob, key);
+}
+
+Error TPMKeyStorage::GetKeyBlob(const PrivateKeyItf& key, std::vector<uint8_t>& blob)
+{
+    auto tpmKey = dynamic_cast<const TPMPrivateKey*>(&key);
+    if (!tpmKey) {
+        return Error::eInvalidArgument;
+    }
+
+    blob = tpmKey->GetBlob();
+
+    return Error::eNone;
+}
+
+TPMObjectCacheMetrics TPMKeyStorage::GetCacheMetrics() const
+{
+    if (!mState) {
+        return TPMObjectCacheMetrics();
+    }
+
+    std::lock_guard<std::mutex> lock(mState->mMutex);
+
+    return mState->mCache->GetMetrics();
+}
+
+/***********************************************************************************************************************
+ * TPMKeyStorage private
+ **********************************************************************************************************************/
+
+Error TPMKeyStorage::AddKey(const std::vector<uint8_t>& blob, std::shared_ptr<PrivateKeyItf>& key)
+{
+    TPM2B_PRIVATE        tpmPrivate;
+    TPM2B_PUBLIC         tpmPublic;
+    KeyAlgorithm         algorithm = KeyAlgorithm::eECDSAP256;
+    std::vector<uint8_t> publicKey;
+
+    auto err = UnmarshalBlob(blob, tpmPrivate, tpmPublic);
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    if ((err = ConvertPublicKey(tpmPublic, algorithm, publicKey)) != Error::eNone) {
+        return err;
+    }
+
+    uint64_t id = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(mState->mMutex);
+
+        id = mState->mNextID++;
+
+        // The key is loaded on first use.
+        if ((err = mState->mCache->Add(id, blob)) != Error::eNone) {
+            return err;
+        }
+    }
+
+    key = std::make_shared<TPMPrivateKey>(mState, id, algorithm, blob, publicKey);
+
+    return Error::eNone;
+}
+
+} // namespace certhandler
+} // namespace iam
+} // namespace aos
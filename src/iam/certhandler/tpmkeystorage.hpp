@@ -0,0 +1,135 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef TPMKEYSTORAGE_HPP_
+#define TPMKEYSTORAGE_HPP_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "keystorage.hpp"
+#include "tpmobjectcache.hpp"
+
+namespace aos {
+namespace iam {
+namespace certhandler {
+
+/** @addtogroup iam Identification and Access Manager
+ *  @{
+ */
+
+/**
+ * TPM connection shared by the storage and its keys.
+ */
+struct TPMState;
+
+/**
+ * TPM 2.0 key storage configuration.
+ */
+struct TPMConfig {
+    /**
+     * TCTI configuration, e.g. "device:/dev/tpmrm0" or "swtpm:host=localhost,port=2321". Empty selects the default
+     * TCTI.
+     */
+    std::string mTCTI;
+
+    /**
+     * Max number of keys kept loaded in the TPM. The storage primary key occupies one more object slot.
+     */
+    size_t mMaxLoadedObjects = 2;
+};
+
+/**
+ * TPM 2.0 key storage. Keys are created under the owner hierarchy storage primary key and are used through a single
+ * HMAC session kept open while the storage or any of its keys exist. Loaded key handles are cached, see
+ * TPMObjectCache.
+ */
+class TPMKeyStorage : public KeyStorageItf {
+public:
+    /**
+     * Connects to the TPM, creates storage primary key and starts the session.
+     *
+     * @param config configuration.
+     * @return Error.
+     */
+    Error Init(const TPMConfig& config);
+
+    /**
+     * Creates private key.
+     *
+     * @param algorithm key algorithm, Ed25519 is not supported.
+     * @param[out] key created key.
+     * @return Error.
+     */
+    Error CreateKey(KeyAlgorithm algorithm, std::shared_ptr<PrivateKeyItf>& key) override;
+
+    /**
+     * Deletes key: the key is flushed from the TPM and can't be used anymore. Its blob is the only persistent copy.
+     *
+     * @param key key to delete.
+     * @return Error.
+     */
+    Error DeleteKey(const std::shared_ptr<PrivateKeyItf>& key) override;
+
+    /**
+     * Returns max number of key operations the storage may run in parallel.
+     *
+     * @return size_t.
+     */
+    size_t GetMaxConcurrency() const override;
+
+    /**
+     * Loads key from the blob returned by GetKeyBlob().
+     *
+     * @param blob key blob.
+     * @param[out] key loaded key.
+     * @return Error.
+     */
+    Error LoadKey(const std::vector<uint8_t>& blob, std::shared_ptr<PrivateKeyItf>& key);
+
+    /**
+     * Returns blob of the key created by TPM storage. The private part is wrapped by the storage primary key and can
+     * be loaded on the same TPM only.
+     *
+     * @param key key.
+     * @param[out] blob key blob.
+     * @return Error.
+     */
+    static Error GetKeyBlob(const PrivateKeyItf& key, std::vector<uint8_t>& blob);
+
+    /**
+     * Returns loaded object cache metrics.
+     *
+     * @return TPMObjectCacheMetrics.
+     */
+    TPMObjectCacheMetrics GetCacheMetrics() const;
+
+private:
+    Error AddKey(const std::vector<uint8_t>& blob, std::shared_ptr<PrivateKeyItf>& key);
+
+    std::shared_ptr<TPMState> mState;
+};
+
+/** @}*/
+
+} // namespace certhandler
+} // namespace iam
+} // namespace aos
+
+#endif
@@ -0,0 +1,143 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <cstdlib>
+
+#include <gtest/gtest.h>
+
+#include "signature.hpp"
+#include "tpmkeystorage.hpp"
+
+using namespace aos;
+using namespace aos::iam::certhandler;
+
+/***********************************************************************************************************************
+ * Utils
+ **********************************************************************************************************************/
+
+namespace {
+
+// Runs against TPM simulator:
+//   swtpm socket --tpm2 --tpmstate dir=/tmp/swtpm --flags not-need-init --server type=tcp,port=2321
+//       --ctrl type=tcp,port=2322
+//   AOS_TPM_TCTI=swtpm:host=localhost,port=2321 aosiamcpp_test
+const char* GetTCTI()
+{
+    return getenv("AOS_TPM_TCTI");
+}
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Tests
+ **********************************************************************************************************************/
+
+TEST(tpmkeystorage, NotInitialized)
+{
+    TPMKeyStorage                  storage;
+    std::shared_ptr<PrivateKeyItf> key;
+    std::vector<uint8_t>           blob;
+
+    EXPECT_EQ(storage.CreateKey(KeyAlgorithm::eECDSAP256, key), Error::eWrongState);
+    EXPECT_EQ(storage.LoadKey({}, key), Error::eWrongState);
+    EXPECT_EQ(storage.GetMaxConcurrency(), 1u);
+}
+
+TEST(tpmkeystorage, Sign)
+{
+    if (!GetTCTI()) {
+        GTEST_SKIP() << "AOS_TPM_TCTI is not set";
+    }
+
+    TPMKeyStorage storage;
+    TPMConfig     config;
+
+    config.mTCTI             = GetTCTI();
+    config.mMaxLoadedObjects = 2;
+
+    ASSERT_EQ(storage.Init(config), Error::eNone);
+
+    std::shared_ptr<PrivateKeyItf> key;
+
+    EXPECT_EQ(storage.CreateKey(KeyAlgorithm::eEd25519, key), Error::eInvalidArgument);
+
+    // More keys than loaded objects: keys are evicted and restored from saved contexts.
+    std::vector<std::shared_ptr<PrivateKeyItf>> keys(4);
+    std::vector<uint8_t>                        data(100, 0x5a), signature, publicKey;
+
+    ASSERT_EQ(storage.CreateKey(KeyAlgorithm::eECDSAP256, keys[0]), Error::eNone);
+    ASSERT_EQ(storage.CreateKey(KeyAlgorithm::eECDSAP384, keys[1]), Error::eNone);
+    ASSERT_EQ(storage.CreateKey(KeyAlgorithm::eRSA2048, keys[2]), Error::eNone);
+    ASSERT_EQ(storage.CreateKey(KeyAlgorithm::eECDSAP256, keys[3]), Error::eNone);
+
+    for (int round = 0; round < 2; round++) {
+        for (const auto& key : keys) {
+            ASSERT_EQ(key->Sign(data, signature), Error::eNone);
+            ASSERT_EQ(key->GetPublicKey(publicKey), Error::eNone);
+            EXPECT_EQ(VerifySignature(publicKey, data, signature), Error::eNone);
+        }
+    }
+
+    // Repeated signing with the same key doesn't load it again.
+    for (int i = 0; i < 4; i++) {
+        ASSERT_EQ(keys[0]->Sign(data, signature), Error::eNone);
+    }
+
+    auto metrics = storage.GetCacheMetrics();
+
+    EXPECT_EQ(metrics.mNumLoads, 4u);
+    EXPECT_GE(metrics.mNumContextLoads, 4u);
+    EXPECT_GE(metrics.mNumHits, 3u);
+
+    ASSERT_EQ(storage.DeleteKey(keys[3]), Error::eNone);
+    EXPECT_EQ(keys[3]->Sign(data, signature), Error::eNotFound);
+}
+
+TEST(tpmkeystorage, LoadKey)
+{
+    if (!GetTCTI()) {
+        GTEST_SKIP() << "AOS_TPM_TCTI is not set";
+    }
+
+    TPMConfig            config;
+    std::vector<uint8_t> blob, publicKey, data(32, 0xa5), signature;
+
+    config.mTCTI = GetTCTI();
+
+    {
+        TPMKeyStorage                  storage;
+        std::shared_ptr<PrivateKeyItf> key;
+
+        ASSERT_EQ(storage.Init(config), Error::eNone);
+        ASSERT_EQ(storage.CreateKey(KeyAlgorithm::eECDSAP256, key), Error::eNone);
+        ASSERT_EQ(TPMKeyStorage::GetKeyBlob(*key, blob), Error::eNone);
+        ASSERT_EQ(key->GetPublicKey(publicKey), Error::eNone);
+    }
+
+    // Storage primary key is recreated from the same template, so the blob is loadable after restart.
+    TPMKeyStorage                  storage;
+    std::shared_ptr<PrivateKeyItf> key;
+
+    ASSERT_EQ(storage.Init(config), Error::eNone);
+    ASSERT_EQ(storage.LoadKey(blob, key), Error::eNone);
+    EXPECT_EQ(key->GetAlgorithm(), KeyAlgorithm::eECDSAP256);
+    ASSERT_EQ(key->Sign(data, signature), Error::eNone);
+    EXPECT_EQ(VerifySignature(publicKey, data, signature), Error::eNone);
+
+    EXPECT_EQ(storage.LoadKey({0x00}, key), Error::eInvalidArgument);
+}
@@ -0,0 +1,191 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <algorithm>
+
+#include "tpmobjectcache.hpp"
+
+namespace aos {
+namespace iam {
+namespace certhandler {
+
+/***********************************************************************************************************************
+ * Public
+ **********************************************************************************************************************/
+
+TPMObjectCache::TPMObjectCache(TPMObjectContextItf& context, size_t maxLoaded)
+    : mContext(context)
+    , mMaxLoaded(std::max<size_t>(maxLoaded, 1))
+{
+}
+
+TPMObjectCache::~TPMObjectCache()
+{
+    for (auto id : mLoaded) {
+        mContext.Flush(mObjects[id].mHandle);
+    }
+}
+
+Error TPMObjectCache::Add(uint64_t id, const std::vector<uint8_t>& blob)
+{
+    auto result = mObjects.emplace(id, Object());
+    if (!result.second) {
+        return Error::eAlreadyExist;
+    }
+
+    result.first->second.mBlob = blob;
+
+    return Error::eNone;
+}
+
+Error TPMObjectCache::Get(uint64_t id, TPMHandle& handle)
+{
+    auto it = mObjects.find(id);
+    if (it == mObjects.end()) {
+        return Error::eNotFound;
+    }
+
+    auto& object = it->second;
+
+    if (object.mLoaded) {
+        mLoaded.splice(mLoaded.begin(), mLoaded, object.mPosition);
+        mMetrics.mNumHits++;
+    } else {
+        auto err = Load(id, object);
+        if (err != Error::eNone) {
+            return err;
+        }
+    }
+
+    handle = object.mHandle;
+
+    return Error::eNone;
+}
+
+Error TPMObjectCache::Remove(uint64_t id)
+{
+    auto it = mObjects.find(id);
+    if (it == mObjects.end()) {
+        return Error::eNotFound;
+    }
+
+    auto err = Error::eNone;
+
+    if (it->second.mLoaded) {
+        err = mContext.Flush(it->second.mHandle);
+        mLoaded.erase(it->second.mPosition);
+    }
+
+    mObjects.erase(it);
+
+    return err;
+}
+
+void TPMObjectCache::Invalidate()
+{
+    for (auto& object : mObjects) {
+        object.second.mLoaded = false;
+        object.second.mContext.clear();
+    }
+
+    mLoaded.clear();
+}
+
+/***********************************************************************************************************************
+ * Private
+ **********************************************************************************************************************/
+
+Error TPMObjectCache::Load(uint64_t id, Object& object)
+{
+    while (mLoaded.size() >= mMaxLoaded) {
+        auto err = EvictOldest();
+        if (err != Error::eNone) {
+            return err;
+        }
+    }
+
+    for (;;) {
+        TPMHandle handle      = 0;
+        bool      fromContext = !object.mContext.empty();
+
+        auto err = fromContext ? mContext.ContextLoad(object.mContext, handle) : mContext.Load(object.mBlob, handle);
+
+        if (err == Error::eNone) {
+            if (fromContext) {
+                mMetrics.mNumContextLoads++;
+            } else {
+                mMetrics.mNumLoads++;
+            }
+
+            object.mContext.clear();
+            object.mLoaded = true;
+            object.mHandle = handle;
+
+            mLoaded.push_front(id);
+            object.mPosition = mLoaded.begin();
+
+            return Error::eNone;
+        }
+
+        // TPM slots are shared with other TPM users: free one more slot of ours and retry.
+        if (err == Error::eNoMemory && !mLoaded.empty()) {
+            if ((err = EvictOldest()) != Error::eNone) {
+                return err;
+            }
+
+            continue;
+        }
+
+        // Saved context doesn't survive TPM reset: fall back to the key blob.
+        if (fromContext) {
+            object.mContext.clear();
+
+            continue;
+        }
+
+        return err;
+    }
+}
+
+Error TPMObjectCache::EvictOldest()
+{
+    auto& object = mObjects.at(mLoaded.back());
+
+    // Object is reloaded from the key blob if its context can't be saved.
+    if (mContext.ContextSave(object.mHandle, object.mContext) != Error::eNone) {
+        object.mContext.clear();
+    }
+
+    auto err = mContext.Flush(object.mHandle);
+    if (err != Error::eNone) {
+        object.mContext.clear();
+
+        return err;
+    }
+
+    object.mLoaded = false;
+
+    mLoaded.pop_back();
+    mMetrics.mNumEvictions++;
+
+    return Error::eNone;
+}
+
+} // namespace certhandler
+} // namespace iam
+} // namespace aos
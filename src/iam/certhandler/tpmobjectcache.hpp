@@ -0,0 +1,201 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef TPMOBJECTCACHE_HPP_
+#define TPMOBJECTCACHE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <vector>
+
+#include "error/error.hpp"
+
+namespace aos {
+namespace iam {
+namespace certhandler {
+
+/** @addtogroup iam Identification and Access Manager
+ *  @{
+ */
+
+/**
+ * TPM object handle, compatible with ESYS_TR.
+ */
+using TPMHandle = uint32_t;
+
+/**
+ * TPM object operations used by the object cache.
+ */
+class TPMObjectContextItf {
+public:
+    /**
+     * Destroys object context.
+     */
+    virtual ~TPMObjectContextItf() = default;
+
+    /**
+     * Loads object from its key blob.
+     *
+     * @param blob key blob.
+     * @param[out] handle loaded object handle.
+     * @return Error eNoMemory if TPM object slots are exhausted.
+     */
+    virtual Error Load(const std::vector<uint8_t>& blob, TPMHandle& handle) = 0;
+
+    /**
+     * Saves context of the loaded object.
+     *
+     * @param handle object handle.
+     * @param[out] context saved context.
+     * @return Error.
+     */
+    virtual Error ContextSave(TPMHandle handle, std::vector<uint8_t>& context) = 0;
+
+    /**
+     * Loads object from the saved context.
+     *
+     * @param context saved context.
+     * @param[out] handle loaded object handle.
+     * @return Error eNoMemory if TPM object slots are exhausted.
+     */
+    virtual Error ContextLoad(const std::vector<uint8_t>& context, TPMHandle& handle) = 0;
+
+    /**
+     * Flushes object from the TPM.
+     *
+     * @param handle object handle.
+     * @return Error.
+     */
+    virtual Error Flush(TPMHandle handle) = 0;
+};
+
+/**
+ * TPM object cache metrics.
+ */
+struct TPMObjectCacheMetrics {
+    /**
+     * Number of requests served by an already loaded object.
+     */
+    size_t mNumHits = 0;
+
+    /**
+     * Number of objects restored from saved context.
+     */
+    size_t mNumContextLoads = 0;
+
+    /**
+     * Number of objects loaded from key blob.
+     */
+    size_t mNumLoads = 0;
+
+    /**
+     * Number of objects context saved and flushed to free TPM object slots.
+     */
+    size_t mNumEvictions = 0;
+};
+
+/**
+ * Keeps TPM key objects loaded between operations. Not more than max loaded objects occupy TPM object slots: least
+ * recently used objects are context saved and flushed, and restored from the saved context when used again, which is
+ * much cheaper than loading from the key blob. The cache is not thread safe: callers serialize TPM access.
+ */
+class TPMObjectCache {
+public:
+    /**
+     * Creates cache.
+     *
+     * @param context object context.
+     * @param maxLoaded max number of loaded objects.
+     */
+    TPMObjectCache(TPMObjectContextItf& context, size_t maxLoaded);
+
+    /**
+     * Destroys cache, loaded objects are flushed.
+     */
+    ~TPMObjectCache();
+
+    TPMObjectCache(const TPMObjectCache&) = delete;
+    TPMObjectCache& operator=(const TPMObjectCache&) = delete;
+
+    /**
+     * Adds object, it is loaded on first use.
+     *
+     * @param id object ID.
+     * @param blob key blob.
+     * @return Error.
+     */
+    Error Add(uint64_t id, const std::vector<uint8_t>& blob);
+
+    /**
+     * Returns handle of the loaded object, loads the object if needed. The handle is valid until the next call.
+     *
+     * @param id object ID.
+     * @param[out] handle object handle.
+     * @return Error.
+     */
+    Error Get(uint64_t id, TPMHandle& handle);
+
+    /**
+     * Removes object and flushes it if loaded.
+     *
+     * @param id object ID.
+     * @return Error.
+     */
+    Error Remove(uint64_t id);
+
+    /**
+     * Forgets loaded handles and saved contexts without flushing, e.g. after TPM reset: objects are reloaded from key
+     * blobs on next use.
+     */
+    void Invalidate();
+
+    /**
+     * Returns metrics.
+     *
+     * @return TPMObjectCacheMetrics.
+     */
+    TPMObjectCacheMetrics GetMetrics() const { return mMetrics; }
+
+private:
+    struct Object {
+        std::vector<uint8_t>          mBlob;
+        std::vector<uint8_t>          mContext;
+        bool                          mLoaded = false;
+        TPMHandle                     mHandle = 0;
+        std::list<uint64_t>::iterator mPosition;
+    };
+
+    Error Load(uint64_t id, Object& object);
+    Error EvictOldest();
+
+    TPMObjectContextItf&       mContext;
+    size_t                     mMaxLoaded;
+    std::map<uint64_t, Object> mObjects;
+    std::list<uint64_t>        mLoaded;
+    TPMObjectCacheMetrics      mMetrics;
+};
+
+/** @}*/
+
+} // namespace certhandler
+} // namespace iam
+} // namespace aos
+
+#endif
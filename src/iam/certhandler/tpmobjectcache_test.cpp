@@ -0,0 +1,215 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+
+#include "tpmobjectcache.hpp"
+
+using namespace aos;
+using namespace aos::iam::certhandler;
+
+/***********************************************************************************************************************
+ * Mocks
+ **********************************************************************************************************************/
+
+namespace {
+
+// TPM with limited number of object slots. Saved contexts are bound to the TPM epoch and become invalid on reset.
+class MockTPM : public TPMObjectContextItf {
+public:
+    explicit MockTPM(size_t numSlots)
+        : mNumSlots(numSlots)
+    {
+    }
+
+    Error Load(const std::vector<uint8_t>& blob, TPMHandle& handle) override
+    {
+        mNumLoads++;
+
+        return Insert(blob, handle);
+    }
+
+    Error ContextSave(TPMHandle handle, std::vector<uint8_t>& context) override
+    {
+        auto it = mObjects.find(handle);
+        if (it == mObjects.end()) {
+            return Error::eNotFound;
+        }
+
+        context = {mEpoch};
+        context.insert(context.end(), it->second.begin(), it->second.end());
+
+        return Error::eNone;
+    }
+
+    Error ContextLoad(const std::vector<uint8_t>& context, TPMHandle& handle) override
+    {
+        if (context.empty() || context[0] != mEpoch) {
+            return Error::eFailed;
+        }
+
+        return Insert(std::vector<uint8_t>(context.begin() + 1, context.end()), handle);
+    }
+
+    Error Flush(TPMHandle handle) override { return mObjects.erase(handle) ? Error::eNone : Error::eNotFound; }
+
+    Error Insert(const std::vector<uint8_t>& blob, TPMHandle& handle)
+    {
+        if (mObjects.size() >= mNumSlots) {
+            return Error::eNoMemory;
+        }
+
+        handle           = mNextHandle++;
+        mObjects[handle] = blob;
+
+        return Error::eNone;
+    }
+
+    void Reset()
+    {
+        mObjects.clear();
+        mEpoch++;
+    }
+
+    size_t                                    mNumSlots;
+    std::map<TPMHandle, std::vector<uint8_t>> mObjects;
+    TPMHandle                                 mNextHandle = 0x80000000;
+    uint8_t                                   mEpoch = 0;
+    size_t                                    mNumLoads = 0;
+};
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Tests
+ **********************************************************************************************************************/
+
+TEST(tpmobjectcache, Get)
+{
+    MockTPM        tpm(3);
+    TPMObjectCache cache(tpm, 2);
+    TPMHandle      handle1 = 0, handle2 = 0;
+
+    EXPECT_EQ(cache.Get(1, handle1), Error::eNotFound);
+
+    ASSERT_EQ(cache.Add(1, {1}), Error::eNone);
+    ASSERT_EQ(cache.Add(2, {2}), Error::eNone);
+    ASSERT_EQ(cache.Add(3, {3}), Error::eNone);
+    EXPECT_EQ(cache.Add(3, {3}), Error::eAlreadyExist);
+
+    ASSERT_EQ(cache.Get(1, handle1), Error::eNone);
+    ASSERT_EQ(cache.Get(1, handle2), Error::eNone);
+    EXPECT_EQ(handle1, handle2);
+    EXPECT_EQ(tpm.mObjects[handle1], std::vector<uint8_t>({1}));
+
+    // Object 1 is the least recently used one when object 3 is loaded.
+    ASSERT_EQ(cache.Get(2, handle2), Error::eNone);
+    ASSERT_EQ(cache.Get(3, handle1), Error::eNone);
+    EXPECT_EQ(tpm.mObjects.size(), 2u);
+    EXPECT_EQ(tpm.mObjects.count(handle2), 1u);
+
+    // Evicted object is restored from saved context.
+    ASSERT_EQ(cache.Get(1, handle1), Error::eNone);
+    EXPECT_EQ(tpm.mObjects[handle1], std::vector<uint8_t>({1}));
+    EXPECT_EQ(tpm.mObjects.size(), 2u);
+    EXPECT_EQ(tpm.mNumLoads, 3u);
+
+    auto metrics = cache.GetMetrics();
+
+    EXPECT_EQ(metrics.mNumHits, 1u);
+    EXPECT_EQ(metrics.mNumLoads, 3u);
+    EXPECT_EQ(metrics.mNumContextLoads, 1u);
+    EXPECT_EQ(metrics.mNumEvictions, 2u);
+}
+
+TEST(tpmobjectcache, SlotsExhausted)
+{
+    MockTPM        tpm(2);
+    TPMObjectCache cache(tpm, 4);
+    TPMHandle      handle = 0, foreign = 0;
+
+    // Object of another TPM user.
+    ASSERT_EQ(tpm.Insert({0}, foreign), Error::eNone);
+
+    ASSERT_EQ(cache.Add(1, {1}), Error::eNone);
+    ASSERT_EQ(cache.Add(2, {2}), Error::eNone);
+
+    ASSERT_EQ(cache.Get(1, handle), Error::eNone);
+    ASSERT_EQ(cache.Get(2, handle), Error::eNone);
+    EXPECT_EQ(tpm.mObjects[handle], std::vector<uint8_t>({2}));
+    EXPECT_EQ(tpm.mObjects.count(foreign), 1u);
+    EXPECT_EQ(cache.GetMetrics().mNumEvictions, 1u);
+
+    // No object of ours to evict.
+    tpm.mNumSlots = 1;
+
+    ASSERT_EQ(cache.Remove(2), Error::eNone);
+    EXPECT_EQ(cache.Get(1, handle), Error::eNoMemory);
+    EXPECT_EQ(cache.Get(2, handle), Error::eNotFound);
+}
+
+TEST(tpmobjectcache, Reset)
+{
+    MockTPM        tpm(1);
+    TPMObjectCache cache(tpm, 1);
+    TPMHandle      handle = 0;
+
+    ASSERT_EQ(cache.Add(1, {1}), Error::eNone);
+    ASSERT_EQ(cache.Add(2, {2}), Error::eNone);
+
+    ASSERT_EQ(cache.Get(1, handle), Error::eNone);
+    ASSERT_EQ(cache.Get(2, handle), Error::eNone);
+
+    // Saved context of object 1 became stale: object is loaded from the key blob.
+    tpm.mEpoch++;
+
+    ASSERT_EQ(cache.Get(1, handle), Error::eNone);
+    EXPECT_EQ(tpm.mObjects[handle], std::vector<uint8_t>({1}));
+    EXPECT_EQ(tpm.mNumLoads, 3u);
+    EXPECT_EQ(cache.GetMetrics().mNumContextLoads, 0u);
+
+    // Handles are forgotten after TPM reset.
+    tpm.Reset();
+    cache.Invalidate();
+
+    ASSERT_EQ(cache.Get(2, handle), Error::eNone);
+    EXPECT_EQ(tpm.mObjects[handle], std::vector<uint8_t>({2}));
+    EXPECT_EQ(tpm.mNumLoads, 4u);
+}
+
+TEST(tpmobjectcache, Flush)
+{
+    MockTPM   tpm(4);
+    TPMHandle handle = 0;
+
+    {
+        TPMObjectCache cache(tpm, 4);
+
+        ASSERT_EQ(cache.Add(1, {1}), Error::eNone);
+        ASSERT_EQ(cache.Add(2, {2}), Error::eNone);
+
+        ASSERT_EQ(cache.Get(1, handle), Error::eNone);
+        ASSERT_EQ(cache.Get(2, handle), Error::eNone);
+
+        ASSERT_EQ(cache.Remove(1), Error::eNone);
+        EXPECT_EQ(tpm.mObjects.size(), 1u);
+        EXPECT_EQ(cache.Remove(1), Error::eNotFound);
+    }
+
+    EXPECT_TRUE(tpm.mObjects.empty());
+}
@@ -0,0 +1,545 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <limits>
+
+#include <openssl/x509v3.h>
+
+#include "asn1time.hpp"
+#include "crypto/sha256.hpp"
+#include "encoding/pem.hpp"
+#include "truststore.hpp"
+#include "x509parser.hpp"
+
+namespace aos {
+namespace iam {
+namespace certhandler {
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+namespace {
+
+struct X509StackDeleter {
+    void operator()(STACK_OF(X509) * stack) const { sk_X509_free(stack); }
+};
+
+std::shared_ptr<X509> ParseCert(const std::vector<uint8_t>& der)
+{
+    auto data = der.data();
+
+    return std::shared_ptr<X509>(d2i_X509(nullptr, &data, static_cast<long>(der.size())), X509_free);
+}
+
+Error GetNameDER(const X509_NAME* name, std::vector<uint8_t>& der)
+{
+    unsigned char* data = nullptr;
+    int            size = i2d_X509_NAME(name, &data);
+
+    if (size <= 0) {
+        return Error::eInvalidArgument;
+    }
+
+    der.assign(data, data + size);
+    OPENSSL_free(data);
+
+    return Error::eNone;
+}
+
+std::string GetKeyID(const ASN1_OCTET_STRING* keyID)
+{
+    if (!keyID) {
+        return {};
+    }
+
+    return std::string(reinterpret_cast<const char*>(ASN1_STRING_get0_data(keyID)), ASN1_STRING_length(keyID));
+}
+
+unsigned long GetNameHash(const X509_NAME* name)
+{
+    return X509_NAME_hash_ex(name, nullptr, nullptr, nullptr);
+}
+
+bool IsValidAt(const X509* cert, time_t time)
+{
+    return X509_cmp_time(X509_get0_notBefore(cert), &time) <= 0 && X509_cmp_time(X509_get0_notAfter(cert), &time) >= 0;
+}
+
+template <typename Index>
+void AddToIndex(Index& index, const typename Index::key_type& key, const std::shared_ptr<X509>& cert)
+{
+    index[key].push_back(cert);
+}
+
+template <typename Index>
+void RemoveFromIndex(Index& index, const typename Index::key_type& key, const std::shared_ptr<X509>& cert)
+{
+    auto it = index.find(key);
+    if (it == index.end()) {
+        return;
+    }
+
+    auto& certs = it->second;
+
+    certs.erase(std::remove(certs.begin(), certs.end(), cert), certs.end());
+
+    if (certs.empty()) {
+        index.erase(it);
+    }
+}
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Public
+ **********************************************************************************************************************/
+
+TrustStore::TrustStore()
+    : mIndex(std::make_shared<AnchorIndex>())
+    , mStore(X509_STORE_new(), X509_STORE_free)
+{
+    // The store holds no certificates: issuers are looked up in the anchor index.
+    if (mStore) {
+        X509_STORE_set_get_issuer(mStore.get(), GetIssuer);
+    }
+
+    UpdateSnapshot();
+}
+
+Error TrustStore::AddTrustAnchor(const std::vector<uint8_t>& der)
+{
+    Anchor anchor;
+
+    auto err = ParseAnchor(der, anchor);
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    if (mAnchors.count(anchor.mFingerprint)) {
+        return Error::eAlreadyExist;
+    }
+
+    UpdateAnchors({anchor}, {});
+
+    return Error::eNone;
+}
+
+Error TrustStore::AddTrustBundle(const std::string& pem)
+{
+    pem::Reader          reader(pem);
+    std::string          label;
+    std::vector<uint8_t> der;
+    std::vector<Anchor>  anchors;
+    Error                err = Error::eNone;
+
+    while ((err = reader.Next(label, der)) == Error::eNone) {
+        Anchor anchor;
+
+        if (label != pem::cCertificate) {
+            continue;
+        }
+
+        err = ParseAnchor(der, anchor);
+        if (err != Error::eNone) {
+            return err;
+        }
+
+        anchors.push_back(std::move(anchor));
+    }
+
+    if (err != Error::eNotFound) {
+        return err;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    // Whole bundle is applied with a single snapshot update.
+    UpdateAnchors(anchors, {});
+
+    return Error::eNone;
+}
+
+Error TrustStore::RemoveTrustAnchor(const std::vector<uint8_t>& der)
+{
+    Anchor anchor;
+
+    auto err = ParseAnchor(der, anchor);
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    if (!mAnchors.count(anchor.mFingerprint)) {
+        return Error::eNotFound;
+    }
+
+    UpdateAnchors({}, {anchor});
+
+    return Error::eNone;
+}
+
+Error TrustStore::UpdateTrustAnchors(
+    const std::vector<std::vector<uint8_t>>& added, const std::vector<std::vector<uint8_t>>& removed)
+{
+    std::vector<Anchor> addedAnchors(added.size()), removedAnchors(removed.size());
+
+    for (size_t i = 0; i < added.size(); i++) {
+        auto err = ParseAnchor(added[i], addedAnchors[i]);
+        if (err != Error::eNone) {
+            return err;
+        }
+    }
+
+    for (size_t i = 0; i < removed.size(); i++) {
+        auto err = ParseAnchor(removed[i], removedAnchors[i]);
+        if (err != Error::eNone) {
+            return err;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    UpdateAnchors(addedAnchors, removedAnchors);
+
+    return Error::eNone;
+}
+
+Error TrustStore::SetCRL(const std::vector<uint8_t>& der)
+{
+    // Parse and index outside of the lock.
+    CRLPtr crl;
+
+    auto err = RevocationList::Create(der, crl);
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    bool anchorIssued = false;
+
+    err = VerifyCRL(*mIndex, *crl, anchorIssued);
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    auto& current = mCRLs[crl->GetIssuer()];
+
+    if (current) {
+        if (!crl->IsNewerThan(*current)) {
+            return Error::eAlreadyExist;
+        }
+
+        if (!anchorIssued) {
+            err = crl->VerifySignature(*current);
+            if (err != Error::eNone && err != Error::eNotFound) {
+                return Error::eFailed;
+            }
+        }
+    }
+
+    current = crl;
+    UpdateSnapshot();
+
+    return Error::eNone;
+}
+
+uint64_t TrustStore::GetGeneration() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    return mGeneration;
+}
+
+Error TrustStore::VerifyChain(const CertChain& chain, time_t now, time_t& validUntil) const
+{
+    if (chain.empty()) {
+        return Error::eInvalidArgument;
+    }
+
+    auto snapshot = mSnapshot.Load();
+
+    std::vector<X509Ptr> certs;
+
+    for (const auto& der : chain) {
+        auto cert = ParseCert(der);
+        if (!cert) {
+            return Error::eInvalidArgument;
+        }
+
+        certs.push_back(cert);
+    }
+
+    std::unique_ptr<STACK_OF(X509), X509StackDeleter>                untrusted(sk_X509_new_null());
+    std::unique_ptr<X509_STORE_CTX, decltype(&X509_STORE_CTX_free)> ctx(X509_STORE_CTX_new(), X509_STORE_CTX_free);
+
+    if (!untrusted || !ctx) {
+        return Error::eNoMemory;
+    }
+
+    for (size_t i = 1; i < certs.size(); i++) {
+        sk_X509_push(untrusted.get(), certs[i].get());
+    }
+
+    if (!X509_STORE_CTX_init(ctx.get(), snapshot->mStore.get(), certs[0].get(), untrusted.get())) {
+        return Error::eFailed;
+    }
+
+    // Issuer lookup uses the anchor index of the snapshot.
+    X509_STORE_CTX_set_app_data(ctx.get(), const_cast<Snapshot*>(snapshot.get()));
+
+    X509_STORE_CTX_set_time(ctx.get(), 0, now);
+
+    if (X509_verify_cert(ctx.get()) != 1) {
+        return Error::eFailed;
+    }
+
+    auto verified = X509_STORE_CTX_get0_chain(ctx.get());
+    int  size     = sk_X509_num(verified);
+
+    validUntil = std::numeric_limits<time_t>::max();
+
+    for (int i = 0; i < size; i++) {
+        auto   cert     = sk_X509_value(verified, i);
+        time_t notAfter = 0;
+
+        auto err = ConvertTime(X509_get0_notAfter(cert), notAfter);
+        if (err != Error::eNone) {
+            return err;
+        }
+
+        validUntil = std::min(validUntil, notAfter);
+
+        // Trust anchor is not checked for revocation.
+        if (i == size - 1) {
+            break;
+        }
+
+        std::vector<uint8_t> issuerName;
+
+        err = GetNameDER(X509_get_issuer_name(cert), issuerName);
+        if (err != Error::eNone) {
+            return err;
+        }
+
+        auto it = snapshot->mCRLs.find(issuerName);
+        if (it == snapshot->mCRLs.end()) {
+            continue;
+        }
+
+        const auto& crl = *it->second;
+
+        if (crl.VerifySignature(X509_get0_pubkey(sk_X509_value(verified, i + 1))) != Error::eNone) {
+            return Error::eFailed;
+        }
+
+        if (crl.GetNextUpdate() != 0) {
+            // Outdated CRL can't prove the certificate is not revoked.
+            if (crl.GetNextUpdate() <= now) {
+                return Error::eFailed;
+            }
+
+            validUntil = std::min(validUntil, crl.GetNextUpdate());
+        }
+
+        std::vector<uint8_t> serial;
+
+        err = RevocationList::ConvertSerial(X509_get0_serialNumber(cert), serial);
+        if (err != Error::eNone) {
+            return err;
+        }
+
+        if (crl.IsRevoked(serial)) {
+            return Error::eFailed;
+        }
+    }
+
+    return Error::eNone;
+}
+
+/***********************************************************************************************************************
+ * Private
+ **********************************************************************************************************************/
+
+Error TrustStore::ParseAnchor(const std::vector<uint8_t>& der, Anchor& anchor)
+{
+    anchor.mCert = ParseCert(der);
+    if (!anchor.mCert) {
+        return Error::eInvalidArgument;
+    }
+
+    auto fingerprint = sha256::Calculate(der.data(), der.size());
+
+    anchor.mFingerprint.assign(fingerprint.begin(), fingerprint.end());
+
+    return Error::eNone;
+}
+
+int TrustStore::GetIssuer(X509** issuer, X509_STORE_CTX* ctx, X509* cert)
+{
+    auto        snapshot = static_cast<const Snapshot*>(X509_STORE_CTX_get_app_data(ctx));
+    const auto& index    = *snapshot->mIndex;
+    auto        time     = X509_VERIFY_PARAM_get_time(X509_STORE_CTX_get0_param(ctx));
+    X509*       match    = nullptr;
+
+    // As OpenSSL store lookup, an issuer valid at verification time is preferred.
+    auto findIssuer = [cert, time, &match](const std::vector<X509Ptr>& candidates) {
+        for (const auto& candidate : candidates) {
+            if (X509_check_issued(candidate.get(), cert) != X509_V_OK) {
+                continue;
+            }
+
+            if (IsValidAt(candidate.get(), time)) {
+                match = candidate.get();
+
+                return true;
+            }
+
+            if (!match) {
+                match = candidate.get();
+            }
+        }
+
+        return false;
+    };
+
+    // Authority key identifier points to the issuer key directly, issuer name is used for certificates without it.
+    auto keyID = GetKeyID(X509_get0_authority_key_id(cert));
+    auto byKey = keyID.empty() ? index.mBySubjectKeyID.end() : index.mBySubjectKeyID.find(keyID);
+
+    if (byKey == index.mBySubjectKeyID.end() || !findIssuer(byKey->second)) {
+        auto byName = index.mBySubject.find(GetNameHash(X509_get_issuer_name(cert)));
+        if (byName != index.mBySubject.end()) {
+            findIssuer(byName->second);
+        }
+    }
+
+    if (!match || !X509_up_ref(match)) {
+        return 0;
+    }
+
+    *issuer = match;
+
+    return 1;
+}
+
+Error TrustStore::VerifyCRL(const AnchorIndex& index, const RevocationList& crl, bool& anchorIssued)
+{
+    const uint8_t* data = crl.GetIssuer().data();
+
+    std::unique_ptr<X509_NAME, decltype(&X509_NAME_free)> issuer(
+        d2i_X509_NAME(nullptr, &data, static_cast<long>(crl.GetIssuer().size())), X509_NAME_free);
+    if (!issuer) {
+        return Error::eInvalidArgument;
+    }
+
+    anchorIssued = false;
+
+    auto it = index.mBySubject.find(GetNameHash(issuer.get()));
+    if (it == index.mBySubject.end()) {
+        return Error::eNone;
+    }
+
+    // Any anchor with the issuer name may have signed the CRL: e.g. during the CA key rollover.
+    for (const auto& anchor : it->second) {
+        if (X509_NAME_cmp(X509_get_subject_name(anchor.get()), issuer.get()) != 0) {
+            continue;
+        }
+
+        anchorIssued = true;
+
+        if (crl.VerifySignature(X509_get0_pubkey(anchor.get())) == Error::eNone) {
+            return Error::eNone;
+        }
+    }
+
+    return anchorIssued ? Error::eFailed : Error::eNone;
+}
+
+void TrustStore::UpdateAnchors(const std::vector<Anchor>& added, const std::vector<Anchor>& removed)
+{
+    std::shared_ptr<AnchorIndex> newIndex;
+
+    // Only changed anchors are indexed, the rest of the index is copied.
+    auto getIndex = [this, &newIndex]() -> AnchorIndex& {
+        if (!newIndex) {
+            newIndex = std::make_shared<AnchorIndex>(*mIndex);
+        }
+
+        return *newIndex;
+    };
+
+    for (const auto& anchor : removed) {
+        auto it = mAnchors.find(anchor.mFingerprint);
+        if (it == mAnchors.end()) {
+            continue;
+        }
+
+        auto  cert  = it->second;
+        auto& index = getIndex();
+
+        RemoveFromIndex(index.mBySubjectKeyID, GetKeyID(X509_get0_subject_key_id(cert.get())), cert);
+        RemoveFromIndex(index.mBySubject, GetNameHash(X509_get_subject_name(cert.get())), cert);
+        mAnchors.erase(it);
+    }
+
+    for (const auto& anchor : added) {
+        if (!mAnchors.emplace(anchor.mFingerprint, anchor.mCert).second) {
+            continue;
+        }
+
+        auto& index = getIndex();
+        auto  keyID = GetKeyID(X509_get0_subject_key_id(anchor.mCert.get()));
+
+        if (!keyID.empty()) {
+            AddToIndex(index.mBySubjectKeyID, keyID, anchor.mCert);
+        }
+
+        AddToIndex(index.mBySubject, GetNameHash(X509_get_subject_name(anchor.mCert.get())), anchor.mCert);
+    }
+
+    if (!newIndex) {
+        return;
+    }
+
+    mIndex = std::move(newIndex);
+    UpdateSnapshot();
+}
+
+void TrustStore::UpdateSnapshot()
+{
+    // Verifications in progress keep using the previous snapshot.
+    auto snapshot = std::make_shared<Snapshot>();
+
+    snapshot->mStore = mStore;
+    snapshot->mIndex = mIndex;
+    snapshot->mCRLs  = mCRLs;
+
+    // Readers load the snapshot through RCU without taking any lock: VerifyChain() never waits for mMutex inside a read
+    // side critical section, so publishing under it can't deadlock.
+    mSnapshot.Store(std::move(snapshot));
+    mGeneration++;
+}
+
+} // namespace certhandler
+} // namespace iam
+} // namespace aos
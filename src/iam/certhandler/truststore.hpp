@@ -0,0 +1,171 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TRUSTSTORE_HPP_
+#define TRUSTSTORE_HPP_
+
+#include <cstdint>
+#include <ctime>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <openssl/x509.h>
+
+#include "error/error.hpp"
+#include "tools/rcu.hpp"
+#include "revocationlist.hpp"
+
+namespace aos {
+namespace iam {
+namespace certhandler {
+
+/** @addtogroup iam Identification and Access Manager
+ *  @{
+ */
+
+/**
+ * DER certificate chain: leaf certificate first, followed by intermediate certificates.
+ */
+using CertChain = std::vector<std::vector<uint8_t>>;
+
+/**
+ * Trust anchors and CRLs used to verify certificate chains.
+ *
+ * Anchors are indexed by subject key identifier and by subject name hash, chain building looks up issuers in the index
+ * instead of an OpenSSL store. Anchor changes update the index incrementally: only changed anchors are parsed and
+ * indexed, the OpenSSL store is not rebuilt.
+ */
+class TrustStore {
+public:
+    /**
+     * Creates trust store.
+     */
+    TrustStore();
+
+    /**
+     * Adds trust anchor.
+     *
+     * @param der DER encoded CA certificate.
+     * @return Error.
+     */
+    Error AddTrustAnchor(const std::vector<uint8_t>& der);
+
+    /**
+     * Adds all certificates of PEM bundle as trust anchors. Blocks other than certificates and certificates which are
+     * already trusted are skipped. Nothing is added if any certificate is invalid.
+     *
+     * @param pem PEM encoded CA certificates.
+     * @return Error.
+     */
+    Error AddTrustBundle(const std::string& pem);
+
+    /**
+     * Removes trust anchor.
+     *
+     * @param der DER encoded CA certificate.
+     * @return Error.
+     */
+    Error RemoveTrustAnchor(const std::vector<uint8_t>& der);
+
+    /**
+     * Removes and adds trust anchors with a single update. Removed certificates which are not trusted and added
+     * certificates which are already trusted are skipped. Nothing is changed if any certificate is invalid.
+     *
+     * @param added DER encoded CA certificates to add.
+     * @param removed DER encoded CA certificates to remove.
+     * @return Error.
+     */
+    Error UpdateTrustAnchors(const std::vector<std::vector<uint8_t>>& added,
+        const std::vector<std::vector<uint8_t>>& removed);
+
+    /**
+     * Sets CRL of the issuer, replaces previously set CRL of the same issuer. CRL which is not newer than the current
+     * one is rejected, so an older CRL can't be replayed to unrevoke certificates. CRL issued by a trust anchor must be
+     * signed by it. CRL of an intermediate CA is checked against the issuer certificate during chain verification and,
+     * once the current CRL has been verified, must be signed with the same key to replace it.
+     *
+     * @param der DER encoded CRL.
+     * @return Error eAlreadyExist if CRL is not newer than the current one, eFailed if CRL signature is invalid.
+     */
+    Error SetCRL(const std::vector<uint8_t>& der);
+
+    /**
+     * Returns trust store generation. Generation is changed on each trust anchor or CRL change.
+     *
+     * @return uint64_t.
+     */
+    uint64_t GetGeneration() const;
+
+    /**
+     * Verifies certificate chain.
+     *
+     * @param chain certificate chain.
+     * @param now verification time.
+     * @param[out] validUntil time until the result stays valid: the earliest chain certificate expiration or next CRL
+     * update.
+     * @return Error eNone if chain is trusted.
+     */
+    Error VerifyChain(const CertChain& chain, time_t now, time_t& validUntil) const;
+
+private:
+    using X509Ptr = std::shared_ptr<X509>;
+    using CRLPtr  = std::shared_ptr<const RevocationList>;
+    using CRLMap  = std::map<std::vector<uint8_t>, CRLPtr>;
+
+    struct Anchor {
+        std::string mFingerprint;
+        X509Ptr     mCert;
+    };
+
+    struct AnchorIndex {
+        std::unordered_map<std::string, std::vector<X509Ptr>>   mBySubjectKeyID;
+        std::unordered_map<unsigned long, std::vector<X509Ptr>> mBySubject;
+    };
+
+    struct Snapshot {
+        std::shared_ptr<X509_STORE>        mStore;
+        std::shared_ptr<const AnchorIndex> mIndex;
+        CRLMap                             mCRLs;
+    };
+
+    static Error ParseAnchor(const std::vector<uint8_t>& der, Anchor& anchor);
+    static int   GetIssuer(X509** issuer, X509_STORE_CTX* ctx, X509* cert);
+    static Error VerifyCRL(const AnchorIndex& index, const RevocationList& crl, bool& anchorIssued);
+
+    void UpdateAnchors(const std::vector<Anchor>& added, const std::vector<Anchor>& removed);
+    void UpdateSnapshot();
+
+    mutable std::mutex                 mMutex;
+    std::map<std::string, X509Ptr>     mAnchors;
+    std::shared_ptr<const AnchorIndex> mIndex;
+    CRLMap                             mCRLs;
+    std::shared_ptr<X509_STORE>        mStore;
+    rcu::SharedPtr<const Snapshot>     mSnapshot;
+    uint64_t                           mGeneration = 0;
+};
+
+/** @}*/
+
+} // namespace certhandler
+} // namespace iam
+} // namespace aos
+
+#endif
@@ -0,0 +1,132 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+
+#include "testcerts.hpp"
+#include "truststore.hpp"
+
+using namespace aos;
+using namespace aos::iam::certhandler;
+using namespace aos::iam::certhandler::test;
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+namespace {
+
+constexpr long cMaxAnchors = 1024;
+
+struct TestPKI {
+    std::vector<std::vector<uint8_t>> mAnchors;
+    std::vector<CertChain>            mChains;
+};
+
+// CA names repeat every 64 anchors, as with renewed or cross-signed CAs, so chains have issuers sharing the name.
+const TestPKI& GetPKI()
+{
+    static TestPKI sPKI;
+
+    if (sPKI.mAnchors.empty()) {
+        auto leafKey = GenerateTestKey();
+
+        for (long i = 0; i < cMaxAnchors; i++) {
+            auto           caKey = GenerateTestKey();
+            TestCertParams params;
+
+            params.mSubject = "ca" + std::to_string(i % 64);
+            params.mIssuer  = params.mSubject;
+            params.mSerial  = i + 1;
+            params.mCA      = true;
+
+            sPKI.mAnchors.push_back(CreateTestCert(params, caKey.get()));
+
+            params.mSubject = "intermediate" + std::to_string(i);
+            params.mCA      = true;
+
+            auto intermediateKey = GenerateTestKey();
+            auto intermediate    = CreateTestCert(params, intermediateKey.get(), caKey.get());
+
+            params.mSubject = "leaf";
+            params.mIssuer  = "intermediate" + std::to_string(i);
+            params.mCA      = false;
+
+            sPKI.mChains.push_back({CreateTestCert(params, leafKey.get(), intermediateKey.get()), intermediate});
+        }
+    }
+
+    return sPKI;
+}
+
+void LoadAnchors(TrustStore& store, size_t count)
+{
+    const auto& pki = GetPKI();
+
+    store.UpdateTrustAnchors({pki.mAnchors.begin(), pki.mAnchors.begin() + count}, {});
+}
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Benchmarks
+ **********************************************************************************************************************/
+
+static void VerifyChain(benchmark::State& state)
+{
+    const auto& pki        = GetPKI();
+    auto        numAnchors = static_cast<size_t>(state.range(0));
+    auto        now        = time(nullptr);
+    time_t      validUntil = 0;
+    TrustStore  store;
+    size_t      index = 0;
+
+    LoadAnchors(store, numAnchors);
+
+    for (auto _ : state) {
+        if (store.VerifyChain(pki.mChains[index], now, validUntil) != Error::eNone) {
+            state.SkipWithError("verification failed");
+
+            return;
+        }
+
+        index = (index + 7) % numAnchors;
+    }
+}
+
+// Bundle update replacing one anchor.
+static void UpdateTrustAnchors(benchmark::State& state)
+{
+    const auto& pki        = GetPKI();
+    auto        numAnchors = static_cast<size_t>(state.range(0));
+    TrustStore  store;
+    size_t      index = 0;
+
+    LoadAnchors(store, numAnchors);
+
+    for (auto _ : state) {
+        auto added = (index + 1) % numAnchors;
+
+        store.UpdateTrustAnchors({pki.mAnchors[added]}, {pki.mAnchors[index]});
+        store.UpdateTrustAnchors({pki.mAnchors[index]}, {});
+
+        index = added;
+    }
+}
+
+BENCHMARK(VerifyChain)->ArgName("anchors")->RangeMultiplier(4)->Range(4, cMaxAnchors);
+BENCHMARK(UpdateTrustAnchors)->ArgName("anchors")->RangeMultiplier(4)->Range(4, cMaxAnchors);
@@ -0,0 +1,280 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include "encoding/pem.hpp"
+#include "testcerts.hpp"
+#include "truststore.hpp"
+
+using namespace aos;
+using namespace aos::iam::certhandler;
+using namespace aos::iam::certhandler::test;
+
+/***********************************************************************************************************************
+ * Suite
+ **********************************************************************************************************************/
+
+class TrustStoreTest : public testing::Test {
+protected:
+    void SetUp() override
+    {
+        TestCertParams params;
+
+        params.mSubject = "root";
+        params.mIssuer  = "root";
+        params.mCA      = true;
+        mRoot           = CreateTestCert(params, mRootKey.get());
+
+        params.mSubject = "intermediate";
+        params.mSerial  = 2;
+        mIntermediate   = CreateTestCert(params, mIntermediateKey.get(), mRootKey.get());
+
+        params.mSubject  = "leaf";
+        params.mIssuer   = "intermediate";
+        params.mSerial   = 3;
+        params.mCA       = false;
+        params.mNotAfter = 30;
+        mLeaf            = CreateTestCert(params, mLeafKey.get(), mIntermediateKey.get());
+    }
+
+    TestKeyPtr           mRootKey         = GenerateTestKey();
+    TestKeyPtr           mIntermediateKey = GenerateTestKey();
+    TestKeyPtr           mLeafKey         = GenerateTestKey();
+    std::vector<uint8_t> mRoot, mIntermediate, mLeaf;
+};
+
+/***********************************************************************************************************************
+ * Tests
+ **********************************************************************************************************************/
+
+TEST_F(TrustStoreTest, VerifyChain)
+{
+    TrustStore store;
+    time_t     now = time(nullptr), validUntil = 0;
+
+    EXPECT_EQ(store.VerifyChain({mLeaf, mIntermediate}, now, validUntil), Error::eFailed);
+
+    ASSERT_EQ(store.AddTrustAnchor(mRoot), Error::eNone);
+    EXPECT_EQ(store.AddTrustAnchor(mRoot), Error::eAlreadyExist);
+
+    ASSERT_EQ(store.VerifyChain({mLeaf, mIntermediate}, now, validUntil), Error::eNone);
+
+    // Result is valid until the leaf expires.
+    EXPECT_GT(validUntil, now + 29 * 24 * 3600);
+    EXPECT_LE(validUntil, now + 30 * 24 * 3600);
+
+    EXPECT_EQ(store.VerifyChain({mLeaf}, now, validUntil), Error::eFailed);
+    EXPECT_EQ(store.VerifyChain({mLeaf, mIntermediate}, now + 31 * 24 * 3600, validUntil), Error::eFailed);
+    EXPECT_EQ(store.VerifyChain({}, now, validUntil), Error::eInvalidArgument);
+    EXPECT_EQ(store.VerifyChain({{0x30, 0x00}}, now, validUntil), Error::eInvalidArgument);
+
+    ASSERT_EQ(store.RemoveTrustAnchor(mRoot), Error::eNone);
+    EXPECT_EQ(store.RemoveTrustAnchor(mRoot), Error::eNotFound);
+    EXPECT_EQ(store.VerifyChain({mLeaf, mIntermediate}, now, validUntil), Error::eFailed);
+}
+
+TEST_F(TrustStoreTest, CRL)
+{
+    TrustStore store;
+    time_t     now = time(nullptr), validUntil = 0;
+
+    ASSERT_EQ(store.AddTrustAnchor(mRoot), Error::eNone);
+
+    ASSERT_EQ(store.SetCRL(CreateTestCRL("intermediate", mIntermediateKey.get(), {5}, 7, -5)), Error::eNone);
+    ASSERT_EQ(store.VerifyChain({mLeaf, mIntermediate}, now, validUntil), Error::eNone);
+
+    // Next CRL update is earlier than leaf expiration.
+    EXPECT_LE(validUntil, now + 7 * 24 * 3600);
+
+    ASSERT_EQ(store.SetCRL(CreateTestCRL("intermediate", mIntermediateKey.get(), {3}, 7, -4)), Error::eNone);
+    EXPECT_EQ(store.VerifyChain({mLeaf, mIntermediate}, now, validUntil), Error::eFailed);
+
+    // Outdated CRL is rejected.
+    ASSERT_EQ(store.SetCRL(CreateTestCRL("intermediate", mIntermediateKey.get(), {}, 0, -3)), Error::eNone);
+    EXPECT_EQ(store.VerifyChain({mLeaf, mIntermediate}, now + 3600, validUntil), Error::eFailed);
+
+    ASSERT_EQ(store.SetCRL(CreateTestCRL("root", mRootKey.get(), {2})), Error::eNone);
+    EXPECT_EQ(store.VerifyChain({mIntermediate}, now, validUntil), Error::eFailed);
+
+    EXPECT_EQ(store.SetCRL({0x30, 0x00}), Error::eInvalidArgument);
+}
+
+TEST_F(TrustStoreTest, CRLReplay)
+{
+    TrustStore store;
+    time_t     now = time(nullptr), validUntil = 0;
+
+    ASSERT_EQ(store.AddTrustAnchor(mRoot), Error::eNone);
+
+    auto previous = CreateTestCRL("intermediate", mIntermediateKey.get(), {}, 7, -2);
+
+    ASSERT_EQ(store.SetCRL(previous), Error::eNone);
+    ASSERT_EQ(store.SetCRL(CreateTestCRL("intermediate", mIntermediateKey.get(), {3})), Error::eNone);
+    ASSERT_EQ(store.VerifyChain({mLeaf, mIntermediate}, now, validUntil), Error::eFailed);
+
+    // Older CRL doesn't unrevoke the leaf, the same CRL is not applied twice.
+    EXPECT_EQ(store.SetCRL(previous), Error::eAlreadyExist);
+    EXPECT_EQ(store.SetCRL(CreateTestCRL("intermediate", mIntermediateKey.get(), {})), Error::eAlreadyExist);
+    EXPECT_EQ(store.VerifyChain({mLeaf, mIntermediate}, now, validUntil), Error::eFailed);
+
+    // CRL numbers take precedence over this update times.
+    ASSERT_EQ(store.SetCRL(CreateTestCRL("root", mRootKey.get(), {}, 7, -2, 2)), Error::eNone);
+    EXPECT_EQ(store.SetCRL(CreateTestCRL("root", mRootKey.get(), {2}, 7, -1, 1)), Error::eAlreadyExist);
+    EXPECT_EQ(store.VerifyChain({mIntermediate}, now, validUntil), Error::eNone);
+
+    ASSERT_EQ(store.SetCRL(CreateTestCRL("root", mRootKey.get(), {2}, 7, -3, 3)), Error::eNone);
+    EXPECT_EQ(store.VerifyChain({mIntermediate}, now, validUntil), Error::eFailed);
+}
+
+TEST_F(TrustStoreTest, CRLSignature)
+{
+    TrustStore store;
+    time_t     now = time(nullptr), validUntil = 0;
+
+    ASSERT_EQ(store.AddTrustAnchor(mRoot), Error::eNone);
+
+    // CRL of the anchor is verified when set.
+    EXPECT_EQ(store.SetCRL(CreateTestCRL("root", mIntermediateKey.get(), {2})), Error::eFailed);
+
+    auto tampered = CreateTestCRL("root", mRootKey.get(), {2});
+
+    tampered.back() ^= 0x01;
+
+    EXPECT_EQ(store.SetCRL(tampered), Error::eFailed);
+    EXPECT_EQ(store.VerifyChain({mLeaf, mIntermediate}, now, validUntil), Error::eNone);
+
+    // CRL of the intermediate CA is verified during chain verification.
+    ASSERT_EQ(store.SetCRL(CreateTestCRL("intermediate", mLeafKey.get(), {}, 7, -3)), Error::eNone);
+    EXPECT_EQ(store.VerifyChain({mLeaf, mIntermediate}, now, validUntil), Error::eFailed);
+
+    ASSERT_EQ(store.SetCRL(CreateTestCRL("intermediate", mIntermediateKey.get(), {}, 7, -2)), Error::eNone);
+    ASSERT_EQ(store.VerifyChain({mLeaf, mIntermediate}, now, validUntil), Error::eNone);
+
+    // Once verified, the intermediate CA CRL can be replaced only by a CRL signed with the same key.
+    EXPECT_EQ(store.SetCRL(CreateTestCRL("intermediate", mLeafKey.get(), {3})), Error::eFailed);
+    EXPECT_EQ(store.VerifyChain({mLeaf, mIntermediate}, now, validUntil), Error::eNone);
+}
+
+TEST_F(TrustStoreTest, Generation)
+{
+    TrustStore store;
+
+    auto generation = store.GetGeneration();
+
+    ASSERT_EQ(store.AddTrustAnchor(mRoot), Error::eNone);
+    EXPECT_GT(store.GetGeneration(), generation);
+
+    generation = store.GetGeneration();
+
+    ASSERT_EQ(store.SetCRL(CreateTestCRL("root", mRootKey.get(), {})), Error::eNone);
+    EXPECT_GT(store.GetGeneration(), generation);
+
+    generation = store.GetGeneration();
+
+    EXPECT_EQ(store.AddTrustAnchor(mRoot), Error::eAlreadyExist);
+    EXPECT_EQ(store.GetGeneration(), generation);
+}
+
+TEST_F(TrustStoreTest, AddTrustBundle)
+{
+    TrustStore store;
+
+    auto generation = store.GetGeneration();
+    auto bundle     = "root CA\n" + ConvertToPEM(mRoot) + "intermediate CA\n" + ConvertToPEM(mIntermediate);
+
+    ASSERT_EQ(store.AddTrustBundle(bundle), Error::eNone);
+    EXPECT_EQ(store.GetGeneration(), generation + 1);
+
+    time_t validUntil = 0;
+
+    EXPECT_EQ(store.VerifyChain({mLeaf}, time(nullptr), validUntil), Error::eNone);
+
+    // Already trusted certificates are skipped.
+    generation = store.GetGeneration();
+
+    EXPECT_EQ(store.AddTrustBundle(bundle), Error::eNone);
+    EXPECT_EQ(store.GetGeneration(), generation);
+
+    // Bundle with invalid certificate is rejected as a whole.
+    std::string invalid;
+
+    pem::Encode(pem::cCertificate, std::vector<uint8_t> {1, 2, 3}, invalid);
+
+    TrustStore other;
+
+    EXPECT_EQ(other.AddTrustBundle(ConvertToPEM(mRoot) + invalid), Error::eInvalidArgument);
+    EXPECT_EQ(other.VerifyChain({mLeaf, mIntermediate}, time(nullptr), validUntil), Error::eFailed);
+}
+
+TEST_F(TrustStoreTest, UpdateTrustAnchors)
+{
+    TrustStore store;
+    time_t     validUntil = 0;
+
+    ASSERT_EQ(store.AddTrustAnchor(mIntermediate), Error::eNone);
+
+    // Anchors are replaced with a single update.
+    auto generation = store.GetGeneration();
+
+    ASSERT_EQ(store.UpdateTrustAnchors({mRoot}, {mIntermediate}), Error::eNone);
+    EXPECT_EQ(store.GetGeneration(), generation + 1);
+    EXPECT_EQ(store.VerifyChain({mLeaf, mIntermediate}, time(nullptr), validUntil), Error::eNone);
+    EXPECT_EQ(store.RemoveTrustAnchor(mIntermediate), Error::eNotFound);
+
+    // Unknown removed and already trusted added certificates are skipped.
+    generation = store.GetGeneration();
+
+    ASSERT_EQ(store.UpdateTrustAnchors({mRoot}, {mIntermediate}), Error::eNone);
+    EXPECT_EQ(store.GetGeneration(), generation);
+
+    // Nothing is changed if any certificate is invalid.
+    EXPECT_EQ(store.UpdateTrustAnchors({}, {mRoot, {0x30, 0x00}}), Error::eInvalidArgument);
+    EXPECT_EQ(store.GetGeneration(), generation);
+    EXPECT_EQ(store.VerifyChain({mLeaf, mIntermediate}, time(nullptr), validUntil), Error::eNone);
+}
+
+TEST_F(TrustStoreTest, IssuerLookup)
+{
+    TrustStore     store;
+    TestCertParams params;
+    time_t         validUntil = 0;
+
+    // Renewed root shares the name with the current one but has another key.
+    auto renewedKey = GenerateTestKey();
+
+    params.mSubject = "root";
+    params.mIssuer  = "root";
+    params.mSerial  = 10;
+    params.mCA      = true;
+
+    auto renewedRoot = CreateTestCert(params, renewedKey.get());
+
+    params.mSubject = "intermediate";
+    params.mSerial  = 11;
+
+    auto renewedIntermediate = CreateTestCert(params, mIntermediateKey.get(), renewedKey.get());
+
+    ASSERT_EQ(store.AddTrustBundle(ConvertToPEM(renewedRoot) + ConvertToPEM(mRoot)), Error::eNone);
+    EXPECT_EQ(store.VerifyChain({mLeaf, mIntermediate}, time(nullptr), validUntil), Error::eNone);
+    EXPECT_EQ(store.VerifyChain({mLeaf, renewedIntermediate}, time(nullptr), validUntil), Error::eNone);
+
+    // Removed anchor is not found by name either.
+    ASSERT_EQ(store.RemoveTrustAnchor(mRoot), Error::eNone);
+    EXPECT_EQ(store.VerifyChain({mLeaf, mIntermediate}, time(nullptr), validUntil), Error::eFailed);
+    EXPECT_EQ(store.VerifyChain({mLeaf, renewedIntermediate}, time(nullptr), validUntil), Error::eNone);
+}
@@ -0,0 +1,147 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "crypto/sha256.hpp"
+
+#include "verifycache.hpp"
+
+namespace aos {
+namespace iam {
+namespace certhandler {
+
+/***********************************************************************************************************************
+ * Public
+ **********************************************************************************************************************/
+
+VerifyCache::VerifyCache(size_t capacity)
+    : mCapacity(capacity)
+{
+}
+
+Error VerifyCache::MakeKey(const CertChain& chain, uint64_t generation, Key& key)
+{
+    if (chain.empty()) {
+        return Error::eInvalidArgument;
+    }
+
+    std::vector<sha256::Message> messages;
+    std::vector<sha256::Digest>  digests;
+
+    for (const auto& cert : chain) {
+        messages.push_back({cert.data(), cert.size()});
+    }
+
+    // Chain certificates are hashed together by multi-buffer implementation.
+    sha256::CalculateMulti(messages, digests);
+
+    auto chainDigest = sha256::Calculate(digests.data(), digests.size() * sizeof(sha256::Digest));
+
+    // Leaf fingerprint, chain fingerprint and generation.
+    key.assign(reinterpret_cast<const char*>(digests[0].data()), digests[0].size());
+    key.append(reinterpret_cast<const char*>(chainDigest.data()), chainDigest.size());
+    key.append(reinterpret_cast<const char*>(&generation), sizeof(generation));
+
+    return Error::eNone;
+}
+
+bool VerifyCache::Lookup(const Key& key, uint64_t generation, time_t now)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    SetGeneration(generation);
+
+    auto it = mIndex.find(key);
+    if (it == mIndex.end()) {
+        mMetrics.mMisses++;
+
+        return false;
+    }
+
+    auto entry = it->second;
+
+    if (now >= entry->mValidUntil) {
+        mEntries.erase(entry);
+        mIndex.erase(it);
+        mMetrics.mMisses++;
+
+        return false;
+    }
+
+    mEntries.splice(mEntries.begin(), mEntries, entry);
+    mMetrics.mHits++;
+    mMetrics.mTimeSaved += entry->mVerifyTime;
+
+    return true;
+}
+
+void VerifyCache::Add(const Key& key, uint64_t generation, time_t validUntil, std::chrono::nanoseconds verifyTime)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    // Result of verification against an outdated trust store is not cached.
+    if (generation < mGeneration || mCapacity == 0) {
+        return;
+    }
+
+    SetGeneration(generation);
+
+    auto it = mIndex.find(key);
+    if (it != mIndex.end()) {
+        it->second->mValidUntil = validUntil;
+        it->second->mVerifyTime = verifyTime;
+        mEntries.splice(mEntries.begin(), mEntries, it->second);
+
+        return;
+    }
+
+    if (mEntries.size() >= mCapacity) {
+        mIndex.erase(mEntries.back().mKey);
+        mEntries.pop_back();
+    }
+
+    mEntries.push_front({key, validUntil, verifyTime});
+    mIndex.emplace(key, mEntries.begin());
+}
+
+VerifyCacheMetrics VerifyCache::GetMetrics() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    auto metrics = mMetrics;
+
+    metrics.mEntries = mEntries.size();
+
+    return metrics;
+}
+
+/***********************************************************************************************************************
+ * Private
+ **********************************************************************************************************************/
+
+void VerifyCache::SetGeneration(uint64_t generation)
+{
+    // Entries of the previous generation can't be hit anymore, drop them at once instead of waiting for eviction.
+    if (generation > mGeneration) {
+        mEntries.clear();
+        mIndex.clear();
+        mGeneration = generation;
+    }
+}
+
+} // namespace certhandler
+} // namespace iam
+} // namespace aos
@@ -0,0 +1,156 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef VERIFYCACHE_HPP_
+#define VERIFYCACHE_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "error/error.hpp"
+#include "truststore.hpp"
+
+namespace aos {
+namespace iam {
+namespace certhandler {
+
+/** @addtogroup iam Identification and Access Manager
+ *  @{
+ */
+
+/**
+ * Chain verification cache metrics.
+ */
+struct VerifyCacheMetrics {
+    /**
+     * Number of lookups served from the cache.
+     */
+    uint64_t mHits = 0;
+
+    /**
+     * Number of lookups which required full verification.
+     */
+    uint64_t mMisses = 0;
+
+    /**
+     * Verification time saved by cache hits, estimated from the time of the cached verification.
+     */
+    std::chrono::nanoseconds mTimeSaved {0};
+
+    /**
+     * Number of cached results.
+     */
+    size_t mEntries = 0;
+
+    /**
+     * Returns hit ratio.
+     *
+     * @return double.
+     */
+    double GetHitRatio() const
+    {
+        return mHits + mMisses ? static_cast<double>(mHits) / static_cast<double>(mHits + mMisses) : 0.0;
+    }
+};
+
+/**
+ * LRU cache of successful chain verification results. Entry key consists of the leaf certificate fingerprint, the
+ * whole chain fingerprint and the trust store generation, so results are invalidated by any trust anchor or CRL
+ * change. Entries expire at the earliest chain certificate expiration or next CRL update.
+ */
+class VerifyCache {
+public:
+    /**
+     * Cache key.
+     */
+    using Key = std::string;
+
+    /**
+     * Creates verification cache.
+     *
+     * @param capacity max number of cached results.
+     */
+    explicit VerifyCache(size_t capacity);
+
+    /**
+     * Creates cache key.
+     *
+     * @param chain certificate chain.
+     * @param generation trust store generation.
+     * @param[out] key cache key.
+     * @return Error.
+     */
+    static Error MakeKey(const CertChain& chain, uint64_t generation, Key& key);
+
+    /**
+     * Looks up successful verification result and updates hit and miss counters.
+     *
+     * @param key cache key.
+     * @param generation current trust store generation, entries of other generations are dropped.
+     * @param now current time.
+     * @return true if successful result is cached.
+     */
+    bool Lookup(const Key& key, uint64_t generation, time_t now);
+
+    /**
+     * Adds successful verification result.
+     *
+     * @param key cache key.
+     * @param generation trust store generation the chain was verified with.
+     * @param validUntil time until the result stays valid.
+     * @param verifyTime time spent to verify the chain.
+     */
+    void Add(const Key& key, uint64_t generation, time_t validUntil, std::chrono::nanoseconds verifyTime);
+
+    /**
+     * Returns cache metrics.
+     *
+     * @return VerifyCacheMetrics.
+     */
+    VerifyCacheMetrics GetMetrics() const;
+
+private:
+    struct Entry {
+        Key                      mKey;
+        time_t                   mValidUntil;
+        std::chrono::nanoseconds mVerifyTime;
+    };
+
+    using EntryList = std::list<Entry>;
+
+    void SetGeneration(uint64_t generation);
+
+    size_t                                       mCapacity;
+    mutable std::mutex                           mMutex;
+    EntryList                                    mEntries;
+    std::unordered_map<Key, EntryList::iterator> mIndex;
+    uint64_t                                     mGeneration = 0;
+    VerifyCacheMetrics                           mMetrics;
+};
+
+/** @}*/
+
+} // namespace certhandler
+} // namespace iam
+} // namespace aos
+
+#endif
@@ -0,0 +1,121 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include "verifycache.hpp"
+
+using namespace aos;
+using namespace aos::iam::certhandler;
+
+/***********************************************************************************************************************
+ * Tests
+ **********************************************************************************************************************/
+
+TEST(verifycache, MakeKey)
+{
+    VerifyCache::Key key1, key2, key3, key4;
+
+    ASSERT_EQ(VerifyCache::MakeKey({{1}, {2}}, 1, key1), Error::eNone);
+    ASSERT_EQ(VerifyCache::MakeKey({{1}, {3}}, 1, key2), Error::eNone);
+    ASSERT_EQ(VerifyCache::MakeKey({{1}, {2}}, 2, key3), Error::eNone);
+    ASSERT_EQ(VerifyCache::MakeKey({{1}, {2}}, 1, key4), Error::eNone);
+
+    EXPECT_NE(key1, key2);
+    EXPECT_NE(key1, key3);
+    EXPECT_EQ(key1, key4);
+
+    EXPECT_EQ(VerifyCache::MakeKey({}, 1, key1), Error::eInvalidArgument);
+}
+
+TEST(verifycache, Metrics)
+{
+    VerifyCache      cache(4);
+    VerifyCache::Key key;
+
+    ASSERT_EQ(VerifyCache::MakeKey({{1}}, 1, key), Error::eNone);
+
+    EXPECT_FALSE(cache.Lookup(key, 1, 100));
+
+    cache.Add(key, 1, 200, std::chrono::milliseconds(2));
+
+    EXPECT_TRUE(cache.Lookup(key, 1, 100));
+    EXPECT_TRUE(cache.Lookup(key, 1, 199));
+
+    auto metrics = cache.GetMetrics();
+
+    EXPECT_EQ(metrics.mHits, 2);
+    EXPECT_EQ(metrics.mMisses, 1);
+    EXPECT_EQ(metrics.mEntries, 1);
+    EXPECT_EQ(metrics.mTimeSaved, std::chrono::milliseconds(4));
+    EXPECT_DOUBLE_EQ(metrics.GetHitRatio(), 2.0 / 3.0);
+}
+
+TEST(verifycache, Expiry)
+{
+    VerifyCache      cache(4);
+    VerifyCache::Key key;
+
+    ASSERT_EQ(VerifyCache::MakeKey({{1}}, 1, key), Error::eNone);
+
+    cache.Add(key, 1, 200, std::chrono::milliseconds(1));
+
+    EXPECT_FALSE(cache.Lookup(key, 1, 200));
+    EXPECT_EQ(cache.GetMetrics().mEntries, 0);
+}
+
+TEST(verifycache, Generation)
+{
+    VerifyCache      cache(4);
+    VerifyCache::Key oldKey, newKey;
+
+    ASSERT_EQ(VerifyCache::MakeKey({{1}}, 1, oldKey), Error::eNone);
+    ASSERT_EQ(VerifyCache::MakeKey({{1}}, 2, newKey), Error::eNone);
+
+    cache.Add(oldKey, 1, 200, std::chrono::milliseconds(1));
+
+    // Trust store change drops all cached results.
+    EXPECT_FALSE(cache.Lookup(newKey, 2, 100));
+    EXPECT_EQ(cache.GetMetrics().mEntries, 0);
+
+    // Result verified with outdated trust store is not cached.
+    cache.Add(oldKey, 1, 200, std::chrono::milliseconds(1));
+    EXPECT_EQ(cache.GetMetrics().mEntries, 0);
+}
+
+TEST(verifycache, Eviction)
+{
+    VerifyCache                   cache(2);
+    std::vector<VerifyCache::Key> keys(3);
+
+    for (uint8_t i = 0; i < keys.size(); i++) {
+        ASSERT_EQ(VerifyCache::MakeKey({{i}}, 1, keys[i]), Error::eNone);
+    }
+
+    cache.Add(keys[0], 1, 200, std::chrono::milliseconds(1));
+    cache.Add(keys[1], 1, 200, std::chrono::milliseconds(1));
+
+    // Touch the first entry, so the second one is the least recently used.
+    EXPECT_TRUE(cache.Lookup(keys[0], 1, 100));
+
+    cache.Add(keys[2], 1, 200, std::chrono::milliseconds(1));
+
+    EXPECT_TRUE(cache.Lookup(keys[0], 1, 100));
+    EXPECT_FALSE(cache.Lookup(keys[1], 1, 100));
+    EXPECT_TRUE(cache.Lookup(keys[2], 1, 100));
+    EXPECT_EQ(cache.GetMetrics().mEntries, 2);
+}
@@ -0,0 +1,382 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "x509parser.hpp"
+
+namespace aos {
+namespace iam {
+namespace certhandler {
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+namespace {
+
+// Max number of length bytes: certificates larger than 4GB are not supported.
+constexpr size_t cMaxLengthBytes = 4;
+
+// Implicitly tagged issuerUniqueID and subjectUniqueID.
+constexpr uint8_t cIssuerUniqueID  = 0x81;
+constexpr uint8_t cSubjectUniqueID = 0x82;
+
+// keyIdentifier field of AuthorityKeyIdentifier.
+constexpr uint8_t cKeyIdentifier = 0x80;
+
+// id-ce-subjectKeyIdentifier and id-ce-authorityKeyIdentifier.
+const uint8_t cSubjectKeyIDOID[]   = {0x55, 0x1d, 0x0e};
+const uint8_t cAuthorityKeyIDOID[] = {0x55, 0x1d, 0x23};
+
+bool ParseDigits(const uint8_t* data, size_t count, int& value)
+{
+    value = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        if (data[i] < '0' || data[i] > '9') {
+            return false;
+        }
+
+        value = value * 10 + (data[i] - '0');
+    }
+
+    return true;
+}
+
+// Returns number of days since 1970-01-01 for proleptic Gregorian calendar date.
+int64_t DaysFromCivil(int64_t year, int month, int day)
+{
+    year -= month <= 2;
+
+    auto era = (year >= 0 ? year : year - 399) / 400;
+    auto yoe = year - era * 400;
+    auto doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    auto doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+
+    return era * 146097 + doe - 719468;
+}
+
+// Reads validity time of the certificate.
+Error ReadTime(DERReader& reader, time_t& result)
+{
+    uint8_t tag = 0;
+    DERView value;
+
+    auto err = reader.Read(tag, value);
+    if (err != Error::eNone) {
+        return Error::eInvalidArgument;
+    }
+
+    return ParseTime(tag, value, result);
+}
+
+Error ParseKeyIDs(X509View& cert)
+{
+    X509ExtensionReader reader(cert);
+    X509Extension       extension;
+    Error               err = Error::eNone;
+
+    while ((err = reader.Next(extension)) == Error::eNone) {
+        DERReader valueReader(extension.mValue);
+        DERView   value;
+
+        if (extension.mOID == DERView(cSubjectKeyIDOID, sizeof(cSubjectKeyIDOID))) {
+            if (valueReader.Expect(dertag::cOctetString, cert.mSubjectKeyID) != Error::eNone || !valueReader.IsEnd()) {
+                return Error::eInvalidArgument;
+            }
+        } else if (extension.mOID == DERView(cAuthorityKeyIDOID, sizeof(cAuthorityKeyIDOID))) {
+            if (valueReader.Expect(dertag::cSequence, value) != Error::eNone || !valueReader.IsEnd()) {
+                return Error::eInvalidArgument;
+            }
+
+            DERReader fieldReader(value);
+            uint8_t   tag = 0;
+
+            if (fieldReader.Peek(tag) == Error::eNone && tag == cKeyIdentifier
+                && fieldReader.Read(tag, cert.mAuthorityKeyID) != Error::eNone) {
+                return Error::eInvalidArgument;
+            }
+        }
+    }
+
+    return err == Error::eNotFound ? Error::eNone : err;
+}
+
+Error ParseTBS(DERView tbs, X509View& cert)
+{
+    DERReader reader(tbs);
+    DERView   value;
+    uint8_t   tag = 0;
+
+    cert.mVersion = 0;
+
+    if (reader.Peek(tag) == Error::eNone && tag == dertag::cContext0) {
+        if (reader.Expect(dertag::cContext0, value) != Error::eNone) {
+            return Error::eInvalidArgument;
+        }
+
+        DERReader versionReader(value);
+
+        if (versionReader.Expect(dertag::cInteger, value) != Error::eNone || !versionReader.IsEnd() || value.mSize != 1
+            || value.mData[0] > 2) {
+            return Error::eInvalidArgument;
+        }
+
+        cert.mVersion = value.mData[0];
+    }
+
+    if (reader.Expect(dertag::cInteger, cert.mSerial) != Error::eNone || cert.mSerial.IsEmpty()) {
+        return Error::eInvalidArgument;
+    }
+
+    while (!cert.mSerial.IsEmpty() && cert.mSerial.mData[0] == 0) {
+        cert.mSerial.mData++;
+        cert.mSerial.mSize--;
+    }
+
+    if (reader.Expect(dertag::cSequence, value) != Error::eNone
+        || reader.Expect(dertag::cSequence, value, &cert.mIssuer) != Error::eNone
+        || reader.Expect(dertag::cSequence, value) != Error::eNone) {
+        return Error::eInvalidArgument;
+    }
+
+    DERReader validityReader(value);
+
+    if (ReadTime(validityReader, cert.mNotBefore) != Error::eNone
+        || ReadTime(validityReader, cert.mNotAfter) != Error::eNone || !validityReader.IsEnd()) {
+        return Error::eInvalidArgument;
+    }
+
+    if (reader.Expect(dertag::cSequence, value, &cert.mSubject) != Error::eNone
+        || reader.Expect(dertag::cSequence, value, &cert.mPublicKey) != Error::eNone) {
+        return Error::eInvalidArgument;
+    }
+
+    cert.mExtensions = DERView();
+
+    while (reader.Peek(tag) == Error::eNone) {
+        if (reader.Read(tag, value) != Error::eNone) {
+            return Error::eInvalidArgument;
+        }
+
+        if (tag == cIssuerUniqueID || tag == cSubjectUniqueID) {
+            continue;
+        }
+
+        if (tag != dertag::cContext3 || !cert.mExtensions.IsEmpty()) {
+            return Error::eInvalidArgument;
+        }
+
+        DERReader extensionsReader(value);
+
+        if (extensionsReader.Expect(dertag::cSequence, cert.mExtensions) != Error::eNone || !extensionsReader.IsEnd()) {
+            return Error::eInvalidArgument;
+        }
+    }
+
+    cert.mSubjectKeyID   = DERView();
+    cert.mAuthorityKeyID = DERView();
+
+    return ParseKeyIDs(cert);
+}
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Public
+ **********************************************************************************************************************/
+
+Error DERReader::Read(uint8_t& tag, DERView& value, DERView* element)
+{
+    auto pos  = mPos;
+    auto data = mData.mData;
+    auto size = mData.mSize;
+
+    if (pos >= size) {
+        return Error::eNotFound;
+    }
+
+    tag = data[pos++];
+
+    // High tag numbers are not used in X.509.
+    if ((tag & 0x1f) == 0x1f || pos >= size) {
+        return Error::eInvalidArgument;
+    }
+
+    size_t length = data[pos++];
+
+    if (length & 0x80) {
+        size_t numBytes = length & 0x7f;
+
+        // Indefinite length and non minimal length encodings are not allowed in DER.
+        if (numBytes == 0 || numBytes > cMaxLengthBytes || numBytes > size - pos || data[pos] == 0) {
+            return Error::eInvalidArgument;
+        }
+
+        length = 0;
+
+        for (size_t i = 0; i < numBytes; i++) {
+            length = (length << 8) | data[pos++];
+        }
+
+        if (length < 0x80) {
+            return Error::eInvalidArgument;
+        }
+    }
+
+    if (length > size - pos) {
+        return Error::eInvalidArgument;
+    }
+
+    value = DERView(data + pos, length);
+
+    if (element) {
+        *element = DERView(data + mPos, pos + length - mPos);
+    }
+
+    mPos = pos + length;
+
+    return Error::eNone;
+}
+
+Error DERReader::Expect(uint8_t tag, DERView& value, DERView* element)
+{
+    uint8_t readTag = 0;
+    auto    pos     = mPos;
+
+    if (Read(readTag, value, element) != Error::eNone || readTag != tag) {
+        mPos = pos;
+
+        return Error::eInvalidArgument;
+    }
+
+    return Error::eNone;
+}
+
+Error DERReader::Peek(uint8_t& tag) const
+{
+    if (mPos >= mData.mSize) {
+        return Error::eNotFound;
+    }
+
+    tag = mData.mData[mPos];
+
+    return Error::eNone;
+}
+
+Error X509ExtensionReader::Next(X509Extension& extension)
+{
+    DERView value;
+    uint8_t tag = 0;
+
+    auto err = mReader.Read(tag, value);
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    if (tag != dertag::cSequence) {
+        return Error::eInvalidArgument;
+    }
+
+    DERReader reader(value);
+
+    if (reader.Expect(dertag::cOID, extension.mOID) != Error::eNone || extension.mOID.IsEmpty()) {
+        return Error::eInvalidArgument;
+    }
+
+    extension.mCritical = false;
+
+    if (reader.Peek(tag) == Error::eNone && tag == dertag::cBoolean) {
+        if (reader.Expect(dertag::cBoolean, value) != Error::eNone || value.mSize != 1) {
+            return Error::eInvalidArgument;
+        }
+
+        extension.mCritical = value.mData[0] != 0;
+    }
+
+    if (reader.Expect(dertag::cOctetString, extension.mValue) != Error::eNone || !reader.IsEnd()) {
+        return Error::eInvalidArgument;
+    }
+
+    return Error::eNone;
+}
+
+Error ParseTime(uint8_t tag, DERView value, time_t& result)
+{
+    size_t yearDigits = 0;
+
+    if (tag == dertag::cUTCTime && value.mSize == 13) {
+        yearDigits = 2;
+    } else if (tag == dertag::cGeneralizedTime && value.mSize == 15) {
+        yearDigits = 4;
+    } else {
+        return Error::eInvalidArgument;
+    }
+
+    auto data = value.mData;
+    int  year = 0, month = 0, day = 0, hour = 0, minute = 0, second = 0;
+
+    if (data[value.mSize - 1] != 'Z' || !ParseDigits(data, yearDigits, year)
+        || !ParseDigits(data + yearDigits, 2, month) || !ParseDigits(data + yearDigits + 2, 2, day)
+        || !ParseDigits(data + yearDigits + 4, 2, hour) || !ParseDigits(data + yearDigits + 6, 2, minute)
+        || !ParseDigits(data + yearDigits + 8, 2, second)) {
+        return Error::eInvalidArgument;
+    }
+
+    if (yearDigits == 2) {
+        year += year >= 50 ? 1900 : 2000;
+    }
+
+    if (month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 59) {
+        return Error::eInvalidArgument;
+    }
+
+    result = static_cast<time_t>(DaysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second);
+
+    return Error::eNone;
+}
+
+Error ParseX509(DERView der, X509View& cert)
+{
+    DERReader reader(der);
+    DERView   value;
+
+    if (reader.Expect(dertag::cSequence, value) != Error::eNone || !reader.IsEnd()) {
+        return Error::eInvalidArgument;
+    }
+
+    DERReader certReader(value);
+    DERView   tbs;
+
+    if (certReader.Expect(dertag::cSequence, tbs, &cert.mTBS) != Error::eNone
+        || certReader.Expect(dertag::cSequence, value, &cert.mSignatureAlgorithm) != Error::eNone
+        || certReader.Expect(dertag::cBitString, value) != Error::eNone || !certReader.IsEnd()) {
+        return Error::eInvalidArgument;
+    }
+
+    // Signature is a whole number of bytes.
+    if (value.IsEmpty() || value.mData[0] != 0) {
+        return Error::eInvalidArgument;
+    }
+
+    cert.mSignature = DERView(value.mData + 1, value.mSize - 1);
+
+    return ParseTBS(tbs, cert);
+}
+
+} // namespace certhandler
+} // namespace iam
+} // namespace aos
@@ -0,0 +1,327 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef X509PARSER_HPP_
+#define X509PARSER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <vector>
+
+#include "error/error.hpp"
+
+namespace aos {
+namespace iam {
+namespace certhandler {
+
+/** @addtogroup iam Identification and Access Manager
+ *  @{
+ */
+
+/**
+ * Non owning view of DER data.
+ */
+struct DERView {
+    /**
+     * Data pointer.
+     */
+    const uint8_t* mData = nullptr;
+
+    /**
+     * Data size.
+     */
+    size_t mSize = 0;
+
+    /**
+     * Creates empty view.
+     */
+    DERView() = default;
+
+    /**
+     * Creates view.
+     *
+     * @param data data pointer.
+     * @param size data size.
+     */
+    DERView(const uint8_t* data, size_t size)
+        : mData(data)
+        , mSize(size)
+    {
+    }
+
+    /**
+     * Returns true if view is empty.
+     *
+     * @return bool.
+     */
+    bool IsEmpty() const { return mSize == 0; }
+
+    /**
+     * Copies view data.
+     *
+     * @return std::vector<uint8_t>.
+     */
+    std::vector<uint8_t> ToVector() const { return std::vector<uint8_t>(mData, mData + mSize); }
+
+    /**
+     * Compares view data.
+     *
+     * @param other view to compare with.
+     * @return bool.
+     */
+    bool operator==(const DERView& other) const
+    {
+        return mSize == other.mSize && (mSize == 0 || memcmp(mData, other.mData, mSize) == 0);
+    }
+
+    /**
+     * Compares view data.
+     *
+     * @param other view to compare with.
+     * @return bool.
+     */
+    bool operator!=(const DERView& other) const { return !(*this == other); }
+};
+
+/**
+ * DER tags used in X.509 certificates.
+ */
+namespace dertag {
+constexpr uint8_t cBoolean         = 0x01;
+constexpr uint8_t cInteger         = 0x02;
+constexpr uint8_t cBitString       = 0x03;
+constexpr uint8_t cOctetString     = 0x04;
+constexpr uint8_t cOID             = 0x06;
+constexpr uint8_t cUTCTime         = 0x17;
+constexpr uint8_t cGeneralizedTime = 0x18;
+constexpr uint8_t cSequence        = 0x30;
+constexpr uint8_t cContext0        = 0xa0;
+constexpr uint8_t cContext3        = 0xa3;
+} // namespace dertag
+
+/**
+ * Sequential reader of DER TLV elements. Only definite lengths and single byte tags are supported.
+ */
+class DERReader {
+public:
+    /**
+     * Creates reader.
+     *
+     * @param data DER data.
+     */
+    explicit DERReader(DERView data)
+        : mData(data)
+    {
+    }
+
+    /**
+     * Reads next element.
+     *
+     * @param[out] tag element tag.
+     * @param[out] value element content.
+     * @param[out] element whole element including tag and length, optional.
+     * @return Error.
+     */
+    Error Read(uint8_t& tag, DERView& value, DERView* element = nullptr);
+
+    /**
+     * Reads next element and checks its tag.
+     *
+     * @param tag expected tag.
+     * @param[out] value element content.
+     * @param[out] element whole element including tag and length, optional.
+     * @return Error.
+     */
+    Error Expect(uint8_t tag, DERView& value, DERView* element = nullptr);
+
+    /**
+     * Returns next element tag without consuming it.
+     *
+     * @param[out] tag element tag.
+     * @return Error eNotFound at the end of data.
+     */
+    Error Peek(uint8_t& tag) const;
+
+    /**
+     * Returns true if all data is read.
+     *
+     * @return bool.
+     */
+    bool IsEnd() const { return mPos == mData.mSize; }
+
+private:
+    DERView mData;
+    size_t  mPos = 0;
+};
+
+/**
+ * X.509 certificate extension.
+ */
+struct X509Extension {
+    /**
+     * Extension OID content.
+     */
+    DERView mOID;
+
+    /**
+     * Critical flag.
+     */
+    bool mCritical = false;
+
+    /**
+     * Extension value: content of extnValue octet string.
+     */
+    DERView mValue;
+};
+
+/**
+ * Zero copy view of X.509 certificate fields. All views point into the parsed buffer which must outlive the view.
+ */
+struct X509View {
+    /**
+     * Whole TBSCertificate element, the signed data.
+     */
+    DERView mTBS;
+
+    /**
+     * Certificate version: 0 for v1, 2 for v3.
+     */
+    int mVersion = 0;
+
+    /**
+     * Serial number content, big endian without leading zeros.
+     */
+    DERView mSerial;
+
+    /**
+     * Whole issuer Name element.
+     */
+    DERView mIssuer;
+
+    /**
+     * Whole subject Name element.
+     */
+    DERView mSubject;
+
+    /**
+     * Validity start.
+     */
+    time_t mNotBefore = 0;
+
+    /**
+     * Validity end.
+     */
+    time_t mNotAfter = 0;
+
+    /**
+     * Whole SubjectPublicKeyInfo element.
+     */
+    DERView mPublicKey;
+
+    /**
+     * Subject key identifier, empty if absent.
+     */
+    DERView mSubjectKeyID;
+
+    /**
+     * Authority key identifier keyIdentifier field, empty if absent.
+     */
+    DERView mAuthorityKeyID;
+
+    /**
+     * Content of extensions sequence, empty if absent. Use X509ExtensionReader to iterate.
+     */
+    DERView mExtensions;
+
+    /**
+     * Whole signature AlgorithmIdentifier element.
+     */
+    DERView mSignatureAlgorithm;
+
+    /**
+     * Signature value without unused bits byte.
+     */
+    DERView mSignature;
+};
+
+/**
+ * Iterates certificate extensions.
+ */
+class X509ExtensionReader {
+public:
+    /**
+     * Creates extension reader.
+     *
+     * @param cert parsed certificate.
+     */
+    explicit X509ExtensionReader(const X509View& cert)
+        : mReader(cert.mExtensions)
+    {
+    }
+
+    /**
+     * Reads next extension.
+     *
+     * @param[out] extension extension.
+     * @return Error eNotFound if there are no more extensions.
+     */
+    Error Next(X509Extension& extension);
+
+private:
+    DERReader mReader;
+};
+
+/**
+ * Parses DER X.509 certificate without copying or allocating memory. Signature is not verified.
+ *
+ * @param der DER certificate, must contain exactly one certificate.
+ * @param[out] cert certificate view.
+ * @return Error.
+ */
+Error ParseX509(DERView der, X509View& cert);
+
+/**
+ * Parses DER X.509 certificate without copying or allocating memory. Signature is not verified.
+ *
+ * @param der DER certificate, must contain exactly one certificate.
+ * @param[out] cert certificate view.
+ * @return Error.
+ */
+inline Error ParseX509(const std::vector<uint8_t>& der, X509View& cert)
+{
+    return ParseX509(DERView(der.data(), der.size()), cert);
+}
+
+/**
+ * Parses X.509 time: UTCTime YYMMDDHHMMSSZ or GeneralizedTime YYYYMMDDHHMMSSZ as required by RFC 5280.
+ *
+ * @param tag time tag, dertag::cUTCTime or dertag::cGeneralizedTime.
+ * @param value time value.
+ * @param[out] result time.
+ * @return Error.
+ */
+Error ParseTime(uint8_t tag, DERView value, time_t& result);
+
+/** @}*/
+
+} // namespace certhandler
+} // namespace iam
+} // namespace aos
+
+#endif
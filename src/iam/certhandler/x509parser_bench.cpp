@@ -0,0 +1,101 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+
+#include "testcerts.hpp"
+#include "x509parser.hpp"
+
+using namespace aos;
+using namespace aos::iam::certhandler;
+using namespace aos::iam::certhandler::test;
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+namespace {
+
+const std::vector<uint8_t>& GetCert()
+{
+    static std::vector<uint8_t> sCert;
+
+    if (sCert.empty()) {
+        auto           key = GenerateTestKey();
+        TestCertParams params;
+
+        sCert = CreateTestCert(params, key.get());
+    }
+
+    return sCert;
+}
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Benchmarks
+ **********************************************************************************************************************/
+
+// Full OpenSSL decoding followed by extraction of the fields used by certificate storage.
+static void ParseOpenSSL(benchmark::State& state)
+{
+    const auto& der = GetCert();
+
+    for (auto _ : state) {
+        auto data = der.data();
+
+        std::unique_ptr<X509, decltype(&X509_free)> cert(d2i_X509(nullptr, &data, der.size()), X509_free);
+        if (!cert) {
+            state.SkipWithError("parse failed");
+        }
+
+        unsigned char* issuer     = nullptr;
+        int            issuerSize = i2d_X509_NAME(X509_get_issuer_name(cert.get()), &issuer);
+
+        std::unique_ptr<BIGNUM, decltype(&BN_free)> serial(
+            ASN1_INTEGER_to_BN(X509_get0_serialNumber(cert.get()), nullptr), BN_free);
+        struct tm notAfter = {};
+
+        ASN1_TIME_to_tm(X509_get0_notAfter(cert.get()), &notAfter);
+        benchmark::DoNotOptimize(X509_get0_subject_key_id(cert.get()));
+        benchmark::DoNotOptimize(issuerSize);
+
+        OPENSSL_free(issuer);
+    }
+
+    state.SetBytesProcessed(state.iterations() * der.size());
+}
+
+static void ParseView(benchmark::State& state)
+{
+    const auto& der = GetCert();
+
+    for (auto _ : state) {
+        X509View cert;
+
+        if (ParseX509(der, cert) != Error::eNone) {
+            state.SkipWithError("parse failed");
+        }
+
+        benchmark::DoNotOptimize(cert);
+    }
+
+    state.SetBytesProcessed(state.iterations() * der.size());
+}
+
+BENCHMARK(ParseOpenSSL);
+BENCHMARK(ParseView);
@@ -0,0 +1,346 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <random>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "asn1time.hpp"
+#include "testcerts.hpp"
+#include "x509parser.hpp"
+
+using namespace aos;
+using namespace aos::iam::certhandler;
+using namespace aos::iam::certhandler::test;
+
+/***********************************************************************************************************************
+ * Utils
+ **********************************************************************************************************************/
+
+static bool IsInside(const DERView& view, const std::vector<uint8_t>& buffer)
+{
+    return view.IsEmpty()
+        || (view.mData >= buffer.data() && view.mSize <= buffer.size()
+            && view.mData + view.mSize <= buffer.data() + buffer.size());
+}
+
+static void CheckViews(const X509View& cert, const std::vector<uint8_t>& buffer)
+{
+    for (const auto& view : {cert.mTBS, cert.mSerial, cert.mIssuer, cert.mSubject, cert.mPublicKey, cert.mSubjectKeyID,
+             cert.mAuthorityKeyID, cert.mExtensions, cert.mSignatureAlgorithm, cert.mSignature}) {
+        EXPECT_TRUE(IsInside(view, buffer));
+    }
+
+    X509ExtensionReader reader(cert);
+    X509Extension       extension;
+
+    while (reader.Next(extension) == Error::eNone) {
+        EXPECT_TRUE(IsInside(extension.mOID, buffer));
+        EXPECT_TRUE(IsInside(extension.mValue, buffer));
+    }
+}
+
+static std::vector<uint8_t> ToVector(const ASN1_STRING* str)
+{
+    if (!str) {
+        return {};
+    }
+
+    return std::vector<uint8_t>(ASN1_STRING_get0_data(str), ASN1_STRING_get0_data(str) + ASN1_STRING_length(str));
+}
+
+static std::vector<uint8_t> NameToVector(const X509_NAME* name)
+{
+    unsigned char* data = nullptr;
+    int            size = i2d_X509_NAME(name, &data);
+
+    std::vector<uint8_t> der(data, data + size);
+
+    OPENSSL_free(data);
+
+    return der;
+}
+
+static time_t ToTime(const ASN1_TIME* asn1Time)
+{
+    struct tm tm = {};
+
+    ASN1_TIME_to_tm(asn1Time, &tm);
+
+    return timegm(&tm);
+}
+
+// Compares parsed fields with OpenSSL.
+static void CompareWithOpenSSL(const std::vector<uint8_t>& der)
+{
+    X509View cert;
+
+    ASSERT_EQ(ParseX509(der, cert), Error::eNone);
+
+    CheckViews(cert, der);
+
+    auto data = der.data();
+
+    std::unique_ptr<X509, decltype(&X509_free)> ref(d2i_X509(nullptr, &data, der.size()), X509_free);
+    ASSERT_NE(ref, nullptr);
+
+    std::unique_ptr<BIGNUM, decltype(&BN_free)> serial(
+        ASN1_INTEGER_to_BN(X509_get0_serialNumber(ref.get()), nullptr), BN_free);
+    std::vector<uint8_t> serialBytes(BN_num_bytes(serial.get()));
+
+    BN_bn2bin(serial.get(), serialBytes.data());
+
+    EXPECT_EQ(cert.mVersion, X509_get_version(ref.get()));
+    EXPECT_EQ(cert.mSerial.ToVector(), serialBytes);
+    EXPECT_EQ(cert.mIssuer.ToVector(), NameToVector(X509_get_issuer_name(ref.get())));
+    EXPECT_EQ(cert.mSubject.ToVector(), NameToVector(X509_get_subject_name(ref.get())));
+    EXPECT_EQ(cert.mNotBefore, ToTime(X509_get0_notBefore(ref.get())));
+    EXPECT_EQ(cert.mNotAfter, ToTime(X509_get0_notAfter(ref.get())));
+    EXPECT_EQ(cert.mSubjectKeyID.ToVector(), ToVector(X509_get0_subject_key_id(ref.get())));
+    EXPECT_EQ(cert.mAuthorityKeyID.ToVector(), ToVector(X509_get0_authority_key_id(ref.get())));
+
+    unsigned char* publicKey     = nullptr;
+    int            publicKeySize = i2d_X509_PUBKEY(X509_get_X509_PUBKEY(ref.get()), &publicKey);
+
+    EXPECT_EQ(cert.mPublicKey.ToVector(), std::vector<uint8_t>(publicKey, publicKey + publicKeySize));
+    OPENSSL_free(publicKey);
+
+    const ASN1_BIT_STRING* signature = nullptr;
+
+    X509_get0_signature(&signature, nullptr, ref.get());
+    EXPECT_EQ(cert.mSignature.ToVector(), ToVector(signature));
+
+    X509ExtensionReader reader(cert);
+    X509Extension       extension;
+    int                 index = 0;
+
+    while (reader.Next(extension) == Error::eNone) {
+        auto refExtension = X509_get_ext(ref.get(), index++);
+
+        ASSERT_NE(refExtension, nullptr);
+        EXPECT_EQ(extension.mCritical, X509_EXTENSION_get_critical(refExtension) != 0);
+        EXPECT_EQ(extension.mValue.ToVector(), ToVector(X509_EXTENSION_get_data(refExtension)));
+    }
+
+    EXPECT_EQ(index, X509_get_ext_count(ref.get()));
+}
+
+/***********************************************************************************************************************
+ * Tests
+ **********************************************************************************************************************/
+
+TEST(x509parser, Fields)
+{
+    auto           caKey = GenerateTestKey(), key = GenerateTestKey();
+    TestCertParams params;
+
+    params.mSubject = "ca";
+    params.mIssuer  = "ca";
+    params.mCA      = true;
+    params.mSerial  = 0x80;
+
+    CompareWithOpenSSL(CreateTestCert(params, caKey.get()));
+
+    // Validity end after 2049 is encoded as GeneralizedTime.
+    params.mSubject  = "leaf";
+    params.mCA       = false;
+    params.mSerial   = 0x123456;
+    params.mNotAfter = 365 * 40;
+
+    CompareWithOpenSSL(CreateTestCert(params, key.get(), caKey.get()));
+
+    std::unique_ptr<EVP_PKEY, decltype(&EVP_PKEY_free)> rsaKey(EVP_RSA_gen(2048), EVP_PKEY_free);
+
+    CompareWithOpenSSL(CreateTestCert(params, rsaKey.get(), caKey.get()));
+}
+
+TEST(x509parser, NoExtensions)
+{
+    auto key = GenerateTestKey();
+
+    std::unique_ptr<X509, decltype(&X509_free)> ref(X509_new(), X509_free);
+
+    ASN1_INTEGER_set(X509_get_serialNumber(ref.get()), 1);
+    X509_gmtime_adj(X509_getm_notBefore(ref.get()), 0);
+    X509_gmtime_adj(X509_getm_notAfter(ref.get()), 3600);
+    X509_set_pubkey(ref.get(), key.get());
+    X509_sign(ref.get(), key.get(), EVP_sha256());
+
+    unsigned char* data = nullptr;
+    int            size = i2d_X509(ref.get(), &data);
+
+    std::vector<uint8_t> der(data, data + size);
+
+    OPENSSL_free(data);
+
+    CompareWithOpenSSL(der);
+
+    X509View cert;
+
+    ASSERT_EQ(ParseX509(der, cert), Error::eNone);
+    EXPECT_EQ(cert.mVersion, 0);
+    EXPECT_TRUE(cert.mExtensions.IsEmpty());
+    EXPECT_TRUE(cert.mSubjectKeyID.IsEmpty());
+}
+
+TEST(x509parser, DERReader)
+{
+    uint8_t tag = 0;
+    DERView value;
+
+    const std::vector<std::vector<uint8_t>> invalid = {
+        {0x30},                               // missing length
+        {0x30, 0x80, 0x00, 0x00},             // indefinite length
+        {0x30, 0x81, 0x05, 0, 0, 0, 0},       // non minimal length
+        {0x30, 0x82, 0x00, 0x80},             // leading zero length byte
+        {0x30, 0x85, 1, 0, 0, 0, 0},          // too many length bytes
+        {0x30, 0x84, 0xff, 0xff, 0xff, 0xff}, // length exceeds data
+        {0x1f, 0x01, 0x00},                   // high tag number
+        {0x04, 0x03, 0x00},                   // truncated content
+    };
+
+    for (const auto& data : invalid) {
+        DERReader reader(DERView(data.data(), data.size()));
+
+        EXPECT_EQ(reader.Read(tag, value), Error::eInvalidArgument);
+    }
+
+    const std::vector<uint8_t> valid = {0x04, 0x81, 0x80};
+    std::vector<uint8_t>       data  = valid;
+
+    data.resize(valid.size() + 0x80);
+
+    DERReader reader(DERView(data.data(), data.size()));
+    DERView   element;
+
+    ASSERT_EQ(reader.Read(tag, value, &element), Error::eNone);
+    EXPECT_EQ(tag, dertag::cOctetString);
+    EXPECT_EQ(value.mData, data.data() + 3);
+    EXPECT_EQ(value.mSize, 0x80);
+    EXPECT_EQ(element.mSize, data.size());
+    EXPECT_TRUE(reader.IsEnd());
+    EXPECT_EQ(reader.Read(tag, value), Error::eNotFound);
+}
+
+TEST(x509parser, Truncated)
+{
+    auto           key = GenerateTestKey();
+    TestCertParams params;
+    auto           der = CreateTestCert(params, key.get());
+
+    for (size_t size = 0; size < der.size(); size++) {
+        std::vector<uint8_t> truncated(der.begin(), der.begin() + size);
+        X509View             cert;
+
+        EXPECT_NE(ParseX509(truncated, cert), Error::eNone) << "size: " << size;
+    }
+
+    der.push_back(0);
+
+    X509View cert;
+
+    EXPECT_EQ(ParseX509(der, cert), Error::eInvalidArgument);
+}
+
+TEST(x509parser, Time)
+{
+    const std::string utcTime = "490101000000Z", generalizedTime = "20500101000000Z";
+    time_t            result  = 0;
+
+    ASSERT_EQ(ParseTime(dertag::cUTCTime, DERView(reinterpret_cast<const uint8_t*>(utcTime.data()), utcTime.size()),
+                  result),
+        Error::eNone);
+    EXPECT_EQ(result, 2493072000);
+
+    ASSERT_EQ(ParseTime(dertag::cGeneralizedTime,
+                  DERView(reinterpret_cast<const uint8_t*>(generalizedTime.data()), generalizedTime.size()), result),
+        Error::eNone);
+    EXPECT_EQ(result, 2524608000);
+
+    EXPECT_EQ(ParseTime(dertag::cGeneralizedTime,
+                  DERView(reinterpret_cast<const uint8_t*>(utcTime.data()), utcTime.size()), result),
+        Error::eInvalidArgument);
+
+    // OpenSSL time of certificates and CRLs.
+    std::unique_ptr<ASN1_TIME, decltype(&ASN1_TIME_free)> asn1Time(ASN1_TIME_set(nullptr, 1700000000), ASN1_TIME_free);
+
+    ASSERT_NE(asn1Time, nullptr);
+    ASSERT_EQ(ConvertTime(asn1Time.get(), result), Error::eNone);
+    EXPECT_EQ(result, 1700000000);
+
+    ASSERT_NE(ASN1_TIME_set(asn1Time.get(), 2524608000), nullptr);
+    ASSERT_EQ(ConvertTime(asn1Time.get(), result), Error::eNone);
+    EXPECT_EQ(result, 2524608000);
+
+    EXPECT_EQ(ConvertTime(nullptr, result), Error::eInvalidArgument);
+}
+
+TEST(x509parser, Fuzz)
+{
+    auto           key = GenerateTestKey();
+    TestCertParams params;
+    auto           der = CreateTestCert(params, key.get());
+
+    std::mt19937                          random(1234);
+    std::uniform_int_distribution<size_t> position(0, der.size() - 1);
+    std::uniform_int_distribution<int>    byte(0, 255);
+    std::uniform_int_distribution<int>    numMutations(1, 8);
+    size_t                                numParsed = 0;
+
+    for (int i = 0; i < 20000; i++) {
+        auto mutated = der;
+
+        for (int j = numMutations(random); j > 0; j--) {
+            mutated[position(random)] = static_cast<uint8_t>(byte(random));
+        }
+
+        if (i % 4 == 0) {
+            mutated.resize(position(random));
+        }
+
+        X509View cert;
+
+        if (ParseX509(mutated, cert) == Error::eNone) {
+            CheckViews(cert, mutated);
+            numParsed++;
+        }
+    }
+
+    // Random data.
+    for (int i = 0; i < 20000; i++) {
+        std::vector<uint8_t> data(position(random) % 64);
+
+        for (auto& value : data) {
+            value = static_cast<uint8_t>(byte(random));
+        }
+
+        if (!data.empty() && i % 2 == 0) {
+            data[0] = dertag::cSequence;
+        }
+
+        X509View cert;
+
+        if (ParseX509(data, cert) == Error::eNone) {
+            CheckViews(cert, data);
+        }
+    }
+
+    // Mutations in signature and names keep the certificate parseable.
+    EXPECT_GT(numParsed, 0);
+}
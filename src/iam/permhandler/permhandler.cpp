@@ -0,0 +1,327 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <algorithm>
+#include <cstring>
+
+#include <openssl/rand.h>
+
+#include "permhandler.hpp"
+#include "tools/rcu.hpp"
+
+namespace aos {
+namespace iam {
+namespace permhandler {
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+namespace {
+
+constexpr size_t cSecretSize   = 16;
+constexpr size_t cMinTableSize = 16;
+
+// Branch free comparison: the time doesn't depend on the position of the first mismatch. Compared word at a time,
+// CRYPTO_memcmp() processes one byte per iteration and dominates the lookup time.
+bool IsEqualSecret(const std::string& lhs, const std::string& rhs)
+{
+    if (lhs.size() != rhs.size()) {
+        return false;
+    }
+
+    auto     left = lhs.data(), right = rhs.data();
+    auto     size = lhs.size();
+    uint64_t diff = 0;
+
+    for (; size >= sizeof(uint64_t); left += sizeof(uint64_t), right += sizeof(uint64_t), size -= sizeof(uint64_t)) {
+        uint64_t leftWord = 0, rightWord = 0;
+
+        memcpy(&leftWord, left, sizeof(leftWord));
+        memcpy(&rightWord, right, sizeof(rightWord));
+
+        diff |= leftWord ^ rightWord;
+    }
+
+    for (; size > 0; left++, right++, size--) {
+        diff |= static_cast<uint8_t>(*left ^ *right);
+    }
+
+    return diff == 0;
+}
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Public
+ **********************************************************************************************************************/
+
+PermHandler::PermHandler()
+{
+    // Keyed hash: bucket positions and probe lengths don't tell anything about secret values.
+    if (RAND_bytes(reinterpret_cast<unsigned char*>(&mHashKey), sizeof(mHashKey)) != 1) {
+        mHashKey = reinterpret_cast<uintptr_t>(this);
+    }
+}
+
+PermHandler::~PermHandler()
+{
+    delete mTable.load();
+}
+
+Error PermHandler::RegisterInstance(const InstanceIdent& instanceIdent,
+    const std::vector<FunctionalServicePermissions>& permissions, std::string& secret)
+{
+    // Waiting for readers of the previous table would wait for the caller itself.
+    if (rcu::IsReading()) {
+        return Error::eWrongState;
+    }
+
+    const Table* previous = nullptr;
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        auto it = std::find_if(mInstances.begin(), mInstances.end(),
+            [&instanceIdent](const InstancePtr& instance) { return instance->mIdent == instanceIdent; });
+
+        auto instance = std::make_shared<Instance>();
+
+        if (it != mInstances.end()) {
+            instance->mSecret = (*it)->mSecret;
+        } else {
+            auto err = GenerateSecret(instance->mSecret);
+            if (err != Error::eNone) {
+                return err;
+            }
+        }
+
+        instance->mHash        = Hash(instance->mSecret);
+        instance->mIdent       = instanceIdent;
+        instance->mPermissions = permissions;
+
+        if (it != mInstances.end()) {
+            *it = instance;
+        } else {
+            mInstances.push_back(instance);
+        }
+
+        previous = UpdateTable();
+        secret   = instance->mSecret;
+    }
+
+    FreeTable(previous);
+
+    return Error::eNone;
+}
+
+Error PermHandler::UnregisterInstance(const InstanceIdent& instanceIdent)
+{
+    if (rcu::IsReading()) {
+        return Error::eWrongState;
+    }
+
+    const Table* previous = nullptr;
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        auto it = std::find_if(mInstances.begin(), mInstances.end(),
+            [&instanceIdent](const InstancePtr& instance) { return instance->mIdent == instanceIdent; });
+        if (it == mInstances.end()) {
+            return Error::eNotFound;
+        }
+
+        mInstances.erase(it);
+        previous = UpdateTable();
+    }
+
+    FreeTable(previous);
+
+    return Error::eNone;
+}
+
+Error PermHandler::GetPermissions(const std::string& secret, const std::string& funcServerID,
+    InstanceIdent& instanceIdent, std::vector<FunctionPermissions>& permissions) const
+{
+    rcu::ReadLock    lock;
+    PermissionResult result;
+
+    auto err = Check(mTable.load(), secret, funcServerID, result);
+    if (err != Error::eNone) {
+        return err;
+    }
+
+    instanceIdent = *result.mInstanceIdent;
+    permissions   = *result.mPermissions;
+
+    return Error::eNone;
+}
+
+Error PermHandler::CheckPermissions(
+    const rcu::ReadLock& lock, const PermissionCheck* checks, size_t count, PermissionResult* results) const
+{
+    (void)lock;
+
+    // Single snapshot: all checks see the same registrations.
+    auto table = mTable.load();
+    auto err   = Error::eNone;
+
+    for (size_t i = 0; i < count; i++) {
+        if (Check(table, checks[i].mSecret, checks[i].mFuncServerID, results[i]) != Error::eNone) {
+            err = Error::eNotFound;
+        }
+    }
+
+    return err;
+}
+
+/***********************************************************************************************************************
+ * Private
+ **********************************************************************************************************************/
+
+uint64_t PermHandler::Hash(const std::string& secret) const
+{
+    auto     data = secret.data();
+    auto     size = secret.size();
+    uint64_t hash = mHashKey ^ (size * 0x9e3779b97f4a7c15);
+
+    // Word at a time: the hash is on the path of every permission check.
+    for (; size >= sizeof(uint64_t); data += sizeof(uint64_t), size -= sizeof(uint64_t)) {
+        uint64_t word = 0;
+
+        memcpy(&word, data, sizeof(word));
+
+        hash = (hash ^ word) * 0x9e3779b97f4a7c15;
+        hash ^= hash >> 32;
+    }
+
+    for (; size > 0; data++, size--) {
+        hash = (hash ^ static_cast<uint8_t>(*data)) * 0x9e3779b97f4a7c15;
+    }
+
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccd;
+    hash ^= hash >> 33;
+
+    return hash;
+}
+
+const PermHandler::Instance* PermHandler::Find(const Table& table, const std::string& secret) const
+{
+    auto hash = Hash(secret);
+
+    for (auto i = hash & table.mMask;; i = (i + 1) & table.mMask) {
+        auto instance = table.mBuckets[i].get();
+
+        if (!instance) {
+            return nullptr;
+        }
+
+        if (IsEqualSecret(instance->mSecret, secret)) {
+            return instance;
+        }
+    }
+}
+
+Error PermHandler::GenerateSecret(std::string& secret) const
+{
+    static const char cHexDigits[] = "0123456789abcdef";
+
+    while (true) {
+        unsigned char random[cSecretSize];
+
+        if (RAND_bytes(random, sizeof(random)) != 1) {
+            return Error::eFailed;
+        }
+
+        secret.clear();
+
+        for (auto value : random) {
+            secret.push_back(cHexDigits[value >> 4]);
+            secret.push_back(cHexDigits[value & 0xf]);
+        }
+
+        if (std::none_of(mInstances.begin(), mInstances.end(),
+                [&secret](const InstancePtr& instance) { return instance->mSecret == secret; })) {
+            return Error::eNone;
+        }
+    }
+}
+
+const PermHandler::Table* PermHandler::UpdateTable()
+{
+    auto table = new Table();
+    auto size  = cMinTableSize;
+
+    while (size < mInstances.size() * 2) {
+        size *= 2;
+    }
+
+    table->mBuckets.resize(size);
+    table->mMask = size - 1;
+
+    for (const auto& instance : mInstances) {
+        auto i = instance->mHash & table->mMask;
+
+        while (table->mBuckets[i]) {
+            i = (i + 1) & table->mMask;
+        }
+
+        table->mBuckets[i] = instance;
+    }
+
+    return mTable.exchange(table);
+}
+
+void PermHandler::FreeTable(const Table* table)
+{
+    // Readers still using the table are waited for without holding the mutex: a reader blocked on it would never
+    // leave its read side critical section, and other updates are not stalled by the grace period.
+    if (table) {
+        rcu::Synchronize();
+        delete table;
+    }
+}
+
+Error PermHandler::Check(
+    const Table* table, const std::string& secret, const std::string& funcServerID, PermissionResult& result) const
+{
+    result = PermissionResult();
+
+    auto instance = table ? Find(*table, secret) : nullptr;
+    if (!instance) {
+        return result.mError;
+    }
+
+    auto it = std::find_if(instance->mPermissions.begin(), instance->mPermissions.end(),
+        [&funcServerID](const FunctionalServicePermissions& server) { return server.mName == funcServerID; });
+    if (it == instance->mPermissions.end()) {
+        return result.mError;
+    }
+
+    result.mError         = Error::eNone;
+    result.mInstanceIdent = &instance->mIdent;
+    result.mPermissions   = &it->mPermissions;
+
+    return Error::eNone;
+}
+
+} // namespace permhandler
+} // namespace iam
+} // namespace aos
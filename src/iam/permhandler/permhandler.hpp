@@ -0,0 +1,249 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef PERMHANDLER_HPP_
+#define PERMHANDLER_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "error/error.hpp"
+#include "tools/rcu.hpp"
+
+namespace aos {
+namespace iam {
+namespace permhandler {
+
+/** @addtogroup iam Identification and Access Manager
+ *  @{
+ */
+
+/**
+ * Service instance identifier.
+ */
+struct InstanceIdent {
+    /**
+     * Service ID.
+     */
+    std::string mServiceID;
+
+    /**
+     * Subject ID.
+     */
+    std::string mSubjectID;
+
+    /**
+     * Instance index.
+     */
+    uint64_t mInstance = 0;
+
+    /**
+     * Compares instance identifiers.
+     *
+     * @param other identifier to compare with.
+     * @return bool.
+     */
+    bool operator==(const InstanceIdent& other) const
+    {
+        return mServiceID == other.mServiceID && mSubjectID == other.mSubjectID && mInstance == other.mInstance;
+    }
+
+    /**
+     * Compares instance identifiers.
+     *
+     * @param other identifier to compare with.
+     * @return bool.
+     */
+    bool operator!=(const InstanceIdent& other) const { return !operator==(other); }
+};
+
+/**
+ * Function permissions.
+ */
+struct FunctionPermissions {
+    /**
+     * Function name.
+     */
+    std::string mFunction;
+
+    /**
+     * Permissions granted for the function.
+     */
+    std::string mPermissions;
+};
+
+/**
+ * Permissions of functional server.
+ */
+struct FunctionalServicePermissions {
+    /**
+     * Functional server ID.
+     */
+    std::string mName;
+
+    /**
+     * Function permissions.
+     */
+    std::vector<FunctionPermissions> mPermissions;
+};
+
+/**
+ * Permission check of batch request.
+ */
+struct PermissionCheck {
+    /**
+     * Instance secret.
+     */
+    std::string mSecret;
+
+    /**
+     * Functional server ID.
+     */
+    std::string mFuncServerID;
+};
+
+/**
+ * Permission check result. Pointers refer to the permission table snapshot and stay valid while the read lock passed
+ * to the check is held.
+ */
+struct PermissionResult {
+    /**
+     * Check error, eNotFound if secret or functional server is unknown.
+     */
+    Error mError = Error::eNotFound;
+
+    /**
+     * Instance identifier, set if the check succeeded.
+     */
+    const InstanceIdent* mInstanceIdent = nullptr;
+
+    /**
+     * Function permissions, set if the check succeeded.
+     */
+    const std::vector<FunctionPermissions>* mPermissions = nullptr;
+};
+
+/**
+ * Maps instance secrets to functional server permissions. Lookups are served from an immutable hash table snapshot
+ * without locks, updates build a new snapshot and swap it in. Secrets are compared in constant time.
+ */
+class PermHandler {
+public:
+    /**
+     * Creates permission handler.
+     */
+    PermHandler();
+
+    /**
+     * Destroys permission handler.
+     */
+    ~PermHandler();
+
+    PermHandler(const PermHandler&) = delete;
+    PermHandler& operator=(const PermHandler&) = delete;
+
+    /**
+     * Registers instance permissions. If the instance is already registered, its permissions are replaced and the
+     * existing secret is returned. Waits for readers of the previous permission table, so it must not be called while
+     * a read lock is held.
+     *
+     * @param instanceIdent instance identifier.
+     * @param permissions functional servers permissions.
+     * @param[out] secret instance secret.
+     * @return Error eWrongState if called inside a read side critical section.
+     */
+    Error RegisterInstance(const InstanceIdent& instanceIdent,
+        const std::vector<FunctionalServicePermissions>& permissions, std::string& secret);
+
+    /**
+     * Unregisters instance. As RegisterInstance(), must not be called while a read lock is held.
+     *
+     * @param instanceIdent instance identifier.
+     * @return Error eWrongState if called inside a read side critical section.
+     */
+    Error UnregisterInstance(const InstanceIdent& instanceIdent);
+
+    /**
+     * Returns instance permissions for the functional server.
+     *
+     * @param secret instance secret.
+     * @param funcServerID functional server ID.
+     * @param[out] instanceIdent instance identifier.
+     * @param[out] permissions function permissions.
+     * @return Error eNotFound if secret or functional server is unknown.
+     */
+    Error GetPermissions(const std::string& secret, const std::string& funcServerID, InstanceIdent& instanceIdent,
+        std::vector<FunctionPermissions>& permissions) const;
+
+    /**
+     * Checks permissions of multiple instances against one permission table snapshot. Doesn't allocate memory: results
+     * refer to the snapshot, which is kept alive by the read lock held by the caller. Instances can't be registered or
+     * unregistered by the thread while the lock is held.
+     *
+     * @param lock read lock held while results are used.
+     * @param checks permission checks.
+     * @param count number of checks.
+     * @param[out] results check results, count elements.
+     * @return Error eNotFound if any check failed.
+     */
+    Error CheckPermissions(
+        const rcu::ReadLock& lock, const PermissionCheck* checks, size_t count, PermissionResult* results) const;
+
+private:
+    struct Instance {
+        std::string                               mSecret;
+        uint64_t                                  mHash = 0;
+        InstanceIdent                             mIdent;
+        std::vector<FunctionalServicePermissions> mPermissions;
+    };
+
+    using InstancePtr = std::shared_ptr<const Instance>;
+
+    // Open addressing table with linear probing, load factor is kept below 1/2.
+    struct Table {
+        std::vector<InstancePtr> mBuckets;
+        uint64_t                 mMask = 0;
+    };
+
+    uint64_t        Hash(const std::string& secret) const;
+    const Instance* Find(const Table& table, const std::string& secret) const;
+    Error           GenerateSecret(std::string& secret) const;
+    const Table*    UpdateTable();
+
+    static void FreeTable(const Table* table);
+
+    Error Check(
+        const Table* table, const std::string& secret, const std::string& funcServerID, PermissionResult& result) const;
+
+    uint64_t                  mHashKey = 0;
+    std::mutex                mMutex;
+    std::vector<InstancePtr>  mInstances;
+    std::atomic<const Table*> mTable {nullptr};
+};
+
+/** @}*/
+
+} // namespace permhandler
+} // namespace iam
+} // namespace aos
+
+#endif
@@ -0,0 +1,152 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <mutex>
+#include <unordered_map>
+
+#include <benchmark/benchmark.h>
+
+#include "permhandler.hpp"
+
+using namespace aos;
+using namespace aos::iam::permhandler;
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+namespace {
+
+constexpr size_t cNumInstances = 256;
+constexpr size_t cBatchSize    = 64;
+
+struct Registry {
+    Registry()
+    {
+        std::vector<FunctionalServicePermissions> permissions = {{"vis", {{"*", "rw"}}}};
+
+        mSecrets.resize(cNumInstances);
+
+        for (size_t i = 0; i < cNumInstances; i++) {
+            mHandler.RegisterInstance({"service", "subject", i}, permissions, mSecrets[i]);
+            mMutexMap[mSecrets[i]] = {{"service", "subject", i}, permissions};
+        }
+    }
+
+    PermHandler              mHandler;
+    std::vector<std::string> mSecrets;
+
+    // Baseline: map protected by a mutex.
+    std::mutex mMutex;
+    std::unordered_map<std::string, std::pair<InstanceIdent, std::vector<FunctionalServicePermissions>>> mMutexMap;
+};
+
+Registry& GetRegistry()
+{
+    static Registry sRegistry;
+
+    return sRegistry;
+}
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Benchmarks
+ **********************************************************************************************************************/
+
+static void GetPermissions(benchmark::State& state)
+{
+    auto&                            registry = GetRegistry();
+    InstanceIdent                    ident;
+    std::vector<FunctionPermissions> permissions;
+    size_t                           index = state.thread_index() * 31;
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(
+            registry.mHandler.GetPermissions(registry.mSecrets[index % cNumInstances], "vis", ident, permissions));
+
+        index++;
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void GetPermissionsMutex(benchmark::State& state)
+{
+    auto&                            registry = GetRegistry();
+    InstanceIdent                    ident;
+    std::vector<FunctionPermissions> permissions;
+    size_t                           index = state.thread_index() * 31;
+
+    for (auto _ : state) {
+        {
+            std::lock_guard<std::mutex> lock(registry.mMutex);
+
+            auto& entry = registry.mMutexMap[registry.mSecrets[index % cNumInstances]];
+
+            ident       = entry.first;
+            permissions = entry.second[0].mPermissions;
+        }
+
+        index++;
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Gateway checking a batch of requests: one call per request vs single batch call.
+static void CheckSingle(benchmark::State& state)
+{
+    auto&                            registry = GetRegistry();
+    InstanceIdent                    ident;
+    std::vector<FunctionPermissions> permissions;
+    std::string                      funcServerID = "vis";
+
+    for (auto _ : state) {
+        for (size_t i = 0; i < cBatchSize; i++) {
+            benchmark::DoNotOptimize(
+                registry.mHandler.GetPermissions(registry.mSecrets[i], funcServerID, ident, permissions));
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * cBatchSize);
+}
+
+static void CheckBatch(benchmark::State& state)
+{
+    auto&            registry = GetRegistry();
+    PermissionCheck  checks[cBatchSize];
+    PermissionResult results[cBatchSize];
+
+    for (size_t i = 0; i < cBatchSize; i++) {
+        checks[i] = {registry.mSecrets[i], "vis"};
+    }
+
+    for (auto _ : state) {
+        rcu::ReadLock lock;
+
+        benchmark::DoNotOptimize(registry.mHandler.CheckPermissions(lock, checks, cBatchSize, results));
+    }
+
+    state.SetItemsProcessed(state.iterations() * cBatchSize);
+}
+
+BENCHMARK(GetPermissions)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK(GetPermissionsMutex)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK(CheckSingle);
+BENCHMARK(CheckBatch);
@@ -0,0 +1,265 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Copyright (C) 2023 Renesas Electronics Corporation.
+// Copyright (C) 2023 EPAM Systems, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "permhandler.hpp"
+
+using namespace aos;
+using namespace aos::iam::permhandler;
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+namespace {
+
+std::vector<FunctionalServicePermissions> MakePermissions(const std::string& value)
+{
+    return {{"vis", {{"*", value}, {"test", "r"}}}, {"sm", {{"GetInfo", value}}}};
+}
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Tests
+ **********************************************************************************************************************/
+
+TEST(permhandler, GetPermissions)
+{
+    PermHandler                      handler;
+    InstanceIdent                    instance {"service1", "subject1", 1}, other {"service1", "subject1", 2};
+    InstanceIdent                    ident;
+    std::vector<FunctionPermissions> permissions;
+    std::string                      secret, otherSecret;
+
+    EXPECT_EQ(handler.GetPermissions("unknown", "vis", ident, permissions), Error::eNotFound);
+
+    ASSERT_EQ(handler.RegisterInstance(instance, MakePermissions("rw"), secret), Error::eNone);
+    ASSERT_EQ(handler.RegisterInstance(other, MakePermissions("r"), otherSecret), Error::eNone);
+
+    EXPECT_EQ(secret.size(), 32);
+    EXPECT_NE(secret, otherSecret);
+
+    ASSERT_EQ(handler.GetPermissions(secret, "vis", ident, permissions), Error::eNone);
+    EXPECT_EQ(ident, instance);
+    ASSERT_EQ(permissions.size(), 2);
+    EXPECT_EQ(permissions[0].mFunction, "*");
+    EXPECT_EQ(permissions[0].mPermissions, "rw");
+
+    ASSERT_EQ(handler.GetPermissions(otherSecret, "sm", ident, permissions), Error::eNone);
+    EXPECT_EQ(ident, other);
+    ASSERT_EQ(permissions.size(), 1);
+    EXPECT_EQ(permissions[0].mPermissions, "r");
+
+    EXPECT_EQ(handler.GetPermissions(secret, "unknown", ident, permissions), Error::eNotFound);
+
+    // Secret differing in the last character only.
+    auto wrongSecret = secret;
+
+    wrongSecret.back() = wrongSecret.back() == '0' ? '1' : '0';
+
+    EXPECT_EQ(handler.GetPermissions(wrongSecret, "vis", ident, permissions), Error::eNotFound);
+    EXPECT_EQ(handler.GetPermissions(secret.substr(1), "vis", ident, permissions), Error::eNotFound);
+}
+
+TEST(permhandler, RegisterInstance)
+{
+    PermHandler                      handler;
+    InstanceIdent                    instance {"service1", "subject1", 1}, ident;
+    std::vector<FunctionPermissions> permissions;
+    std::string                      secret, newSecret;
+
+    ASSERT_EQ(handler.RegisterInstance(instance, MakePermissions("rw"), secret), Error::eNone);
+
+    // Registering again replaces permissions and keeps the secret.
+    ASSERT_EQ(handler.RegisterInstance(instance, MakePermissions("r"), newSecret), Error::eNone);
+    EXPECT_EQ(newSecret, secret);
+
+    ASSERT_EQ(handler.GetPermissions(secret, "sm", ident, permissions), Error::eNone);
+    EXPECT_EQ(permissions[0].mPermissions, "r");
+
+    ASSERT_EQ(handler.UnregisterInstance(instance), Error::eNone);
+    EXPECT_EQ(handler.UnregisterInstance(instance), Error::eNotFound);
+
+    EXPECT_EQ(handler.GetPermissions(secret, "sm", ident, permissions), Error::eNotFound);
+}
+
+TEST(permhandler, ManyInstances)
+{
+    PermHandler              handler;
+    std::vector<std::string> secrets(500);
+
+    for (size_t i = 0; i < secrets.size(); i++) {
+        ASSERT_EQ(handler.RegisterInstance({"service", "subject", i}, MakePermissions(std::to_string(i)), secrets[i]),
+            Error::eNone);
+    }
+
+    for (size_t i = 0; i < secrets.size(); i += 2) {
+        ASSERT_EQ(handler.UnregisterInstance({"service", "subject", i}), Error::eNone);
+    }
+
+    for (size_t i = 0; i < secrets.size(); i++) {
+        InstanceIdent                    ident;
+        std::vector<FunctionPermissions> permissions;
+
+        if (i % 2 == 0) {
+            EXPECT_EQ(handler.GetPermissions(secrets[i], "sm", ident, permissions), Error::eNotFound);
+
+            continue;
+        }
+
+        ASSERT_EQ(handler.GetPermissions(secrets[i], "sm", ident, permissions), Error::eNone);
+        EXPECT_EQ(ident.mInstance, i);
+        EXPECT_EQ(permissions[0].mPermissions, std::to_string(i));
+    }
+}
+
+TEST(permhandler, CheckPermissions)
+{
+    PermHandler   handler;
+    InstanceIdent instance {"service1", "subject1", 1}, other {"service2", "subject1", 1};
+    std::string   secret, otherSecret;
+
+    ASSERT_EQ(handler.RegisterInstance(instance, MakePermissions("rw"), secret), Error::eNone);
+    ASSERT_EQ(handler.RegisterInstance(other, MakePermissions("r"), otherSecret), Error::eNone);
+
+    PermissionCheck checks[] = {
+        {secret, "vis"},
+        {otherSecret, "sm"},
+        {"unknown", "vis"},
+        {secret, "unknown"},
+    };
+    PermissionResult results[4];
+
+    {
+        rcu::ReadLock lock;
+
+        EXPECT_EQ(handler.CheckPermissions(lock, checks, 2, results), Error::eNone);
+        EXPECT_EQ(handler.CheckPermissions(lock, checks, 4, results), Error::eNotFound);
+    }
+
+    std::thread unregisterThread;
+
+    {
+        rcu::ReadLock lock;
+
+        EXPECT_EQ(handler.CheckPermissions(lock, checks, 4, results), Error::eNotFound);
+
+        // Results stay valid while the lock is held, even if the instance is unregistered meanwhile.
+        unregisterThread = std::thread([&] { EXPECT_EQ(handler.UnregisterInstance(other), Error::eNone); });
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+        EXPECT_EQ(results[0].mError, Error::eNone);
+        EXPECT_EQ(results[1].mError, Error::eNone);
+        EXPECT_EQ(results[2].mError, Error::eNotFound);
+        EXPECT_EQ(results[2].mInstanceIdent, nullptr);
+        EXPECT_EQ(results[3].mError, Error::eNotFound);
+        EXPECT_EQ(results[3].mPermissions, nullptr);
+
+        if (results[0].mError == Error::eNone && results[1].mError == Error::eNone) {
+            EXPECT_EQ(*results[0].mInstanceIdent, instance);
+            EXPECT_EQ(results[0].mPermissions->size(), 2);
+            EXPECT_EQ(results[0].mPermissions->front().mPermissions, "rw");
+            EXPECT_EQ(*results[1].mInstanceIdent, other);
+            EXPECT_EQ(results[1].mPermissions->front().mPermissions, "r");
+        }
+    }
+
+    unregisterThread.join();
+
+    rcu::ReadLock lock;
+
+    EXPECT_EQ(handler.CheckPermissions(lock, checks, 2, results), Error::eNotFound);
+    EXPECT_EQ(results[1].mError, Error::eNotFound);
+}
+
+TEST(permhandler, UpdateWhileReading)
+{
+    PermHandler   handler;
+    InstanceIdent instance {"service1", "subject1", 1};
+    std::string   secret;
+
+    ASSERT_EQ(handler.RegisterInstance(instance, MakePermissions("rw"), secret), Error::eNone);
+
+    // Updates inside a read side critical section would wait for the caller forever, they are rejected instead.
+    {
+        rcu::ReadLock    lock;
+        PermissionCheck  check {secret, "vis"};
+        PermissionResult result;
+
+        ASSERT_EQ(handler.CheckPermissions(lock, &check, 1, &result), Error::eNone);
+        EXPECT_EQ(handler.RegisterInstance(instance, MakePermissions("r"), secret), Error::eWrongState);
+        EXPECT_EQ(handler.UnregisterInstance(instance), Error::eWrongState);
+        EXPECT_EQ(result.mPermissions->front().mPermissions, "rw");
+    }
+
+    EXPECT_EQ(handler.RegisterInstance(instance, MakePermissions("r"), secret), Error::eNone);
+    EXPECT_EQ(handler.UnregisterInstance(instance), Error::eNone);
+}
+
+TEST(permhandler, ConcurrentUpdates)
+{
+    PermHandler       handler;
+    InstanceIdent     instance {"service", "subject", 0};
+    std::string       secret;
+    std::atomic<bool> stop {false};
+    std::atomic<int>  failures {0};
+
+    ASSERT_EQ(handler.RegisterInstance(instance, MakePermissions("rw"), secret), Error::eNone);
+
+    std::vector<std::thread> readers;
+
+    for (int i = 0; i < 4; i++) {
+        readers.emplace_back([&] {
+            InstanceIdent                    ident;
+            std::vector<FunctionPermissions> permissions;
+
+            while (!stop) {
+                if (handler.GetPermissions(secret, "vis", ident, permissions) != Error::eNone || ident != instance
+                    || permissions.size() != 2) {
+                    failures++;
+                }
+            }
+        });
+    }
+
+    // Readers keep finding the instance while other instances come and go.
+    for (uint64_t i = 1; i < 200; i++) {
+        std::string otherSecret;
+
+        ASSERT_EQ(handler.RegisterInstance({"service", "subject", i}, MakePermissions("r"), otherSecret), Error::eNone);
+
+        if (i % 3 == 0) {
+            ASSERT_EQ(handler.UnregisterInstance({"service", "subject", i - 1}), Error::eNone);
+        }
+    }
+
+    stop = true;
+
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    EXPECT_EQ(failures, 0);
+}